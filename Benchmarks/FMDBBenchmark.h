@@ -0,0 +1,44 @@
+#import <Foundation/Foundation.h>
+
+/**
+ *  Measures the helper methods against synthetic tables of increasing size.
+ *
+ *  Each measurement is written to the output as a single line of JSON, so that results can be collected and compared
+ *  across releases. Every line has a `benchmark` name, the number of `rows` in the table, the elapsed `seconds`, and
+ *  the sqlite version, along with measurements specific to the benchmark, e.g. `rowsPerSecond`.
+ */
+@interface FMDBBenchmark : NSObject
+
+/**
+ *  Creates a benchmark that runs against tables of each of the given sizes.
+ *
+ *  @param  rowCounts   The table sizes to measure, as `NSNumber`s.
+ *  @param  output      Where results are written.
+ */
+- (instancetype)initWithRowCounts:(NSArray *)rowCounts
+                           output:(NSFileHandle *)output;
+
+/**
+ *  Returns the table sizes 10^3, 10^4, ... up to and including `maxRowCount`.
+ */
++ (NSArray *)rowCountsUpTo:(NSUInteger)maxRowCount;
+
+/**
+ *  If set, only benchmarks whose names contain this string are run.
+ */
+@property (nonatomic, copy) NSString * filter;
+
+/**
+ *  The minimum time spent repeating each fast operation, such as a count, to get a stable measurement. Defaults to
+ *  0.5 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval minimumDuration;
+
+/**
+ *  Runs every benchmark.
+ *
+ *  @return `YES` if every benchmark ran, or `NO` if one of them failed.
+ */
+- (BOOL)run:(NSError **)error_p;
+
+@end
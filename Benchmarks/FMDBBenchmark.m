@@ -0,0 +1,643 @@
+#import "FMDBBenchmark.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import <stdio.h>
+#import <unistd.h>
+#if __APPLE__
+#import <mach/mach.h>
+#endif
+
+static NSString * const FMDBBenchmarkTableName = @"people";
+
+static const NSUInteger FMDBBenchmarkDistinctValueCount = 100;
+
+static const NSUInteger FMDBBenchmarkSmallListSize = 10;
+
+static const NSUInteger FMDBBenchmarkLargeListSize = 1000;
+
+static const NSTimeInterval FMDBBenchmarkDefaultMinimumDuration = 0.5;
+
+static double FMDBBenchmarkRate(double count, NSTimeInterval seconds)
+{
+  return (seconds > 0 ? count / seconds : 0);
+}
+
+static uint64_t FMDBBenchmarkNextRandom(uint64_t * state)
+{
+  // xorshift, so that every platform selects the same rows
+  uint64_t value = *state;
+  value ^= value << 13;
+  value ^= value >> 7;
+  value ^= value << 17;
+  *state = value;
+  return value;
+}
+
+static uint64_t FMDBBenchmarkResidentMemorySize(void)
+{
+#if __APPLE__
+  struct mach_task_basic_info info;
+  mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount) != KERN_SUCCESS)
+  {
+    return 0;
+  }
+  return info.resident_size;
+#else
+  // the second field of /proc/self/statm is the number of resident pages
+  FILE * statm = fopen("/proc/self/statm", "r");
+  if (statm == NULL)
+  {
+    return 0;
+  }
+  
+  unsigned long long pageCount = 0;
+  unsigned long long residentPageCount = 0;
+  int fieldCount = fscanf(statm, "%llu %llu", &pageCount, &residentPageCount);
+  fclose(statm);
+  return (fieldCount == 2 ? residentPageCount * (uint64_t)sysconf(_SC_PAGESIZE) : 0);
+#endif
+}
+
+/**
+ *  A row of the benchmark table, read by the `allObjects` benchmark.
+ */
+@interface FMDBBenchmarkPerson : NSObject
+
+@property (nonatomic, copy) NSString * firstName;
+@property (nonatomic, copy) NSString * lastName;
+@property (nonatomic, assign) NSInteger age;
+@property (nonatomic, assign) double score;
+
+@end
+
+@implementation FMDBBenchmarkPerson
+@end
+
+@implementation FMDBBenchmark
+{
+  NSArray * _rowCounts;
+  NSFileHandle * _output;
+  NSString * _sqliteVersion;
+  uint64_t _randomState;
+}
+
+- (instancetype)initWithRowCounts:(NSArray *)rowCounts
+                           output:(NSFileHandle *)output
+{
+  NSParameterAssert(rowCounts.count > 0);
+  NSParameterAssert(output != nil);
+  
+  self = [super init];
+  if (self)
+  {
+    _rowCounts = [rowCounts copy];
+    _output = output;
+    _sqliteVersion = [NSString stringWithUTF8String:sqlite3_libversion()];
+    _minimumDuration = FMDBBenchmarkDefaultMinimumDuration;
+  }
+  return self;
+}
+
++ (NSArray *)rowCountsUpTo:(NSUInteger)maxRowCount
+{
+  NSMutableArray * rowCounts = [[NSMutableArray alloc] init];
+  for (NSUInteger rowCount = 1000; rowCount <= maxRowCount; rowCount *= 10)
+  {
+    [rowCounts addObject:@(rowCount)];
+  }
+  return rowCounts;
+}
+
+- (BOOL)run:(NSError **)error_p
+{
+  for (NSNumber * rowCount in _rowCounts)
+  {
+    NSError * error = nil;
+    BOOL succeeded;
+    @autoreleasepool
+    {
+      succeeded = [self runWithRowCount:rowCount.unsignedIntegerValue
+                                  error:&error];
+    }
+    
+    if (NO == succeeded)
+    {
+      if (error_p != NULL)
+      {
+        *error_p = error;
+      }
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (BOOL)runWithRowCount:(NSUInteger)rowCount
+                  error:(NSError **)error_p
+{
+  // the same rows are selected for every run
+  _randomState = 88172645463325252ull;
+  
+  for (NSNumber * batchSize in @[ @1, @10, @100 ])
+  {
+    if (NO == [self measureInsertWithRowCount:rowCount
+                                    batchSize:batchSize.unsignedIntegerValue
+                                        error:error_p])
+    {
+      return NO;
+    }
+  }
+  
+  if (NO == [self measureBulkInsertWithRowCount:rowCount
+                                          error:error_p])
+  {
+    return NO;
+  }
+  
+  FMDatabase * database = [self openDatabaseWithRowCount:rowCount
+                                                   error:error_p];
+  if (database == nil)
+  {
+    return NO;
+  }
+  
+  BOOL succeeded = ([self measureSelectMatchingValuesInDatabase:database
+                                                       rowCount:rowCount
+                                                       listSize:FMDBBenchmarkSmallListSize
+                                                          error:error_p] &&
+                    [self measureSelectMatchingValuesInDatabase:database
+                                                       rowCount:rowCount
+                                                       listSize:FMDBBenchmarkLargeListSize
+                                                          error:error_p] &&
+                    [self measureCountInDatabase:database
+                                        rowCount:rowCount
+                                           error:error_p] &&
+                    [self measureCountMatchingValuesInDatabase:database
+                                                      rowCount:rowCount
+                                                         error:error_p] &&
+                    [self measureAllRecordsInDatabase:database
+                                             rowCount:rowCount
+                                           modelClass:Nil
+                                                error:error_p] &&
+                    [self measureAllRecordsInDatabase:database
+                                             rowCount:rowCount
+                                           modelClass:[FMDBBenchmarkPerson class]
+                                                error:error_p] &&
+                    [self measureUpdateInDatabase:database
+                                         rowCount:rowCount
+                                            error:error_p] &&
+                    [self measureDeleteInDatabase:database
+                                         rowCount:rowCount
+                                            error:error_p]);
+  [database close];
+  return succeeded;
+}
+
+// ========== DATABASES ================================================================================================
+#pragma mark - Databases
+
++ (NSArray *)columnNames
+{
+  return @[ @"firstName", @"lastName", @"age", @"score" ];
+}
+
++ (NSArray *)rowAtIndex:(NSUInteger)rowIdx
+{
+  NSUInteger value = rowIdx % FMDBBenchmarkDistinctValueCount;
+  return @[ [NSString stringWithFormat:@"First %lu", (unsigned long)rowIdx],
+            [NSString stringWithFormat:@"Last %lu", (unsigned long)value],
+            @(value),
+            @(rowIdx * 0.5) ];
+}
+
+- (FMDatabase *)openEmptyDatabase:(NSError **)error_p
+{
+  // a temporary database is stored on disk, so writes are measured realistically
+  FMDatabase * database = [FMDatabase temporaryDatabase];
+  if (NO == [database open:error_p])
+  {
+    return nil;
+  }
+  
+  if (NO == [database createTableWithName:FMDBBenchmarkTableName
+                                  columns:@[ @"id INTEGER PRIMARY KEY",
+                                             @"firstName TEXT",
+                                             @"lastName TEXT",
+                                             @"age INTEGER",
+                                             @"score REAL" ]
+                              constraints:nil
+                                    error:error_p])
+  {
+    [database close];
+    return nil;
+  }
+  
+  return database;
+}
+
+- (FMDatabase *)openDatabaseWithRowCount:(NSUInteger)rowCount
+                                   error:(NSError **)error_p
+{
+  FMDatabase * database = [self openEmptyDatabase:error_p];
+  if (database == nil)
+  {
+    return nil;
+  }
+  
+  __block NSUInteger rowIdx = 0;
+  FMDBBulkInsertResult * result = [database bulkInsertInto:FMDBBenchmarkTableName
+                                                   columns:[FMDBBenchmark columnNames]
+                                             rowsFromBlock:^NSArray *{
+                                               return (rowIdx < rowCount
+                                                       ? [FMDBBenchmark rowAtIndex:rowIdx++]
+                                                       : nil);
+                                             }
+                                            commitInterval:0
+                                                     error:error_p];
+  if (result == nil || NO == [database createIndexWithName:@"people_lastName"
+                                                 tableName:FMDBBenchmarkTableName
+                                                   columns:@[ @"lastName" ]
+                                                     error:error_p])
+  {
+    [database close];
+    return nil;
+  }
+  
+  return database;
+}
+
+// ========== MEASUREMENTS =============================================================================================
+#pragma mark - Measurements
+
+- (BOOL)shouldMeasure:(NSString *)benchmarkName
+{
+  return (self.filter.length == 0 || [benchmarkName rangeOfString:self.filter].location != NSNotFound);
+}
+
+- (void)reportBenchmark:(NSString *)benchmarkName
+               rowCount:(NSUInteger)rowCount
+                seconds:(NSTimeInterval)seconds
+           measurements:(NSDictionary *)measurements
+{
+  NSMutableDictionary * result = [[NSMutableDictionary alloc] init];
+  result[@"benchmark"] = benchmarkName;
+  result[@"rows"] = @(rowCount);
+  result[@"seconds"] = @(seconds);
+  result[@"sqlite"] = _sqliteVersion;
+  [result addEntriesFromDictionary:measurements];
+  
+  NSMutableData * line = [[NSJSONSerialization dataWithJSONObject:result
+                                                          options:0
+                                                            error:NULL] mutableCopy];
+  [line appendBytes:"\n" length:1];
+  [_output writeData:line];
+}
+
+/**
+ *  Repeats an operation until at least `minimumDuration` has passed, and reports the time per operation.
+ */
+- (BOOL)measureRepeatedly:(NSString *)benchmarkName
+                 rowCount:(NSUInteger)rowCount
+             measurements:(NSDictionary *)measurements
+                operation:(BOOL (^)(NSError ** error_p))operation
+                    error:(NSError **)error_p
+{
+  NSUInteger operationCount = 0;
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  NSTimeInterval seconds = 0;
+  do
+  {
+    NSError * error = nil;
+    BOOL succeeded;
+    @autoreleasepool
+    {
+      succeeded = operation(&error);
+    }
+    
+    if (NO == succeeded)
+    {
+      if (error_p != NULL)
+      {
+        *error_p = error;
+      }
+      return NO;
+    }
+    
+    operationCount++;
+    seconds = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  } while (seconds < self.minimumDuration);
+  
+  NSMutableDictionary * allMeasurements = [measurements mutableCopy] ?: [[NSMutableDictionary alloc] init];
+  allMeasurements[@"operations"] = @(operationCount);
+  allMeasurements[@"operationsPerSecond"] = @(FMDBBenchmarkRate(operationCount, seconds));
+  allMeasurements[@"secondsPerOperation"] = @(seconds / operationCount);
+  
+  [self reportBenchmark:benchmarkName
+               rowCount:rowCount
+                seconds:seconds
+           measurements:allMeasurements];
+  return YES;
+}
+
+// ---------- INSERT ---------------------------------------------------------------------------------------------------
+#pragma mark Insert
+
+- (BOOL)measureInsertWithRowCount:(NSUInteger)rowCount
+                        batchSize:(NSUInteger)batchSize
+                            error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"insert"])
+  {
+    return YES;
+  }
+  
+  FMDatabase * database = [self openEmptyDatabase:error_p];
+  if (database == nil)
+  {
+    return NO;
+  }
+  
+  NSArray * columnNames = [FMDBBenchmark columnNames];
+  NSMutableArray * batch = [[NSMutableArray alloc] initWithCapacity:batchSize];
+  BOOL succeeded = YES;
+  
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  [database beginTransaction];
+  for (NSUInteger rowIdx = 0; rowIdx < rowCount && succeeded; rowIdx++)
+  {
+    [batch addObject:[FMDBBenchmark rowAtIndex:rowIdx]];
+    if (batch.count == batchSize || rowIdx == rowCount - 1)
+    {
+      succeeded = [database insertInto:FMDBBenchmarkTableName
+                               columns:columnNames
+                                values:batch
+                                 error:error_p];
+      [batch removeAllObjects];
+    }
+  }
+  succeeded = succeeded && [database commit];
+  NSTimeInterval seconds = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  
+  if (NO == succeeded && error_p != NULL && *error_p == nil)
+  {
+    *error_p = database.lastError;
+  }
+  [database close];
+  
+  if (succeeded)
+  {
+    [self reportBenchmark:@"insert"
+                 rowCount:rowCount
+                  seconds:seconds
+             measurements:@{ @"batchSize": @(batchSize),
+                             @"rowsPerSecond": @(FMDBBenchmarkRate(rowCount, seconds)) }];
+  }
+  return succeeded;
+}
+
+- (BOOL)measureBulkInsertWithRowCount:(NSUInteger)rowCount
+                                error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"bulkInsert"])
+  {
+    return YES;
+  }
+  
+  FMDatabase * database = [self openEmptyDatabase:error_p];
+  if (database == nil)
+  {
+    return NO;
+  }
+  
+  __block NSUInteger rowIdx = 0;
+  FMDBBulkInsertResult * result = [database bulkInsertInto:FMDBBenchmarkTableName
+                                                   columns:[FMDBBenchmark columnNames]
+                                             rowsFromBlock:^NSArray *{
+                                               return (rowIdx < rowCount
+                                                       ? [FMDBBenchmark rowAtIndex:rowIdx++]
+                                                       : nil);
+                                             }
+                                            commitInterval:0
+                                                     error:error_p];
+  [database close];
+  if (result == nil)
+  {
+    return NO;
+  }
+  
+  [self reportBenchmark:@"bulkInsert"
+               rowCount:rowCount
+                seconds:result.duration
+           measurements:@{ @"rowsPerSecond": @(result.rowsPerSecond) }];
+  return YES;
+}
+
+// ---------- SELECT ---------------------------------------------------------------------------------------------------
+#pragma mark Select
+
+- (BOOL)measureSelectMatchingValuesInDatabase:(FMDatabase *)database
+                                     rowCount:(NSUInteger)rowCount
+                                     listSize:(NSUInteger)listSize
+                                        error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"selectMatchingValues"])
+  {
+    return YES;
+  }
+  
+  // large lists don't fit in sqlite's limit of bound variables, so they're matched through a temporary table
+  database.matchingSetThreshold = FMDBBenchmarkSmallListSize;
+  
+  return [self measureRepeatedly:@"selectMatchingValues"
+                        rowCount:rowCount
+                    measurements:@{ @"listSize": @(listSize) }
+                       operation:^BOOL(NSError ** operationError_p) {
+                         NSMutableArray * rowIds = [[NSMutableArray alloc] initWithCapacity:listSize];
+                         for (NSUInteger idIdx = 0; idIdx < listSize; idIdx++)
+                         {
+                           [rowIds addObject:@(FMDBBenchmarkNextRandom(&self->_randomState) % rowCount + 1)];
+                         }
+                         
+                         FMResultSet * results = [database selectResultsFrom:FMDBBenchmarkTableName
+                                                              matchingValues:@{ @"id": rowIds }
+                                                                     orderBy:nil
+                                                                       error:operationError_p];
+                         return (results.allRecords != nil);
+                       }
+                           error:error_p];
+}
+
+/**
+ *  Measures reading a whole table as dictionaries, or as objects of `modelClass` if it isn't `Nil`.
+ */
+- (BOOL)measureAllRecordsInDatabase:(FMDatabase *)database
+                           rowCount:(NSUInteger)rowCount
+                         modelClass:(Class)modelClass
+                              error:(NSError **)error_p
+{
+  NSString * benchmarkName = (modelClass != Nil ? @"allObjects" : @"allRecords");
+  if (NO == [self shouldMeasure:benchmarkName])
+  {
+    return YES;
+  }
+  
+  NSError * error = nil;
+  BOOL succeeded = NO;
+  NSUInteger recordCount = 0;
+  uint64_t residentBytes = 0;
+  NSTimeInterval seconds = 0;
+  @autoreleasepool
+  {
+    uint64_t residentSizeBefore = FMDBBenchmarkResidentMemorySize();
+    NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+    NSArray * records = nil;
+    if (modelClass != Nil)
+    {
+      FMResultSet * results = [database selectResultsFrom:FMDBBenchmarkTableName
+                                                  orderBy:nil
+                                                    error:&error];
+      records = [results allObjectsOfClass:modelClass];
+    }
+    else
+    {
+      records = [database selectAllFrom:FMDBBenchmarkTableName
+                                orderBy:nil
+                                  error:&error];
+    }
+    seconds = [NSDate timeIntervalSinceReferenceDate] - startTime;
+    uint64_t residentSizeAfter = FMDBBenchmarkResidentMemorySize();
+    
+    succeeded = (records != nil);
+    recordCount = records.count;
+    residentBytes = (residentSizeAfter > residentSizeBefore ? residentSizeAfter - residentSizeBefore : 0);
+  }
+  
+  if (NO == succeeded)
+  {
+    if (error_p != NULL)
+    {
+      *error_p = error;
+    }
+    return NO;
+  }
+  
+  [self reportBenchmark:benchmarkName
+               rowCount:rowCount
+                seconds:seconds
+           measurements:@{ @"rowsPerSecond": @(FMDBBenchmarkRate(recordCount, seconds)),
+                           @"residentBytes": @(residentBytes),
+                           @"bytesPerRow": @(FMDBBenchmarkRate(residentBytes, recordCount)) }];
+  return YES;
+}
+
+// ---------- COUNT ----------------------------------------------------------------------------------------------------
+#pragma mark Count
+
+- (BOOL)measureCountInDatabase:(FMDatabase *)database
+                      rowCount:(NSUInteger)rowCount
+                         error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"countFrom"])
+  {
+    return YES;
+  }
+  
+  return [self measureRepeatedly:@"countFrom"
+                        rowCount:rowCount
+                    measurements:nil
+                       operation:^BOOL(NSError ** operationError_p) {
+                         return ([database countFrom:FMDBBenchmarkTableName
+                                               error:operationError_p] >= 0);
+                       }
+                           error:error_p];
+}
+
+- (BOOL)measureCountMatchingValuesInDatabase:(FMDatabase *)database
+                                    rowCount:(NSUInteger)rowCount
+                                       error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"countMatchingValues"])
+  {
+    return YES;
+  }
+  
+  return [self measureRepeatedly:@"countMatchingValues"
+                        rowCount:rowCount
+                    measurements:nil
+                       operation:^BOOL(NSError ** operationError_p) {
+                         uint64_t random = FMDBBenchmarkNextRandom(&self->_randomState);
+                         uint64_t value = random % FMDBBenchmarkDistinctValueCount;
+                         NSString * lastName = [NSString stringWithFormat:@"Last %llu", (unsigned long long)value];
+                         return ([database countFrom:FMDBBenchmarkTableName
+                                      matchingValues:@{ @"lastName": lastName }
+                                               error:operationError_p] >= 0);
+                       }
+                           error:error_p];
+}
+
+// ---------- UPDATE AND DELETE ----------------------------------------------------------------------------------------
+#pragma mark Update and Delete
+
+- (BOOL)measureUpdateInDatabase:(FMDatabase *)database
+                       rowCount:(NSUInteger)rowCount
+                          error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"updateWhere"])
+  {
+    return YES;
+  }
+  
+  // updates a tenth of the rows
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  NSInteger changes = [database update:FMDBBenchmarkTableName
+                                values:@{ @"score": @0 }
+                                 where:@"age < ?"
+                             arguments:@[ @(FMDBBenchmarkDistinctValueCount / 10) ]
+                                 error:error_p];
+  NSTimeInterval seconds = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  if (changes < 0)
+  {
+    return NO;
+  }
+  
+  [self reportBenchmark:@"updateWhere"
+               rowCount:rowCount
+                seconds:seconds
+           measurements:@{ @"changes": @(changes),
+                           @"rowsPerSecond": @(FMDBBenchmarkRate(changes, seconds)) }];
+  return YES;
+}
+
+- (BOOL)measureDeleteInDatabase:(FMDatabase *)database
+                       rowCount:(NSUInteger)rowCount
+                          error:(NSError **)error_p
+{
+  if (NO == [self shouldMeasure:@"deleteWhere"])
+  {
+    return YES;
+  }
+  
+  // deletes a tenth of the rows
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  NSInteger changes = [database deleteFrom:FMDBBenchmarkTableName
+                                     where:@"age >= ?"
+                                 arguments:@[ @(FMDBBenchmarkDistinctValueCount * 9 / 10) ]
+                                     error:error_p];
+  NSTimeInterval seconds = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  if (changes < 0)
+  {
+    return NO;
+  }
+  
+  [self reportBenchmark:@"deleteWhere"
+               rowCount:rowCount
+                seconds:seconds
+           measurements:@{ @"changes": @(changes),
+                           @"rowsPerSecond": @(FMDBBenchmarkRate(changes, seconds)) }];
+  return YES;
+}
+
+@end
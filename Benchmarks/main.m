@@ -0,0 +1,35 @@
+#import <Foundation/Foundation.h>
+#import "FMDBBenchmark.h"
+
+static const NSInteger FMDBBenchmarkDefaultMaxRowCount = 1000000;
+
+int main(int argc, const char * argv[])
+{
+  @autoreleasepool
+  {
+    // options are passed as arguments, e.g. `-maxRows 10000000 -filter insert -minimumDuration 1`
+    NSUserDefaults * options = [NSUserDefaults standardUserDefaults];
+    NSInteger maxRowCount = [options integerForKey:@"maxRows"];
+    if (maxRowCount <= 0)
+    {
+      maxRowCount = FMDBBenchmarkDefaultMaxRowCount;
+    }
+    
+    NSArray * rowCounts = [FMDBBenchmark rowCountsUpTo:MAX(maxRowCount, 1000)];
+    FMDBBenchmark * benchmark = [[FMDBBenchmark alloc] initWithRowCounts:rowCounts
+                                                                  output:[NSFileHandle fileHandleWithStandardOutput]];
+    benchmark.filter = [options stringForKey:@"filter"];
+    if ([options objectForKey:@"minimumDuration"] != nil)
+    {
+      benchmark.minimumDuration = [options doubleForKey:@"minimumDuration"];
+    }
+    
+    NSError * error = nil;
+    if (NO == [benchmark run:&error])
+    {
+      fprintf(stderr, "Benchmark failed: %s\n", error.description.UTF8String);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,127 @@
+#import <Foundation/Foundation.h>
+#import <sqlite3.h>
+
+/**
+ *  The type of values stored in an `FMDBColumnBuffer`.
+ */
+typedef NS_ENUM(NSInteger, FMDBColumnBufferType)
+{
+  /** Values are read with `sqlite3_column_int64` into an `int64_t` array. */
+  FMDBColumnBufferTypeInteger,
+  /** Values are read with `sqlite3_column_double` into a `double` array. */
+  FMDBColumnBufferTypeReal,
+  /** UTF-8 text is copied into the buffer's arena. */
+  FMDBColumnBufferTypeText,
+  /** Blobs are copied into the buffer's arena. */
+  FMDBColumnBufferTypeBlob,
+};
+
+/**
+ *  Holds the values of a single result column, for up to `capacity` rows, in contiguous memory. Values are read
+ *  directly from the statement without creating objects, so the buffer can be passed to vectorized code.
+ *
+ *  Integer and real values are stored in packed `int64_t` or `double` arrays. Text and blob values are copied into a
+ *  single arena, and located by their offset and length. NULL values are recorded in a bitmap, with one bit per row.
+ *
+ *  Buffers are reused: each read overwrites the values from the previous read. See
+ *  `-[FMResultSet readColumnsIntoBuffers:]`.
+ */
+@interface FMDBColumnBuffer : NSObject
+
+/**
+ *  Creates a buffer that allocates its own storage.
+ *
+ *  @param  columnIdx   The index of the result column to read.
+ *  @param  type        The type of values to read.
+ *  @param  capacity    The maximum number of rows to read at once.
+ */
+- (instancetype)initWithColumnIndex:(int)columnIdx
+                               type:(FMDBColumnBufferType)type
+                           capacity:(NSUInteger)capacity;
+
+/**
+ *  Creates an integer or real buffer that reads into caller-supplied storage. The storage is not freed by the buffer,
+ *  and must outlive it.
+ *
+ *  @param  columnIdx   The index of the result column to read.
+ *  @param  type        `FMDBColumnBufferTypeInteger` or `FMDBColumnBufferTypeReal`.
+ *  @param  capacity    The number of values that fit in `values`.
+ *  @param  values      An array of `capacity` `int64_t` or `double` values.
+ *  @param  nullBitmap  An array of at least `(capacity + 7) / 8` bytes, or `NULL` to allocate one.
+ */
+- (instancetype)initWithColumnIndex:(int)columnIdx
+                               type:(FMDBColumnBufferType)type
+                           capacity:(NSUInteger)capacity
+                             values:(void *)values
+                         nullBitmap:(uint8_t *)nullBitmap;
+
+@property (nonatomic, assign, readonly) int columnIndex;
+@property (nonatomic, assign, readonly) FMDBColumnBufferType type;
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+ *  The number of rows read into the buffer.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ *  The values of an integer buffer, or `NULL`.
+ */
+@property (nonatomic, assign, readonly) const int64_t * integers;
+
+/**
+ *  The values of a real buffer, or `NULL`.
+ */
+@property (nonatomic, assign, readonly) const double * reals;
+
+/**
+ *  One bit per row, set if the row's value is NULL. Bit `i % 8` of byte `i / 8` corresponds to row `i`.
+ */
+@property (nonatomic, assign, readonly) const uint8_t * nullBitmap;
+
+/**
+ *  The offset of each text or blob value in the arena, or `NULL`.
+ */
+@property (nonatomic, assign, readonly) const NSUInteger * offsets;
+
+/**
+ *  The length in bytes of each text or blob value, or `NULL`.
+ */
+@property (nonatomic, assign, readonly) const NSUInteger * lengths;
+
+/**
+ *  The bytes of all text or blob values, or `NULL`. Text is not NUL-terminated.
+ */
+@property (nonatomic, assign, readonly) const uint8_t * arena;
+
+/**
+ *  Whether the value of the given row is NULL.
+ */
+- (BOOL)isNullAtIndex:(NSUInteger)rowIdx;
+
+/**
+ *  Returns a text value as a string, or `nil` if it is NULL.
+ */
+- (NSString *)stringAtIndex:(NSUInteger)rowIdx;
+
+/**
+ *  Returns a blob value as data, or `nil` if it is NULL.
+ */
+- (NSData *)dataAtIndex:(NSUInteger)rowIdx;
+
+// ========== READING ==================================================================================================
+#pragma mark - Reading
+
+/// @name Reading Values
+
+/**
+ *  Discards all values, so the buffer can be refilled.
+ */
+- (void)reset;
+
+/**
+ *  Appends the value of the buffer's column from the statement's current row. The buffer must not be full.
+ */
+- (void)appendValueFromStatement:(sqlite3_stmt *)statement;
+
+@end
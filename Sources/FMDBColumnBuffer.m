@@ -0,0 +1,210 @@
+#import "FMDBColumnBuffer.h"
+
+static const NSUInteger FMDBColumnBufferInitialArenaSize = 4096;
+
+@implementation FMDBColumnBuffer
+{
+  void * _values;
+  uint8_t * _nulls;
+  NSUInteger * _offsets;
+  NSUInteger * _lengths;
+  uint8_t * _arena;
+  NSUInteger _arenaLength;
+  NSUInteger _arenaCapacity;
+  BOOL _ownsValues;
+  BOOL _ownsNulls;
+}
+
+- (instancetype)initWithColumnIndex:(int)columnIdx
+                               type:(FMDBColumnBufferType)type
+                           capacity:(NSUInteger)capacity
+{
+  return [self initWithColumnIndex:columnIdx
+                              type:type
+                          capacity:capacity
+                            values:NULL
+                        nullBitmap:NULL];
+}
+
+- (instancetype)initWithColumnIndex:(int)columnIdx
+                               type:(FMDBColumnBufferType)type
+                           capacity:(NSUInteger)capacity
+                             values:(void *)values
+                         nullBitmap:(uint8_t *)nullBitmap
+{
+  NSParameterAssert(capacity > 0);
+  NSParameterAssert(values == NULL || type == FMDBColumnBufferTypeInteger || type == FMDBColumnBufferTypeReal);
+  
+  self = [super init];
+  if (self)
+  {
+    _columnIndex = columnIdx;
+    _type = type;
+    _capacity = capacity;
+    
+    _ownsNulls = (nullBitmap == NULL);
+    _nulls = _ownsNulls ? calloc((capacity + 7) / 8, 1) : nullBitmap;
+    
+    switch (type)
+    {
+      case FMDBColumnBufferTypeInteger:
+      case FMDBColumnBufferTypeReal:
+        _ownsValues = (values == NULL);
+        _values = _ownsValues ? calloc(capacity, (type == FMDBColumnBufferTypeInteger ? sizeof(int64_t)
+                                                                                      : sizeof(double))) : values;
+        break;
+      
+      case FMDBColumnBufferTypeText:
+      case FMDBColumnBufferTypeBlob:
+        _offsets = calloc(capacity, sizeof(NSUInteger));
+        _lengths = calloc(capacity, sizeof(NSUInteger));
+        _arenaCapacity = FMDBColumnBufferInitialArenaSize;
+        _arena = malloc(_arenaCapacity);
+        break;
+    }
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_ownsValues) free(_values);
+  if (_ownsNulls) free(_nulls);
+  free(_offsets);
+  free(_lengths);
+  free(_arena);
+}
+
+// ========== VALUES ===================================================================================================
+#pragma mark - Values
+
+- (const int64_t *)integers
+{
+  return (_type == FMDBColumnBufferTypeInteger ? _values : NULL);
+}
+
+- (const double *)reals
+{
+  return (_type == FMDBColumnBufferTypeReal ? _values : NULL);
+}
+
+- (const uint8_t *)nullBitmap
+{
+  return _nulls;
+}
+
+- (const NSUInteger *)offsets
+{
+  return _offsets;
+}
+
+- (const NSUInteger *)lengths
+{
+  return _lengths;
+}
+
+- (const uint8_t *)arena
+{
+  return _arena;
+}
+
+- (BOOL)isNullAtIndex:(NSUInteger)rowIdx
+{
+  NSParameterAssert(rowIdx < _count);
+  return (_nulls[rowIdx / 8] & (1 << (rowIdx % 8))) != 0;
+}
+
+- (NSString *)stringAtIndex:(NSUInteger)rowIdx
+{
+  NSParameterAssert(_type == FMDBColumnBufferTypeText);
+  if ([self isNullAtIndex:rowIdx])
+  {
+    return nil;
+  }
+  
+  return [[NSString alloc] initWithBytes:(_arena + _offsets[rowIdx])
+                                  length:_lengths[rowIdx]
+                                encoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)dataAtIndex:(NSUInteger)rowIdx
+{
+  NSParameterAssert(_type == FMDBColumnBufferTypeBlob || _type == FMDBColumnBufferTypeText);
+  if ([self isNullAtIndex:rowIdx])
+  {
+    return nil;
+  }
+  
+  return [NSData dataWithBytes:(_arena + _offsets[rowIdx])
+                        length:_lengths[rowIdx]];
+}
+
+// ========== READING ==================================================================================================
+#pragma mark - Reading
+
+- (void)reset
+{
+  memset(_nulls, 0, (_capacity + 7) / 8);
+  _count = 0;
+  _arenaLength = 0;
+}
+
+- (void)appendValueFromStatement:(sqlite3_stmt *)statement
+{
+  NSParameterAssert(_count < _capacity);
+  
+  NSUInteger rowIdx = _count++;
+  BOOL isNull = (sqlite3_column_type(statement, _columnIndex) == SQLITE_NULL);
+  if (isNull)
+  {
+    _nulls[rowIdx / 8] |= (1 << (rowIdx % 8));
+  }
+  
+  switch (_type)
+  {
+    case FMDBColumnBufferTypeInteger:
+      ((int64_t *)_values)[rowIdx] = sqlite3_column_int64(statement, _columnIndex);
+      break;
+    
+    case FMDBColumnBufferTypeReal:
+      ((double *)_values)[rowIdx] = sqlite3_column_double(statement, _columnIndex);
+      break;
+    
+    case FMDBColumnBufferTypeText:
+    case FMDBColumnBufferTypeBlob:
+    {
+      // the pointer must be fetched before the length, which may convert the value
+      const void * bytes = (_type == FMDBColumnBufferTypeText
+                            ? (const void *)sqlite3_column_text(statement, _columnIndex)
+                            : sqlite3_column_blob(statement, _columnIndex));
+      NSUInteger length = (NSUInteger)sqlite3_column_bytes(statement, _columnIndex);
+      
+      [self reserveArenaLength:length];
+      if (length > 0)
+      {
+        memcpy(_arena + _arenaLength, bytes, length);
+      }
+      
+      _offsets[rowIdx] = _arenaLength;
+      _lengths[rowIdx] = length;
+      _arenaLength += length;
+      break;
+    }
+  }
+}
+
+- (void)reserveArenaLength:(NSUInteger)length
+{
+  if (_arenaLength + length <= _arenaCapacity)
+  {
+    return;
+  }
+  
+  while (_arenaLength + length > _arenaCapacity)
+  {
+    _arenaCapacity *= 2;
+  }
+  _arena = realloc(_arena, _arenaCapacity);
+}
+
+@end
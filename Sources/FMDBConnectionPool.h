@@ -0,0 +1,191 @@
+#import "FMDatabase.h"
+
+/**
+ *  A pool of connections to a database file: one writer, and several read-only connections so that selects can run
+ *  in parallel on different threads. The database is put in WAL mode, so that readers don't block the writer, and
+ *  vice versa.
+ *
+ *  Each reader is checked out for a single query, or for the duration of an `-inReader:` block. Writes are serialized
+ *  on the writer connection. Readers see the last committed state of the database, so a write is visible to readers
+ *  once its transaction has committed.
+ *
+ *  The pool's helpers mirror the `FMDatabase (FMDBHelpers)` methods that return materialized results. To read an
+ *  `FMResultSet`, use `-inReader:`, and read the results before the block returns.
+ */
+@interface FMDBConnectionPool : NSObject
+
+/**
+ *  Creates a pool with one reader per processor.
+ */
++ (instancetype)poolWithPath:(NSString *)path;
+
+/**
+ *  Creates a pool for the database at the given path. WAL mode needs a file shared by all connections, so `path`
+ *  can't be an in-memory or temporary database. Call `-open:` before using the pool.
+ *
+ *  @param  path          The path to the database file, which is created if it doesn't exist.
+ *  @param  readerCount   The number of read-only connections to open.
+ */
+- (instancetype)initWithPath:(NSString *)path
+                 readerCount:(NSUInteger)readerCount;
+
+@property (nonatomic, copy, readonly) NSString * path;
+@property (nonatomic, assign, readonly) NSUInteger readerCount;
+
+/**
+ *  Opens the writer, switches the database to WAL mode, and opens the readers.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)open:(NSError **)error_p;
+
+/**
+ *  Closes all connections. The pool must not be in use.
+ */
+- (void)close;
+
+// ========== CONNECTIONS ==============================================================================================
+#pragma mark - Connections
+
+/// @name Using Connections
+
+/**
+ *  Checks out a reader, waiting until one is available, and passes it to `block`. The reader is checked back in when
+ *  the block returns, so results must not be used outside of the block. Don't nest calls, as the pool can run out of
+ *  readers.
+ */
+- (void)inReader:(void (^)(FMDatabase * db))block;
+
+/**
+ *  Runs each block on its own reader, in parallel, and returns once all blocks have finished. At most `readerCount`
+ *  blocks run at the same time.
+ *
+ *  @param  blocks  An array of `void (^)(FMDatabase * db)` blocks.
+ */
+- (void)inReadersConcurrently:(NSArray *)blocks;
+
+/**
+ *  Passes the writer to `block`. Calls are serialized, and must not be nested.
+ */
+- (void)inWriter:(void (^)(FMDatabase * db))block;
+
+/**
+ *  Passes the writer to `block` inside a transaction, which is committed when the block returns unless it sets
+ *  `*rollback` to `YES`.
+ */
+- (void)inWriterTransaction:(void (^)(FMDatabase * db, BOOL * rollback))block;
+
+// ========== READS ====================================================================================================
+#pragma mark - Reads
+
+/// @name Reading
+
+/**
+ *  See `-[FMDatabase countFrom:error:]`.
+ */
+- (NSInteger)countFrom:(NSString *)from
+                 error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase countFrom:matchingValues:error:]`.
+ */
+- (NSInteger)countFrom:(NSString *)from
+        matchingValues:(NSDictionary *)valuesToMatch
+                 error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase count:from:where:arguments:error:]`.
+ */
+- (NSInteger)count:(NSArray *)columnNames
+              from:(NSString *)from
+             where:(NSString *)where
+         arguments:(NSArray *)arguments
+             error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase selectAllFrom:orderBy:error:]`.
+ */
+- (NSArray *)selectAllFrom:(NSString *)from
+                   orderBy:(NSString *)orderBy
+                     error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase selectAllFrom:where:arguments:orderBy:error:]`.
+ */
+- (NSArray *)selectAllFrom:(NSString *)from
+                     where:(NSString *)where
+                 arguments:(NSArray *)arguments
+                   orderBy:(NSString *)orderBy
+                     error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase enumerateAllFrom:where:arguments:orderBy:usingBlock:error:]`. The reader is checked out until
+ *  enumeration ends.
+ */
+- (BOOL)enumerateAllFrom:(NSString *)from
+                   where:(NSString *)where
+               arguments:(NSArray *)arguments
+                 orderBy:(NSString *)orderBy
+              usingBlock:(void (^)(NSDictionary * record, BOOL * stop))block
+                   error:(NSError **)error_p;
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+/// @name Writing
+
+/**
+ *  See `-[FMDatabase executeUpdate:withArgumentsInArray:error:]`.
+ */
+- (BOOL)executeUpdate:(NSString *)sql
+ withArgumentsInArray:(NSArray *)arguments
+                error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase insertInto:columns:values:error:]`.
+ */
+- (BOOL)insertInto:(NSString *)tableName
+           columns:(NSArray *)columns
+            values:(NSArray *)values
+             error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase insertInto:row:error:]`.
+ */
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+                   error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase update:values:matchingValues:error:]`.
+ */
+- (NSInteger)update:(NSString *)tableName
+             values:(NSDictionary *)values
+     matchingValues:(NSDictionary *)matchingValues
+              error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase update:values:where:arguments:error:]`.
+ */
+- (NSInteger)update:(NSString *)tableName
+             values:(NSDictionary *)values
+              where:(NSString *)where
+          arguments:(NSArray *)arguments
+              error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase deleteFrom:matchingValues:error:]`.
+ */
+- (NSInteger)deleteFrom:(NSString *)tableName
+         matchingValues:(NSDictionary *)matchingValues
+                  error:(NSError **)error_p;
+
+/**
+ *  See `-[FMDatabase deleteFrom:where:arguments:error:]`.
+ */
+- (NSInteger)deleteFrom:(NSString *)tableName
+                  where:(NSString *)where
+              arguments:(NSArray *)arguments
+                  error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,353 @@
+#import "FMDBConnectionPool.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import <FMDB/FMDatabaseAdditions.h>
+
+@implementation FMDBConnectionPool
+{
+  FMDatabase * _writer;
+  NSRecursiveLock * _writerLock;
+  
+  NSArray * _readers;
+  NSMutableArray * _idleReaders;
+  dispatch_semaphore_t _idleReaderCount;
+}
+
++ (instancetype)poolWithPath:(NSString *)path
+{
+  return [[self alloc] initWithPath:path
+                        readerCount:[[NSProcessInfo processInfo] activeProcessorCount]];
+}
+
+- (instancetype)initWithPath:(NSString *)path
+                 readerCount:(NSUInteger)readerCount
+{
+  NSParameterAssert(path.length > 0 && NO == [path isEqualToString:@":memory:"]);
+  NSParameterAssert(readerCount > 0);
+  
+  self = [super init];
+  if (self)
+  {
+    _path = [path copy];
+    _readerCount = readerCount;
+    _writerLock = [[NSRecursiveLock alloc] init];
+  }
+  return self;
+}
+
+- (BOOL)open:(NSError **)error_p
+{
+  FMDatabase * writer = [FMDatabase databaseWithPath:self.path];
+  if (NO == [writer openWithFlags:(SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)
+                            error:error_p])
+  {
+    return NO;
+  }
+  
+  // readers need the database to be in WAL mode before they open it
+  NSString * journalMode = [writer stringForQuery:@"PRAGMA journal_mode = WAL"];
+  if (NO == [journalMode.lowercaseString isEqualToString:@"wal"])
+  {
+    if (error_p != NULL)
+    {
+      NSDictionary * userInfo = @{ NSLocalizedDescriptionKey: @"The database could not be switched to WAL mode" };
+      *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                     code:SQLITE_CANTOPEN
+                                 userInfo:userInfo];
+    }
+    [writer close];
+    return NO;
+  }
+  
+  NSMutableArray * readers = [[NSMutableArray alloc] initWithCapacity:self.readerCount];
+  for (NSUInteger readerIdx = 0; readerIdx < self.readerCount; readerIdx++)
+  {
+    // each reader is only used by one thread at a time, so sqlite's per-connection mutex isn't needed
+    FMDatabase * reader = [FMDatabase databaseWithPath:self.path];
+    if (NO == [reader openWithFlags:(SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX)
+                              error:error_p])
+    {
+      for (FMDatabase * openReader in readers)
+      {
+        [openReader close];
+      }
+      [writer close];
+      return NO;
+    }
+    [readers addObject:reader];
+  }
+  
+  _writer = writer;
+  _readers = readers;
+  _idleReaders = [readers mutableCopy];
+  _idleReaderCount = dispatch_semaphore_create((long)readers.count);
+  return YES;
+}
+
+- (void)close
+{
+  [_writerLock lock];
+  [_writer close];
+  _writer = nil;
+  [_writerLock unlock];
+  
+  for (FMDatabase * reader in _readers)
+  {
+    [reader close];
+  }
+  _readers = nil;
+  _idleReaders = nil;
+  _idleReaderCount = nil;
+}
+
+// ========== CONNECTIONS ==============================================================================================
+#pragma mark - Connections
+
+- (FMDatabase *)checkOutReader
+{
+  NSAssert(_readers != nil, @"Pool is not open");
+  
+  dispatch_semaphore_wait(_idleReaderCount, DISPATCH_TIME_FOREVER);
+  
+  FMDatabase * reader;
+  @synchronized (_idleReaders)
+  {
+    reader = _idleReaders.lastObject;
+    [_idleReaders removeLastObject];
+  }
+  return reader;
+}
+
+- (void)checkInReader:(FMDatabase *)reader
+{
+  @synchronized (_idleReaders)
+  {
+    [_idleReaders addObject:reader];
+  }
+  dispatch_semaphore_signal(_idleReaderCount);
+}
+
+- (void)inReader:(void (^)(FMDatabase * db))block
+{
+  FMDatabase * reader = [self checkOutReader];
+  block(reader);
+  [self checkInReader:reader];
+}
+
+- (void)inReadersConcurrently:(NSArray *)blocks
+{
+  dispatch_apply(blocks.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t blockIdx) {
+    [self inReader:blocks[blockIdx]];
+  });
+}
+
+- (void)inWriter:(void (^)(FMDatabase * db))block
+{
+  NSAssert(_writer != nil, @"Pool is not open");
+  
+  [_writerLock lock];
+  block(_writer);
+  [_writerLock unlock];
+}
+
+- (void)inWriterTransaction:(void (^)(FMDatabase * db, BOOL * rollback))block
+{
+  [self inWriter:^(FMDatabase * db) {
+    BOOL shouldRollback = NO;
+    [db beginTransaction];
+    block(db, &shouldRollback);
+    
+    if (shouldRollback)
+    {
+      [db rollback];
+    }
+    else
+    {
+      [db commit];
+    }
+  }];
+}
+
+// ========== READS ====================================================================================================
+#pragma mark - Reads
+
+- (NSInteger)countFrom:(NSString *)from
+                 error:(NSError **)error_p
+{
+  return [self count:nil
+                from:from
+               where:nil
+           arguments:nil
+               error:error_p];
+}
+
+- (NSInteger)countFrom:(NSString *)from
+        matchingValues:(NSDictionary *)valuesToMatch
+                 error:(NSError **)error_p
+{
+  FMDatabase * reader = [self checkOutReader];
+  NSInteger count = [reader countFrom:from
+                       matchingValues:valuesToMatch
+                                error:error_p];
+  [self checkInReader:reader];
+  return count;
+}
+
+- (NSInteger)count:(NSArray *)columnNames
+              from:(NSString *)from
+             where:(NSString *)where
+         arguments:(NSArray *)arguments
+             error:(NSError **)error_p
+{
+  FMDatabase * reader = [self checkOutReader];
+  NSInteger count = [reader count:columnNames
+                             from:from
+                            where:where
+                        arguments:arguments
+                            error:error_p];
+  [self checkInReader:reader];
+  return count;
+}
+
+- (NSArray *)selectAllFrom:(NSString *)from
+                   orderBy:(NSString *)orderBy
+                     error:(NSError **)error_p
+{
+  return [self selectAllFrom:from
+                       where:nil
+                   arguments:nil
+                     orderBy:orderBy
+                       error:error_p];
+}
+
+- (NSArray *)selectAllFrom:(NSString *)from
+                     where:(NSString *)where
+                 arguments:(NSArray *)arguments
+                   orderBy:(NSString *)orderBy
+                     error:(NSError **)error_p
+{
+  FMDatabase * reader = [self checkOutReader];
+  NSArray * records = [reader selectAllFrom:from
+                                      where:where
+                                  arguments:arguments
+                                    orderBy:orderBy
+                                      error:error_p];
+  [self checkInReader:reader];
+  return records;
+}
+
+- (BOOL)enumerateAllFrom:(NSString *)from
+                   where:(NSString *)where
+               arguments:(NSArray *)arguments
+                 orderBy:(NSString *)orderBy
+              usingBlock:(void (^)(NSDictionary * record, BOOL * stop))block
+                   error:(NSError **)error_p
+{
+  FMDatabase * reader = [self checkOutReader];
+  BOOL succeeded = [reader enumerateAllFrom:from
+                                      where:where
+                                  arguments:arguments
+                                    orderBy:orderBy
+                                 usingBlock:block
+                                      error:error_p];
+  [self checkInReader:reader];
+  return succeeded;
+}
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+- (BOOL)executeUpdate:(NSString *)sql
+ withArgumentsInArray:(NSArray *)arguments
+                error:(NSError **)error_p
+{
+  [_writerLock lock];
+  BOOL succeeded = [_writer executeUpdate:sql
+                     withArgumentsInArray:arguments
+                                    error:error_p];
+  [_writerLock unlock];
+  return succeeded;
+}
+
+- (BOOL)insertInto:(NSString *)tableName
+           columns:(NSArray *)columns
+            values:(NSArray *)values
+             error:(NSError **)error_p
+{
+  [_writerLock lock];
+  BOOL succeeded = [_writer insertInto:tableName
+                               columns:columns
+                                values:values
+                                 error:error_p];
+  [_writerLock unlock];
+  return succeeded;
+}
+
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+                   error:(NSError **)error_p
+{
+  [_writerLock lock];
+  NSNumber * rowId = [_writer insertInto:tableName
+                                     row:rowValues
+                                   error:error_p];
+  [_writerLock unlock];
+  return rowId;
+}
+
+- (NSInteger)update:(NSString *)tableName
+             values:(NSDictionary *)values
+     matchingValues:(NSDictionary *)matchingValues
+              error:(NSError **)error_p
+{
+  [_writerLock lock];
+  NSInteger changes = [_writer update:tableName
+                               values:values
+                       matchingValues:matchingValues
+                                error:error_p];
+  [_writerLock unlock];
+  return changes;
+}
+
+- (NSInteger)update:(NSString *)tableName
+             values:(NSDictionary *)values
+              where:(NSString *)where
+          arguments:(NSArray *)arguments
+              error:(NSError **)error_p
+{
+  [_writerLock lock];
+  NSInteger changes = [_writer update:tableName
+                               values:values
+                                where:where
+                            arguments:arguments
+                                error:error_p];
+  [_writerLock unlock];
+  return changes;
+}
+
+- (NSInteger)deleteFrom:(NSString *)tableName
+         matchingValues:(NSDictionary *)matchingValues
+                  error:(NSError **)error_p
+{
+  [_writerLock lock];
+  NSInteger changes = [_writer deleteFrom:tableName
+                           matchingValues:matchingValues
+                                    error:error_p];
+  [_writerLock unlock];
+  return changes;
+}
+
+- (NSInteger)deleteFrom:(NSString *)tableName
+                  where:(NSString *)where
+              arguments:(NSArray *)arguments
+                  error:(NSError **)error_p
+{
+  [_writerLock lock];
+  NSInteger changes = [_writer deleteFrom:tableName
+                                    where:where
+                                arguments:arguments
+                                    error:error_p];
+  [_writerLock unlock];
+  return changes;
+}
+
+@end
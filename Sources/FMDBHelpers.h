@@ -1,2 +1,23 @@
 #import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBatchUpdate.h"
+#import "FMDatabase+FMDBBlobs.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBChangesets.h"
+#import "FMDatabase+FMDBCountedTables.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBFullTextSearch.h"
+#import "FMDatabase+FMDBImportExport.h"
+#import "FMDatabase+FMDBIndexAdvisor.h"
+#import "FMDatabase+FMDBIndexes.h"
+#import "FMDatabase+FMDBKeysetPagination.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import "FMDatabase+FMDBResultCache.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMDatabase+FMDBStatementCache.h"
+#import "FMDBColumnBuffer.h"
+#import "FMDBConnectionPool.h"
+#import "FMDBOnlineMigration.h"
+#import "FMDBShardedTable.h"
+#import "FMDBWriteQueue.h"
 #import "FMResultSet+FMDBHelpers.h"
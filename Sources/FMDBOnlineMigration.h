@@ -0,0 +1,192 @@
+#import "FMDatabase.h"
+
+@class FMDBWriteQueue;
+
+/**
+ *  Changes a large table a chunk of rows at a time, so that other writes can continue while it runs. Each chunk is a
+ *  bounded range of rowids, changed in its own short transaction; between chunks the write lock is released.
+ *
+ *  There are two kinds of migration:
+ *
+ *  - A copy migration rebuilds a table with a new definition, e.g. to change its columns or constraints, or to build
+ *    large indexes without a blocking `CREATE INDEX`. The new table is created empty, with its indexes, and rows are
+ *    copied into it chunk by chunk. Triggers keep rows that have already been copied up to date as the table changes.
+ *    When every row has been copied, the old table is dropped and the new one takes its name.
+ *  - A backfill migration sets columns of every row, e.g. after `-addColumn:toTable:error:`, with an UPDATE per chunk.
+ *
+ *  Progress is saved in the `fmdb_online_migrations` table in the same transaction as each chunk, so a migration that
+ *  is interrupted, by cancellation or a crash, resumes where it left off when a migration with the same name is run
+ *  again. A migration that has finished isn't run again, so migrations can be run each time the database is opened.
+ *
+ *  Completion is recorded by name alone, not by the table's contents or definition: if the table is later dropped and
+ *  recreated, e.g. when a database is reset to an older schema, a finished migration with the same name is still
+ *  skipped. Give a migration a new name, such as one that includes a schema version, to run it on the new table.
+ *
+ *  The table must have rowids, i.e. not be a `WITHOUT ROWID` table.
+ */
+@interface FMDBOnlineMigration : NSObject
+
+/**
+ *  Creates a migration that rebuilds a table with new columns and constraints.
+ *
+ *  By default each column of the new table that also exists in the old table is copied as is; use
+ *  `-setExpression:forColumn:` to fill columns with other values. Rowids are preserved.
+ *
+ *  Only the indexes added with `-addIndexWithName:columns:unique:` are created on the new table, and the old table's
+ *  indexes and triggers are dropped with it. A row that violates the new table's constraints, e.g. a unique index,
+ *  fails the chunk that copies it, leaving the old table as it is, and while the migration runs, a write to the old
+ *  table that would violate them fails. As index names are shared by all tables, new indexes need names that
+ *  aren't already in use.
+ *
+ *  @param  name          Identifies the migration's progress, so that it can be resumed, and whether it has finished.
+ *  @param  tableName     The table to rebuild.
+ *  @param  columns       Column definitions of the new table, as for `-createTableWithName:columns:constraints:error:`.
+ *  @param  constraints   Table constraints of the new table, or `nil`.
+ */
++ (instancetype)copyMigrationWithName:(NSString *)name
+                            tableName:(NSString *)tableName
+                              columns:(NSArray *)columns
+                          constraints:(NSArray *)constraints;
+
+/**
+ *  Creates a migration that sets columns of each row of a table.
+ *
+ *  @param  name          Identifies the migration's progress, so that it can be resumed, and whether it has finished.
+ *  @param  tableName     The table to update.
+ *  @param  expressions   A dictionary of SQL expressions keyed by the columns they set, e.g.
+ *                        @{ @"fullName": @"firstName || ' ' || lastName" }. Expressions can use the row's columns.
+ */
++ (instancetype)backfillMigrationWithName:(NSString *)name
+                                tableName:(NSString *)tableName
+                              expressions:(NSDictionary *)expressions;
+
+@property (nonatomic, copy, readonly) NSString * name;
+@property (nonatomic, copy, readonly) NSString * tableName;
+
+/**
+ *  The maximum number of rows changed in each chunk. Defaults to 1000.
+ */
+@property (atomic, assign) NSUInteger chunkSize;
+
+/**
+ *  How long `-runInDatabase:error:` waits between chunks, so that other connections can write. Defaults to 0, which
+ *  only releases the write lock.
+ */
+@property (atomic, assign) NSTimeInterval pauseBetweenChunks;
+
+/**
+ *  Called after each step, on the thread that ran it. Read `lastRowId` and `maxRowId` to show progress.
+ */
+@property (atomic, copy) void (^progressHandler)(FMDBOnlineMigration * migration);
+
+// ========== DEFINITION ===============================================================================================
+#pragma mark - Definition
+
+/// @name Defining Copies
+
+/**
+ *  Fills a column of the new table with a SQL expression over the old table's columns, e.g. `lower(email)`.
+ */
+- (void)setExpression:(NSString *)expression
+            forColumn:(NSString *)columnName;
+
+/**
+ *  Creates an index on the new table before rows are copied, so that it is built a chunk at a time.
+ */
+- (void)addIndexWithName:(NSString *)indexName
+                 columns:(NSArray *)columns
+                  unique:(BOOL)isUnique;
+
+/**
+ *  Restricts a backfill to rows matching a WHERE clause, e.g. `fullName IS NULL`.
+ */
+- (void)setWhere:(NSString *)where
+       arguments:(NSArray *)arguments;
+
+// ========== PROGRESS =================================================================================================
+#pragma mark - Progress
+
+/// @name Progress
+
+/**
+ *  The rowid of the last row migrated, as of the last chunk run or loaded.
+ */
+@property (atomic, assign, readonly) int64_t lastRowId;
+
+/**
+ *  The largest rowid in the table, as of the last chunk run.
+ */
+@property (atomic, assign, readonly) int64_t maxRowId;
+
+/**
+ *  The number of rows changed by all chunks so far, including those of earlier runs.
+ */
+@property (atomic, assign, readonly) int64_t migratedRowCount;
+
+/**
+ *  Whether the migration has finished.
+ */
+@property (atomic, assign, readonly) BOOL isFinished;
+
+/**
+ *  Whether `-cancel` has been called.
+ */
+@property (atomic, assign, readonly) BOOL isCancelled;
+
+/**
+ *  Stops the migration. A chunk that is running is interrupted through sqlite's progress handler and rolled back, and
+ *  no more chunks are started. Progress already committed is kept, so the migration can be resumed by a new instance.
+ */
+- (void)cancel;
+
+// ========== RUNNING ==================================================================================================
+#pragma mark - Running
+
+/// @name Running
+
+/**
+ *  Runs the next step of the migration: starting it, migrating a chunk, or finishing it. Unless a transaction is
+ *  already open, the step runs in its own transaction, which is rolled back if an error occurs.
+ *
+ *  Dropping the old table of a copy migration would delete or update the rows of other tables that reference it, so
+ *  when foreign keys are enabled, a copy migration's steps turn them off, and check that no row violates them before
+ *  committing its finish, as in sqlite's procedure for altering a table. As sqlite can't turn foreign keys off within
+ *  a transaction, a copy migration can't finish within one while they're enabled.
+ *
+ *  Call repeatedly until `isFinished`, e.g. from `-[FMDBConnectionPool inWriter:]`, to interleave chunks with other
+ *  writes.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs or the migration was cancelled.
+ */
+- (BOOL)migrateNextChunkInDatabase:(FMDatabase *)database
+                             error:(NSError **)error_p;
+
+/**
+ *  Runs the migration to completion, pausing for `pauseBetweenChunks` between chunks.
+ *
+ *  @return `YES` if the migration has finished, `NO` if an error occurs or it was cancelled.
+ */
+- (BOOL)runInDatabase:(FMDatabase *)database
+                error:(NSError **)error_p;
+
+/**
+ *  Runs the migration on a write queue, queueing each chunk once the previous one has been committed, so that writes
+ *  queued in the meantime are committed between chunks. Each chunk runs in its own transaction, outside of the queue's
+ *  batches of writes.
+ *
+ *  @param  completion  Called on the queue's completion queue with `YES` once the migration has finished, or `NO`
+ *                      and an error. May be `nil`.
+ */
+- (void)runInWriteQueue:(FMDBWriteQueue *)writeQueue
+             completion:(void (^)(BOOL finished, NSError * error))completion;
+
+/**
+ *  Abandons a migration that hasn't finished, dropping its saved progress, and the new table and triggers of a copy
+ *  migration. A finished migration is left as it is.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)discardInDatabase:(FMDatabase *)database
+                    error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,735 @@
+#import "FMDBOnlineMigration.h"
+#import "FMDBWriteQueue.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import <FMDB/FMDatabaseAdditions.h>
+
+static const NSUInteger FMDBDefaultMigrationChunkSize = 1000;
+
+static NSString * const FMDBCreateMigrationsTableStatement =
+  @"CREATE TABLE IF NOT EXISTS fmdb_online_migrations"
+  @" (name TEXT PRIMARY KEY, table_name TEXT NOT NULL, last_rowid INTEGER NOT NULL,"
+  @"  row_count INTEGER NOT NULL DEFAULT 0, finished INTEGER NOT NULL DEFAULT 0)";
+
+@interface FMDBOnlineMigration ()
+
+@property (atomic, assign, readwrite) int64_t lastRowId;
+@property (atomic, assign, readwrite) int64_t maxRowId;
+@property (atomic, assign, readwrite) int64_t migratedRowCount;
+@property (atomic, assign, readwrite) BOOL isFinished;
+@property (atomic, assign, readwrite) BOOL isCancelled;
+
+@end
+
+@implementation FMDBOnlineMigration
+{
+  BOOL _isCopy;
+  NSArray * _columns;
+  NSArray * _constraints;
+  NSMutableDictionary * _expressions;
+  NSMutableArray * _indexes;
+  NSString * _where;
+  NSArray * _whereArguments;
+  
+  // interrupts the running chunk when the migration is cancelled
+  FMDBCancellationToken * _cancellationToken;
+  
+  // whether the running step turned off foreign keys, which must then be checked before it finishes
+  BOOL _hasDisabledForeignKeys;
+  
+  // the columns of the new table that are copied, and the expressions that fill them, once the new table exists
+  NSArray * _copiedColumnNames;
+  NSArray * _copiedExpressions;
+}
+
++ (instancetype)copyMigrationWithName:(NSString *)name
+                            tableName:(NSString *)tableName
+                              columns:(NSArray *)columns
+                          constraints:(NSArray *)constraints
+{
+  NSParameterAssert(columns.count > 0);
+  
+  FMDBOnlineMigration * migration = [[self alloc] initWithName:name
+                                                     tableName:tableName];
+  migration->_isCopy = YES;
+  migration->_columns = [columns copy];
+  migration->_constraints = [constraints copy];
+  return migration;
+}
+
++ (instancetype)backfillMigrationWithName:(NSString *)name
+                                tableName:(NSString *)tableName
+                              expressions:(NSDictionary *)expressions
+{
+  NSParameterAssert(expressions.count > 0);
+  
+  FMDBOnlineMigration * migration = [[self alloc] initWithName:name
+                                                     tableName:tableName];
+  [migration->_expressions addEntriesFromDictionary:expressions];
+  return migration;
+}
+
+- (instancetype)initWithName:(NSString *)name
+                   tableName:(NSString *)tableName
+{
+  NSParameterAssert(name != nil);
+  NSParameterAssert(tableName != nil);
+  
+  self = [super init];
+  if (self)
+  {
+    _name = [name copy];
+    _tableName = [tableName copy];
+    _chunkSize = FMDBDefaultMigrationChunkSize;
+    _expressions = [[NSMutableDictionary alloc] init];
+    _indexes = [[NSMutableArray alloc] init];
+    _cancellationToken = [[FMDBCancellationToken alloc] init];
+  }
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %@ of %@, rowid %lld of %lld, %lld rows%@>",
+          NSStringFromClass([self class]),
+          (_isCopy ? @"copy" : @"backfill"),
+          self.tableName,
+          self.lastRowId,
+          self.maxRowId,
+          self.migratedRowCount,
+          (self.isFinished ? @", finished" : @"")];
+}
+
+// ========== DEFINITION ===============================================================================================
+#pragma mark - Definition
+
+- (void)setExpression:(NSString *)expression
+            forColumn:(NSString *)columnName
+{
+  NSParameterAssert(_isCopy);
+  
+  _expressions[columnName] = expression;
+}
+
+- (void)addIndexWithName:(NSString *)indexName
+                 columns:(NSArray *)columns
+                  unique:(BOOL)isUnique
+{
+  NSParameterAssert(_isCopy);
+  
+  NSMutableArray * createIndex = [NSMutableArray arrayWithObject:@"CREATE"];
+  if (isUnique) [createIndex addObject:@"UNIQUE"];
+  [createIndex addObject:@"INDEX"];
+  [createIndex addObject:[FMDatabase escapeIdentifier:indexName]];
+  [createIndex addObject:@"ON"];
+  [createIndex addObject:[FMDatabase escapeIdentifier:[self nameOfCopiedTable]]];
+  [createIndex addObject:[NSString stringWithFormat:@"(%@)", [columns componentsJoinedByString:@", "]]];
+  
+  [_indexes addObject:[createIndex componentsJoinedByString:@" "]];
+}
+
+- (void)setWhere:(NSString *)where
+       arguments:(NSArray *)arguments
+{
+  NSParameterAssert(NO == _isCopy);
+  
+  _where = [where copy];
+  _whereArguments = [arguments copy];
+}
+
+- (NSString *)nameOfCopiedTable
+{
+  return [@"fmdb_copy_of_" stringByAppendingString:self.tableName];
+}
+
+- (NSString *)nameOfTriggerForEvent:(NSString *)event
+{
+  return [NSString stringWithFormat:@"fmdb_copy_%@_%@", self.tableName, event];
+}
+
+// ========== PROGRESS =================================================================================================
+#pragma mark - Progress
+
+- (void)cancel
+{
+  self.isCancelled = YES;
+  [_cancellationToken cancel];
+}
+
+- (NSError *)cancellationError
+{
+  NSDictionary * userInfo = @{ NSLocalizedDescriptionKey: @"The migration was cancelled" };
+  return [NSError errorWithDomain:@"FMDatabase"
+                             code:SQLITE_INTERRUPT
+                         userInfo:userInfo];
+}
+
+/**
+ *  Reads the migration's saved progress.
+ *
+ *  @return `YES` if the migration has started, `NO` if not.
+ */
+- (BOOL)loadProgressFromDatabase:(FMDatabase *)database
+{
+  FMResultSet * results = [database executeQuery:@"SELECT last_rowid, row_count, finished FROM fmdb_online_migrations"
+                                                 @" WHERE name = ?"
+                            withArgumentsInArray:@[ self.name ]];
+  BOOL hasStarted = [results next];
+  if (hasStarted)
+  {
+    self.lastRowId = [results longLongIntForColumnIndex:0];
+    self.migratedRowCount = [results longLongIntForColumnIndex:1];
+    self.isFinished = [results boolForColumnIndex:2];
+  }
+  [results close];
+  return hasStarted;
+}
+
+// ========== RUNNING ==================================================================================================
+#pragma mark - Running
+
+- (BOOL)migrateNextChunkInDatabase:(FMDatabase *)database
+                             error:(NSError **)error_p
+{
+  NSParameterAssert(database != nil);
+  
+  if (self.isCancelled)
+  {
+    if (error_p != NULL) *error_p = [self cancellationError];
+    return NO;
+  }
+  
+  BOOL ownsTransaction = (NO == database.inTransaction);
+  
+  // dropping the old table would delete or update rows that reference it, so a copy migration's steps turn foreign
+  // keys off, which sqlite only allows outside a transaction
+  _hasDisabledForeignKeys = (_isCopy && ownsTransaction && [database longForQuery:@"PRAGMA foreign_keys"] != 0);
+  if (_hasDisabledForeignKeys)
+  {
+    [database executeUpdate:@"PRAGMA foreign_keys = OFF"];
+  }
+  
+  if (ownsTransaction && NO == [database beginTransaction])
+  {
+    if (error_p != NULL) *error_p = database.lastError;
+    [self restoreForeignKeysInDatabase:database];
+    return NO;
+  }
+  
+  // interrupting a statement rolls back its whole transaction, so only a transaction of our own is interrupted
+  __block BOOL succeeded = NO;
+  [database performWithDeadline:nil
+              cancellationToken:(ownsTransaction ? _cancellationToken : nil)
+                     usingBlock:^{
+    succeeded = [self performNextStepInDatabase:database
+                                          error:error_p];
+  }];
+  
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [database commit];
+      if (NO == succeeded && error_p != NULL) *error_p = database.lastError;
+    }
+    else
+    {
+      [database rollback];
+    }
+  }
+  [self restoreForeignKeysInDatabase:database];
+  
+  if (NO == succeeded)
+  {
+    if (self.isCancelled && error_p != NULL) *error_p = [self cancellationError];
+    
+    // a finish that failed to commit didn't finish; the saved progress is reloaded by the next step
+    self.isFinished = NO;
+    return NO;
+  }
+  
+  void (^progressHandler)(FMDBOnlineMigration * migration) = self.progressHandler;
+  if (progressHandler != nil)
+  {
+    progressHandler(self);
+  }
+  return YES;
+}
+
+- (void)restoreForeignKeysInDatabase:(FMDatabase *)database
+{
+  if (_hasDisabledForeignKeys)
+  {
+    [database executeUpdate:@"PRAGMA foreign_keys = ON"];
+    _hasDisabledForeignKeys = NO;
+  }
+}
+
+- (BOOL)runInDatabase:(FMDatabase *)database
+                error:(NSError **)error_p
+{
+  while (YES)
+  {
+    @autoreleasepool
+    {
+      if (NO == [self migrateNextChunkInDatabase:database
+                                           error:error_p])
+      {
+        return NO;
+      }
+    }
+    
+    if (self.isFinished)
+    {
+      return YES;
+    }
+    
+    if (self.pauseBetweenChunks > 0)
+    {
+      [NSThread sleepForTimeInterval:self.pauseBetweenChunks];
+    }
+  }
+}
+
+- (void)runInWriteQueue:(FMDBWriteQueue *)writeQueue
+             completion:(void (^)(BOOL finished, NSError * error))completion
+{
+  NSParameterAssert(writeQueue != nil);
+  
+  // each chunk is queued after the last has committed, behind any writes queued while it ran, and runs in its own
+  // transaction, so that it can be interrupted, and a copy migration can turn off foreign keys
+  [writeQueue performWriteOutsideTransaction:^id(FMDatabase * db, NSError ** error_p) {
+    return ([self migrateNextChunkInDatabase:db error:error_p] ? @YES : nil);
+  } completion:^(id result, NSError * error) {
+    if (result == nil || self.isFinished)
+    {
+      if (completion != nil)
+      {
+        completion((result != nil), error);
+      }
+    }
+    else
+    {
+      [self runInWriteQueue:writeQueue
+                 completion:completion];
+    }
+  }];
+}
+
+// ---------- STEPS ----------------------------------------------------------------------------------------------------
+#pragma mark Steps
+
+- (BOOL)performNextStepInDatabase:(FMDatabase *)database
+                            error:(NSError **)error_p
+{
+  if (NO == [database executeUpdate:FMDBCreateMigrationsTableStatement
+                              error:error_p])
+  {
+    return NO;
+  }
+  
+  if (NO == [self loadProgressFromDatabase:database])
+  {
+    return [self startInDatabase:database
+                           error:error_p];
+  }
+  
+  if (self.isFinished)
+  {
+    return YES;
+  }
+  
+  // max(rowid) is read from the end of the table's b-tree, without a scan
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:self.tableName];
+  FMResultSet * results = [database executeQuery:[NSString stringWithFormat:@"SELECT max(rowid) FROM %@",
+                                                  escapedTableName]];
+  if (results == nil)
+  {
+    if (error_p != NULL) *error_p = database.lastError;
+    return NO;
+  }
+  int64_t maxRowId = ([results next] && NO == [results columnIndexIsNull:0]
+                      ? [results longLongIntForColumnIndex:0]
+                      : self.lastRowId);
+  [results close];
+  self.maxRowId = maxRowId;
+  
+  if (maxRowId <= self.lastRowId)
+  {
+    return [self finishInDatabase:database
+                            error:error_p];
+  }
+  
+  // a chunk ends at the rowid chunkSize rows on, so that gaps in rowids don't shrink it
+  int64_t chunkEndRowId = maxRowId;
+  results = [database executeQuery:[NSString stringWithFormat:@"SELECT rowid FROM %@ WHERE rowid > ?"
+                                                              @" ORDER BY rowid LIMIT 1 OFFSET ?",
+                                    escapedTableName]
+              withArgumentsInArray:@[ @(self.lastRowId), @(MAX(self.chunkSize, (NSUInteger)1) - 1) ]];
+  if ([results next])
+  {
+    chunkEndRowId = [results longLongIntForColumnIndex:0];
+  }
+  [results close];
+  
+  NSString * chunkSQL = nil;
+  NSMutableArray * arguments = [NSMutableArray arrayWithObjects:@(self.lastRowId), @(chunkEndRowId), nil];
+  if (_isCopy)
+  {
+    chunkSQL = [self statementToCopyRowsWhere:@"rowid > ? AND rowid <= ?"
+                                   inDatabase:database];
+  }
+  else
+  {
+    chunkSQL = [self statementToBackfillRowsWhere:@"rowid > ? AND rowid <= ?"];
+    [arguments addObjectsFromArray:_whereArguments];
+  }
+  
+  if (NO == [database executeUpdate:chunkSQL
+               withArgumentsInArray:arguments
+                              error:error_p])
+  {
+    return NO;
+  }
+  
+  int64_t migratedRowCount = self.migratedRowCount + database.changes;
+  if (NO == [database executeUpdate:@"UPDATE fmdb_online_migrations SET last_rowid = ?, row_count = ? WHERE name = ?"
+               withArgumentsInArray:@[ @(chunkEndRowId), @(migratedRowCount), self.name ]
+                              error:error_p])
+  {
+    return NO;
+  }
+  
+  self.lastRowId = chunkEndRowId;
+  self.migratedRowCount = migratedRowCount;
+  return YES;
+}
+
+- (BOOL)startInDatabase:(FMDatabase *)database
+                  error:(NSError **)error_p
+{
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:self.tableName];
+  
+  if (_isCopy)
+  {
+    // a copy left by a migration that was abandoned before it started is replaced
+    if (NO == [database dropTableIfExistsWithName:[self nameOfCopiedTable]
+                                            error:error_p] ||
+        NO == [database createTableWithName:[self nameOfCopiedTable]
+                                    columns:_columns
+                                constraints:_constraints
+                                      error:error_p])
+    {
+      return NO;
+    }
+    
+    NSArray * triggerStatements = [self statementsToCreateTriggersInDatabase:database];
+    for (NSString * statement in [_indexes arrayByAddingObjectsFromArray:triggerStatements])
+    {
+      if (NO == [database executeUpdate:statement
+                                  error:error_p])
+      {
+        return NO;
+      }
+    }
+    [database invalidateSchemaCatalog];
+  }
+  
+  // rows are migrated after last_rowid, so it starts just before the first row
+  NSString * startSQL = [NSString stringWithFormat:@"INSERT INTO fmdb_online_migrations (name, table_name, last_rowid)"
+                                                   @" SELECT ?, ?, coalesce(min(rowid), 1) - 1 FROM %@",
+                         escapedTableName];
+  if (NO == [database executeUpdate:startSQL
+               withArgumentsInArray:@[ self.name, self.tableName ]
+                              error:error_p])
+  {
+    return NO;
+  }
+  
+  return [self loadProgressFromDatabase:database];
+}
+
+- (BOOL)finishInDatabase:(FMDatabase *)database
+                   error:(NSError **)error_p
+{
+  if (_isCopy && [database longForQuery:@"PRAGMA foreign_keys"] != 0)
+  {
+    NSString * description = @"A copy migration can't finish within a transaction while foreign keys are enabled";
+    if (error_p != NULL) *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                                        code:SQLITE_MISUSE
+                                                    userInfo:@{ NSLocalizedDescriptionKey: description }];
+    return NO;
+  }
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  if (_isCopy)
+  {
+    [statements addObjectsFromArray:[self statementsToDropTriggers]];
+    [statements addObject:[@"DROP TABLE " stringByAppendingString:[FMDatabase escapeIdentifier:self.tableName]]];
+    [statements addObject:[NSString stringWithFormat:@"ALTER TABLE %@ RENAME TO %@",
+                           [FMDatabase escapeIdentifier:[self nameOfCopiedTable]],
+                           [FMDatabase escapeIdentifier:self.tableName]]];
+  }
+  [statements addObject:[NSString stringWithFormat:@"UPDATE fmdb_online_migrations SET finished = 1 WHERE name = %@",
+                         [FMDatabase escapeString:self.name]]];
+  
+  if (NO == [self executeStatements:statements
+                         inDatabase:database
+                              error:error_p])
+  {
+    return NO;
+  }
+  
+  if (_hasDisabledForeignKeys && NO == [self checkForeignKeysInDatabase:database
+                                                                  error:error_p])
+  {
+    return NO;
+  }
+  
+  self.isFinished = YES;
+  return YES;
+}
+
+/**
+ *  Checks that no row violates a foreign key, as they weren't enforced while the new table was filled and swapped in.
+ *  `PRAGMA foreign_key_check` needs sqlite 3.7.16.
+ */
+- (BOOL)checkForeignKeysInDatabase:(FMDatabase *)database
+                             error:(NSError **)error_p
+{
+  if (sqlite3_libversion_number() < 3007016)
+  {
+    return YES;
+  }
+  
+  FMResultSet * results = [database executeQuery:@"PRAGMA foreign_key_check"];
+  if (results == nil)
+  {
+    if (error_p != NULL) *error_p = database.lastError;
+    return NO;
+  }
+  NSString * violatingTableName = ([results next] ? [results stringForColumnIndex:0] : nil);
+  [results close];
+  
+  if (violatingTableName != nil)
+  {
+    NSString * description = [NSString stringWithFormat:@"A row of %@ violates a foreign key constraint",
+                              violatingTableName];
+    if (error_p != NULL) *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                                        code:SQLITE_CONSTRAINT
+                                                    userInfo:@{ NSLocalizedDescriptionKey: description }];
+    return NO;
+  }
+  return YES;
+}
+
+- (BOOL)discardInDatabase:(FMDatabase *)database
+                    error:(NSError **)error_p
+{
+  NSParameterAssert(database != nil);
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:FMDBCreateMigrationsTableStatement];
+  if (_isCopy)
+  {
+    [statements addObjectsFromArray:[self statementsToDropTriggers]];
+    [statements addObject:[@"DROP TABLE IF EXISTS " stringByAppendingString:
+                           [FMDatabase escapeIdentifier:[self nameOfCopiedTable]]]];
+  }
+  [statements addObject:[NSString stringWithFormat:@"DELETE FROM fmdb_online_migrations"
+                                                   @" WHERE name = %@ AND finished = 0",
+                         [FMDatabase escapeString:self.name]]];
+  
+  BOOL ownsTransaction = (NO == database.inTransaction);
+  if (ownsTransaction && NO == [database beginTransaction])
+  {
+    if (error_p != NULL) *error_p = database.lastError;
+    return NO;
+  }
+  
+  BOOL succeeded = [self executeStatements:statements
+                                inDatabase:database
+                                     error:error_p];
+  
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [database commit];
+      if (NO == succeeded && error_p != NULL) *error_p = database.lastError;
+    }
+    else
+    {
+      [database rollback];
+    }
+  }
+  return succeeded;
+}
+
+- (BOOL)executeStatements:(NSArray *)statements
+               inDatabase:(FMDatabase *)database
+                    error:(NSError **)error_p
+{
+  // the statements drop and rename tables, which only changes the main database's schema_version
+  [database invalidateSchemaCatalog];
+  for (NSString * statement in statements)
+  {
+    if (NO == [database executeUpdate:statement
+                                error:error_p])
+    {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+// ---------- STATEMENTS -----------------------------------------------------------------------------------------------
+#pragma mark Statements
+
+/**
+ *  Works out which columns of the new table are copied, and from which expressions: those set by
+ *  `-setExpression:forColumn:`, and columns with the same name in both tables.
+ */
+- (void)loadCopiedColumnsInDatabase:(FMDatabase *)database
+{
+  if (_copiedColumnNames != nil)
+  {
+    return;
+  }
+  
+  NSMutableDictionary * oldColumnNames = [[NSMutableDictionary alloc] init];
+  for (NSString * columnName in [database tableSchema:self.tableName])
+  {
+    oldColumnNames[columnName.lowercaseString] = columnName;
+  }
+  
+  NSMutableArray * columnNames = [[NSMutableArray alloc] init];
+  NSMutableArray * expressions = [[NSMutableArray alloc] init];
+  for (NSString * columnName in [database tableSchema:[self nameOfCopiedTable]])
+  {
+    NSString * expression = _expressions[columnName];
+    if (expression == nil && oldColumnNames[columnName.lowercaseString] != nil)
+    {
+      expression = [FMDatabase escapeIdentifier:oldColumnNames[columnName.lowercaseString]];
+    }
+    
+    if (expression != nil)
+    {
+      [columnNames addObject:[FMDatabase escapeIdentifier:columnName]];
+      [expressions addObject:expression];
+    }
+  }
+  
+  _copiedColumnNames = columnNames;
+  _copiedExpressions = expressions;
+}
+
+/**
+ *  Returns an INSERT that copies the old table's rows matching `where` into the new table. Rows that violate the new
+ *  table's constraints fail the INSERT, rather than replacing other rows.
+ */
+- (NSString *)statementToCopyRowsWhere:(NSString *)where
+                            inDatabase:(FMDatabase *)database
+{
+  [self loadCopiedColumnsInDatabase:database];
+  
+  NSMutableArray * copyRows = [[NSMutableArray alloc] init];
+  [copyRows addObject:@"INSERT INTO"];
+  [copyRows addObject:[FMDatabase escapeIdentifier:[self nameOfCopiedTable]]];
+  [copyRows addObject:[NSString stringWithFormat:@"(rowid, %@)", [_copiedColumnNames componentsJoinedByString:@", "]]];
+  [copyRows addObject:@"SELECT rowid,"];
+  [copyRows addObject:[_copiedExpressions componentsJoinedByString:@", "]];
+  [copyRows addObject:@"FROM"];
+  [copyRows addObject:[FMDatabase escapeIdentifier:self.tableName]];
+  [copyRows addObject:@"WHERE"];
+  [copyRows addObject:where];
+  
+  return [copyRows componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns an UPDATE that sets the backfilled columns of rows matching `where`, and the migration's own WHERE clause.
+ */
+- (NSString *)statementToBackfillRowsWhere:(NSString *)where
+{
+  NSMutableArray * assignments = [[NSMutableArray alloc] initWithCapacity:_expressions.count];
+  [_expressions enumerateKeysAndObjectsUsingBlock:^(NSString * columnName, NSString * expression, BOOL * stop) {
+    [assignments addObject:[NSString stringWithFormat:@"%@ = %@",
+                            [FMDatabase escapeIdentifier:columnName],
+                            expression]];
+  }];
+  
+  NSMutableArray * backfillRows = [[NSMutableArray alloc] init];
+  [backfillRows addObject:@"UPDATE"];
+  [backfillRows addObject:[FMDatabase escapeIdentifier:self.tableName]];
+  [backfillRows addObject:@"SET"];
+  [backfillRows addObject:[assignments componentsJoinedByString:@", "]];
+  [backfillRows addObject:@"WHERE"];
+  [backfillRows addObject:where];
+  if (_where != nil)
+  {
+    [backfillRows addObject:[NSString stringWithFormat:@"AND (%@)", _where]];
+  }
+  
+  return [backfillRows componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns statements creating triggers that keep the copies of rows up to last_rowid in step with the old table.
+ *  Rows after last_rowid are left to the chunks that copy them.
+ */
+- (NSArray *)statementsToCreateTriggersInDatabase:(FMDatabase *)database
+{
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:self.tableName];
+  NSString * escapedCopiedTableName = [FMDatabase escapeIdentifier:[self nameOfCopiedTable]];
+  NSString * copiedRowsWhere = [NSString stringWithFormat:@"rowid = NEW.rowid AND rowid <="
+                                                          @" (SELECT last_rowid FROM fmdb_online_migrations"
+                                                          @"  WHERE name = %@)",
+                                [FMDatabase escapeString:self.name]];
+  NSString * copyNewRowSQL = [self statementToCopyRowsWhere:copiedRowsWhere
+                                                 inDatabase:database];
+  NSString * deleteOldRowSQL = [NSString stringWithFormat:@"DELETE FROM %@ WHERE rowid = OLD.rowid",
+                                escapedCopiedTableName];
+  
+  // a row replaced by INSERT OR REPLACE, or UPDATE OR REPLACE, doesn't fire the delete trigger unless recursive
+  // triggers are enabled, so any copy with the new row's rowid is deleted before the new row is copied
+  NSString * deleteNewRowSQL = [NSString stringWithFormat:@"DELETE FROM %@ WHERE rowid = NEW.rowid",
+                                escapedCopiedTableName];
+  
+  NSDictionary * triggerBodies = @{ @"insert": @[ deleteNewRowSQL, copyNewRowSQL ],
+                                    @"update": @[ deleteOldRowSQL, deleteNewRowSQL, copyNewRowSQL ],
+                                    @"delete": @[ deleteOldRowSQL ] };
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [triggerBodies enumerateKeysAndObjectsUsingBlock:^(NSString * event, NSArray * body, BOOL * stop) {
+    NSMutableArray * createTrigger = [[NSMutableArray alloc] init];
+    [createTrigger addObject:@"CREATE TRIGGER"];
+    [createTrigger addObject:[FMDatabase escapeIdentifier:[self nameOfTriggerForEvent:event]]];
+    [createTrigger addObject:[@"AFTER " stringByAppendingString:event.uppercaseString]];
+    [createTrigger addObject:@"ON"];
+    [createTrigger addObject:escapedTableName];
+    [createTrigger addObject:@"BEGIN"];
+    for (NSString * statement in body)
+    {
+      [createTrigger addObject:[statement stringByAppendingString:@";"]];
+    }
+    [createTrigger addObject:@"END"];
+    
+    [statements addObject:[createTrigger componentsJoinedByString:@" "]];
+  }];
+  return statements;
+}
+
+- (NSArray *)statementsToDropTriggers
+{
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  for (NSString * event in @[ @"insert", @"update", @"delete" ])
+  {
+    NSString * triggerName = [FMDatabase escapeIdentifier:[self nameOfTriggerForEvent:event]];
+    [statements addObject:[@"DROP TRIGGER IF EXISTS " stringByAppendingString:triggerName]];
+  }
+  return statements;
+}
+
+@end
@@ -0,0 +1,230 @@
+#import "FMDatabase.h"
+
+@class FMDBConnectionPool;
+
+/**
+ *  One logical table spread across several database files, or shards, so that writes to different shards can run in
+ *  parallel, e.g. on different disks, and no one file holds every row.
+ *
+ *  Each row belongs to the shard chosen by hashing the value of its shard key column. Inserts, and updates, deletes,
+ *  selects, and counts whose `matchingValues` include the shard key, are routed to the shards that can hold the
+ *  matching rows. Other operations fan out to every shard in parallel: counts and changes are summed, and selected
+ *  rows are merged in order of their sort descriptors.
+ *
+ *  Each shard is an `FMDBConnectionPool`, with its own writer and readers. Writes are only atomic within a shard: if
+ *  a write to one shard fails, the changes already made to others remain. Rowids are assigned by each shard, so rows
+ *  should be identified by a key unique across shards, such as the shard key itself. The value of a row's shard key
+ *  must not be updated, as the row would then be on the wrong shard.
+ */
+@interface FMDBShardedTable : NSObject
+
+/**
+ *  Creates a sharded table whose shards share the processors' readers between them.
+ */
++ (instancetype)tableWithName:(NSString *)tableName
+               shardKeyColumn:(NSString *)shardKeyColumn
+                        paths:(NSArray *)paths;
+
+/**
+ *  Creates a sharded table. Call `-open:` before using it.
+ *
+ *  @param  tableName             The name of the table in every shard.
+ *  @param  shardKeyColumn        The column whose value chooses a row's shard.
+ *  @param  paths                 The paths to the shards' database files, one per shard. The order of the paths
+ *                                determines which rows each shard holds, so it mustn't change once rows are inserted.
+ *  @param  readerCountPerShard   The number of read-only connections to open to each shard.
+ */
+- (instancetype)initWithName:(NSString *)tableName
+              shardKeyColumn:(NSString *)shardKeyColumn
+                       paths:(NSArray *)paths
+         readerCountPerShard:(NSUInteger)readerCountPerShard;
+
+@property (nonatomic, copy, readonly) NSString * tableName;
+@property (nonatomic, copy, readonly) NSString * shardKeyColumn;
+
+/**
+ *  The shards' connection pools, in the order of their paths.
+ */
+@property (nonatomic, copy, readonly) NSArray * shards;
+
+/**
+ *  Opens every shard.
+ *
+ *  @return `YES` if successful, `NO` if a shard couldn't be opened, in which case all shards are closed.
+ */
+- (BOOL)open:(NSError **)error_p;
+
+/**
+ *  Closes every shard. The table must not be in use.
+ */
+- (void)close;
+
+// ========== SHARDING =================================================================================================
+#pragma mark - Sharding
+
+/// @name Choosing Shards
+
+/**
+ *  Returns a hash of a shard key value that is the same in every process and on every platform. Numbers equal in SQL,
+ *  e.g. 1 and 1.0, have the same hash, and dates are hashed as their number of seconds since 1970, as FMDB binds them.
+ */
++ (uint64_t)hashOfShardKey:(id)key;
+
+/**
+ *  Returns the index of the shard holding rows with a shard key value, from `+hashOfShardKey:`. Subclasses may
+ *  override this to shard rows differently, e.g. by ranges of keys.
+ *
+ *  Keys are converted by the type affinity of the shard key column, as the shards store them, before they're passed
+ *  to this method, so that values equal in SQL are routed to the same shard, e.g. `@"1"` and `@1` for an `INTEGER`
+ *  column.
+ */
+- (NSUInteger)shardIndexOfKey:(id)key;
+
+// ========== SCHEMA ===================================================================================================
+#pragma mark - Schema
+
+/// @name Creating the Table
+
+/**
+ *  Creates the table in every shard, as `-[FMDatabase createTableWithName:columns:constraints:error:]`.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs in any shard.
+ */
+- (BOOL)createTableWithColumns:(NSArray *)columns
+                   constraints:(NSArray *)constraints
+                         error:(NSError **)error_p;
+
+/**
+ *  Executes a statement, e.g. CREATE INDEX, on the writer of every shard in parallel.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs in any shard.
+ */
+- (BOOL)executeUpdateOnEveryShard:(NSString *)sql
+             withArgumentsInArray:(NSArray *)arguments
+                            error:(NSError **)error_p;
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+/// @name Writing
+
+/**
+ *  Inserts a row into its shard, as `-[FMDatabase insertInto:row:error:]`. The row must have a shard key value.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs.
+ */
+- (BOOL)insertRow:(NSDictionary *)rowValues
+            error:(NSError **)error_p;
+
+/**
+ *  Inserts rows, each of which must have a shard key value. The rows of each shard are inserted in one transaction,
+ *  and shards are written in parallel.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs in any shard.
+ */
+- (BOOL)insertRows:(NSArray *)rows
+             error:(NSError **)error_p;
+
+/**
+ *  Updates rows matching values, as `-[FMDatabase update:values:matchingValues:error:]`, in the shards that can hold
+ *  them. `values` must not include the shard key column.
+ *
+ *  @return The total number of updated rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)updateValues:(NSDictionary *)values
+           matchingValues:(NSDictionary *)valuesToMatch
+                    error:(NSError **)error_p;
+
+/**
+ *  Updates rows matching a WHERE clause in every shard, as `-[FMDatabase update:values:where:arguments:error:]`.
+ *  `values` must not include the shard key column.
+ *
+ *  @return The total number of updated rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)updateValues:(NSDictionary *)values
+                    where:(NSString *)where
+                arguments:(NSArray *)arguments
+                    error:(NSError **)error_p;
+
+/**
+ *  Deletes rows matching values, as `-[FMDatabase deleteFrom:matchingValues:error:]`, from the shards that can hold
+ *  them.
+ *
+ *  @return The total number of deleted rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)deleteMatchingValues:(NSDictionary *)valuesToMatch
+                            error:(NSError **)error_p;
+
+/**
+ *  Deletes rows matching a WHERE clause from every shard, as `-[FMDatabase deleteFrom:where:arguments:error:]`.
+ *
+ *  @return The total number of deleted rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)deleteWhere:(NSString *)where
+               arguments:(NSArray *)arguments
+                   error:(NSError **)error_p;
+
+// ========== READS ====================================================================================================
+#pragma mark - Reads
+
+/// @name Reading
+
+/**
+ *  Counts the rows matching values in the shards that can hold them, as
+ *  `-[FMDatabase countFrom:matchingValues:error:]`.
+ *
+ *  @return The total number of matching rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)countMatchingValues:(NSDictionary *)valuesToMatch
+                           error:(NSError **)error_p;
+
+/**
+ *  Counts the rows matching a WHERE clause in every shard, as `-[FMDatabase count:from:where:arguments:error:]`.
+ *
+ *  @return The total number of matching rows, or -1 if an error occurs in any shard.
+ */
+- (NSInteger)countWhere:(NSString *)where
+              arguments:(NSArray *)arguments
+                  error:(NSError **)error_p;
+
+/**
+ *  Selects the rows matching values from the shards that can hold them.
+ *
+ *  Each shard sorts its rows and applies `limit + offset` itself, and the shards' rows are then merged, k ways, in the
+ *  order of `sortDescriptors`, before the offset and limit are applied to the merged rows. Rows are sorted with the
+ *  BINARY collation, whatever collation their columns declare, so that every shard sorts them as they're merged.
+ *
+ *  @param  columnNames       The columns to select, or `nil` to select all columns. Sort columns that aren't selected
+ *                            are selected from each shard to merge its rows, but aren't returned.
+ *  @param  valuesToMatch     Values to match, as described in
+ *                            `-[FMDatabase selectResults:from:matchingValues:orderBy:limit:offset:error:]`.
+ *  @param  sortDescriptors   `NSSortDescriptor` instances whose keys are the columns to sort by. If empty, the rows of
+ *                            each shard are returned in turn.
+ *  @param  limit             The maximum number of rows to return, or `nil` to return all rows.
+ *  @param  offset            The number of rows to skip, or `nil`.
+ *  @param  error_p           A pointer to any error that occurs.
+ *
+ *  @return The selected rows as dictionaries, or `nil` if an error occurs in any shard.
+ */
+- (NSArray *)selectColumns:(NSArray *)columnNames
+            matchingValues:(NSDictionary *)valuesToMatch
+           sortDescriptors:(NSArray *)sortDescriptors
+                     limit:(NSNumber *)limit
+                    offset:(NSNumber *)offset
+                     error:(NSError **)error_p;
+
+/**
+ *  Selects the rows matching a WHERE clause from every shard, sorted and merged as for
+ *  `-selectColumns:matchingValues:sortDescriptors:limit:offset:error:`.
+ *
+ *  @return The selected rows as dictionaries, or `nil` if an error occurs in any shard.
+ */
+- (NSArray *)selectColumns:(NSArray *)columnNames
+                     where:(NSString *)where
+                 arguments:(NSArray *)arguments
+           sortDescriptors:(NSArray *)sortDescriptors
+                     limit:(NSNumber *)limit
+                    offset:(NSNumber *)offset
+                     error:(NSError **)error_p;
+
+@end
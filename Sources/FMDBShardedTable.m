@@ -0,0 +1,903 @@
+#import "FMDBShardedTable.h"
+#import "FMDBConnectionPool.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMResultSet+FMDBHelpers.h"
+
+// FNV-1a, which is simple, fast, and the same everywhere, unlike -[NSObject hash]
+static const uint64_t FMDBShardKeyHashOffsetBasis = 14695981039346656037ULL;
+static const uint64_t FMDBShardKeyHashPrime = 1099511628211ULL;
+
+static uint64_t FMDBHashBytes(uint64_t hash, const void * bytes, size_t length)
+{
+  const uint8_t * byte = bytes;
+  for (size_t byteIdx = 0; byteIdx < length; byteIdx++)
+  {
+    hash ^= byte[byteIdx];
+    hash *= FMDBShardKeyHashPrime;
+  }
+  return hash;
+}
+
+/**
+ *  Returns a number as text, as sqlite converts it, with a decimal point in whole reals.
+ */
+static NSString * FMDBTextOfNumber(NSNumber * number)
+{
+  if (NO == CFNumberIsFloatType((__bridge CFNumberRef)number))
+  {
+    return [NSString stringWithFormat:@"%lld", number.longLongValue];
+  }
+  
+  NSString * text = [NSString stringWithFormat:@"%.15g", number.doubleValue];
+  NSCharacterSet * realCharacters = [NSCharacterSet characterSetWithCharactersInString:@".eEn"];
+  if ([text rangeOfCharacterFromSet:realCharacters].location == NSNotFound)
+  {
+    text = [text stringByAppendingString:@".0"];
+  }
+  return text;
+}
+
+/**
+ *  Returns text as a number, as sqlite converts well-formed integer and real literals, or the text if it isn't one.
+ */
+static id FMDBNumberOfText(NSString * text)
+{
+  NSString * trimmedText = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+  NSScanner * scanner = [NSScanner scannerWithString:trimmedText];
+  scanner.charactersToBeSkipped = nil;
+  
+  long long integerValue = 0;
+  if ([scanner scanLongLong:&integerValue] && scanner.isAtEnd && integerValue != LLONG_MAX && integerValue != LLONG_MIN)
+  {
+    return @(integerValue);
+  }
+  
+  scanner.scanLocation = 0;
+  double doubleValue = 0;
+  if ([scanner scanDouble:&doubleValue] && scanner.isAtEnd)
+  {
+    return @(doubleValue);
+  }
+  return text;
+}
+
+/**
+ *  Returns a shard key as a column of the declared type stores it, following sqlite's rules for type affinity, so that
+ *  keys that are equal in SQL, e.g. 1 and '1' in an INTEGER column, are hashed equally.
+ */
+static id FMDBShardKeyWithAffinity(id key, NSString * declaredType)
+{
+  if ([key isKindOfClass:[NSDate class]])
+  {
+    key = @([key timeIntervalSince1970]);
+  }
+  
+  NSString * type = declaredType.uppercaseString;
+  if ([type rangeOfString:@"INT"].location == NSNotFound)
+  {
+    if ([type rangeOfString:@"CHAR"].location != NSNotFound ||
+        [type rangeOfString:@"CLOB"].location != NSNotFound ||
+        [type rangeOfString:@"TEXT"].location != NSNotFound)
+    {
+      return ([key isKindOfClass:[NSNumber class]] ? FMDBTextOfNumber(key) : key);
+    }
+    else if (type.length == 0 || [type rangeOfString:@"BLOB"].location != NSNotFound)
+    {
+      return key;
+    }
+  }
+  
+  // INTEGER, REAL, and NUMERIC affinity
+  return ([key isKindOfClass:[NSString class]] ? FMDBNumberOfText(key) : key);
+}
+
+// ========== MERGING ==================================================================================================
+#pragma mark - Merging
+
+/**
+ *  Returns the rank of a value's type in sqlite's sort order: NULL, then numbers, then text, then blobs.
+ */
+static int FMDBSortRankOfValue(id value)
+{
+  if (value == nil || value == [NSNull null])
+  {
+    return 0;
+  }
+  else if ([value isKindOfClass:[NSNumber class]])
+  {
+    return 1;
+  }
+  else if ([value isKindOfClass:[NSString class]])
+  {
+    return 2;
+  }
+  return 3;
+}
+
+static NSComparisonResult FMDBCompareBytes(const void * bytes,
+                                           size_t length,
+                                           const void * otherBytes,
+                                           size_t otherLength)
+{
+  int result = memcmp(bytes, otherBytes, MIN(length, otherLength));
+  if (result == 0)
+  {
+    result = (length < otherLength ? -1 : (length > otherLength ? 1 : 0));
+  }
+  return (result < 0 ? NSOrderedAscending : (result > 0 ? NSOrderedDescending : NSOrderedSame));
+}
+
+/**
+ *  Compares values as sqlite's ORDER BY does, comparing text and blobs byte by byte as the BINARY collation does.
+ */
+static NSComparisonResult FMDBCompareValues(id value, id otherValue)
+{
+  int rank = FMDBSortRankOfValue(value);
+  int otherRank = FMDBSortRankOfValue(otherValue);
+  if (rank != otherRank)
+  {
+    return (rank < otherRank ? NSOrderedAscending : NSOrderedDescending);
+  }
+  
+  switch (rank)
+  {
+    case 0:
+      return NSOrderedSame;
+    
+    case 1:
+      return [value compare:otherValue];
+    
+    case 2:
+    {
+      const char * text = [value UTF8String];
+      const char * otherText = [otherValue UTF8String];
+      return FMDBCompareBytes(text, strlen(text), otherText, strlen(otherText));
+    }
+    
+    default:
+      return FMDBCompareBytes([value bytes], [value length], [otherValue bytes], [otherValue length]);
+  }
+}
+
+static NSComparisonResult FMDBCompareRecords(NSDictionary * record,
+                                             NSDictionary * otherRecord,
+                                             NSArray * sortDescriptors)
+{
+  for (NSSortDescriptor * sortDescriptor in sortDescriptors)
+  {
+    NSComparisonResult result = FMDBCompareValues(record[sortDescriptor.key], otherRecord[sortDescriptor.key]);
+    if (result != NSOrderedSame)
+    {
+      return (sortDescriptor.ascending ? result : (NSComparisonResult)-result);
+    }
+  }
+  return NSOrderedSame;
+}
+
+// ========== FMDBShardedTable =========================================================================================
+#pragma mark - FMDBShardedTable
+
+@implementation FMDBShardedTable
+{
+  // the declared type of the shard key column, read from the first shard; guarded by @synchronized (self)
+  NSString * _shardKeyDeclaredType;
+}
+
++ (instancetype)tableWithName:(NSString *)tableName
+               shardKeyColumn:(NSString *)shardKeyColumn
+                        paths:(NSArray *)paths
+{
+  NSUInteger processorCount = [[NSProcessInfo processInfo] activeProcessorCount];
+  return [[self alloc] initWithName:tableName
+                     shardKeyColumn:shardKeyColumn
+                              paths:paths
+                readerCountPerShard:MAX(processorCount / MAX(paths.count, 1), 1)];
+}
+
+- (instancetype)initWithName:(NSString *)tableName
+              shardKeyColumn:(NSString *)shardKeyColumn
+                       paths:(NSArray *)paths
+         readerCountPerShard:(NSUInteger)readerCountPerShard
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(shardKeyColumn != nil);
+  NSParameterAssert(paths.count > 0);
+  
+  self = [super init];
+  if (self)
+  {
+    _tableName = [tableName copy];
+    _shardKeyColumn = [shardKeyColumn copy];
+    
+    NSMutableArray * shards = [[NSMutableArray alloc] initWithCapacity:paths.count];
+    for (NSString * path in paths)
+    {
+      [shards addObject:[[FMDBConnectionPool alloc] initWithPath:path
+                                                     readerCount:readerCountPerShard]];
+    }
+    _shards = shards;
+  }
+  return self;
+}
+
+- (BOOL)open:(NSError **)error_p
+{
+  for (FMDBConnectionPool * shard in self.shards)
+  {
+    if (NO == [shard open:error_p])
+    {
+      [self close];
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (void)close
+{
+  for (FMDBConnectionPool * shard in self.shards)
+  {
+    [shard close];
+  }
+}
+
+// ========== SHARDING =================================================================================================
+#pragma mark - Sharding
+
++ (uint64_t)hashOfShardKey:(id)key
+{
+  if ([key isKindOfClass:[NSDate class]])
+  {
+    key = @([key timeIntervalSince1970]);
+  }
+  
+  // the type is hashed too, so that e.g. 1 and '1' usually land on different shards, as they don't match in SQL
+  uint8_t type;
+  const void * bytes = NULL;
+  size_t length = 0;
+  uint64_t number = 0;
+  if (key == nil || key == [NSNull null])
+  {
+    type = 'n';
+  }
+  else if ([key isKindOfClass:[NSNumber class]])
+  {
+    double doubleValue = [key doubleValue];
+    long long integerValue = [key longLongValue];
+    if (CFNumberIsFloatType((__bridge CFNumberRef)key) && (double)integerValue != doubleValue)
+    {
+      type = 'r';
+      memcpy(&number, &doubleValue, sizeof(number));
+    }
+    else
+    {
+      type = 'i';
+      number = (uint64_t)integerValue;
+    }
+    number = CFSwapInt64HostToLittle(number);
+    bytes = &number;
+    length = sizeof(number);
+  }
+  else if ([key isKindOfClass:[NSString class]])
+  {
+    const char * text = [key UTF8String];
+    type = 't';
+    bytes = text;
+    length = strlen(text);
+  }
+  else
+  {
+    NSParameterAssert([key isKindOfClass:[NSData class]]);
+    type = 'b';
+    bytes = [key bytes];
+    length = [key length];
+  }
+  
+  uint64_t hash = FMDBHashBytes(FMDBShardKeyHashOffsetBasis, &type, sizeof(type));
+  return FMDBHashBytes(hash, bytes, length);
+}
+
+- (NSUInteger)shardIndexOfKey:(id)key
+{
+  return (NSUInteger)([FMDBShardedTable hashOfShardKey:key] % self.shards.count);
+}
+
+/**
+ *  Returns the index of the shard holding rows with a shard key value, once converted by the shard key column's type
+ *  affinity, as the shards compare it.
+ */
+- (NSUInteger)shardIndexOfValue:(id)value
+{
+  return [self shardIndexOfKey:FMDBShardKeyWithAffinity(value, [self shardKeyDeclaredType])];
+}
+
+- (NSString *)shardKeyDeclaredType
+{
+  @synchronized (self)
+  {
+    if (_shardKeyDeclaredType == nil)
+    {
+      __block NSString * declaredType = nil;
+      [self.shards.firstObject inReader:^(FMDatabase * db) {
+        NSDictionary * tableSchema = [db tableSchema:self.tableName];
+        for (NSString * columnName in tableSchema)
+        {
+          if ([columnName caseInsensitiveCompare:self.shardKeyColumn] == NSOrderedSame)
+          {
+            declaredType = tableSchema[columnName][@"type"];
+          }
+        }
+      }];
+      
+      // until the table exists, keys are hashed as they are
+      _shardKeyDeclaredType = [declaredType copy];
+    }
+    return _shardKeyDeclaredType;
+  }
+}
+
+/**
+ *  Returns the values to match in each shard that can hold matching rows, keyed by shard index. Rows matching one key
+ *  are in one shard, and rows matching an array of keys are in the shards of those keys.
+ */
+- (NSDictionary *)valuesToMatchByShard:(NSDictionary *)valuesToMatch
+{
+  id key = valuesToMatch[self.shardKeyColumn];
+  if (key == nil)
+  {
+    return [self objectByEveryShard:(valuesToMatch ?: @{})];
+  }
+  else if (NO == [key isKindOfClass:[NSArray class]])
+  {
+    return @{ @([self shardIndexOfValue:key]): valuesToMatch };
+  }
+  
+  NSMutableDictionary * keysByShard = [[NSMutableDictionary alloc] init];
+  for (id shardKey in key)
+  {
+    NSNumber * shardIdx = @([self shardIndexOfValue:shardKey]);
+    NSMutableArray * keys = keysByShard[shardIdx];
+    if (keys == nil)
+    {
+      keys = [[NSMutableArray alloc] init];
+      keysByShard[shardIdx] = keys;
+    }
+    [keys addObject:shardKey];
+  }
+  
+  NSMutableDictionary * valuesToMatchByShard = [[NSMutableDictionary alloc] initWithCapacity:keysByShard.count];
+  for (NSNumber * shardIdx in keysByShard)
+  {
+    NSMutableDictionary * shardValuesToMatch = [valuesToMatch mutableCopy];
+    shardValuesToMatch[self.shardKeyColumn] = keysByShard[shardIdx];
+    valuesToMatchByShard[shardIdx] = shardValuesToMatch;
+  }
+  return valuesToMatchByShard;
+}
+
+- (NSDictionary *)objectByEveryShard:(id)object
+{
+  NSMutableDictionary * objectsByShard = [[NSMutableDictionary alloc] initWithCapacity:self.shards.count];
+  for (NSUInteger shardIdx = 0; shardIdx < self.shards.count; shardIdx++)
+  {
+    objectsByShard[@(shardIdx)] = object;
+  }
+  return objectsByShard;
+}
+
+/**
+ *  Runs a block on each shard in `objectsByShard` in parallel, passing the shard's object, and returns the block's
+ *  results in order of shard index, or `nil` if the block returns `nil` for any shard.
+ */
+- (NSArray *)resultsOfPerformingOnShards:(NSDictionary *)objectsByShard
+                                   error:(NSError **)error_p
+                              usingBlock:(id (^)(FMDBConnectionPool * shard, id object, NSError ** error_p))block
+{
+  NSArray * shardIndexes = [objectsByShard.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  NSMutableArray * results = [[NSMutableArray alloc] initWithCapacity:shardIndexes.count];
+  for (NSUInteger resultIdx = 0; resultIdx < shardIndexes.count; resultIdx++)
+  {
+    [results addObject:[NSNull null]];
+  }
+  
+  __block NSError * firstError = nil;
+  __block BOOL failed = NO;
+  void (^performOnShard)(size_t) = ^(size_t resultIdx) {
+    NSNumber * shardIdx = shardIndexes[resultIdx];
+    NSError * error = nil;
+    id result = block(self.shards[shardIdx.unsignedIntegerValue], objectsByShard[shardIdx], &error);
+    @synchronized (results)
+    {
+      if (result != nil)
+      {
+        results[resultIdx] = result;
+      }
+      else if (NO == failed)
+      {
+        failed = YES;
+        firstError = error;
+      }
+    }
+  };
+  
+  // an operation routed to one shard runs on the calling thread
+  if (shardIndexes.count == 1)
+  {
+    performOnShard(0);
+  }
+  else
+  {
+    dispatch_apply(shardIndexes.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), performOnShard);
+  }
+  
+  if (failed)
+  {
+    if (error_p != NULL) *error_p = firstError;
+    return nil;
+  }
+  return results;
+}
+
+/**
+ *  Runs a block on each shard in `objectsByShard` in parallel, and returns the sum of the counts it returns, or -1 if
+ *  it returns -1 for any shard.
+ */
+- (NSInteger)sumOfPerformingOnShards:(NSDictionary *)objectsByShard
+                               error:(NSError **)error_p
+                          usingBlock:(NSInteger (^)(FMDBConnectionPool * shard, id object, NSError ** error_p))block
+{
+  NSArray * counts = [self resultsOfPerformingOnShards:objectsByShard
+                                                 error:error_p
+                                            usingBlock:^id(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    NSInteger count = block(shard, object, error_p);
+    return (count >= 0 ? @(count) : nil);
+  }];
+  if (counts == nil)
+  {
+    return -1;
+  }
+  
+  NSInteger sum = 0;
+  for (NSNumber * count in counts)
+  {
+    sum += count.integerValue;
+  }
+  return sum;
+}
+
+// ========== SCHEMA ===================================================================================================
+#pragma mark - Schema
+
+- (BOOL)createTableWithColumns:(NSArray *)columns
+                   constraints:(NSArray *)constraints
+                         error:(NSError **)error_p
+{
+  @synchronized (self)
+  {
+    _shardKeyDeclaredType = nil;
+  }
+  
+  NSString * tableName = self.tableName;
+  return nil != [self resultsOfPerformingOnShards:[self objectByEveryShard:[NSNull null]]
+                                            error:error_p
+                                       usingBlock:^id(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    __block BOOL created = NO;
+    [shard inWriter:^(FMDatabase * db) {
+      created = [db createTableWithName:tableName
+                                columns:columns
+                            constraints:constraints
+                                  error:error_p];
+    }];
+    return (created ? @YES : nil);
+  }];
+}
+
+- (BOOL)executeUpdateOnEveryShard:(NSString *)sql
+             withArgumentsInArray:(NSArray *)arguments
+                            error:(NSError **)error_p
+{
+  return nil != [self resultsOfPerformingOnShards:[self objectByEveryShard:[NSNull null]]
+                                            error:error_p
+                                       usingBlock:^id(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    return ([shard executeUpdate:sql withArgumentsInArray:arguments error:error_p] ? @YES : nil);
+  }];
+}
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+- (BOOL)insertRow:(NSDictionary *)rowValues
+            error:(NSError **)error_p
+{
+  id key = rowValues[self.shardKeyColumn];
+  NSParameterAssert(key != nil);
+  
+  FMDBConnectionPool * shard = self.shards[[self shardIndexOfValue:key]];
+  return nil != [shard insertInto:self.tableName
+                              row:rowValues
+                            error:error_p];
+}
+
+- (BOOL)insertRows:(NSArray *)rows
+             error:(NSError **)error_p
+{
+  NSMutableDictionary * rowsByShard = [[NSMutableDictionary alloc] init];
+  for (NSDictionary * row in rows)
+  {
+    id key = row[self.shardKeyColumn];
+    NSParameterAssert(key != nil);
+    
+    NSNumber * shardIdx = @([self shardIndexOfValue:key]);
+    NSMutableArray * shardRows = rowsByShard[shardIdx];
+    if (shardRows == nil)
+    {
+      shardRows = [[NSMutableArray alloc] init];
+      rowsByShard[shardIdx] = shardRows;
+    }
+    [shardRows addObject:row];
+  }
+  
+  NSString * tableName = self.tableName;
+  return nil != [self resultsOfPerformingOnShards:rowsByShard
+                                            error:error_p
+                                       usingBlock:^id(FMDBConnectionPool * shard,
+                                                      NSArray * shardRows,
+                                                      NSError ** error_p) {
+    __block BOOL inserted = YES;
+    [shard inWriterTransaction:^(FMDatabase * db, BOOL * rollback) {
+      for (NSDictionary * row in shardRows)
+      {
+        if (nil == [db insertInto:tableName row:row error:error_p])
+        {
+          inserted = NO;
+          *rollback = YES;
+          break;
+        }
+      }
+    }];
+    return (inserted ? @YES : nil);
+  }];
+}
+
+- (NSInteger)updateValues:(NSDictionary *)values
+           matchingValues:(NSDictionary *)valuesToMatch
+                    error:(NSError **)error_p
+{
+  NSParameterAssert(values[self.shardKeyColumn] == nil);
+  
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self valuesToMatchByShard:valuesToMatch]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard,
+                                                  NSDictionary * shardValuesToMatch,
+                                                  NSError ** error_p) {
+    return [shard update:tableName
+                  values:values
+          matchingValues:shardValuesToMatch
+                   error:error_p];
+  }];
+}
+
+- (NSInteger)updateValues:(NSDictionary *)values
+                    where:(NSString *)where
+                arguments:(NSArray *)arguments
+                    error:(NSError **)error_p
+{
+  NSParameterAssert(values[self.shardKeyColumn] == nil);
+  
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self objectByEveryShard:[NSNull null]]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    return [shard update:tableName
+                  values:values
+                   where:where
+               arguments:arguments
+                   error:error_p];
+  }];
+}
+
+- (NSInteger)deleteMatchingValues:(NSDictionary *)valuesToMatch
+                            error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self valuesToMatchByShard:valuesToMatch]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard,
+                                                  NSDictionary * shardValuesToMatch,
+                                                  NSError ** error_p) {
+    return [shard deleteFrom:tableName
+              matchingValues:shardValuesToMatch
+                       error:error_p];
+  }];
+}
+
+- (NSInteger)deleteWhere:(NSString *)where
+               arguments:(NSArray *)arguments
+                   error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self objectByEveryShard:[NSNull null]]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    return [shard deleteFrom:tableName
+                       where:where
+                   arguments:arguments
+                       error:error_p];
+  }];
+}
+
+// ========== READS ====================================================================================================
+#pragma mark - Reads
+
+- (NSInteger)countMatchingValues:(NSDictionary *)valuesToMatch
+                           error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self valuesToMatchByShard:valuesToMatch]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard,
+                                                  NSDictionary * shardValuesToMatch,
+                                                  NSError ** error_p) {
+    return [shard countFrom:tableName
+             matchingValues:shardValuesToMatch
+                      error:error_p];
+  }];
+}
+
+- (NSInteger)countWhere:(NSString *)where
+              arguments:(NSArray *)arguments
+                  error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self sumOfPerformingOnShards:[self objectByEveryShard:[NSNull null]]
+                                 error:error_p
+                            usingBlock:^NSInteger(FMDBConnectionPool * shard, id object, NSError ** error_p) {
+    return [shard count:nil
+                   from:tableName
+                  where:where
+              arguments:arguments
+                  error:error_p];
+  }];
+}
+
+- (NSArray *)selectColumns:(NSArray *)columnNames
+            matchingValues:(NSDictionary *)valuesToMatch
+           sortDescriptors:(NSArray *)sortDescriptors
+                     limit:(NSNumber *)limit
+                    offset:(NSNumber *)offset
+                     error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self selectFromShards:[self valuesToMatchByShard:valuesToMatch]
+                    columnNames:columnNames
+                sortDescriptors:sortDescriptors
+                          limit:limit
+                         offset:offset
+                          error:error_p
+                     usingBlock:^FMResultSet *(FMDatabase * db,
+                                               NSDictionary * shardValuesToMatch,
+                                               NSArray * shardColumnNames,
+                                               NSString * orderBy,
+                                               NSNumber * shardLimit,
+                                               NSNumber * shardOffset,
+                                               NSError ** error_p) {
+    return [db selectResults:shardColumnNames
+                        from:tableName
+              matchingValues:shardValuesToMatch
+                     orderBy:orderBy
+                       limit:shardLimit
+                      offset:shardOffset
+                       error:error_p];
+  }];
+}
+
+- (NSArray *)selectColumns:(NSArray *)columnNames
+                     where:(NSString *)where
+                 arguments:(NSArray *)arguments
+           sortDescriptors:(NSArray *)sortDescriptors
+                     limit:(NSNumber *)limit
+                    offset:(NSNumber *)offset
+                     error:(NSError **)error_p
+{
+  NSString * tableName = self.tableName;
+  return [self selectFromShards:[self objectByEveryShard:[NSNull null]]
+                    columnNames:columnNames
+                sortDescriptors:sortDescriptors
+                          limit:limit
+                         offset:offset
+                          error:error_p
+                     usingBlock:^FMResultSet *(FMDatabase * db,
+                                               id object,
+                                               NSArray * shardColumnNames,
+                                               NSString * orderBy,
+                                               NSNumber * shardLimit,
+                                               NSNumber * shardOffset,
+                                               NSError ** error_p) {
+    return [db selectResults:shardColumnNames
+                        from:tableName
+                       where:where
+                     groupBy:nil
+                      having:nil
+                   arguments:arguments
+                     orderBy:orderBy
+                       limit:shardLimit
+                      offset:shardOffset
+                       error:error_p];
+  }];
+}
+
+/**
+ *  Selects sorted rows from each shard on one of its readers, and merges them. A single shard applies the limit and
+ *  offset itself, but when there are several, each returns its first `limit + offset` rows, as any of them may be
+ *  among the merged rows, and also selects any sort columns that weren't asked for, which are removed once merged.
+ */
+- (NSArray *)selectFromShards:(NSDictionary *)objectsByShard
+                  columnNames:(NSArray *)columnNames
+              sortDescriptors:(NSArray *)sortDescriptors
+                        limit:(NSNumber *)limit
+                       offset:(NSNumber *)offset
+                        error:(NSError **)error_p
+                   usingBlock:(FMResultSet * (^)(FMDatabase * db,
+                                                 id object,
+                                                 NSArray * shardColumnNames,
+                                                 NSString * orderBy,
+                                                 NSNumber * shardLimit,
+                                                 NSNumber * shardOffset,
+                                                 NSError ** error_p))block
+{
+  BOOL isMerged = (objectsByShard.count > 1);
+  NSString * orderBy = (sortDescriptors.count > 0
+                        ? [FMDBShardedTable binaryOrderByClauseWithSortDescriptors:sortDescriptors]
+                        : nil);
+  NSArray * shardColumnNames = columnNames;
+  NSMutableArray * addedColumnNames = [[NSMutableArray alloc] init];
+  NSNumber * shardLimit = limit;
+  NSNumber * shardOffset = offset;
+  if (isMerged)
+  {
+    shardLimit = (limit != nil ? @(limit.unsignedIntegerValue + offset.unsignedIntegerValue) : nil);
+    shardOffset = nil;
+    
+    if (columnNames != nil && NO == [columnNames containsObject:@"*"])
+    {
+      for (NSSortDescriptor * sortDescriptor in sortDescriptors)
+      {
+        NSString * key = sortDescriptor.key;
+        if (NO == [columnNames containsObject:key] &&
+            NO == [columnNames containsObject:[FMDatabase escapeIdentifier:key]] &&
+            NO == [addedColumnNames containsObject:key])
+        {
+          [addedColumnNames addObject:key];
+        }
+      }
+      
+      NSMutableArray * escapedColumnNames = [[NSMutableArray alloc] initWithCapacity:addedColumnNames.count];
+      for (NSString * columnName in addedColumnNames)
+      {
+        [escapedColumnNames addObject:[FMDatabase escapeIdentifier:columnName]];
+      }
+      shardColumnNames = [columnNames arrayByAddingObjectsFromArray:escapedColumnNames];
+    }
+  }
+  
+  NSArray * recordsByShard = [self resultsOfPerformingOnShards:objectsByShard
+                                                         error:error_p
+                                                    usingBlock:^id(FMDBConnectionPool * shard,
+                                                                   id object,
+                                                                   NSError ** error_p) {
+    __block NSArray * records = nil;
+    [shard inReader:^(FMDatabase * db) {
+      FMResultSet * results = block(db, object, shardColumnNames, orderBy, shardLimit, shardOffset, error_p);
+      records = results.allRecords;
+      if (results != nil && [db hadError])
+      {
+        if (error_p != NULL) *error_p = db.lastError;
+        records = nil;
+      }
+    }];
+    return records;
+  }];
+  
+  if (recordsByShard == nil)
+  {
+    return nil;
+  }
+  else if (NO == isMerged)
+  {
+    return recordsByShard.firstObject ?: @[];
+  }
+  
+  NSArray * mergedRecords = [FMDBShardedTable mergeRecordsByShard:recordsByShard
+                                                  sortDescriptors:sortDescriptors
+                                                            limit:limit
+                                                           offset:offset];
+  if (addedColumnNames.count == 0)
+  {
+    return mergedRecords;
+  }
+  
+  NSMutableArray * records = [[NSMutableArray alloc] initWithCapacity:mergedRecords.count];
+  for (NSDictionary * mergedRecord in mergedRecords)
+  {
+    NSMutableDictionary * record = [mergedRecord mutableCopy];
+    [record removeObjectsForKeys:addedColumnNames];
+    [records addObject:record];
+  }
+  return records;
+}
+
+/**
+ *  Returns an ORDER BY clause for the given sort descriptors that sorts with the BINARY collation, whatever collation
+ *  the columns declare, so that each shard's rows are in the order they're merged in.
+ */
++ (NSString *)binaryOrderByClauseWithSortDescriptors:(NSArray *)sortDescriptors
+{
+  NSMutableArray * orderBy = [[NSMutableArray alloc] initWithCapacity:sortDescriptors.count];
+  for (NSSortDescriptor * sortDescriptor in sortDescriptors)
+  {
+    [orderBy addObject:[NSString stringWithFormat:@"%@ COLLATE BINARY %@",
+                        [FMDatabase escapeIdentifier:sortDescriptor.key],
+                        (sortDescriptor.ascending ? @"ASC" : @"DESC")]];
+  }
+  return [orderBy componentsJoinedByString:@", "];
+}
+
+/**
+ *  Merges the sorted records of each shard, skipping `offset` records and returning at most `limit`. Each record is
+ *  chosen from the first remaining record of each shard by scanning them all, which is faster than a heap for the few
+ *  shards a table has.
+ */
++ (NSArray *)mergeRecordsByShard:(NSArray *)recordsByShard
+                 sortDescriptors:(NSArray *)sortDescriptors
+                           limit:(NSNumber *)limit
+                          offset:(NSNumber *)offset
+{
+  NSUInteger skipCount = offset.unsignedIntegerValue;
+  NSUInteger maximumCount = (limit != nil ? limit.unsignedIntegerValue : NSUIntegerMax);
+  NSMutableArray * mergedRecords = [[NSMutableArray alloc] init];
+  
+  NSUInteger * positions = calloc(recordsByShard.count, sizeof(NSUInteger));
+  while (mergedRecords.count < maximumCount)
+  {
+    NSUInteger nextShardIdx = NSNotFound;
+    NSDictionary * nextRecord = nil;
+    for (NSUInteger shardIdx = 0; shardIdx < recordsByShard.count; shardIdx++)
+    {
+      NSArray * records = recordsByShard[shardIdx];
+      if (positions[shardIdx] >= records.count)
+      {
+        continue;
+      }
+      
+      // without sort descriptors, each shard's records are returned in turn
+      NSDictionary * record = records[positions[shardIdx]];
+      if (nextRecord == nil ||
+          FMDBCompareRecords(record, nextRecord, sortDescriptors) == NSOrderedAscending)
+      {
+        nextShardIdx = shardIdx;
+        nextRecord = record;
+      }
+    }
+    
+    if (nextRecord == nil)
+    {
+      break;
+    }
+    
+    positions[nextShardIdx]++;
+    if (skipCount > 0)
+    {
+      skipCount--;
+    }
+    else
+    {
+      [mergedRecords addObject:nextRecord];
+    }
+  }
+  free(positions);
+  
+  return mergedRecords;
+}
+
+@end
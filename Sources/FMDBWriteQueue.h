@@ -0,0 +1,100 @@
+#import "FMDatabase.h"
+
+/**
+ *  Runs writes asynchronously on a serial queue, grouping writes that arrive close together into a single transaction.
+ *  Committing many small writes at once needs only one sync to disk, rather than one per statement.
+ *
+ *  A batch is committed once it holds `batchSize` writes, or `batchInterval` seconds after its first write was queued,
+ *  whichever comes first. Each write's completion block is called after its batch has committed, with the write's own
+ *  result or error. Each write runs within its own savepoint, so a failed write's changes are rolled back without
+ *  affecting the other writes in its batch. If an error rolls back the whole transaction, e.g. `SQLITE_FULL` or
+ *  `RAISE(ROLLBACK)` in a trigger, the writes before it in the batch fail with its error, and the rest of the batch is
+ *  written in a new transaction. If the commit itself fails, every write that was still uncommitted fails with the
+ *  commit's error.
+ *
+ *  The queue takes over the database, which must not be used elsewhere while the queue exists.
+ */
+@interface FMDBWriteQueue : NSObject
+
+/**
+ *  Creates a queue that writes to an open database.
+ */
+- (instancetype)initWithDatabase:(FMDatabase *)database;
+
+@property (nonatomic, strong, readonly) FMDatabase * database;
+
+/**
+ *  The maximum number of writes committed in one transaction. Defaults to 1000.
+ */
+@property (atomic, assign) NSUInteger batchSize;
+
+/**
+ *  How long to wait for more writes before committing a batch. Defaults to 0.005 seconds.
+ */
+@property (atomic, assign) NSTimeInterval batchInterval;
+
+/**
+ *  The queue on which completion blocks are called. Defaults to the main queue.
+ */
+@property (atomic, strong) dispatch_queue_t completionQueue;
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+/// @name Queueing Writes
+
+/**
+ *  Queues `-[FMDatabase insertInto:row:error:]`.
+ *
+ *  @param  completion  Called with the new row's ID, or `nil` and an error. May be `nil`.
+ */
+- (void)insertInto:(NSString *)tableName
+               row:(NSDictionary *)rowValues
+        completion:(void (^)(NSNumber * rowId, NSError * error))completion;
+
+/**
+ *  Queues `-[FMDatabase update:values:matchingValues:error:]`.
+ *
+ *  @param  completion  Called with the number of changed rows, or -1 and an error. May be `nil`.
+ */
+- (void)update:(NSString *)tableName
+        values:(NSDictionary *)values
+matchingValues:(NSDictionary *)matchingValues
+    completion:(void (^)(NSInteger changes, NSError * error))completion;
+
+/**
+ *  Queues `-[FMDatabase deleteFrom:where:arguments:error:]`.
+ *
+ *  @param  completion  Called with the number of deleted rows, or -1 and an error. May be `nil`.
+ */
+- (void)deleteFrom:(NSString *)tableName
+             where:(NSString *)where
+         arguments:(NSArray *)arguments
+        completion:(void (^)(NSInteger changes, NSError * error))completion;
+
+/**
+ *  Queues an arbitrary write.
+ *
+ *  @param  write       Performs the write, and returns its result, or `nil` and sets `*error_p` if it fails.
+ *  @param  completion  Called with the result returned by `write`, or `nil` and an error. May be `nil`.
+ */
+- (void)performWrite:(id (^)(FMDatabase * db, NSError ** error_p))write
+          completion:(void (^)(id result, NSError * error))completion;
+
+/**
+ *  Queues a write that runs outside of the queue's transactions, once the writes queued before it have been committed,
+ *  e.g. a write that manages its own transaction, or changes a setting that sqlite ignores within a transaction.
+ *
+ *  @param  write       Performs the write, and returns its result, or `nil` and sets `*error_p` if it fails.
+ *  @param  completion  Called with the result returned by `write`, or `nil` and an error. May be `nil`.
+ */
+- (void)performWriteOutsideTransaction:(id (^)(FMDatabase * db, NSError ** error_p))write
+                            completion:(void (^)(id result, NSError * error))completion;
+
+/**
+ *  Commits any queued writes, and waits until they have been committed. Completion blocks may not have been called
+ *  yet when this returns.
+ */
+- (void)flush;
+
+@end
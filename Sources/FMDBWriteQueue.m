@@ -0,0 +1,274 @@
+#import "FMDBWriteQueue.h"
+#import "FMDatabase+FMDBHelpers.h"
+
+static const NSUInteger FMDBDefaultWriteBatchSize = 1000;
+
+static const NSTimeInterval FMDBDefaultWriteBatchInterval = 0.005;
+
+static NSString * const FMDBWriteSavepointStatement = @"SAVEPOINT fmdb_write_queue";
+
+static NSString * const FMDBWriteSavepointRollbackStatement = @"ROLLBACK TO fmdb_write_queue";
+
+static NSString * const FMDBWriteSavepointReleaseStatement = @"RELEASE fmdb_write_queue";
+
+// ========== FMDBQueuedWrite ==========================================================================================
+#pragma mark - FMDBQueuedWrite
+
+@interface FMDBQueuedWrite : NSObject
+
+@property (nonatomic, copy) id (^write)(FMDatabase * db, NSError ** error_p);
+@property (nonatomic, copy) void (^completion)(id result, NSError * error);
+@property (nonatomic, strong) id result;
+@property (nonatomic, strong) NSError * error;
+
+@end
+
+@implementation FMDBQueuedWrite
+
+@end
+
+// ========== FMDBWriteQueue ===========================================================================================
+#pragma mark - FMDBWriteQueue
+
+@implementation FMDBWriteQueue
+{
+  dispatch_queue_t _writeQueue;
+  
+  // guarded by @synchronized (_pendingWrites)
+  NSMutableArray * _pendingWrites;
+  BOOL _isCommitScheduled;
+}
+
+- (instancetype)initWithDatabase:(FMDatabase *)database
+{
+  NSParameterAssert(database != nil);
+  
+  self = [super init];
+  if (self)
+  {
+    _database = database;
+    _batchSize = FMDBDefaultWriteBatchSize;
+    _batchInterval = FMDBDefaultWriteBatchInterval;
+    _completionQueue = dispatch_get_main_queue();
+    
+    _writeQueue = dispatch_queue_create("FMDBWriteQueue", DISPATCH_QUEUE_SERIAL);
+    _pendingWrites = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+- (void)insertInto:(NSString *)tableName
+               row:(NSDictionary *)rowValues
+        completion:(void (^)(NSNumber * rowId, NSError * error))completion
+{
+  [self performWrite:^id(FMDatabase * db, NSError ** error_p) {
+    return [db insertInto:tableName
+                      row:rowValues
+                    error:error_p];
+  } completion:(completion == nil ? nil : ^(id result, NSError * error) {
+    completion(result, error);
+  })];
+}
+
+- (void)update:(NSString *)tableName
+        values:(NSDictionary *)values
+matchingValues:(NSDictionary *)matchingValues
+    completion:(void (^)(NSInteger changes, NSError * error))completion
+{
+  [self performWrite:^id(FMDatabase * db, NSError ** error_p) {
+    NSInteger changes = [db update:tableName
+                            values:values
+                    matchingValues:matchingValues
+                             error:error_p];
+    return (changes >= 0 ? @(changes) : nil);
+  } completion:(completion == nil ? nil : ^(id result, NSError * error) {
+    completion((result != nil ? [result integerValue] : -1), error);
+  })];
+}
+
+- (void)deleteFrom:(NSString *)tableName
+             where:(NSString *)where
+         arguments:(NSArray *)arguments
+        completion:(void (^)(NSInteger changes, NSError * error))completion
+{
+  [self performWrite:^id(FMDatabase * db, NSError ** error_p) {
+    NSInteger changes = [db deleteFrom:tableName
+                                 where:where
+                             arguments:arguments
+                                 error:error_p];
+    return (changes >= 0 ? @(changes) : nil);
+  } completion:(completion == nil ? nil : ^(id result, NSError * error) {
+    completion((result != nil ? [result integerValue] : -1), error);
+  })];
+}
+
+- (void)performWrite:(id (^)(FMDatabase * db, NSError ** error_p))write
+          completion:(void (^)(id result, NSError * error))completion
+{
+  NSParameterAssert(write != nil);
+  
+  FMDBQueuedWrite * queuedWrite = [[FMDBQueuedWrite alloc] init];
+  queuedWrite.write = write;
+  queuedWrite.completion = completion;
+  
+  BOOL shouldCommitNow = NO;
+  BOOL shouldScheduleCommit = NO;
+  @synchronized (_pendingWrites)
+  {
+    [_pendingWrites addObject:queuedWrite];
+    if (_pendingWrites.count >= self.batchSize)
+    {
+      shouldCommitNow = YES;
+    }
+    else if (NO == _isCommitScheduled)
+    {
+      _isCommitScheduled = YES;
+      shouldScheduleCommit = YES;
+    }
+  }
+  
+  if (shouldCommitNow)
+  {
+    dispatch_async(_writeQueue, ^{
+      [self commitPendingWrites];
+    });
+  }
+  else if (shouldScheduleCommit)
+  {
+    dispatch_time_t commitTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.batchInterval * NSEC_PER_SEC));
+    dispatch_after(commitTime, _writeQueue, ^{
+      [self commitPendingWrites];
+    });
+  }
+}
+
+- (void)performWriteOutsideTransaction:(id (^)(FMDatabase * db, NSError ** error_p))write
+                            completion:(void (^)(id result, NSError * error))completion
+{
+  NSParameterAssert(write != nil);
+  
+  dispatch_async(_writeQueue, ^{
+    [self commitPendingWrites];
+    
+    NSError * error = nil;
+    id result = write(self.database, &error);
+    if (result == nil && error == nil)
+    {
+      error = self.database.lastError;
+    }
+    
+    if (completion != nil)
+    {
+      dispatch_async(self.completionQueue, ^{
+        completion(result, error);
+      });
+    }
+  });
+}
+
+- (void)flush
+{
+  dispatch_sync(_writeQueue, ^{
+    [self commitPendingWrites];
+  });
+}
+
+// ---------- COMMITTING -----------------------------------------------------------------------------------------------
+#pragma mark Committing
+
+- (void)commitPendingWrites
+{
+  NSArray * pendingWrites;
+  @synchronized (_pendingWrites)
+  {
+    pendingWrites = [_pendingWrites copy];
+    [_pendingWrites removeAllObjects];
+    _isCommitScheduled = NO;
+  }
+  
+  NSUInteger batchSize = MAX(self.batchSize, 1);
+  for (NSUInteger batchStart = 0; batchStart < pendingWrites.count; batchStart += batchSize)
+  {
+    NSRange batchRange = NSMakeRange(batchStart, MIN(batchSize, pendingWrites.count - batchStart));
+    [self commitBatch:[pendingWrites subarrayWithRange:batchRange]];
+  }
+}
+
+- (void)commitBatch:(NSArray *)batch
+{
+  // if a transaction can't be started, each write is committed on its own
+  BOOL inTransaction = [self.database beginTransaction];
+  NSMutableArray * uncommittedWrites = [[NSMutableArray alloc] initWithCapacity:batch.count];
+  
+  for (FMDBQueuedWrite * queuedWrite in batch)
+  {
+    @autoreleasepool
+    {
+      // each write has its own savepoint, so that a failed write's partial changes are undone without the others
+      BOOL hasSavepoint = (inTransaction && [self.database executeUpdate:FMDBWriteSavepointStatement]);
+      
+      NSError * error = nil;
+      queuedWrite.result = queuedWrite.write(self.database, &error);
+      if (queuedWrite.result == nil)
+      {
+        queuedWrite.error = (error ?: self.database.lastError);
+      }
+      
+      // some errors, e.g. SQLITE_FULL or RAISE(ROLLBACK), roll back the whole transaction, and the earlier writes with
+      // it, which FMDB's inTransaction doesn't reflect
+      if (inTransaction && sqlite3_get_autocommit([self.database sqliteHandle]))
+      {
+        NSError * rollbackError = (queuedWrite.error ?: self.database.lastError);
+        for (FMDBQueuedWrite * uncommittedWrite in uncommittedWrites)
+        {
+          uncommittedWrite.result = nil;
+          uncommittedWrite.error = rollbackError;
+        }
+        [uncommittedWrites removeAllObjects];
+        
+        inTransaction = [self.database beginTransaction];
+        continue;
+      }
+      
+      if (hasSavepoint)
+      {
+        if (queuedWrite.result == nil)
+        {
+          [self.database executeUpdate:FMDBWriteSavepointRollbackStatement];
+        }
+        [self.database executeUpdate:FMDBWriteSavepointReleaseStatement];
+      }
+      if (inTransaction && queuedWrite.result != nil)
+      {
+        [uncommittedWrites addObject:queuedWrite];
+      }
+    }
+  }
+  
+  if (inTransaction && NO == [self.database commit])
+  {
+    NSError * commitError = self.database.lastError;
+    [self.database rollback];
+    
+    for (FMDBQueuedWrite * uncommittedWrite in uncommittedWrites)
+    {
+      uncommittedWrite.result = nil;
+      uncommittedWrite.error = commitError;
+    }
+  }
+  
+  dispatch_async(self.completionQueue, ^{
+    for (FMDBQueuedWrite * queuedWrite in batch)
+    {
+      if (queuedWrite.completion != nil)
+      {
+        queuedWrite.completion(queuedWrite.result, queuedWrite.error);
+      }
+    }
+  });
+}
+
+@end
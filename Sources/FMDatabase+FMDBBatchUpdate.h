@@ -0,0 +1,65 @@
+#import "FMDatabase.h"
+
+/**
+ *  Describes the rows updated by `-batchUpdate:keyColumns:rows:error:`.
+ */
+@interface FMDBBatchUpdateResult : NSObject
+
+/**
+ *  The number of rows in the batch.
+ */
+@property (nonatomic, assign, readonly) NSUInteger rowCount;
+
+/**
+ *  The number of table rows changed by each chunk of the batch, as `NSNumber`s.
+ */
+@property (nonatomic, copy, readonly) NSArray * changeCounts;
+
+/**
+ *  The total number of table rows changed by the batch.
+ */
+@property (nonatomic, assign, readonly) NSUInteger changeCount;
+
+/**
+ *  The time taken to apply the batch, in seconds.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+@end
+
+@interface FMDatabase (FMDBBatchUpdate)
+
+// ========== BATCH UPDATE =============================================================================================
+#pragma mark - Batch Update
+
+/// @name Updating Many Rows
+
+/**
+ *  Updates many rows, each with its own values. Unlike `-update:values:matchingValues:error:`, which executes a
+ *  statement for each set of values, rows are applied in chunks by a single statement per chunk.
+ *
+ *  Each chunk's rows are loaded into a temporary table with one multi-row INSERT, sized to fit within the connection's
+ *  limit of bound variables (`SQLITE_LIMIT_VARIABLE_NUMBER`), and an UPDATE then sets the columns of every table row
+ *  whose key matches one of the loaded rows. A chunk only holds consecutive rows that set the same columns, so rows
+ *  may set different columns at the cost of more chunks. The statements for each chunk size are prepared once and
+ *  reused, and the temporary tables are created once per connection and named with the `fmdb_batch_update_` prefix.
+ *
+ *  When rows share a key, the later row's values are applied. Keys that are `NULL` don't match any row.
+ *
+ *  Unless a transaction is already open, the batch is applied within a transaction that is rolled back if an error
+ *  occurs. When a transaction is already open, it is left to the caller to commit or roll back.
+ *
+ *  @param  tableName       The table to update.
+ *  @param  keyColumnNames  The columns that identify the rows to update, e.g. @[ @"id" ].
+ *  @param  rows            An array of dictionaries keyed by column names. Each holds a value for every key column,
+ *                          and the new values of the columns to set. E.g. @{ @"id": @1, @"firstName": @"Grace" }.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return A description of the updated rows, or `nil` if an error occurs.
+ */
+- (FMDBBatchUpdateResult *)batchUpdate:(NSString *)tableName
+                            keyColumns:(NSArray *)keyColumnNames
+                                  rows:(NSArray *)rows
+                                 error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,387 @@
+#import "FMDatabase+FMDBBatchUpdate.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBHelpers.h"
+
+// ========== FMDBBatchUpdateResult ====================================================================================
+#pragma mark - FMDBBatchUpdateResult
+
+@interface FMDBBatchUpdateResult ()
+
+@property (nonatomic, assign, readwrite) NSUInteger rowCount;
+@property (nonatomic, copy, readwrite) NSArray * changeCounts;
+@property (nonatomic, assign, readwrite) NSTimeInterval duration;
+
+@end
+
+@implementation FMDBBatchUpdateResult
+
+- (NSUInteger)changeCount
+{
+  NSUInteger changeCount = 0;
+  for (NSNumber * chunkChangeCount in self.changeCounts)
+  {
+    changeCount += chunkChangeCount.unsignedIntegerValue;
+  }
+  return changeCount;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %lu rows, %lu changes (%lu chunks) in %.3fs>",
+          NSStringFromClass([self class]),
+          (unsigned long)self.rowCount,
+          (unsigned long)self.changeCount,
+          (unsigned long)self.changeCounts.count,
+          self.duration];
+}
+
+@end
+
+// ========== FMDatabase (FMDBBatchUpdate) =============================================================================
+#pragma mark - FMDatabase (FMDBBatchUpdate)
+
+@implementation FMDatabase (FMDBBatchUpdate)
+
+- (FMDBBatchUpdateResult *)batchUpdate:(NSString *)tableName
+                            keyColumns:(NSArray *)keyColumnNames
+                                  rows:(NSArray *)rows
+                                 error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(keyColumnNames.count > 0);
+  
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  NSMutableArray * changeCounts = [[NSMutableArray alloc] init];
+  NSMutableDictionary * statements = [[NSMutableDictionary alloc] init];
+  BOOL succeeded = YES;
+  
+  NSUInteger rowIdx = 0;
+  while (succeeded && rowIdx < rows.count)
+  {
+    @autoreleasepool
+    {
+      // a chunk is a run of rows that set the same columns, no larger than fits in a single INSERT
+      NSArray * columnNames = [FMDatabase columnNamesToBatchUpdateInRow:rows[rowIdx]
+                                                             keyColumns:keyColumnNames];
+      NSUInteger columnCount = keyColumnNames.count + columnNames.count;
+      NSUInteger rowsPerChunk = [self maximumRowsPerStatementWithColumnCount:columnCount];
+      NSUInteger chunkEndIdx = rowIdx + 1;
+      while (chunkEndIdx < rows.count && chunkEndIdx - rowIdx < rowsPerChunk)
+      {
+        NSArray * nextColumnNames = [FMDatabase columnNamesToBatchUpdateInRow:rows[chunkEndIdx]
+                                                                   keyColumns:keyColumnNames];
+        if (NO == [nextColumnNames isEqualToArray:columnNames])
+        {
+          break;
+        }
+        chunkEndIdx++;
+      }
+      
+      NSInteger changeCount = [self batchUpdate:tableName
+                                     keyColumns:keyColumnNames
+                                        columns:columnNames
+                                           rows:[rows subarrayWithRange:NSMakeRange(rowIdx, chunkEndIdx - rowIdx)]
+                                     statements:statements];
+      if (changeCount < 0)
+      {
+        succeeded = NO;
+      }
+      else
+      {
+        [changeCounts addObject:@(changeCount)];
+      }
+      rowIdx = chunkEndIdx;
+    }
+  }
+  
+  for (NSValue * statement in statements.allValues)
+  {
+    sqlite3_finalize(statement.pointerValue);
+  }
+  
+  if (NO == succeeded)
+  {
+    NSError * error = self.lastError;
+    if (ownsTransaction && self.inTransaction)
+    {
+      [self rollback];
+    }
+    if (error_p != NULL) *error_p = error;
+    return nil;
+  }
+  
+  if (ownsTransaction && NO == [self commit])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  FMDBBatchUpdateResult * result = [[FMDBBatchUpdateResult alloc] init];
+  result.rowCount = rows.count;
+  result.changeCounts = changeCounts;
+  result.duration = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  return result;
+}
+
+/**
+ *  Applies a chunk of rows that set the same columns, and returns the number of changed rows, or -1 if an error occurs.
+ */
+- (NSInteger)batchUpdate:(NSString *)tableName
+              keyColumns:(NSArray *)keyColumnNames
+                 columns:(NSArray *)columnNames
+                    rows:(NSArray *)rows
+              statements:(NSMutableDictionary *)statements
+{
+  // chunks with the same number of key and value columns share a table, which is kept for the connection's lifetime
+  NSString * chunkTableName = [NSString stringWithFormat:@"temp.fmdb_batch_update_%lu_%lu",
+                               (unsigned long)keyColumnNames.count,
+                               (unsigned long)columnNames.count];
+  
+  // preparing a CREATE TABLE, even one that does nothing, is reported as a schema change, so it's only prepared when
+  // the table is missing
+  NSString * clearSQL = [@"DELETE FROM " stringByAppendingString:chunkTableName];
+  if (statements[clearSQL] == nil && NO == [self chunkTableExists:chunkTableName])
+  {
+    NSString * createSQL = [FMDatabase statementToCreateChunkTable:chunkTableName
+                                                    keyColumnCount:keyColumnNames.count
+                                                       columnCount:columnNames.count];
+    if (NO == [self executeUpdate:createSQL
+                            error:NULL])
+    {
+      return -1;
+    }
+  }
+  
+  NSString * insertSQL = [FMDatabase statementToInsertIntoChunkTable:chunkTableName
+                                                         columnCount:(keyColumnNames.count + columnNames.count)
+                                                            rowCount:rows.count];
+  NSString * updateSQL = [FMDatabase statementToUpdate:tableName
+                                            keyColumns:keyColumnNames
+                                               columns:columnNames
+                                        fromChunkTable:chunkTableName];
+  
+  sqlite3_stmt * clearStatement = [self preparedBatchStatement:clearSQL
+                                                    statements:statements];
+  sqlite3_stmt * insertStatement = [self preparedBatchStatement:insertSQL
+                                                     statements:statements];
+  sqlite3_stmt * updateStatement = [self preparedBatchStatement:updateSQL
+                                                     statements:statements];
+  if (clearStatement == NULL || insertStatement == NULL || updateStatement == NULL)
+  {
+    return -1;
+  }
+  
+  int stepResult = sqlite3_step(clearStatement);
+  sqlite3_reset(clearStatement);
+  if (stepResult != SQLITE_DONE)
+  {
+    return -1;
+  }
+  
+  NSArray * insertedColumnNames = [keyColumnNames arrayByAddingObjectsFromArray:columnNames];
+  int parameterIdx = 1;
+  for (NSDictionary * row in rows)
+  {
+    for (NSString * columnName in insertedColumnNames)
+    {
+      NSParameterAssert(row[columnName] != nil);
+      if ([self bindValue:row[columnName] toStatement:insertStatement atIndex:parameterIdx++] != SQLITE_OK)
+      {
+        sqlite3_reset(insertStatement);
+        return -1;
+      }
+    }
+  }
+  
+  stepResult = sqlite3_step(insertStatement);
+  sqlite3_reset(insertStatement);
+  if (stepResult != SQLITE_DONE)
+  {
+    return -1;
+  }
+  
+  stepResult = sqlite3_step(updateStatement);
+  sqlite3_reset(updateStatement);
+  if (stepResult != SQLITE_DONE)
+  {
+    return -1;
+  }
+  return sqlite3_changes([self sqliteHandle]);
+}
+
+/**
+ *  Returns whether a chunk table was already created on this connection.
+ */
+- (BOOL)chunkTableExists:(NSString *)chunkTableName
+{
+  NSString * name = [chunkTableName substringFromIndex:@"temp.".length];
+  FMResultSet * resultSet = [self executeQuery:@"SELECT 1 FROM sqlite_temp_master WHERE type = 'table' AND name = ?",
+                             name];
+  BOOL exists = [resultSet next];
+  [resultSet close];
+  return exists;
+}
+
+/**
+ *  Returns a prepared statement for the SQL, preparing it the first time it's used within a batch.
+ */
+- (sqlite3_stmt *)preparedBatchStatement:(NSString *)sql
+                              statements:(NSMutableDictionary *)statements
+{
+  NSValue * preparedStatement = statements[sql];
+  if (preparedStatement != nil)
+  {
+    return preparedStatement.pointerValue;
+  }
+  
+  sqlite3_stmt * statement = NULL;
+  if (sqlite3_prepare_v2([self sqliteHandle], sql.UTF8String, -1, &statement, NULL) != SQLITE_OK)
+  {
+    sqlite3_finalize(statement);
+    return NULL;
+  }
+  statements[sql] = [NSValue valueWithPointer:statement];
+  return statement;
+}
+
+// ========== STATEMENTS ===============================================================================================
+#pragma mark - Statements
+
+/**
+ *  Returns the sorted names of the columns a row sets, which are all of its columns other than the key columns.
+ */
++ (NSArray *)columnNamesToBatchUpdateInRow:(NSDictionary *)row
+                                keyColumns:(NSArray *)keyColumnNames
+{
+  NSMutableArray * columnNames = [row.allKeys mutableCopy];
+  [columnNames removeObjectsInArray:keyColumnNames];
+  NSParameterAssert(columnNames.count > 0);
+  
+  [columnNames sortUsingSelector:@selector(compare:)];
+  return columnNames;
+}
+
++ (NSString *)keyColumnNameOfChunkTableAtIndex:(NSUInteger)columnIdx
+{
+  return [NSString stringWithFormat:@"fmdb_key_%lu", (unsigned long)columnIdx];
+}
+
++ (NSString *)valueColumnNameOfChunkTableAtIndex:(NSUInteger)columnIdx
+{
+  return [NSString stringWithFormat:@"fmdb_value_%lu", (unsigned long)columnIdx];
+}
+
++ (NSString *)statementToCreateChunkTable:(NSString *)chunkTableName
+                           keyColumnCount:(NSUInteger)keyColumnCount
+                              columnCount:(NSUInteger)columnCount
+{
+  NSMutableArray * keyColumnNames = [[NSMutableArray alloc] initWithCapacity:keyColumnCount];
+  for (NSUInteger columnIdx = 0; columnIdx < keyColumnCount; columnIdx++)
+  {
+    [keyColumnNames addObject:[self keyColumnNameOfChunkTableAtIndex:columnIdx]];
+  }
+  
+  NSMutableArray * allColumnNames = [keyColumnNames mutableCopy];
+  for (NSUInteger columnIdx = 0; columnIdx < columnCount; columnIdx++)
+  {
+    [allColumnNames addObject:[self valueColumnNameOfChunkTableAtIndex:columnIdx]];
+  }
+  
+  // the primary key indexes the update's lookups, and lets a later row with the same key replace an earlier one
+  NSMutableArray * createTable = [[NSMutableArray alloc] init];
+  [createTable addObject:@"CREATE TABLE IF NOT EXISTS"];
+  [createTable addObject:chunkTableName];
+  [createTable addObject:@"("];
+  [createTable addObject:[allColumnNames componentsJoinedByString:@", "]];
+  [createTable addObject:@", PRIMARY KEY ("];
+  [createTable addObject:[keyColumnNames componentsJoinedByString:@", "]];
+  [createTable addObject:@") )"];
+  
+  return [createTable componentsJoinedByString:@" "];
+}
+
++ (NSString *)statementToInsertIntoChunkTable:(NSString *)chunkTableName
+                                  columnCount:(NSUInteger)columnCount
+                                     rowCount:(NSUInteger)rowCount
+{
+  NSMutableArray * placeholders = [[NSMutableArray alloc] initWithCapacity:columnCount];
+  for (NSUInteger columnIdx = 0; columnIdx < columnCount; columnIdx++)
+  {
+    [placeholders addObject:@"?"];
+  }
+  NSString * tuple = [NSString stringWithFormat:@"(%@)", [placeholders componentsJoinedByString:@", "]];
+  
+  NSMutableArray * tuples = [[NSMutableArray alloc] initWithCapacity:rowCount];
+  for (NSUInteger rowIdx = 0; rowIdx < rowCount; rowIdx++)
+  {
+    [tuples addObject:tuple];
+  }
+  
+  NSMutableArray * insert = [[NSMutableArray alloc] init];
+  [insert addObject:@"INSERT OR REPLACE INTO"];
+  [insert addObject:chunkTableName];
+  [insert addObject:@"VALUES"];
+  [insert addObject:[tuples componentsJoinedByString:@", "]];
+  
+  return [insert componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns an UPDATE statement that sets each column from the row of the chunk table with the same key. sqlite has no
+ *  UPDATE ... FROM, so each column is set by a correlated subquery.
+ */
++ (NSString *)statementToUpdate:(NSString *)tableName
+                     keyColumns:(NSArray *)keyColumnNames
+                        columns:(NSArray *)columnNames
+                 fromChunkTable:(NSString *)chunkTableName
+{
+  // the chunk table's columns have names that can't be mistaken for the updated table's columns
+  NSMutableArray * keyCondition = [[NSMutableArray alloc] init];
+  [keyColumnNames enumerateObjectsUsingBlock:^(NSString * keyColumnName, NSUInteger columnIdx, BOOL *stop) {
+    if (columnIdx > 0)
+    {
+      [keyCondition addObject:@"AND"];
+    }
+    
+    [keyCondition addObject:[self keyColumnNameOfChunkTableAtIndex:columnIdx]];
+    [keyCondition addObject:@"="];
+    [keyCondition addObject:[FMDatabase escapeIdentifier:keyColumnName]];
+  }];
+  NSString * keyConditionSQL = [keyCondition componentsJoinedByString:@" "];
+  
+  NSMutableArray * expressions = [[NSMutableArray alloc] initWithCapacity:columnNames.count];
+  for (NSUInteger columnIdx = 0; columnIdx < columnNames.count; columnIdx++)
+  {
+    [expressions addObject:[NSString stringWithFormat:@"(SELECT %@ FROM %@ WHERE %@)",
+                            [self valueColumnNameOfChunkTableAtIndex:columnIdx],
+                            chunkTableName,
+                            keyConditionSQL]];
+  }
+  
+  NSString * where = nil;
+  if (keyColumnNames.count == 1)
+  {
+    where = [NSString stringWithFormat:@"%@ IN (SELECT %@ FROM %@)",
+             [FMDatabase escapeIdentifier:keyColumnNames[0]],
+             [self keyColumnNameOfChunkTableAtIndex:0],
+             chunkTableName];
+  }
+  else
+  {
+    where = [NSString stringWithFormat:@"EXISTS (SELECT 1 FROM %@ WHERE %@)", chunkTableName, keyConditionSQL];
+  }
+  
+  return [FMDatabase statementToUpdate:tableName
+                               columns:columnNames
+                           expressions:expressions
+                                 where:where];
+}
+
+@end
@@ -0,0 +1,187 @@
+#import "FMDatabase.h"
+
+/**
+ *  A handle to a single blob value, read and written in place with sqlite's incremental blob I/O, so that large values
+ *  needn't be copied into memory whole.
+ *
+ *  A blob is read and written from its `offset`, like a stream, or at explicit offsets. Its length is fixed when it is
+ *  opened: writes can't grow it, so reserve space first, e.g. with
+ *  `-insertInto:row:reservingBlobOfLength:inColumn:error:`.
+ *
+ *  If the row is changed or deleted while the blob is open, other than through the blob itself, the handle expires
+ *  and reads and writes fail with `SQLITE_ABORT`. Like the database it belongs to, a blob must only be used on one
+ *  thread at a time. It is closed when it is released, but should be closed before its database is.
+ */
+@interface FMDBBlob : NSObject
+
+@property (nonatomic, strong, readonly) FMDatabase * database;
+@property (nonatomic, copy, readonly) NSString * tableName;
+@property (nonatomic, copy, readonly) NSString * columnName;
+@property (nonatomic, assign, readonly) int64_t rowId;
+@property (nonatomic, assign, readonly, getter = isWritable) BOOL writable;
+
+/**
+ *  The length of the blob in bytes, or 0 once it has been closed.
+ */
+@property (nonatomic, assign, readonly) NSUInteger length;
+
+/**
+ *  The position of the next `-read:maxLength:error:` or `-write:length:error:`. Starts at 0.
+ */
+@property (nonatomic, assign) NSUInteger offset;
+
+// ========== STREAMING ================================================================================================
+#pragma mark - Streaming
+
+/// @name Streaming
+
+/**
+ *  Reads up to `maxLength` bytes from `offset`, and advances `offset` past them.
+ *
+ *  @return The number of bytes read, 0 at the end of the blob, or -1 if an error occurs.
+ */
+- (NSInteger)read:(void *)buffer
+        maxLength:(NSUInteger)maxLength
+            error:(NSError **)error_p;
+
+/**
+ *  Writes bytes at `offset`, and advances `offset` past them.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs, including if the bytes don't fit within `length`.
+ */
+- (BOOL)write:(const void *)bytes
+       length:(NSUInteger)length
+        error:(NSError **)error_p;
+
+/**
+ *  Reads from `offset` to the end of the blob, a buffer at a time, writing each buffer to an open stream. Blocks
+ *  until the stream has accepted all bytes.
+ *
+ *  @return The number of bytes copied, or -1 if an error occurs.
+ */
+- (NSInteger)writeToOutputStream:(NSOutputStream *)outputStream
+                           error:(NSError **)error_p;
+
+/**
+ *  Reads an open stream until it ends, a buffer at a time, writing its bytes from `offset`.
+ *
+ *  @return The number of bytes copied, or -1 if an error occurs, including if the stream is longer than the rest of
+ *          the blob.
+ */
+- (NSInteger)readFromInputStream:(NSInputStream *)inputStream
+                           error:(NSError **)error_p;
+
+// ========== RANDOM ACCESS ============================================================================================
+#pragma mark - Random Access
+
+/// @name Random Access
+
+/**
+ *  Reads `length` bytes from an offset, without changing `offset`.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs, including if the bytes are beyond the end of the blob.
+ */
+- (BOOL)readBytes:(void *)buffer
+           length:(NSUInteger)length
+         atOffset:(NSUInteger)offset
+            error:(NSError **)error_p;
+
+/**
+ *  Writes bytes at an offset, without changing `offset`.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs, including if the bytes don't fit within `length`.
+ */
+- (BOOL)writeBytes:(const void *)bytes
+            length:(NSUInteger)length
+          atOffset:(NSUInteger)offset
+             error:(NSError **)error_p;
+
+/**
+ *  Moves the handle to the same column of another row, which is faster than opening a new blob. `offset` is reset to
+ *  0. If an error occurs, e.g. the row doesn't exist, the blob is closed.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs.
+ */
+- (BOOL)reopenWithRowId:(int64_t)rowId
+                  error:(NSError **)error_p;
+
+/**
+ *  Closes the handle. Reads and writes fail afterwards.
+ */
+- (void)close;
+
+@end
+
+@interface FMDatabase (FMDBBlobs)
+
+// ========== OPENING ==================================================================================================
+#pragma mark - Opening
+
+/// @name Opening Blobs
+
+/**
+ *  Opens the value of a column of a row for incremental reading, and writing if `writable`.
+ *
+ *  The value must be a blob or text. Columns that are indexed, or part of a foreign key, can't be opened for writing.
+ *
+ *  @param  tableName   The table containing the row, in the main database.
+ *  @param  columnName  The column to open.
+ *  @param  rowId       The rowid of the row.
+ *  @param  writable    Whether the blob can be written.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return The open blob, or `nil` if an error occurs.
+ */
+- (FMDBBlob *)openBlobIn:(NSString *)tableName
+                  column:(NSString *)columnName
+                   rowId:(int64_t)rowId
+                writable:(BOOL)writable
+                   error:(NSError **)error_p;
+
+// ========== INSERTING ================================================================================================
+#pragma mark - Inserting
+
+/// @name Inserting Blobs
+
+/**
+ *  Inserts a row whose blob column is filled with `length` zero bytes by `zeroblob()`, without creating the bytes in
+ *  memory. Open the blob to write its contents a chunk at a time.
+ *
+ *  @param  tableName   The table into which the row is inserted.
+ *  @param  rowValues   The values of the row's other columns, as for `-insertInto:row:error:`.
+ *  @param  length      The length of the blob to reserve.
+ *  @param  columnName  The blob column.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return The rowid of the inserted row, or `nil` if an error occurs.
+ */
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+   reservingBlobOfLength:(NSUInteger)length
+                inColumn:(NSString *)columnName
+                   error:(NSError **)error_p;
+
+/**
+ *  Inserts a row whose blob column is read from a stream, without holding the blob in memory: the blob is reserved by
+ *  `-insertInto:row:reservingBlobOfLength:inColumn:error:`, then written a buffer at a time.
+ *
+ *  Unless a transaction is already open, the row is inserted within a transaction, which is rolled back if an error
+ *  occurs, including if the stream's length doesn't match `length`.
+ *
+ *  @param  tableName     The table into which the row is inserted.
+ *  @param  rowValues     The values of the row's other columns.
+ *  @param  columnName    The blob column.
+ *  @param  inputStream   An open stream of exactly `length` bytes.
+ *  @param  length        The length of the stream.
+ *  @param  error_p       A pointer to any error that occurs.
+ *
+ *  @return The rowid of the inserted row, or `nil` if an error occurs.
+ */
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+              blobColumn:(NSString *)columnName
+         fromInputStream:(NSInputStream *)inputStream
+                  length:(NSUInteger)length
+                   error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,410 @@
+#import "FMDatabase+FMDBBlobs.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBResultCache.h"
+
+static const NSUInteger FMDBBlobBufferSize = 64 * 1024;
+
+static NSError * FMDBBlobError(int code, NSString * description)
+{
+  return [NSError errorWithDomain:@"FMDatabase"
+                             code:code
+                         userInfo:@{ NSLocalizedDescriptionKey: description }];
+}
+
+// ========== FMDBBlob =================================================================================================
+#pragma mark - FMDBBlob
+
+@interface FMDBBlob ()
+
+@property (nonatomic, strong, readwrite) FMDatabase * database;
+@property (nonatomic, copy, readwrite) NSString * tableName;
+@property (nonatomic, copy, readwrite) NSString * columnName;
+@property (nonatomic, assign, readwrite) int64_t rowId;
+@property (nonatomic, assign, readwrite, getter = isWritable) BOOL writable;
+
+@end
+
+@implementation FMDBBlob
+{
+  sqlite3_blob * _blob;
+}
+
+- (instancetype)initWithDatabase:(FMDatabase *)database
+                       tableName:(NSString *)tableName
+                      columnName:(NSString *)columnName
+                           rowId:(int64_t)rowId
+                        writable:(BOOL)writable
+                            blob:(sqlite3_blob *)blob
+{
+  self = [super init];
+  if (self)
+  {
+    _database = database;
+    _tableName = [tableName copy];
+    _columnName = [columnName copy];
+    _rowId = rowId;
+    _writable = writable;
+    _blob = blob;
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [self close];
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %p %@.%@ rowid %lld, %lu bytes%@>",
+          self.class,
+          self,
+          self.tableName,
+          self.columnName,
+          self.rowId,
+          (unsigned long)self.length,
+          (self.isWritable ? @", writable" : @"")];
+}
+
+- (NSUInteger)length
+{
+  return (_blob != NULL ? (NSUInteger)sqlite3_blob_bytes(_blob) : 0);
+}
+
+- (void)close
+{
+  if (_blob != NULL)
+  {
+    sqlite3_blob_close(_blob);
+    _blob = NULL;
+  }
+}
+
+- (BOOL)reopenWithRowId:(int64_t)rowId
+                  error:(NSError **)error_p
+{
+  if (_blob == NULL)
+  {
+    if (error_p != NULL) *error_p = FMDBBlobError(SQLITE_MISUSE, @"The blob has been closed");
+    return NO;
+  }
+  
+  if (sqlite3_blob_reopen(_blob, rowId) != SQLITE_OK)
+  {
+    // a blob that fails to move can't be used again
+    if (error_p != NULL) *error_p = self.database.lastError;
+    [self close];
+    return NO;
+  }
+  
+  self.rowId = rowId;
+  self.offset = 0;
+  return YES;
+}
+
+// ========== RANDOM ACCESS ============================================================================================
+#pragma mark - Random Access
+
+- (BOOL)checkRangeWithLength:(NSUInteger)length
+                    atOffset:(NSUInteger)offset
+                       error:(NSError **)error_p
+{
+  if (_blob == NULL)
+  {
+    if (error_p != NULL) *error_p = FMDBBlobError(SQLITE_MISUSE, @"The blob has been closed");
+    return NO;
+  }
+  
+  NSUInteger blobLength = self.length;
+  if (offset > blobLength || length > blobLength - offset)
+  {
+    if (error_p != NULL)
+    {
+      NSString * description = [NSString stringWithFormat:@"%lu bytes at offset %lu are beyond the end of the blob",
+                                (unsigned long)length,
+                                (unsigned long)offset];
+      *error_p = FMDBBlobError(SQLITE_RANGE, description);
+    }
+    return NO;
+  }
+  return YES;
+}
+
+- (BOOL)readBytes:(void *)buffer
+           length:(NSUInteger)length
+         atOffset:(NSUInteger)offset
+            error:(NSError **)error_p
+{
+  if (NO == [self checkRangeWithLength:length atOffset:offset error:error_p])
+  {
+    return NO;
+  }
+  
+  if (sqlite3_blob_read(_blob, buffer, (int)length, (int)offset) != SQLITE_OK)
+  {
+    if (error_p != NULL) *error_p = self.database.lastError;
+    return NO;
+  }
+  return YES;
+}
+
+- (BOOL)writeBytes:(const void *)bytes
+            length:(NSUInteger)length
+          atOffset:(NSUInteger)offset
+             error:(NSError **)error_p
+{
+  if (NO == [self checkRangeWithLength:length atOffset:offset error:error_p])
+  {
+    return NO;
+  }
+  
+  if (sqlite3_blob_write(_blob, bytes, (int)length, (int)offset) != SQLITE_OK)
+  {
+    if (error_p != NULL) *error_p = self.database.lastError;
+    return NO;
+  }
+  
+  // blob writes aren't reported to the update hook
+  [self.database invalidateResultCacheForTable:self.tableName];
+  return YES;
+}
+
+// ========== STREAMING ================================================================================================
+#pragma mark - Streaming
+
+- (NSInteger)read:(void *)buffer
+        maxLength:(NSUInteger)maxLength
+            error:(NSError **)error_p
+{
+  NSUInteger length = MIN(maxLength, self.length - MIN(self.offset, self.length));
+  if (NO == [self readBytes:buffer length:length atOffset:self.offset error:error_p])
+  {
+    return -1;
+  }
+  
+  self.offset += length;
+  return (NSInteger)length;
+}
+
+- (BOOL)write:(const void *)bytes
+       length:(NSUInteger)length
+        error:(NSError **)error_p
+{
+  if (NO == [self writeBytes:bytes length:length atOffset:self.offset error:error_p])
+  {
+    return NO;
+  }
+  
+  self.offset += length;
+  return YES;
+}
+
+- (NSInteger)writeToOutputStream:(NSOutputStream *)outputStream
+                           error:(NSError **)error_p
+{
+  NSParameterAssert(outputStream != nil);
+  
+  uint8_t * buffer = malloc(FMDBBlobBufferSize);
+  NSInteger copiedLength = 0;
+  NSInteger readLength;
+  while ((readLength = [self read:buffer maxLength:FMDBBlobBufferSize error:error_p]) > 0)
+  {
+    NSInteger writtenLength = 0;
+    while (writtenLength < readLength)
+    {
+      NSInteger length = [outputStream write:buffer + writtenLength
+                                   maxLength:(NSUInteger)(readLength - writtenLength)];
+      if (length <= 0)
+      {
+        if (error_p != NULL)
+        {
+          *error_p = outputStream.streamError ?: FMDBBlobError(SQLITE_FULL, @"The output stream is full");
+        }
+        free(buffer);
+        return -1;
+      }
+      writtenLength += length;
+    }
+    copiedLength += readLength;
+  }
+  free(buffer);
+  
+  return (readLength < 0 ? -1 : copiedLength);
+}
+
+- (NSInteger)readFromInputStream:(NSInputStream *)inputStream
+                           error:(NSError **)error_p
+{
+  NSParameterAssert(inputStream != nil);
+  
+  uint8_t * buffer = malloc(FMDBBlobBufferSize);
+  NSInteger copiedLength = 0;
+  NSInteger readLength;
+  while ((readLength = [inputStream read:buffer maxLength:FMDBBlobBufferSize]) > 0)
+  {
+    if (NO == [self write:buffer length:(NSUInteger)readLength error:error_p])
+    {
+      free(buffer);
+      return -1;
+    }
+    copiedLength += readLength;
+  }
+  free(buffer);
+  
+  if (readLength < 0)
+  {
+    if (error_p != NULL) *error_p = inputStream.streamError;
+    return -1;
+  }
+  return copiedLength;
+}
+
+@end
+
+// ========== FMDatabase (FMDBBlobs) ===================================================================================
+#pragma mark - FMDatabase (FMDBBlobs)
+
+@implementation FMDatabase (FMDBBlobs)
+
+- (FMDBBlob *)openBlobIn:(NSString *)tableName
+                  column:(NSString *)columnName
+                   rowId:(int64_t)rowId
+                writable:(BOOL)writable
+                   error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(columnName != nil);
+  
+  sqlite3_blob * blob = NULL;
+  if (sqlite3_blob_open([self sqliteHandle],
+                        "main",
+                        tableName.UTF8String,
+                        columnName.UTF8String,
+                        rowId,
+                        (writable ? 1 : 0),
+                        &blob) != SQLITE_OK)
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    sqlite3_blob_close(blob);
+    return nil;
+  }
+  
+  return [[FMDBBlob alloc] initWithDatabase:self
+                                  tableName:tableName
+                                 columnName:columnName
+                                      rowId:rowId
+                                   writable:writable
+                                       blob:blob];
+}
+
+// ========== INSERTING ================================================================================================
+#pragma mark - Inserting
+
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+   reservingBlobOfLength:(NSUInteger)length
+                inColumn:(NSString *)columnName
+                   error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(columnName != nil);
+  NSParameterAssert(rowValues[columnName] == nil);
+  NSParameterAssert(length <= INT_MAX);
+  
+  // columns are sorted so that rows with the same keys share a statement
+  NSArray * columnNames = [rowValues.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  NSMutableArray * values = [[NSMutableArray alloc] initWithCapacity:columnNames.count + 1];
+  NSMutableArray * insertSQL = [[NSMutableArray alloc] init];
+  [insertSQL addObject:@"INSERT INTO"];
+  [insertSQL addObject:tableName];
+  [insertSQL addObject:@"("];
+  for (NSString * name in columnNames)
+  {
+    [insertSQL addObject:[FMDatabase escapeIdentifier:name]];
+    [insertSQL addObject:@","];
+    [values addObject:rowValues[name]];
+  }
+  [insertSQL addObject:[FMDatabase escapeIdentifier:columnName]];
+  [insertSQL addObject:@") VALUES ("];
+  for (NSUInteger valueIdx = 0; valueIdx < columnNames.count; valueIdx++)
+  {
+    [insertSQL addObject:@"?,"];
+  }
+  [insertSQL addObject:@"zeroblob(?) )"];
+  [values addObject:@(length)];
+  
+  if (NO == [self executeUpdate:[insertSQL componentsJoinedByString:@" "]
+           withArgumentsInArray:values
+                          error:error_p])
+  {
+    return nil;
+  }
+  return @(self.lastInsertRowId);
+}
+
+- (NSNumber *)insertInto:(NSString *)tableName
+                     row:(NSDictionary *)rowValues
+              blobColumn:(NSString *)columnName
+         fromInputStream:(NSInputStream *)inputStream
+                  length:(NSUInteger)length
+                   error:(NSError **)error_p
+{
+  NSParameterAssert(inputStream != nil);
+  
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  NSError * error = nil;
+  NSNumber * rowId = [self insertInto:tableName
+                                  row:rowValues
+                reservingBlobOfLength:length
+                             inColumn:columnName
+                                error:&error];
+  
+  FMDBBlob * blob = nil;
+  if (rowId != nil)
+  {
+    blob = [self openBlobIn:tableName
+                     column:columnName
+                      rowId:rowId.longLongValue
+                   writable:YES
+                      error:&error];
+  }
+  
+  if (blob != nil)
+  {
+    NSInteger copiedLength = [blob readFromInputStream:inputStream error:&error];
+    [blob close];
+    
+    if (copiedLength >= 0 && (NSUInteger)copiedLength != length)
+    {
+      NSString * description = [NSString stringWithFormat:@"The stream has %ld bytes, rather than %lu",
+                                (long)copiedLength,
+                                (unsigned long)length];
+      error = FMDBBlobError(SQLITE_MISMATCH, description);
+    }
+  }
+  
+  if (error != nil)
+  {
+    if (ownsTransaction && self.inTransaction)
+    {
+      [self rollback];
+    }
+    if (error_p != NULL) *error_p = error;
+    return nil;
+  }
+  
+  if (ownsTransaction && NO == [self commit])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  return rowId;
+}
+
+@end
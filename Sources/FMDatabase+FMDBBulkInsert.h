@@ -0,0 +1,101 @@
+#import "FMDatabase.h"
+
+/**
+ *  Describes the rows inserted by `-bulkInsertInto:columns:rowsFromBlock:commitInterval:error:`.
+ */
+@interface FMDBBulkInsertResult : NSObject
+
+/**
+ *  The number of rows that were inserted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger rowCount;
+
+/**
+ *  The rowid of the last inserted row, as returned by `-lastInsertRowId`, or 0 if no rows were inserted. Rows inserted
+ *  earlier don't necessarily have consecutive rowids, e.g. when they set an `INTEGER PRIMARY KEY` themselves, and
+ *  tables created `WITHOUT ROWID` don't have rowids at all.
+ */
+@property (nonatomic, assign, readonly) int64_t lastRowId;
+
+/**
+ *  The time taken to insert all rows, in seconds.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+/**
+ *  The number of rows inserted per second.
+ */
+@property (nonatomic, assign, readonly) double rowsPerSecond;
+
+@end
+
+@interface FMDatabase (FMDBBulkInsert)
+
+// ========== BULK INSERT ==============================================================================================
+#pragma mark - Bulk Insert
+
+/// @name Inserting Many Rows
+
+/**
+ *  Inserts rows read from an enumerator. See `-bulkInsertInto:columns:rowsFromBlock:commitInterval:error:`.
+ */
+- (FMDBBulkInsertResult *)bulkInsertInto:(NSString *)tableName
+                                 columns:(NSArray *)columnNames
+                      rowsFromEnumerator:(NSEnumerator *)rowEnumerator
+                          commitInterval:(NSUInteger)commitInterval
+                                   error:(NSError **)error_p;
+
+/**
+ *  Inserts rows produced by a block, until the block returns `nil`. Unlike `-insertInto:columns:values:error:`, rows
+ *  don't need to be held in memory at once.
+ *
+ *  Rows are inserted in batches of multi-row INSERT statements, each sized to fit within the connection's limit of
+ *  bound variables (`SQLITE_LIMIT_VARIABLE_NUMBER`). The statement for each batch size is prepared once and reused.
+ *
+ *  Unless a transaction is already open, the rows are inserted within a transaction that is committed every
+ *  `commitInterval` rows. If an error occurs that transaction is rolled back, but rows committed earlier remain. When a
+ *  transaction is already open, it is left to the caller to commit or roll back.
+ *
+ *  @param  tableName       The table into which data will be inserted.
+ *  @param  columnNames     The names of the columns that will be inserted.
+ *  @param  nextRow         Returns an array of values matching `columnNames` for the next row, or `nil` when there are
+ *                          no more rows.
+ *  @param  commitInterval  The number of rows to insert per transaction. 0 inserts all rows in a single transaction.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return A description of the inserted rows, or `nil` if an error occurs.
+ */
+- (FMDBBulkInsertResult *)bulkInsertInto:(NSString *)tableName
+                                 columns:(NSArray *)columnNames
+                           rowsFromBlock:(NSArray * (^)(void))nextRow
+                          commitInterval:(NSUInteger)commitInterval
+                                   error:(NSError **)error_p;
+
+/**
+ *  The maximum number of rows that fit in a single statement with the given number of columns, based on the
+ *  connection's limit of bound variables, and before sqlite 3.8.8, its limit of terms in a compound SELECT (500 by
+ *  default), which also applies to the rows of a VALUES clause.
+ */
+- (NSUInteger)maximumRowsPerStatementWithColumnCount:(NSUInteger)columnCount;
+
+// ========== BINDING ==================================================================================================
+#pragma mark - Binding
+
+/// @name Binding Values
+
+/**
+ *  Binds a value to a prepared statement, the same way FMDB binds arguments. `nil` and `NSNull` are bound as NULL,
+ *  `NSData` as a blob, `NSDate` as a timestamp (or a string, if the database has a date formatter), `NSNumber` as an
+ *  integer or real, and anything else as text.
+ *
+ *  @param  value       The value to bind.
+ *  @param  statement   The prepared statement.
+ *  @param  idx         The 1-based index of the parameter to bind.
+ *
+ *  @return The sqlite result code.
+ */
+- (int)bindValue:(id)value
+     toStatement:(sqlite3_stmt *)statement
+         atIndex:(int)idx;
+
+@end
@@ -0,0 +1,287 @@
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBHelpers.h"
+
+// ========== FMDBBulkInsertResult =====================================================================================
+#pragma mark - FMDBBulkInsertResult
+
+@interface FMDBBulkInsertResult ()
+
+@property (nonatomic, assign, readwrite) NSUInteger rowCount;
+@property (nonatomic, assign, readwrite) int64_t lastRowId;
+@property (nonatomic, assign, readwrite) NSTimeInterval duration;
+
+@end
+
+@implementation FMDBBulkInsertResult
+
+- (double)rowsPerSecond
+{
+  if (self.duration <= 0)
+  {
+    return 0;
+  }
+  return self.rowCount / self.duration;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %lu rows (last %lld) in %.3fs, %.0f rows/sec>",
+          NSStringFromClass([self class]),
+          (unsigned long)self.rowCount,
+          self.lastRowId,
+          self.duration,
+          self.rowsPerSecond];
+}
+
+@end
+
+// ========== FMDatabase (FMDBBulkInsert) ==============================================================================
+#pragma mark - FMDatabase (FMDBBulkInsert)
+
+@implementation FMDatabase (FMDBBulkInsert)
+
+- (FMDBBulkInsertResult *)bulkInsertInto:(NSString *)tableName
+                                 columns:(NSArray *)columnNames
+                      rowsFromEnumerator:(NSEnumerator *)rowEnumerator
+                          commitInterval:(NSUInteger)commitInterval
+                                   error:(NSError **)error_p
+{
+  return [self bulkInsertInto:tableName
+                      columns:columnNames
+                rowsFromBlock:^NSArray *{
+                  return [rowEnumerator nextObject];
+                }
+               commitInterval:commitInterval
+                        error:error_p];
+}
+
+- (FMDBBulkInsertResult *)bulkInsertInto:(NSString *)tableName
+                                 columns:(NSArray *)columnNames
+                           rowsFromBlock:(NSArray * (^)(void))nextRow
+                          commitInterval:(NSUInteger)commitInterval
+                                   error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(columnNames.count > 0);
+  NSParameterAssert(nextRow != nil);
+  
+  NSUInteger rowsPerStatement = [self maximumRowsPerStatementWithColumnCount:columnNames.count];
+  if (commitInterval > 0)
+  {
+    // keep batches from straddling transactions
+    rowsPerStatement = MIN(rowsPerStatement, commitInterval);
+  }
+  
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  FMDBBulkInsertResult * result = [[FMDBBulkInsertResult alloc] init];
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  
+  NSMutableArray * batch = [[NSMutableArray alloc] initWithCapacity:rowsPerStatement];
+  sqlite3_stmt * batchStatement = NULL;
+  NSUInteger rowsSinceCommit = 0;
+  BOOL succeeded = YES;
+  BOOL finished = NO;
+  
+  while (succeeded && NO == finished)
+  {
+    @autoreleasepool
+    {
+      NSArray * row = nextRow();
+      if (row != nil)
+      {
+        NSParameterAssert(row.count == columnNames.count);
+        [batch addObject:row];
+      }
+      else
+      {
+        finished = YES;
+      }
+      
+      if (batch.count == rowsPerStatement || (finished && batch.count > 0))
+      {
+        if (batch.count == rowsPerStatement)
+        {
+          if (batchStatement == NULL)
+          {
+            batchStatement = [self prepareInsertInto:tableName
+                                             columns:columnNames
+                                            rowCount:rowsPerStatement];
+          }
+          succeeded = [self insertBatch:batch
+                          withStatement:batchStatement
+                                 result:result];
+        }
+        else
+        {
+          // the final, partial batch is the only one of its size
+          sqlite3_stmt * finalStatement = [self prepareInsertInto:tableName
+                                                          columns:columnNames
+                                                         rowCount:batch.count];
+          succeeded = [self insertBatch:batch
+                          withStatement:finalStatement
+                                 result:result];
+          sqlite3_finalize(finalStatement);
+        }
+        
+        rowsSinceCommit += batch.count;
+        [batch removeAllObjects];
+        
+        if (succeeded && ownsTransaction && commitInterval > 0 && rowsSinceCommit >= commitInterval && NO == finished)
+        {
+          succeeded = [self commit] && [self beginTransaction];
+          rowsSinceCommit = 0;
+        }
+      }
+    }
+  }
+  
+  if (batchStatement != NULL)
+  {
+    sqlite3_finalize(batchStatement);
+  }
+  
+  if (NO == succeeded)
+  {
+    NSError * error = self.lastError;
+    if (ownsTransaction && self.inTransaction)
+    {
+      [self rollback];
+    }
+    if (error_p != NULL) *error_p = error;
+    return nil;
+  }
+  
+  if (ownsTransaction && NO == [self commit])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  result.duration = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  return result;
+}
+
+- (NSUInteger)maximumRowsPerStatementWithColumnCount:(NSUInteger)columnCount
+{
+  NSParameterAssert(columnCount > 0);
+  
+  int variableLimit = sqlite3_limit([self sqliteHandle], SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+  NSUInteger rowCount = MAX((NSUInteger)1, (NSUInteger)variableLimit / columnCount);
+  
+  // before sqlite 3.8.8, each row of a multi-row VALUES clause counts as a term of a compound SELECT
+  if (sqlite3_libversion_number() < 3008008)
+  {
+    int compoundSelectLimit = sqlite3_limit([self sqliteHandle], SQLITE_LIMIT_COMPOUND_SELECT, -1);
+    rowCount = MIN(rowCount, (NSUInteger)MAX(compoundSelectLimit, 1));
+  }
+  return rowCount;
+}
+
+- (sqlite3_stmt *)prepareInsertInto:(NSString *)tableName
+                            columns:(NSArray *)columnNames
+                           rowCount:(NSUInteger)rowCount
+{
+  NSString * insertSQL = [FMDatabase statementToInsertInto:tableName
+                                                   columns:columnNames
+                                                  rowCount:rowCount];
+  
+  sqlite3_stmt * statement = NULL;
+  if (sqlite3_prepare_v2([self sqliteHandle], insertSQL.UTF8String, -1, &statement, NULL) != SQLITE_OK)
+  {
+    sqlite3_finalize(statement);
+    return NULL;
+  }
+  return statement;
+}
+
+- (BOOL)insertBatch:(NSArray *)rows
+      withStatement:(sqlite3_stmt *)statement
+             result:(FMDBBulkInsertResult *)result
+{
+  if (statement == NULL)
+  {
+    return NO;
+  }
+  
+  int parameterIdx = 1;
+  for (NSArray * row in rows)
+  {
+    for (id value in row)
+    {
+      if ([self bindValue:value toStatement:statement atIndex:parameterIdx++] != SQLITE_OK)
+      {
+        sqlite3_reset(statement);
+        return NO;
+      }
+    }
+  }
+  
+  int stepResult = sqlite3_step(statement);
+  sqlite3_reset(statement);
+  if (stepResult != SQLITE_DONE)
+  {
+    return NO;
+  }
+  
+  result.lastRowId = sqlite3_last_insert_rowid([self sqliteHandle]);
+  result.rowCount += rows.count;
+  return YES;
+}
+
+// ========== BINDING ==================================================================================================
+#pragma mark - Binding
+
+- (int)bindValue:(id)value
+     toStatement:(sqlite3_stmt *)statement
+         atIndex:(int)idx
+{
+  if (value == nil || value == [NSNull null])
+  {
+    return sqlite3_bind_null(statement, idx);
+  }
+  else if ([value isKindOfClass:[NSData class]])
+  {
+    const void * bytes = [value bytes];
+    if (bytes == NULL)
+    {
+      // an empty blob, rather than NULL
+      bytes = "";
+    }
+    return sqlite3_bind_blob(statement, idx, bytes, (int)[value length], SQLITE_TRANSIENT);
+  }
+  else if ([value isKindOfClass:[NSDate class]])
+  {
+    if ([self hasDateFormatter])
+    {
+      return sqlite3_bind_text(statement, idx, [[self stringFromDate:value] UTF8String], -1, SQLITE_TRANSIENT);
+    }
+    return sqlite3_bind_double(statement, idx, [value timeIntervalSince1970]);
+  }
+  else if ([value isKindOfClass:[NSNumber class]])
+  {
+    switch ([value objCType][0])
+    {
+      case 'f':
+      case 'd':
+        return sqlite3_bind_double(statement, idx, [value doubleValue]);
+      
+      case 'Q':
+        return sqlite3_bind_int64(statement, idx, (sqlite3_int64)[value unsignedLongLongValue]);
+      
+      default:
+        return sqlite3_bind_int64(statement, idx, [value longLongValue]);
+    }
+  }
+  else
+  {
+    return sqlite3_bind_text(statement, idx, [[value description] UTF8String], -1, SQLITE_TRANSIENT);
+  }
+}
+
+@end
@@ -0,0 +1,135 @@
+#import "FMDatabase.h"
+
+/**
+ *  How `-[FMDatabase applyChangeset:conflictPolicy:error:]` treats a change to a row that has also been changed
+ *  locally, i.e. a row of a tracked table whose local changes haven't been discarded.
+ */
+typedef NS_ENUM(NSInteger, FMDBChangesetConflictPolicy)
+{
+  /**
+   *  The changeset's change replaces the local change.
+   */
+  FMDBChangesetConflictPolicyReplace,
+  /**
+   *  The local change is kept, and the changeset's change to the row is skipped.
+   */
+  FMDBChangesetConflictPolicyIgnore,
+  /**
+   *  The whole changeset is rolled back, and an error with the code `SQLITE_ABORT` is returned.
+   */
+  FMDBChangesetConflictPolicyAbort,
+};
+
+@interface FMDatabase (FMDBChangesets)
+
+// ========== CHANGE TRACKING ==========================================================================================
+#pragma mark - Change Tracking
+
+/// @name Tracking Changes
+
+/**
+ *  Starts recording which rows of a table are inserted, updated, or deleted, so that changesets of the table only
+ *  contain the rows changed since a given change number, rather than the whole table.
+ *
+ *  Changes are recorded by triggers on the table, in a log table with one row per changed primary key, so they are
+ *  recorded however the table is changed, and the log grows with the number of changed rows rather than the number of
+ *  changes. Each change takes the next change number, which is shared by all tracked tables. Rows that exist when
+ *  tracking starts aren't recorded, so a replica starts from a copy of the database taken along with
+ *  `-currentChangeNumber`. Tracking a table again discards its recorded changes.
+ *
+ *  The table must have a primary key, whose values must not be NULL. Rows deleted by `INSERT OR REPLACE` are only
+ *  recorded when `PRAGMA recursive_triggers` is enabled, as sqlite doesn't otherwise fire delete triggers for them.
+ *
+ *  @param  tableName       The table to track.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)trackChangesToTable:(NSString *)tableName
+                      error:(NSError **)error_p;
+
+/**
+ *  Stops recording changes to a table, dropping its triggers and its log of changed rows.
+ *
+ *  @param  tableName       The tracked table.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)stopTrackingChangesToTable:(NSString *)tableName
+                             error:(NSError **)error_p;
+
+/**
+ *  Returns whether changes to a table are recorded.
+ */
+- (BOOL)isTrackingChangesToTable:(NSString *)tableName;
+
+/**
+ *  Returns the number of the latest recorded change to any tracked table, or 0 if no change has been recorded.
+ */
+- (int64_t)currentChangeNumber;
+
+/**
+ *  Discards the recorded changes to all tracked tables up to and including a change number, e.g. once every replica
+ *  has applied a changeset through it. Discarded changes are no longer included in changesets, and no longer conflict
+ *  with changesets applied to this database.
+ *
+ *  @param  changeNumber    The number of the last change to discard.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)discardChangesThroughChangeNumber:(int64_t)changeNumber
+                                    error:(NSError **)error_p;
+
+// ========== CHANGESETS ===============================================================================================
+#pragma mark - Changesets
+
+/// @name Creating and Applying Changesets
+
+/**
+ *  Returns a changeset of the rows of tracked tables changed after a change number, and up to the current change
+ *  number, which is returned so that it can be passed as `changeNumber` for the next changeset.
+ *
+ *  A changeset holds the current values of each inserted or updated row, and the primary key of each deleted row, in a
+ *  compact binary format: each value is written as a type tag followed by a variable-length integer, an 8-byte real,
+ *  or length-prefixed bytes. A row changed several times is only included once, so the size of a changeset grows with
+ *  the number of changed rows, however many times they changed. Changed rows are found through the log's index on
+ *  change numbers, and read by primary key, without scanning the tables.
+ *
+ *  Rows are read within a transaction, unless one is already open, so that the changeset is consistent with the
+ *  returned change number.
+ *
+ *  @param  tableNames          The tracked tables whose changes to include.
+ *  @param  changeNumber        The number of the last change already applied, e.g. the change number returned with
+ *                              the previous changeset, or 0 for every recorded change.
+ *  @param  lastChangeNumber_p  Returns the number of the last change included. May be `NULL`.
+ *  @param  error_p             A pointer to any error that occurs.
+ *
+ *  @return The changeset, or `nil` if an error occurs, e.g. if a table isn't tracked.
+ */
+- (NSData *)changesetOfTables:(NSArray *)tableNames
+            sinceChangeNumber:(int64_t)changeNumber
+             lastChangeNumber:(int64_t *)lastChangeNumber_p
+                        error:(NSError **)error_p;
+
+/**
+ *  Applies a changeset created by `-changesetOfTables:sinceChangeNumber:lastChangeNumber:error:`, inserting or
+ *  updating each changed row by primary key, and deleting each deleted row.
+ *
+ *  The changeset is applied within a transaction, unless one is already open, and is rolled back if an error occurs.
+ *  When a table is also tracked in this database, rows with local changes conflict with the changeset, and are
+ *  resolved by the conflict policy. Changes made by applying the changeset aren't recorded as local changes, so they
+ *  aren't included in this database's own changesets.
+ *
+ *  @param  changeset       The changeset to apply.
+ *  @param  conflictPolicy  How to treat rows that have also been changed locally.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return The number of rows inserted, updated, or deleted, or -1 if an error occurs.
+ */
+- (NSInteger)applyChangeset:(NSData *)changeset
+             conflictPolicy:(FMDBChangesetConflictPolicy)conflictPolicy
+                      error:(NSError **)error_p;
+
+@end
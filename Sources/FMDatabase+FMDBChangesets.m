@@ -0,0 +1,982 @@
+#import "FMDatabase+FMDBChangesets.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+
+static NSString * const FMDBChangeNumberTableName = @"fmdb_change_number";
+
+static NSString * const FMDBChangeLogPrefix = @"fmdb_changes_";
+
+// the number of the latest change is kept in a single row, shared by the triggers of every tracked table
+static NSString * const FMDBCreateChangeNumberTableStatement =
+  @"CREATE TABLE IF NOT EXISTS fmdb_change_number (value INTEGER NOT NULL)";
+
+static NSString * const FMDBInsertChangeNumberStatement =
+  @"INSERT INTO fmdb_change_number (value) SELECT 0 WHERE NOT EXISTS (SELECT 1 FROM fmdb_change_number)";
+
+// a changeset starts with these bytes, followed by its tables
+static const uint8_t FMDBChangesetHeader[] = { 'F', 'M', 'C', 'S', 1 };
+
+/**
+ *  The tag before each row of a table in a changeset. A table's rows end with `FMDBChangesetRowEnd`.
+ */
+typedef NS_ENUM(uint8_t, FMDBChangesetRow)
+{
+  FMDBChangesetRowEnd = 0,
+  /** Followed by the values of all of the table's columns. */
+  FMDBChangesetRowUpsert = 1,
+  /** Followed by the values of the table's primary key columns. */
+  FMDBChangesetRowDelete = 2,
+};
+
+/**
+ *  The tag before each value in a changeset.
+ */
+typedef NS_ENUM(uint8_t, FMDBChangesetValue)
+{
+  FMDBChangesetValueNull = 0,
+  /** Followed by a zigzag-encoded variable-length integer. */
+  FMDBChangesetValueInteger = 1,
+  /** Followed by 8 bytes, little-endian. */
+  FMDBChangesetValueReal = 2,
+  /** Followed by the length of the UTF-8 text, as a variable-length integer, and the text. */
+  FMDBChangesetValueText = 3,
+  /** Followed by the length of the blob, as a variable-length integer, and the blob. */
+  FMDBChangesetValueBlob = 4,
+};
+
+/**
+ *  A position in a changeset being applied.
+ */
+typedef struct
+{
+  const uint8_t * bytes;
+  NSUInteger length;
+  NSUInteger offset;
+  BOOL isMalformed;
+} FMDBChangesetReader;
+
+// ========== WRITING ==================================================================================================
+#pragma mark - Writing
+
+static void FMDBChangesetAppendByte(NSMutableData * changeset, uint8_t byte)
+{
+  [changeset appendBytes:&byte length:1];
+}
+
+static void FMDBChangesetAppendVarint(NSMutableData * changeset, uint64_t value)
+{
+  // 7 bits per byte, least significant first, with the high bit set on every byte but the last
+  uint8_t bytes[10];
+  NSUInteger length = 0;
+  do
+  {
+    bytes[length] = (uint8_t)(value & 0x7f);
+    value >>= 7;
+    if (value != 0)
+    {
+      bytes[length] |= 0x80;
+    }
+    length++;
+  } while (value != 0);
+  [changeset appendBytes:bytes length:length];
+}
+
+static void FMDBChangesetAppendBytes(NSMutableData * changeset, const void * bytes, NSUInteger length)
+{
+  FMDBChangesetAppendVarint(changeset, length);
+  [changeset appendBytes:bytes length:length];
+}
+
+static void FMDBChangesetAppendString(NSMutableData * changeset, NSString * string)
+{
+  NSData * utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+  FMDBChangesetAppendBytes(changeset, utf8.bytes, utf8.length);
+}
+
+/**
+ *  Appends a value of the current row, read with sqlite's typed column accessors, without creating an object.
+ */
+static void FMDBChangesetAppendColumn(NSMutableData * changeset, sqlite3_stmt * statement, int columnIdx)
+{
+  switch (sqlite3_column_type(statement, columnIdx))
+  {
+    case SQLITE_INTEGER:
+    {
+      // zigzag encoding keeps small negative integers short
+      int64_t integer = sqlite3_column_int64(statement, columnIdx);
+      FMDBChangesetAppendByte(changeset, FMDBChangesetValueInteger);
+      FMDBChangesetAppendVarint(changeset, ((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63));
+      break;
+    }
+    
+    case SQLITE_FLOAT:
+    {
+      double real = sqlite3_column_double(statement, columnIdx);
+      uint64_t bits = 0;
+      memcpy(&bits, &real, sizeof(bits));
+      bits = CFSwapInt64HostToLittle(bits);
+      FMDBChangesetAppendByte(changeset, FMDBChangesetValueReal);
+      [changeset appendBytes:&bits length:sizeof(bits)];
+      break;
+    }
+    
+    case SQLITE_TEXT:
+      FMDBChangesetAppendByte(changeset, FMDBChangesetValueText);
+      FMDBChangesetAppendBytes(changeset,
+                               sqlite3_column_text(statement, columnIdx),
+                               (NSUInteger)sqlite3_column_bytes(statement, columnIdx));
+      break;
+    
+    case SQLITE_BLOB:
+      FMDBChangesetAppendByte(changeset, FMDBChangesetValueBlob);
+      FMDBChangesetAppendBytes(changeset,
+                               sqlite3_column_blob(statement, columnIdx),
+                               (NSUInteger)sqlite3_column_bytes(statement, columnIdx));
+      break;
+    
+    default:
+      FMDBChangesetAppendByte(changeset, FMDBChangesetValueNull);
+      break;
+  }
+}
+
+// ========== READING ==================================================================================================
+#pragma mark - Reading
+
+static uint8_t FMDBChangesetReadByte(FMDBChangesetReader * reader)
+{
+  if (reader->offset >= reader->length)
+  {
+    reader->isMalformed = YES;
+    return 0;
+  }
+  return reader->bytes[reader->offset++];
+}
+
+static uint64_t FMDBChangesetReadVarint(FMDBChangesetReader * reader)
+{
+  uint64_t value = 0;
+  for (unsigned int shift = 0; shift < 64 && NO == reader->isMalformed; shift += 7)
+  {
+    uint8_t byte = FMDBChangesetReadByte(reader);
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return value;
+    }
+  }
+  reader->isMalformed = YES;
+  return 0;
+}
+
+/**
+ *  Returns a pointer to the length-prefixed bytes at the reader's position, or `NULL` if they run past the end.
+ */
+static const uint8_t * FMDBChangesetReadBytes(FMDBChangesetReader * reader, NSUInteger * length_p)
+{
+  uint64_t length = FMDBChangesetReadVarint(reader);
+  if (reader->isMalformed || length > reader->length - reader->offset)
+  {
+    reader->isMalformed = YES;
+    return NULL;
+  }
+  
+  const uint8_t * bytes = reader->bytes + reader->offset;
+  reader->offset += (NSUInteger)length;
+  *length_p = (NSUInteger)length;
+  return bytes;
+}
+
+static NSString * FMDBChangesetReadString(FMDBChangesetReader * reader)
+{
+  NSUInteger length = 0;
+  const uint8_t * bytes = FMDBChangesetReadBytes(reader, &length);
+  NSString * string = (bytes != NULL
+                       ? [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding]
+                       : nil);
+  if (string == nil)
+  {
+    reader->isMalformed = YES;
+  }
+  return string;
+}
+
+/**
+ *  Returns the next value as an object to bind to a statement: `NSNull`, `NSNumber`, `NSString`, or `NSData`.
+ */
+static id FMDBChangesetReadValue(FMDBChangesetReader * reader)
+{
+  switch (FMDBChangesetReadByte(reader))
+  {
+    case FMDBChangesetValueNull:
+      return [NSNull null];
+    
+    case FMDBChangesetValueInteger:
+    {
+      uint64_t zigzag = FMDBChangesetReadVarint(reader);
+      return @((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+    }
+    
+    case FMDBChangesetValueReal:
+    {
+      uint64_t bits = 0;
+      if (reader->length - reader->offset < sizeof(bits))
+      {
+        reader->isMalformed = YES;
+        return nil;
+      }
+      memcpy(&bits, reader->bytes + reader->offset, sizeof(bits));
+      reader->offset += sizeof(bits);
+      bits = CFSwapInt64LittleToHost(bits);
+      
+      double real = 0;
+      memcpy(&real, &bits, sizeof(real));
+      return @(real);
+    }
+    
+    case FMDBChangesetValueText:
+      return FMDBChangesetReadString(reader);
+    
+    case FMDBChangesetValueBlob:
+    {
+      NSUInteger length = 0;
+      const uint8_t * bytes = FMDBChangesetReadBytes(reader, &length);
+      return (bytes != NULL ? [[NSData alloc] initWithBytes:bytes length:length] : nil);
+    }
+    
+    default:
+      reader->isMalformed = YES;
+      return nil;
+  }
+}
+
+static NSArray * FMDBChangesetReadValues(FMDBChangesetReader * reader, NSUInteger count)
+{
+  NSMutableArray * values = [[NSMutableArray alloc] initWithCapacity:count];
+  for (NSUInteger valueIdx = 0; valueIdx < count && NO == reader->isMalformed; valueIdx++)
+  {
+    id value = FMDBChangesetReadValue(reader);
+    if (value != nil)
+    {
+      [values addObject:value];
+    }
+  }
+  return (reader->isMalformed ? nil : values);
+}
+
+@implementation FMDatabase (FMDBChangesets)
+
+// ========== CHANGE TRACKING ==========================================================================================
+#pragma mark - Change Tracking
+
+- (BOOL)trackChangesToTable:(NSString *)tableName
+                      error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  
+  NSArray * keyColumnNames = [self primaryKeyColumnNamesOfTable:tableName];
+  if (keyColumnNames.count == 0)
+  {
+    if (error_p != NULL)
+    {
+      NSString * description = [NSString stringWithFormat:@"Changes to %@ can't be tracked without a primary key",
+                                tableName];
+      *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                     code:SQLITE_ERROR
+                                 userInfo:@{ NSLocalizedDescriptionKey: description }];
+    }
+    return NO;
+  }
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:FMDBCreateChangeNumberTableStatement];
+  [statements addObject:FMDBInsertChangeNumberStatement];
+  [statements addObjectsFromArray:[self statementsToStopTrackingTable:tableName]];
+  [statements addObjectsFromArray:[FMDatabase statementsToTrackTable:tableName
+                                                      keyColumnNames:keyColumnNames]];
+  
+  return [self executeChangeTrackingStatements:statements
+                                         error:error_p];
+}
+
+- (BOOL)stopTrackingChangesToTable:(NSString *)tableName
+                             error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  
+  return [self executeChangeTrackingStatements:[self statementsToStopTrackingTable:tableName]
+                                         error:error_p];
+}
+
+- (BOOL)isTrackingChangesToTable:(NSString *)tableName
+{
+  NSString * triggerName = [FMDatabase nameOfChangeTriggerOnTable:tableName event:@"insert"];
+  return [[self.schemaCatalog triggerNamesOnTable:tableName] containsObject:triggerName];
+}
+
+- (int64_t)currentChangeNumber
+{
+  if ([self.schemaCatalog schemaOfTable:FMDBChangeNumberTableName] == nil)
+  {
+    return 0;
+  }
+  
+  // read as a 64-bit integer, which longForQuery: would truncate where long is 32 bits
+  FMResultSet * results = [self executeQuery:@"SELECT value FROM fmdb_change_number"];
+  int64_t changeNumber = ([results next] ? [results longLongIntForColumnIndex:0] : 0);
+  [results close];
+  return changeNumber;
+}
+
+- (BOOL)discardChangesThroughChangeNumber:(int64_t)changeNumber
+                                    error:(NSError **)error_p
+{
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  for (NSString * tableName in self.schemaCatalog.tableNames)
+  {
+    if ([tableName.lowercaseString hasPrefix:FMDBChangeLogPrefix])
+    {
+      [statements addObject:[NSString stringWithFormat:@"DELETE FROM %@ WHERE change_number <= %lld",
+                             [FMDatabase escapeIdentifier:tableName],
+                             (long long)changeNumber]];
+    }
+  }
+  
+  return [self executeChangeTrackingStatements:statements
+                                         error:error_p];
+}
+
+- (NSArray *)statementsToStopTrackingTable:(NSString *)tableName
+{
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  
+  NSString * triggerPrefix = [FMDatabase nameOfChangeTriggerOnTable:tableName event:@""];
+  for (NSString * triggerName in [self.schemaCatalog triggerNamesOnTable:tableName])
+  {
+    if ([triggerName.lowercaseString hasPrefix:triggerPrefix])
+    {
+      [statements addObject:[@"DROP TRIGGER IF EXISTS " stringByAppendingString:
+                             [FMDatabase escapeIdentifier:triggerName]]];
+    }
+  }
+  
+  [statements addObject:[@"DROP TABLE IF EXISTS " stringByAppendingString:
+                         [FMDatabase escapeIdentifier:[FMDatabase nameOfChangeLogOfTable:tableName]]]];
+  return statements;
+}
+
+- (BOOL)executeChangeTrackingStatements:(NSArray *)statements
+                                  error:(NSError **)error_p
+{
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return NO;
+  }
+  
+  BOOL succeeded = YES;
+  for (NSString * statement in statements)
+  {
+    succeeded = succeeded && [self executeUpdate:statement
+                                           error:error_p];
+  }
+  
+  return [self finishChangesetTransaction:ownsTransaction
+                                succeeded:succeeded
+                                    error:error_p];
+}
+
+- (BOOL)finishChangesetTransaction:(BOOL)ownsTransaction
+                         succeeded:(BOOL)succeeded
+                             error:(NSError **)error_p
+{
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [self commit];
+      if (NO == succeeded && error_p != NULL) *error_p = self.lastError;
+    }
+    else
+    {
+      [self rollback];
+    }
+  }
+  return succeeded;
+}
+
+/**
+ *  Returns the names of a table's primary key columns, in the order of the key.
+ */
+- (NSArray *)primaryKeyColumnNamesOfTable:(NSString *)tableName
+{
+  NSMutableArray * columns = [[NSMutableArray alloc] init];
+  for (NSDictionary * columnInfo in [[self.schemaCatalog schemaOfTable:tableName] allValues])
+  {
+    if ([columnInfo[@"pk"] integerValue] > 0)
+    {
+      [columns addObject:columnInfo];
+    }
+  }
+  
+  // before sqlite 3.7.16, pk is 1 for every key column, which are then in the order of the table's columns
+  [columns sortUsingDescriptors:@[ [NSSortDescriptor sortDescriptorWithKey:@"pk" ascending:YES],
+                                   [NSSortDescriptor sortDescriptorWithKey:@"cid" ascending:YES] ]];
+  return [columns valueForKey:@"name"];
+}
+
+/**
+ *  Returns the names of a table's columns, in the order of the table.
+ */
+- (NSArray *)columnNamesOfTable:(NSString *)tableName
+{
+  NSArray * columns = [[[self.schemaCatalog schemaOfTable:tableName] allValues] sortedArrayUsingDescriptors:
+                       @[ [NSSortDescriptor sortDescriptorWithKey:@"cid" ascending:YES] ]];
+  return [columns valueForKey:@"name"];
+}
+
+// ---------- STATEMENTS -----------------------------------------------------------------------------------------------
+#pragma mark Statements
+
+/**
+ *  Returns the name of the table that logs a table's changed rows. Names are lowercase, so that they can be found
+ *  however the table is named.
+ */
++ (NSString *)nameOfChangeLogOfTable:(NSString *)tableName
+{
+  return [[FMDBChangeLogPrefix stringByAppendingString:tableName] lowercaseString];
+}
+
++ (NSString *)nameOfChangeTriggerOnTable:(NSString *)tableName
+                                   event:(NSString *)event
+{
+  return [[NSString stringWithFormat:@"fmdb_track_%@_%@", tableName, event] lowercaseString];
+}
+
+/**
+ *  Returns the statements that create a table's change log and the triggers that record its changes.
+ */
++ (NSArray *)statementsToTrackTable:(NSString *)tableName
+                     keyColumnNames:(NSArray *)keyColumnNames
+{
+  NSString * changeLogName = [self nameOfChangeLogOfTable:tableName];
+  NSMutableArray * escapedKeyColumnNames = [[NSMutableArray alloc] initWithCapacity:keyColumnNames.count];
+  for (NSString * columnName in keyColumnNames)
+  {
+    [escapedKeyColumnNames addObject:[FMDatabase escapeIdentifier:columnName]];
+  }
+  NSString * keyList = [escapedKeyColumnNames componentsJoinedByString:@", "];
+  
+  // key values are kept as stored, without affinity, so that they match the table's
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:[NSString stringWithFormat:@"CREATE TABLE %@ (change_number INTEGER NOT NULL, %@,"
+                                                   @" PRIMARY KEY (%@))",
+                         [FMDatabase escapeIdentifier:changeLogName],
+                         keyList,
+                         keyList]];
+  [statements addObject:[NSString stringWithFormat:@"CREATE INDEX %@ ON %@ (change_number)",
+                         [FMDatabase escapeIdentifier:[changeLogName stringByAppendingString:@"_change_number"]],
+                         [FMDatabase escapeIdentifier:changeLogName]]];
+  
+  [statements addObject:[self statementToCreateChangeTrigger:[self nameOfChangeTriggerOnTable:tableName event:@"insert"]
+                                                       event:@"INSERT"
+                                                     onTable:tableName
+                                                        when:nil
+                                                       steps:[self stepsToLogChangeToTable:tableName
+                                                                            keyColumnNames:keyColumnNames
+                                                                                       row:@"NEW"]]];
+  [statements addObject:[self statementToCreateChangeTrigger:[self nameOfChangeTriggerOnTable:tableName event:@"update"]
+                                                       event:@"UPDATE"
+                                                     onTable:tableName
+                                                        when:nil
+                                                       steps:[self stepsToLogChangeToTable:tableName
+                                                                            keyColumnNames:keyColumnNames
+                                                                                       row:@"NEW"]]];
+  [statements addObject:[self statementToCreateChangeTrigger:[self nameOfChangeTriggerOnTable:tableName event:@"delete"]
+                                                       event:@"DELETE"
+                                                     onTable:tableName
+                                                        when:nil
+                                                       steps:[self stepsToLogChangeToTable:tableName
+                                                                            keyColumnNames:keyColumnNames
+                                                                                       row:@"OLD"]]];
+  
+  // a row whose key changes is deleted under its old key
+  NSMutableArray * keyChanges = [[NSMutableArray alloc] init];
+  for (NSString * escapedColumnName in escapedKeyColumnNames)
+  {
+    [keyChanges addObject:[NSString stringWithFormat:@"OLD.%@ IS NOT NEW.%@", escapedColumnName, escapedColumnName]];
+  }
+  NSString * updateKeyTriggerName = [self nameOfChangeTriggerOnTable:tableName event:@"update_key"];
+  [statements addObject:[self statementToCreateChangeTrigger:updateKeyTriggerName
+                                                       event:[@"UPDATE OF " stringByAppendingString:keyList]
+                                                     onTable:tableName
+                                                        when:[keyChanges componentsJoinedByString:@" OR "]
+                                                       steps:[self stepsToLogChangeToTable:tableName
+                                                                            keyColumnNames:keyColumnNames
+                                                                                       row:@"OLD"]]];
+  
+  return statements;
+}
+
++ (NSString *)statementToCreateChangeTrigger:(NSString *)triggerName
+                                       event:(NSString *)event
+                                     onTable:(NSString *)tableName
+                                        when:(NSString *)when
+                                       steps:(NSArray *)steps
+{
+  NSMutableArray * createTrigger = [[NSMutableArray alloc] init];
+  [createTrigger addObject:@"CREATE TRIGGER"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:triggerName]];
+  [createTrigger addObject:@"AFTER"];
+  [createTrigger addObject:event];
+  [createTrigger addObject:@"ON"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:tableName]];
+  [createTrigger addObject:@"FOR EACH ROW"];
+  
+  if (when != nil)
+  {
+    [createTrigger addObject:@"WHEN"];
+    [createTrigger addObject:when];
+  }
+  
+  [createTrigger addObject:@"BEGIN"];
+  for (NSString * step in steps)
+  {
+    [createTrigger addObject:[step stringByAppendingString:@";"]];
+  }
+  [createTrigger addObject:@"END"];
+  
+  return [createTrigger componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns the trigger steps that take the next change number, and log the key of the given row with it, replacing
+ *  the row's earlier change.
+ */
++ (NSArray *)stepsToLogChangeToTable:(NSString *)tableName
+                      keyColumnNames:(NSArray *)keyColumnNames
+                                 row:(NSString *)row
+{
+  NSMutableArray * columns = [[NSMutableArray alloc] initWithObjects:@"change_number", nil];
+  NSMutableArray * values = [[NSMutableArray alloc] initWithObjects:@"value", nil];
+  for (NSString * columnName in keyColumnNames)
+  {
+    NSString * escapedColumnName = [FMDatabase escapeIdentifier:columnName];
+    [columns addObject:escapedColumnName];
+    [values addObject:[NSString stringWithFormat:@"%@.%@", row, escapedColumnName]];
+  }
+  
+  NSMutableArray * logStep = [[NSMutableArray alloc] init];
+  [logStep addObject:@"INSERT OR REPLACE INTO"];
+  [logStep addObject:[FMDatabase escapeIdentifier:[self nameOfChangeLogOfTable:tableName]]];
+  [logStep addObject:[NSString stringWithFormat:@"(%@)", [columns componentsJoinedByString:@", "]]];
+  [logStep addObject:@"SELECT"];
+  [logStep addObject:[values componentsJoinedByString:@", "]];
+  [logStep addObject:@"FROM fmdb_change_number"];
+  
+  return @[ @"UPDATE fmdb_change_number SET value = value + 1",
+            [logStep componentsJoinedByString:@" "] ];
+}
+
+/**
+ *  Returns a condition that matches the given key columns of a table, or its change log, to `?` placeholders.
+ */
++ (NSString *)conditionToMatchKeyColumns:(NSArray *)keyColumnNames
+{
+  NSMutableArray * condition = [[NSMutableArray alloc] init];
+  for (NSString * columnName in keyColumnNames)
+  {
+    [condition addObject:[[FMDatabase escapeIdentifier:columnName] stringByAppendingString:@" = ?"]];
+  }
+  return [condition componentsJoinedByString:@" AND "];
+}
+
+// ========== CHANGESETS ===============================================================================================
+#pragma mark - Changesets
+
+- (NSData *)changesetOfTables:(NSArray *)tableNames
+            sinceChangeNumber:(int64_t)changeNumber
+             lastChangeNumber:(int64_t *)lastChangeNumber_p
+                        error:(NSError **)error_p
+{
+  NSParameterAssert(tableNames != nil);
+  
+  // a deferred transaction reads a consistent snapshot without taking the write lock, as it only reads
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginDeferredTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  int64_t lastChangeNumber = [self currentChangeNumber];
+  NSMutableData * changeset = [[NSMutableData alloc] initWithBytes:FMDBChangesetHeader
+                                                            length:sizeof(FMDBChangesetHeader)];
+  BOOL succeeded = YES;
+  for (NSString * tableName in tableNames)
+  {
+    succeeded = succeeded && [self appendChangesToTable:tableName
+                                      sinceChangeNumber:changeNumber
+                                   throughChangeNumber:lastChangeNumber
+                                            toChangeset:changeset
+                                                  error:error_p];
+  }
+  
+  // the transaction only reads, so it is committed either way
+  if (ownsTransaction)
+  {
+    [self commit];
+  }
+  if (NO == succeeded)
+  {
+    return nil;
+  }
+  
+  if (lastChangeNumber_p != NULL) *lastChangeNumber_p = lastChangeNumber;
+  return changeset;
+}
+
+/**
+ *  Appends a table's columns, followed by its rows changed within the given change numbers, in the order in which
+ *  they were last changed.
+ */
+- (BOOL)appendChangesToTable:(NSString *)tableName
+           sinceChangeNumber:(int64_t)changeNumber
+         throughChangeNumber:(int64_t)lastChangeNumber
+                 toChangeset:(NSMutableData *)changeset
+                       error:(NSError **)error_p
+{
+  if (NO == [self isTrackingChangesToTable:tableName])
+  {
+    if (error_p != NULL)
+    {
+      NSString * description = [NSString stringWithFormat:@"Changes to %@ aren't tracked", tableName];
+      *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                     code:SQLITE_ERROR
+                                 userInfo:@{ NSLocalizedDescriptionKey: description }];
+    }
+    return NO;
+  }
+  
+  NSArray * columnNames = [self columnNamesOfTable:tableName];
+  NSArray * keyColumnNames = [self primaryKeyColumnNamesOfTable:tableName];
+  
+  FMDBChangesetAppendString(changeset, tableName);
+  FMDBChangesetAppendVarint(changeset, columnNames.count);
+  for (NSString * columnName in columnNames)
+  {
+    FMDBChangesetAppendString(changeset, columnName);
+  }
+  FMDBChangesetAppendVarint(changeset, keyColumnNames.count);
+  for (NSString * columnName in keyColumnNames)
+  {
+    FMDBChangesetAppendVarint(changeset, [columnNames indexOfObject:columnName]);
+  }
+  
+  // the log's keys are followed by the row's columns, which are NULL if the row has been deleted
+  NSMutableArray * columns = [[NSMutableArray alloc] init];
+  NSMutableArray * joinConditions = [[NSMutableArray alloc] init];
+  for (NSString * columnName in keyColumnNames)
+  {
+    NSString * escapedColumnName = [FMDatabase escapeIdentifier:columnName];
+    [columns addObject:[@"fmdb_change." stringByAppendingString:escapedColumnName]];
+    [joinConditions addObject:[NSString stringWithFormat:@"fmdb_row.%@ = fmdb_change.%@",
+                               escapedColumnName,
+                               escapedColumnName]];
+  }
+  for (NSString * columnName in columnNames)
+  {
+    [columns addObject:[@"fmdb_row." stringByAppendingString:[FMDatabase escapeIdentifier:columnName]]];
+  }
+  
+  NSMutableArray * selectSQL = [[NSMutableArray alloc] init];
+  [selectSQL addObject:@"SELECT"];
+  [selectSQL addObject:[columns componentsJoinedByString:@", "]];
+  [selectSQL addObject:@"FROM"];
+  [selectSQL addObject:[FMDatabase escapeIdentifier:[FMDatabase nameOfChangeLogOfTable:tableName]]];
+  [selectSQL addObject:@"AS fmdb_change LEFT JOIN"];
+  [selectSQL addObject:[FMDatabase escapeIdentifier:tableName]];
+  [selectSQL addObject:@"AS fmdb_row ON"];
+  [selectSQL addObject:[joinConditions componentsJoinedByString:@" AND "]];
+  [selectSQL addObject:@"WHERE fmdb_change.change_number > ? AND fmdb_change.change_number <= ?"];
+  [selectSQL addObject:@"ORDER BY fmdb_change.change_number"];
+  
+  FMResultSet * results = [self executeProfiledQuery:[selectSQL componentsJoinedByString:@" "]
+                                withArgumentsInArray:@[ @(changeNumber), @(lastChangeNumber) ]];
+  if (results == nil)
+  {
+    if (error_p != NULL) *error_p = [self lastStatementError];
+    return NO;
+  }
+  
+  sqlite3_stmt * statement = results.statement.statement;
+  int keyColumnCount = (int)keyColumnNames.count;
+  int firstRowKeyIdx = keyColumnCount + (int)[columnNames indexOfObject:keyColumnNames.firstObject];
+  
+  id profilingToken = [results beginProfiledSteps];
+  NSUInteger rowCount = 0;
+  while ([results next])
+  {
+    // key values are never NULL, so a NULL key means that the row no longer exists
+    BOOL isDeleted = (sqlite3_column_type(statement, firstRowKeyIdx) == SQLITE_NULL);
+    FMDBChangesetAppendByte(changeset, (isDeleted ? FMDBChangesetRowDelete : FMDBChangesetRowUpsert));
+    
+    int firstColumnIdx = (isDeleted ? 0 : keyColumnCount);
+    int columnCount = (isDeleted ? keyColumnCount : (int)columnNames.count);
+    for (int columnIdx = firstColumnIdx; columnIdx < firstColumnIdx + columnCount; columnIdx++)
+    {
+      FMDBChangesetAppendColumn(changeset, statement, columnIdx);
+    }
+    rowCount++;
+  }
+  FMDBChangesetAppendByte(changeset, FMDBChangesetRowEnd);
+  
+  BOOL succeeded = (NO == [self hadError]);
+  [results endProfiledSteps:profilingToken
+                   rowCount:rowCount
+                   finished:succeeded];
+  [results close];
+  
+  if (NO == succeeded && error_p != NULL) *error_p = [self lastStatementError];
+  return succeeded;
+}
+
+// ---------- APPLYING -------------------------------------------------------------------------------------------------
+#pragma mark Applying
+
+- (NSInteger)applyChangeset:(NSData *)changeset
+             conflictPolicy:(FMDBChangesetConflictPolicy)conflictPolicy
+                      error:(NSError **)error_p
+{
+  NSParameterAssert(changeset != nil);
+  
+  FMDBChangesetReader reader = { .bytes = changeset.bytes, .length = changeset.length };
+  if (changeset.length < sizeof(FMDBChangesetHeader)
+      || memcmp(changeset.bytes, FMDBChangesetHeader, sizeof(FMDBChangesetHeader)) != 0)
+  {
+    if (error_p != NULL) *error_p = [FMDatabase malformedChangesetError];
+    return -1;
+  }
+  reader.offset = sizeof(FMDBChangesetHeader);
+  
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return -1;
+  }
+  
+  // changes made while applying take later change numbers, and are discarded from the logs of tracked tables
+  int64_t changeNumber = [self currentChangeNumber];
+  NSMutableSet * trackedTableNames = [[NSMutableSet alloc] init];
+  NSInteger changedRowCount = 0;
+  BOOL succeeded = YES;
+  while (succeeded && reader.offset < reader.length)
+  {
+    succeeded = [self applyChangesToTableFromReader:&reader
+                                     conflictPolicy:conflictPolicy
+                                  trackedTableNames:trackedTableNames
+                                    changedRowCount:&changedRowCount
+                                              error:error_p];
+  }
+  
+  for (NSString * tableName in trackedTableNames)
+  {
+    NSString * discardSQL = [NSString stringWithFormat:@"DELETE FROM %@ WHERE change_number > ?",
+                             [FMDatabase escapeIdentifier:[FMDatabase nameOfChangeLogOfTable:tableName]]];
+    succeeded = succeeded && [self executeUpdate:discardSQL
+                            withArgumentsInArray:@[ @(changeNumber) ]
+                                           error:error_p];
+  }
+  
+  if (NO == [self finishChangesetTransaction:ownsTransaction
+                                   succeeded:succeeded
+                                       error:error_p])
+  {
+    return -1;
+  }
+  return changedRowCount;
+}
+
+/**
+ *  Applies the changes to the table at the reader's position, up to the end of its rows.
+ */
+- (BOOL)applyChangesToTableFromReader:(FMDBChangesetReader *)reader
+                       conflictPolicy:(FMDBChangesetConflictPolicy)conflictPolicy
+                    trackedTableNames:(NSMutableSet *)trackedTableNames
+                      changedRowCount:(NSInteger *)changedRowCount_p
+                                error:(NSError **)error_p
+{
+  NSString * tableName = FMDBChangesetReadString(reader);
+  NSUInteger columnCount = (NSUInteger)FMDBChangesetReadVarint(reader);
+  NSMutableArray * columnNames = [[NSMutableArray alloc] init];
+  for (NSUInteger columnIdx = 0; columnIdx < columnCount && NO == reader->isMalformed; columnIdx++)
+  {
+    NSString * columnName = FMDBChangesetReadString(reader);
+    if (columnName != nil)
+    {
+      [columnNames addObject:columnName];
+    }
+  }
+  
+  NSUInteger keyColumnCount = (NSUInteger)FMDBChangesetReadVarint(reader);
+  NSMutableArray * keyColumnIndexes = [[NSMutableArray alloc] init];
+  NSMutableArray * keyColumnNames = [[NSMutableArray alloc] init];
+  for (NSUInteger keyIdx = 0; keyIdx < keyColumnCount && NO == reader->isMalformed; keyIdx++)
+  {
+    uint64_t columnIdx = FMDBChangesetReadVarint(reader);
+    reader->isMalformed = (reader->isMalformed || columnIdx >= columnNames.count);
+    if (NO == reader->isMalformed)
+    {
+      [keyColumnIndexes addObject:@(columnIdx)];
+      [keyColumnNames addObject:columnNames[(NSUInteger)columnIdx]];
+    }
+  }
+  if (reader->isMalformed || keyColumnNames.count == 0)
+  {
+    if (error_p != NULL) *error_p = [FMDatabase malformedChangesetError];
+    return NO;
+  }
+  
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:tableName];
+  NSString * keyCondition = [FMDatabase conditionToMatchKeyColumns:keyColumnNames];
+  NSMutableArray * placeholders = [[NSMutableArray alloc] initWithCapacity:columnNames.count];
+  for (NSUInteger columnIdx = 0; columnIdx < columnNames.count; columnIdx++)
+  {
+    [placeholders addObject:@"?"];
+  }
+  
+  NSString * updateSQL = [FMDatabase statementToUpdate:tableName
+                                               columns:columnNames
+                                           expressions:placeholders
+                                                 where:keyCondition];
+  NSString * insertSQL = [FMDatabase statementToInsertInto:escapedTableName
+                                                   columns:columnNames
+                                                  rowCount:1];
+  NSString * deleteSQL = [FMDatabase statementToDeleteFrom:escapedTableName
+                                                     where:keyCondition];
+  
+  // rows changed locally are those still in the table's change log
+  NSString * conflictSQL = nil;
+  if ([self isTrackingChangesToTable:tableName])
+  {
+    [trackedTableNames addObject:tableName];
+    conflictSQL = [NSString stringWithFormat:@"SELECT 1 FROM %@ WHERE %@",
+                   [FMDatabase escapeIdentifier:[FMDatabase nameOfChangeLogOfTable:tableName]],
+                   keyCondition];
+  }
+  
+  while (YES)
+  {
+    FMDBChangesetRow row = FMDBChangesetReadByte(reader);
+    if (reader->isMalformed || row == FMDBChangesetRowEnd)
+    {
+      break;
+    }
+    
+    NSArray * values = nil;
+    NSArray * keyValues = nil;
+    if (row == FMDBChangesetRowUpsert)
+    {
+      values = FMDBChangesetReadValues(reader, columnNames.count);
+      keyValues = (values != nil ? [FMDatabase valuesOf:values atIndexes:keyColumnIndexes] : nil);
+    }
+    else if (row == FMDBChangesetRowDelete)
+    {
+      keyValues = FMDBChangesetReadValues(reader, keyColumnNames.count);
+    }
+    if (keyValues == nil)
+    {
+      reader->isMalformed = YES;
+      break;
+    }
+    
+    if (conflictSQL != nil && conflictPolicy != FMDBChangesetConflictPolicyReplace)
+    {
+      FMResultSet * results = [self executeProfiledQuery:conflictSQL
+                                    withArgumentsInArray:keyValues];
+      BOOL isConflict = [results next];
+      [results close];
+      [self endInterruptibleStatement];
+      if (results == nil || [self hadError])
+      {
+        if (error_p != NULL) *error_p = [self lastStatementError];
+        return NO;
+      }
+      
+      if (isConflict && conflictPolicy == FMDBChangesetConflictPolicyIgnore)
+      {
+        continue;
+      }
+      if (isConflict)
+      {
+        if (error_p != NULL)
+        {
+          NSString * description = [NSString stringWithFormat:@"The changeset conflicts with a local change to %@",
+                                    tableName];
+          *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                         code:SQLITE_ABORT
+                                     userInfo:@{ NSLocalizedDescriptionKey: description }];
+        }
+        return NO;
+      }
+    }
+    
+    if (row == FMDBChangesetRowUpsert)
+    {
+      // a row that doesn't exist yet isn't updated, so it is inserted
+      if (NO == [self executeUpdate:updateSQL
+               withArgumentsInArray:[values arrayByAddingObjectsFromArray:keyValues]
+                              error:error_p])
+      {
+        return NO;
+      }
+      if ([self changes] == 0 && NO == [self executeUpdate:insertSQL
+                                      withArgumentsInArray:values
+                                                     error:error_p])
+      {
+        return NO;
+      }
+    }
+    else if (NO == [self executeUpdate:deleteSQL
+                  withArgumentsInArray:keyValues
+                                 error:error_p])
+    {
+      return NO;
+    }
+    *changedRowCount_p += [self changes];
+  }
+  
+  if (reader->isMalformed)
+  {
+    if (error_p != NULL) *error_p = [FMDatabase malformedChangesetError];
+    return NO;
+  }
+  return YES;
+}
+
+/**
+ *  Returns the values at the given indexes, in the order of the indexes.
+ */
++ (NSArray *)valuesOf:(NSArray *)values
+            atIndexes:(NSArray *)indexes
+{
+  NSMutableArray * valuesAtIndexes = [[NSMutableArray alloc] initWithCapacity:indexes.count];
+  for (NSNumber * index in indexes)
+  {
+    [valuesAtIndexes addObject:values[index.unsignedIntegerValue]];
+  }
+  return valuesAtIndexes;
+}
+
++ (NSError *)malformedChangesetError
+{
+  return [NSError errorWithDomain:@"FMDatabase"
+                             code:SQLITE_CORRUPT
+                         userInfo:@{ NSLocalizedDescriptionKey: @"The changeset is malformed" }];
+}
+
+@end
@@ -0,0 +1,87 @@
+#import "FMDatabase.h"
+
+@interface FMDatabase (FMDBCountedTables)
+
+// ========== MAINTAINED COUNTS ========================================================================================
+#pragma mark - Maintained Counts
+
+/// @name Maintaining Counts
+
+/**
+ *  Whether `-countFrom:error:`, `-countFrom:matchingValues:error:`, and the `count:` helpers without a WHERE clause are
+ *  answered from maintained counts when possible, rather than by scanning the table. Enabled by
+ *  `-maintainCountsOfTable:groupedByColumns:error:`, but must be enabled on other connections to the same database.
+ *  Defaults to `NO`.
+ */
+@property (nonatomic, assign) BOOL shouldUseMaintainedCounts;
+
+/**
+ *  Starts keeping counts of a table's rows in the `fmdb_row_counts` table, along with the number of rows for each
+ *  distinct value of the given columns. Counts are kept by triggers on the table, at the cost of an extra write per
+ *  counted column for each inserted, updated, or deleted row. Columns should therefore have few distinct values, e.g. a
+ *  status.
+ *
+ *  The counts stay exact as rows are inserted, updated, and deleted, except that rows replaced by `INSERT OR REPLACE`
+ *  or an `ON CONFLICT REPLACE` constraint stay counted unless `PRAGMA recursive_triggers` is enabled, as sqlite doesn't
+ *  otherwise fire delete triggers for them.
+ *
+ *  The table is counted once when counting starts, within a transaction, replacing any columns counted before.
+ *
+ *  @param  tableName       The table to count.
+ *  @param  columnNames     The columns whose values are counted, or `nil` to only count rows.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)maintainCountsOfTable:(NSString *)tableName
+             groupedByColumns:(NSArray *)columnNames
+                        error:(NSError **)error_p;
+
+/**
+ *  Stops keeping counts of a table, dropping its triggers and counts.
+ *
+ *  @param  tableName       The counted table.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)stopMaintainingCountsOfTable:(NSString *)tableName
+                               error:(NSError **)error_p;
+
+/**
+ *  Returns the number of rows that match the given values from the maintained counts, or `nil` if they can't answer it.
+ *  Counts can answer an empty dictionary, or a single counted column matched to a value, `NSNull`, or an array of no
+ *  more values than `matchingSetThreshold` and the connection's limit of bound variables allow. Values are compared to
+ *  the counted values as stored, with binary collation, so values that the column's type affinity would convert, e.g. a
+ *  string matched to an `INTEGER` column, and columns that declare another collation, e.g. `NOCASE`, can't be answered.
+ *
+ *  @param  tableName       The counted table.
+ *  @param  valuesToMatch   A dictionary of values to match, as described in
+ *                          `-selectResults:from:matchingValues:orderBy:limit:offset:error:`, or `nil`.
+ */
+- (NSNumber *)maintainedCountFrom:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch;
+
+// ========== APPROXIMATE COUNTS =======================================================================================
+#pragma mark - Approximate Counts
+
+/// @name Estimating Counts
+
+/**
+ *  Returns an estimate of the number of rows that match the given values, without scanning the table when possible.
+ *
+ *  Maintained counts are used when they can answer exactly. Otherwise the estimate is read from the statistics
+ *  gathered by `ANALYZE` in `sqlite_stat1`: the size of the table, or for a single column that leads an index, the
+ *  average number of rows per value. When there are no usable statistics the rows are counted.
+ *
+ *  @param  tableName       The table to count.
+ *  @param  valuesToMatch   A dictionary of values to match, or `nil`.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return The estimated number of rows, or -1 if an error occurs.
+ */
+- (NSInteger)approximateCountFrom:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch
+                            error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,606 @@
+#import "FMDatabase+FMDBCountedTables.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import <FMDB/FMDatabaseAdditions.h>
+#import <objc/runtime.h>
+
+static const void * FMDBShouldUseMaintainedCountsKey = &FMDBShouldUseMaintainedCountsKey;
+
+static NSString * const FMDBRowCountsTableName = @"fmdb_row_counts";
+
+// the count of all rows is kept under an empty column name; values of counted columns are kept as stored, so the value
+// column has no affinity of its own, and each distinct value has its own count
+static NSString * const FMDBCreateRowCountsTableStatement =
+  @"CREATE TABLE IF NOT EXISTS fmdb_row_counts"
+  @" (table_name TEXT NOT NULL COLLATE NOCASE, column_name TEXT NOT NULL COLLATE NOCASE,"
+  @"  value, row_count INTEGER NOT NULL)";
+
+static NSString * const FMDBCreateRowCountsIndexStatement =
+  @"CREATE INDEX IF NOT EXISTS fmdb_row_counts_index ON fmdb_row_counts (table_name, column_name, value)";
+
+@implementation FMDatabase (FMDBCountedTables)
+
+// ========== MAINTAINED COUNTS ========================================================================================
+#pragma mark - Maintained Counts
+
+- (BOOL)shouldUseMaintainedCounts
+{
+  return [objc_getAssociatedObject(self, FMDBShouldUseMaintainedCountsKey) boolValue];
+}
+
+- (void)setShouldUseMaintainedCounts:(BOOL)shouldUseMaintainedCounts
+{
+  objc_setAssociatedObject(self,
+                           FMDBShouldUseMaintainedCountsKey,
+                           @(shouldUseMaintainedCounts),
+                           OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (BOOL)maintainCountsOfTable:(NSString *)tableName
+             groupedByColumns:(NSArray *)columnNames
+                        error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:FMDBCreateRowCountsTableStatement];
+  [statements addObject:FMDBCreateRowCountsIndexStatement];
+  [statements addObjectsFromArray:[self statementsToStopCountingTable:tableName]];
+  [statements addObjectsFromArray:[FMDatabase statementsToCountTable:tableName
+                                                    groupedByColumns:columnNames]];
+  
+  if (NO == [self executeUpdatesInTransaction:statements
+                                        error:error_p])
+  {
+    return NO;
+  }
+  
+  self.shouldUseMaintainedCounts = YES;
+  return YES;
+}
+
+- (BOOL)stopMaintainingCountsOfTable:(NSString *)tableName
+                               error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  
+  return [self executeUpdatesInTransaction:[self statementsToStopCountingTable:tableName]
+                                     error:error_p];
+}
+
+- (NSNumber *)maintainedCountFrom:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch
+{
+  NSSet * triggerNames = [self.schemaCatalog triggerNamesOnTable:tableName];
+  if (NO == [triggerNames containsObject:[FMDatabase nameOfCountTriggerOnTable:tableName event:@"insert"]])
+  {
+    return nil;
+  }
+  
+  if (valuesToMatch.count == 0)
+  {
+    return [self countFromStatement:@"SELECT row_count FROM fmdb_row_counts WHERE table_name = ? AND column_name = ''"
+                          arguments:@[ tableName ]];
+  }
+  
+  id columnName = valuesToMatch.allKeys.firstObject;
+  if (valuesToMatch.count > 1 || NO == [columnName isKindOfClass:[NSString class]])
+  {
+    return nil;
+  }
+  
+  // only counted columns have an update trigger
+  NSString * event = [@"update_" stringByAppendingString:columnName];
+  if (NO == [triggerNames containsObject:[FMDatabase nameOfCountTriggerOnTable:tableName event:event]])
+  {
+    return nil;
+  }
+  
+  // counted values are matched with the BINARY collation, which would miss values that the column's own collation
+  // considers equal
+  if (NO == [[self collationOfColumn:columnName inTable:tableName] isEqualToString:@"BINARY"])
+  {
+    return nil;
+  }
+  
+  // counted values have the column's affinity, but the values to match don't, so they're only matched by the counts
+  // when the column's affinity wouldn't convert them, as it does in the helpers' WHERE clauses
+  id value = valuesToMatch[columnName];
+  NSString * declaredType = [self declaredTypeOfColumn:columnName
+                                               inTable:tableName];
+  for (id arg in ([value isKindOfClass:[NSArray class]] ? value : @[ value ]))
+  {
+    if (NO == [FMDatabase affinityOfDeclaredType:declaredType leavesValue:arg])
+    {
+      return nil;
+    }
+  }
+  
+  NSMutableArray * countSQL = [[NSMutableArray alloc] init];
+  [countSQL addObject:@"SELECT coalesce(sum(row_count), 0) FROM fmdb_row_counts"];
+  [countSQL addObject:@"WHERE table_name = ? AND column_name = ? AND value"];
+  
+  NSMutableArray * arguments = [[NSMutableArray alloc] initWithObjects:tableName, columnName, nil];
+  if ([value isKindOfClass:[NSArray class]])
+  {
+    int variableLimit = sqlite3_limit([self sqliteHandle], SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+    if ([value count] > self.matchingSetThreshold || [value count] + arguments.count > (NSUInteger)variableLimit)
+    {
+      return nil;
+    }
+    
+    NSMutableArray * placeholders = [[NSMutableArray alloc] initWithCapacity:[value count]];
+    for (id arg in value)
+    {
+      [placeholders addObject:@"?"];
+      [arguments addObject:arg];
+    }
+    [countSQL addObject:[NSString stringWithFormat:@"IN (%@)", [placeholders componentsJoinedByString:@", "]]];
+  }
+  else
+  {
+    [countSQL addObject:@"IS ?"];
+    [arguments addObject:value];
+  }
+  
+  return [self countFromStatement:[countSQL componentsJoinedByString:@" "]
+                        arguments:arguments];
+}
+
+- (NSArray *)statementsToStopCountingTable:(NSString *)tableName
+{
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  
+  NSString * triggerPrefix = [FMDatabase nameOfCountTriggerOnTable:tableName event:@""];
+  for (NSString * triggerName in [self.schemaCatalog triggerNamesOnTable:tableName])
+  {
+    if ([triggerName.lowercaseString hasPrefix:triggerPrefix])
+    {
+      [statements addObject:[@"DROP TRIGGER IF EXISTS " stringByAppendingString:
+                             [FMDatabase escapeIdentifier:triggerName]]];
+    }
+  }
+  
+  if (statements.count > 0 || [self.schemaCatalog schemaOfTable:FMDBRowCountsTableName] != nil)
+  {
+    [statements addObject:[@"DELETE FROM fmdb_row_counts WHERE table_name = " stringByAppendingString:
+                           [FMDatabase escapeString:tableName]]];
+  }
+  return statements;
+}
+
+- (BOOL)executeUpdatesInTransaction:(NSArray *)statements
+                              error:(NSError **)error_p
+{
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return NO;
+  }
+  
+  BOOL succeeded = YES;
+  for (NSString * statement in statements)
+  {
+    succeeded = succeeded && [self executeUpdate:statement
+                                           error:error_p];
+  }
+  
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [self commit];
+      if (NO == succeeded && error_p != NULL) *error_p = self.lastError;
+    }
+    else
+    {
+      [self rollback];
+    }
+  }
+  return succeeded;
+}
+
+- (NSString *)declaredTypeOfColumn:(NSString *)columnName
+                           inTable:(NSString *)tableName
+{
+  NSDictionary * tableSchema = [self.schemaCatalog schemaOfTable:tableName];
+  for (NSString * schemaColumnName in tableSchema)
+  {
+    if ([schemaColumnName caseInsensitiveCompare:columnName] == NSOrderedSame)
+    {
+      return tableSchema[schemaColumnName][@"type"];
+    }
+  }
+  return nil;
+}
+
+/**
+ *  Returns the uppercased name of the collation that a column declares in its table's SQL, `BINARY` if it declares
+ *  none, or `nil` if the table's SQL isn't known.
+ */
+- (NSString *)collationOfColumn:(NSString *)columnName
+                        inTable:(NSString *)tableName
+{
+  NSString * sql = [self.schemaCatalog sqlForTable:tableName];
+  NSUInteger definitionStartIdx = [sql rangeOfString:@"("].location;
+  if (sql == nil || definitionStartIdx == NSNotFound)
+  {
+    return nil;
+  }
+  
+  // column definitions are separated by the commas that aren't within parentheses or quotes
+  NSMutableArray * definitions = [[NSMutableArray alloc] init];
+  NSUInteger depth = 0;
+  unichar closingQuote = 0;
+  definitionStartIdx++;
+  for (NSUInteger characterIdx = definitionStartIdx; characterIdx < sql.length; characterIdx++)
+  {
+    unichar character = [sql characterAtIndex:characterIdx];
+    if (closingQuote != 0)
+    {
+      closingQuote = (character == closingQuote ? 0 : closingQuote);
+    }
+    else if (character == '"' || character == '\'' || character == '`')
+    {
+      closingQuote = character;
+    }
+    else if (character == '[')
+    {
+      closingQuote = ']';
+    }
+    else if (character == '(')
+    {
+      depth++;
+    }
+    else if (character == ')' && depth > 0)
+    {
+      depth--;
+    }
+    else if (depth == 0 && (character == ',' || character == ')'))
+    {
+      [definitions addObject:[sql substringWithRange:NSMakeRange(definitionStartIdx,
+                                                                 characterIdx - definitionStartIdx)]];
+      definitionStartIdx = characterIdx + 1;
+      if (character == ')')
+      {
+        break;
+      }
+    }
+  }
+  
+  NSCharacterSet * quotes = [NSCharacterSet characterSetWithCharactersInString:@"\"'`[]"];
+  NSString * collatePattern = @"\\bCOLLATE\\s+[\"'`\\[]?(\\w+)";
+  NSRegularExpression * regex = [NSRegularExpression regularExpressionWithPattern:collatePattern
+                                                                          options:NSRegularExpressionCaseInsensitive
+                                                                            error:NULL];
+  for (NSString * definition in definitions)
+  {
+    NSString * trimmedDefinition = [definition stringByTrimmingCharactersInSet:
+                                    [NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    NSString * definedName = [trimmedDefinition componentsSeparatedByCharactersInSet:
+                              [NSCharacterSet whitespaceAndNewlineCharacterSet]].firstObject;
+    if ([[definedName stringByTrimmingCharactersInSet:quotes] caseInsensitiveCompare:columnName] == NSOrderedSame)
+    {
+      NSTextCheckingResult * match = [regex firstMatchInString:trimmedDefinition
+                                                       options:0
+                                                         range:NSMakeRange(0, trimmedDefinition.length)];
+      return (match == nil ? @"BINARY" : [trimmedDefinition substringWithRange:[match rangeAtIndex:1]].uppercaseString);
+    }
+  }
+  return nil;
+}
+
+/**
+ *  Returns whether comparing a value to a column of the declared type leaves the value as it is, following sqlite's
+ *  rules for the affinity of a declared type: numbers are converted to text by TEXT affinity, and text to numbers by
+ *  INTEGER, REAL, and NUMERIC affinity.
+ */
++ (BOOL)affinityOfDeclaredType:(NSString *)declaredType
+                   leavesValue:(id)value
+{
+  if (value == [NSNull null] || [value isKindOfClass:[NSData class]])
+  {
+    return YES;
+  }
+  
+  NSString * type = declaredType.uppercaseString;
+  if ([type rangeOfString:@"INT"].location != NSNotFound)
+  {
+    return [value isKindOfClass:[NSNumber class]];
+  }
+  else if ([type rangeOfString:@"CHAR"].location != NSNotFound ||
+           [type rangeOfString:@"CLOB"].location != NSNotFound ||
+           [type rangeOfString:@"TEXT"].location != NSNotFound)
+  {
+    return [value isKindOfClass:[NSString class]];
+  }
+  else if (type.length == 0 || [type rangeOfString:@"BLOB"].location != NSNotFound)
+  {
+    return ([value isKindOfClass:[NSNumber class]] || [value isKindOfClass:[NSString class]]);
+  }
+  return [value isKindOfClass:[NSNumber class]];
+}
+
+/**
+ *  Returns the integer in the first column of the statement's first row, or `nil` if there is none.
+ */
+- (NSNumber *)countFromStatement:(NSString *)sql
+                       arguments:(NSArray *)arguments
+{
+  FMResultSet * results = [self executeQuery:sql
+                        withArgumentsInArray:arguments];
+  NSNumber * count = nil;
+  if ([results next] && NO == [results columnIndexIsNull:0])
+  {
+    count = @([results longLongIntForColumnIndex:0]);
+  }
+  [results close];
+  return count;
+}
+
+// ---------- STATEMENTS -----------------------------------------------------------------------------------------------
+#pragma mark Statements
+
+/**
+ *  Returns the name of a trigger that keeps a table's counts. Names are lowercase, so that they can be found however
+ *  the table is named.
+ */
++ (NSString *)nameOfCountTriggerOnTable:(NSString *)tableName
+                                  event:(NSString *)event
+{
+  return [[NSString stringWithFormat:@"fmdb_count_%@_%@", tableName, event] lowercaseString];
+}
+
+/**
+ *  Returns the statements that count a table's rows and create the triggers that keep the counts.
+ */
++ (NSArray *)statementsToCountTable:(NSString *)tableName
+                   groupedByColumns:(NSArray *)columnNames
+{
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:tableName];
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  
+  [statements addObject:[NSString stringWithFormat:
+                         @"INSERT INTO fmdb_row_counts (table_name, column_name, value, row_count)"
+                         @" SELECT %@, '', NULL, count(*) FROM %@",
+                         [FMDatabase escapeString:tableName],
+                         escapedTableName]];
+  
+  for (NSString * columnName in columnNames)
+  {
+    NSString * escapedColumnName = [FMDatabase escapeIdentifier:columnName];
+    [statements addObject:[NSString stringWithFormat:
+                           @"INSERT INTO fmdb_row_counts (table_name, column_name, value, row_count)"
+                           @" SELECT %@, %@, %@, count(*) FROM %@ GROUP BY %@",
+                           [FMDatabase escapeString:tableName],
+                           [FMDatabase escapeString:columnName],
+                           escapedColumnName,
+                           escapedTableName,
+                           escapedColumnName]];
+  }
+  
+  NSMutableArray * insertSteps = [[NSMutableArray alloc] init];
+  NSMutableArray * deleteSteps = [[NSMutableArray alloc] init];
+  [insertSteps addObject:[self stepToAdd:1 toCountOfTable:tableName column:nil row:nil]];
+  [deleteSteps addObject:[self stepToAdd:-1 toCountOfTable:tableName column:nil row:nil]];
+  for (NSString * columnName in columnNames)
+  {
+    [insertSteps addObject:[self stepToInsertCountOfTable:tableName column:columnName row:@"NEW"]];
+    [insertSteps addObject:[self stepToAdd:1 toCountOfTable:tableName column:columnName row:@"NEW"]];
+    [deleteSteps addObject:[self stepToAdd:-1 toCountOfTable:tableName column:columnName row:@"OLD"]];
+  }
+  
+  [statements addObject:[self statementToCreateCountTrigger:[self nameOfCountTriggerOnTable:tableName event:@"insert"]
+                                                      event:@"INSERT"
+                                                    onTable:tableName
+                                                       when:nil
+                                                      steps:insertSteps]];
+  [statements addObject:[self statementToCreateCountTrigger:[self nameOfCountTriggerOnTable:tableName event:@"delete"]
+                                                      event:@"DELETE"
+                                                    onTable:tableName
+                                                       when:nil
+                                                      steps:deleteSteps]];
+  
+  // a row whose counted value changes moves from one value's count to another's
+  for (NSString * columnName in columnNames)
+  {
+    NSString * escapedColumnName = [FMDatabase escapeIdentifier:columnName];
+    NSArray * updateSteps = @[ [self stepToAdd:-1 toCountOfTable:tableName column:columnName row:@"OLD"],
+                               [self stepToInsertCountOfTable:tableName column:columnName row:@"NEW"],
+                               [self stepToAdd:1 toCountOfTable:tableName column:columnName row:@"NEW"] ];
+    NSString * event = [@"update_" stringByAppendingString:columnName];
+    [statements addObject:[self statementToCreateCountTrigger:[self nameOfCountTriggerOnTable:tableName event:event]
+                                                        event:[@"UPDATE OF " stringByAppendingString:escapedColumnName]
+                                                      onTable:tableName
+                                                         when:[NSString stringWithFormat:@"OLD.%@ IS NOT NEW.%@",
+                                                               escapedColumnName,
+                                                               escapedColumnName]
+                                                        steps:updateSteps]];
+  }
+  
+  return statements;
+}
+
++ (NSString *)statementToCreateCountTrigger:(NSString *)triggerName
+                                      event:(NSString *)event
+                                    onTable:(NSString *)tableName
+                                       when:(NSString *)when
+                                      steps:(NSArray *)steps
+{
+  NSMutableArray * createTrigger = [[NSMutableArray alloc] init];
+  [createTrigger addObject:@"CREATE TRIGGER"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:triggerName]];
+  [createTrigger addObject:@"AFTER"];
+  [createTrigger addObject:event];
+  [createTrigger addObject:@"ON"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:tableName]];
+  [createTrigger addObject:@"FOR EACH ROW"];
+  
+  if (when != nil)
+  {
+    [createTrigger addObject:@"WHEN"];
+    [createTrigger addObject:when];
+  }
+  
+  [createTrigger addObject:@"BEGIN"];
+  for (NSString * step in steps)
+  {
+    [createTrigger addObject:[step stringByAppendingString:@";"]];
+  }
+  [createTrigger addObject:@"END"];
+  
+  return [createTrigger componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns a trigger step that adds to the count of all rows, or to the count of a column's value in the given row.
+ */
++ (NSString *)stepToAdd:(NSInteger)delta
+         toCountOfTable:(NSString *)tableName
+                 column:(NSString *)columnName
+                    row:(NSString *)row
+{
+  NSMutableArray * step = [[NSMutableArray alloc] init];
+  [step addObject:[NSString stringWithFormat:@"UPDATE fmdb_row_counts SET row_count = row_count + (%ld)", (long)delta]];
+  [step addObject:@"WHERE"];
+  [step addObject:[self conditionToMatchCountOfTable:tableName column:columnName row:row]];
+  
+  return [step componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns a trigger step that adds an empty count for a column's value in the given row, unless it's already counted.
+ */
++ (NSString *)stepToInsertCountOfTable:(NSString *)tableName
+                                column:(NSString *)columnName
+                                   row:(NSString *)row
+{
+  // a unique index can't be used to skip existing counts, since it wouldn't treat NULL values as equal
+  NSMutableArray * step = [[NSMutableArray alloc] init];
+  [step addObject:@"INSERT INTO fmdb_row_counts (table_name, column_name, value, row_count) SELECT"];
+  [step addObject:[FMDatabase escapeString:tableName]];
+  [step addObject:@","];
+  [step addObject:[FMDatabase escapeString:columnName]];
+  [step addObject:@","];
+  [step addObject:[NSString stringWithFormat:@"%@.%@", row, [FMDatabase escapeIdentifier:columnName]]];
+  [step addObject:@", 0 WHERE NOT EXISTS (SELECT 1 FROM fmdb_row_counts WHERE"];
+  [step addObject:[self conditionToMatchCountOfTable:tableName column:columnName row:row]];
+  [step addObject:@")"];
+  
+  return [step componentsJoinedByString:@" "];
+}
+
++ (NSString *)conditionToMatchCountOfTable:(NSString *)tableName
+                                    column:(NSString *)columnName
+                                       row:(NSString *)row
+{
+  NSMutableArray * condition = [[NSMutableArray alloc] init];
+  [condition addObject:@"table_name ="];
+  [condition addObject:[FMDatabase escapeString:tableName]];
+  [condition addObject:@"AND column_name ="];
+  
+  if (columnName == nil)
+  {
+    [condition addObject:@"''"];
+  }
+  else
+  {
+    [condition addObject:[FMDatabase escapeString:columnName]];
+    [condition addObject:@"AND value IS"];
+    [condition addObject:[NSString stringWithFormat:@"%@.%@", row, [FMDatabase escapeIdentifier:columnName]]];
+  }
+  
+  return [condition componentsJoinedByString:@" "];
+}
+
+// ========== APPROXIMATE COUNTS =======================================================================================
+#pragma mark - Approximate Counts
+
+- (NSInteger)approximateCountFrom:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch
+                            error:(NSError **)error_p
+{
+  NSNumber * count = [self maintainedCountFrom:tableName
+                                matchingValues:valuesToMatch];
+  if (count == nil)
+  {
+    count = [self estimatedCountFrom:tableName
+                      matchingValues:valuesToMatch];
+  }
+  if (count != nil)
+  {
+    return count.integerValue;
+  }
+  
+  return [self count:nil
+                from:tableName
+      matchingValues:valuesToMatch
+               error:error_p];
+}
+
+/**
+ *  Returns an estimate from `sqlite_stat1`, or `nil` if the table hasn't been analyzed or the values can't be
+ *  estimated.
+ */
+- (NSNumber *)estimatedCountFrom:(NSString *)tableName
+                  matchingValues:(NSDictionary *)valuesToMatch
+{
+  if (valuesToMatch.count > 1 || NO == [self tableExists:@"sqlite_stat1"])
+  {
+    return nil;
+  }
+  
+  NSString * columnName = valuesToMatch.allKeys.firstObject;
+  if (columnName != nil && NO == [columnName isKindOfClass:[NSString class]])
+  {
+    return nil;
+  }
+  
+  id value = valuesToMatch[columnName];
+  int64_t valueCount = ([value isKindOfClass:[NSArray class]] ? (int64_t)[value count] : 1);
+  
+  // each row's stat starts with the number of rows in the index (or table), followed by the average number of rows
+  // that share each prefix of the index's columns
+  FMResultSet * results = [self executeQuery:@"SELECT idx, stat FROM sqlite_stat1 WHERE tbl = ? COLLATE NOCASE"
+                        withArgumentsInArray:@[ tableName ]];
+  NSNumber * estimate = nil;
+  while ([results next])
+  {
+    NSArray * stat = [[results stringForColumnIndex:1] componentsSeparatedByString:@" "];
+    if (columnName == nil)
+    {
+      estimate = @(MAX(estimate.longLongValue, [stat[0] longLongValue]));
+    }
+    else if (stat.count > 1 && NO == [results columnIndexIsNull:0])
+    {
+      NSString * leadingColumnName = [self leadingColumnNameOfIndex:[results stringForColumnIndex:0]];
+      if ([leadingColumnName caseInsensitiveCompare:columnName] == NSOrderedSame)
+      {
+        estimate = @([stat[1] longLongValue] * valueCount);
+        break;
+      }
+    }
+  }
+  [results close];
+  return estimate;
+}
+
+- (NSString *)leadingColumnNameOfIndex:(NSString *)indexName
+{
+  FMResultSet * results = [self executeQuery:[@"PRAGMA index_info(" stringByAppendingFormat:@"%@)",
+                                              [FMDatabase escapeIdentifier:indexName]]];
+  NSString * columnName = nil;
+  while (columnName == nil && [results next])
+  {
+    if ([results intForColumn:@"seqno"] == 0)
+    {
+      columnName = [results stringForColumn:@"name"];
+    }
+  }
+  [results close];
+  return columnName;
+}
+
+@end
@@ -0,0 +1,120 @@
+#import "FMDatabase.h"
+
+/**
+ *  The code of the error returned, in the `FMDatabase` domain, when a statement is interrupted because its deadline
+ *  passed. It is negative so that it can't be mistaken for a sqlite result code. Statements interrupted by a
+ *  cancellation token return `SQLITE_INTERRUPT` instead.
+ */
+extern const NSInteger FMDBDeadlineExceededErrorCode;
+
+/**
+ *  Cancels the statements run within `-[FMDatabase performWithDeadline:cancellationToken:usingBlock:]`. A token may be
+ *  cancelled from any thread, and the running statement is interrupted within a few thousand sqlite instructions.
+ */
+@interface FMDBCancellationToken : NSObject
+
+/**
+ *  Whether `-cancel` has been called.
+ */
+@property (atomic, assign, readonly) BOOL isCancelled;
+
+/**
+ *  Interrupts the running statement, and every later statement, of the blocks performed with this token.
+ */
+- (void)cancel;
+
+@end
+
+@interface FMDatabase (FMDBDeadlines)
+
+// ========== DEADLINES ================================================================================================
+#pragma mark - Deadlines
+
+/// @name Deadlines
+
+/**
+ *  The longest a single statement executed by the helper methods may run, including the time spent reading its
+ *  results, before it is interrupted with a timeout error, or 0 for no limit. Defaults to 0.
+ *
+ *  A default budget bounds the time that one slow query, e.g. with an unindexed predicate, holds the connection, and so
+ *  the latency of everything queued behind it.
+ */
+@property (nonatomic, assign) NSTimeInterval defaultStatementTimeout;
+
+/**
+ *  Performs a block whose statements are interrupted once a deadline passes or a token is cancelled. Statements that
+ *  are interrupted fail, and the helper methods that run them return a timeout error, with the code
+ *  `FMDBDeadlineExceededErrorCode`, or a cancellation error, with the code `SQLITE_INTERRUPT`, through their `error_p`
+ *  parameters.
+ *
+ *  Deadlines and tokens apply to every statement executed by the helper methods within the block, which is how each
+ *  helper accepts them. Blocks may be nested, in which case the earliest deadline applies, as do all tokens. The
+ *  statements are interrupted through sqlite's progress handler, which replaces any other progress handler on the
+ *  connection while the block runs.
+ *
+ *  Interrupting an INSERT, UPDATE, or DELETE within a transaction rolls back the whole transaction.
+ *
+ *  @param  deadline            The time by which the block's statements must finish, or `nil`.
+ *  @param  cancellationToken   A token that cancels the block's statements, or `nil`.
+ *  @param  block               The block to perform, synchronously.
+ */
+- (void)performWithDeadline:(NSDate *)deadline
+          cancellationToken:(FMDBCancellationToken *)cancellationToken
+                 usingBlock:(void (^)(void))block;
+
+/**
+ *  Performs a block whose statements must finish within a timeout from now. See
+ *  `-performWithDeadline:cancellationToken:usingBlock:`.
+ */
+- (void)performWithTimeout:(NSTimeInterval)timeout
+                usingBlock:(void (^)(void))block;
+
+/**
+ *  Returns the error of the last statement: a timeout or cancellation error if it was interrupted by a deadline or a
+ *  cancellation token, otherwise `lastError`.
+ */
+- (NSError *)lastStatementError;
+
+// ---------- STATEMENT EXECUTION --------------------------------------------------------------------------------------
+#pragma mark Statement Execution
+
+/// @name Enforcing Deadlines
+
+/**
+ *  Starts the time budget of a statement about to be executed, and interrupts it if its deadline passes or a token
+ *  is cancelled. Called by `-executeProfiledQuery:withArgumentsInArray:` and
+ *  `-executeProfiledUpdate:withArgumentsInArray:`.
+ *
+ *  The budget lasts until `-endInterruptibleStatement`, or until the next interruptible statement begins, so that
+ *  statements executed in the meantime by other means, e.g. `COMMIT`, are only interrupted by the deadlines and tokens
+ *  of the blocks being performed.
+ */
+- (void)beginInterruptibleStatement;
+
+/**
+ *  Ends the time budget of the statement begun by `-beginInterruptibleStatement`. Called once an update has been
+ *  executed, and once the helper methods have read a query's results to the end.
+ */
+- (void)endInterruptibleStatement;
+
+// ---------- COUNTERS -------------------------------------------------------------------------------------------------
+#pragma mark Counters
+
+/// @name Counting Interruptions
+
+/**
+ *  The number of statements interrupted because their deadline passed.
+ */
+@property (nonatomic, assign, readonly) NSUInteger timedOutStatementCount;
+
+/**
+ *  The number of statements interrupted because a token was cancelled.
+ */
+@property (nonatomic, assign, readonly) NSUInteger cancelledStatementCount;
+
+/**
+ *  Resets `timedOutStatementCount` and `cancelledStatementCount` to 0.
+ */
+- (void)resetInterruptedStatementCounts;
+
+@end
@@ -0,0 +1,307 @@
+#import "FMDatabase+FMDBDeadlines.h"
+#import <objc/runtime.h>
+
+static const void * FMDBStatementDeadlinesKey = &FMDBStatementDeadlinesKey;
+
+const NSInteger FMDBDeadlineExceededErrorCode = -1;
+
+// the number of virtual machine instructions between checks of the deadline and tokens
+static const int FMDBDeadlineProgressHandlerInterval = 1000;
+
+typedef NS_ENUM(NSUInteger, FMDBStatementInterruption)
+{
+  FMDBStatementInterruptionNone,
+  FMDBStatementInterruptionDeadline,
+  FMDBStatementInterruptionCancellation,
+};
+
+// ========== FMDBCancellationToken ====================================================================================
+#pragma mark - FMDBCancellationToken
+
+@interface FMDBCancellationToken ()
+
+@property (atomic, assign, readwrite) BOOL isCancelled;
+
+@end
+
+@implementation FMDBCancellationToken
+
+- (void)cancel
+{
+  self.isCancelled = YES;
+}
+
+@end
+
+// ========== FMDBStatementDeadlines ===================================================================================
+#pragma mark - FMDBStatementDeadlines
+
+/**
+ *  The deadlines and tokens that apply to a connection's statements, and the interruptions they have caused.
+ */
+@interface FMDBStatementDeadlines : NSObject
+
+@property (nonatomic, assign) NSTimeInterval defaultStatementTimeout;
+
+/**
+ *  The earliest deadline of the blocks being performed, as a time interval since the reference date, or `DBL_MAX`.
+ */
+@property (nonatomic, assign) NSTimeInterval deadline;
+
+/**
+ *  The tokens of the blocks being performed.
+ */
+@property (nonatomic, copy) NSArray * cancellationTokens;
+
+/**
+ *  Why the last statement was interrupted, if it was.
+ */
+@property (nonatomic, assign) FMDBStatementInterruption lastInterruption;
+
+@property (nonatomic, assign) NSUInteger timedOutStatementCount;
+@property (nonatomic, assign) NSUInteger cancelledStatementCount;
+
+/**
+ *  Whether any deadline or token applies to statements, so that the progress handler is needed.
+ */
+- (BOOL)isEnforced;
+
+- (void)beginStatement;
+
+/**
+ *  Ends the running statement's own budget, so that later statements are only interrupted by the blocks' deadline
+ *  and tokens.
+ */
+- (void)endStatement;
+
+- (BOOL)shouldInterruptStatement;
+
+@end
+
+@implementation FMDBStatementDeadlines
+{
+  // the deadline of the running statement, from the blocks' deadline and its own budget
+  NSTimeInterval _statementDeadline;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _deadline = DBL_MAX;
+    _cancellationTokens = @[];
+    _statementDeadline = DBL_MAX;
+  }
+  return self;
+}
+
+- (BOOL)isEnforced
+{
+  return (self.defaultStatementTimeout > 0 || self.deadline < DBL_MAX || self.cancellationTokens.count > 0);
+}
+
+- (void)beginStatement
+{
+  self.lastInterruption = FMDBStatementInterruptionNone;
+  
+  _statementDeadline = self.deadline;
+  if (self.defaultStatementTimeout > 0)
+  {
+    _statementDeadline = MIN(_statementDeadline,
+                             [NSDate timeIntervalSinceReferenceDate] + self.defaultStatementTimeout);
+  }
+}
+
+- (void)endStatement
+{
+  _statementDeadline = self.deadline;
+}
+
+- (BOOL)shouldInterruptStatement
+{
+  for (FMDBCancellationToken * token in self.cancellationTokens)
+  {
+    if (token.isCancelled)
+    {
+      self.lastInterruption = FMDBStatementInterruptionCancellation;
+      self.cancelledStatementCount++;
+      return YES;
+    }
+  }
+  
+  if (_statementDeadline < DBL_MAX && [NSDate timeIntervalSinceReferenceDate] >= _statementDeadline)
+  {
+    self.lastInterruption = FMDBStatementInterruptionDeadline;
+    self.timedOutStatementCount++;
+    return YES;
+  }
+  
+  return NO;
+}
+
+@end
+
+static int FMDBDeadlineProgressHandler(void * context)
+{
+  // a non-zero result interrupts the running statement
+  FMDBStatementDeadlines * deadlines = (__bridge FMDBStatementDeadlines *)context;
+  return ([deadlines shouldInterruptStatement] ? 1 : 0);
+}
+
+// ========== FMDatabase (FMDBDeadlines) ===============================================================================
+#pragma mark - FMDatabase (FMDBDeadlines)
+
+@implementation FMDatabase (FMDBDeadlines)
+
+- (FMDBStatementDeadlines *)statementDeadlines
+{
+  FMDBStatementDeadlines * deadlines = objc_getAssociatedObject(self, FMDBStatementDeadlinesKey);
+  if (deadlines == nil)
+  {
+    deadlines = [[FMDBStatementDeadlines alloc] init];
+    objc_setAssociatedObject(self, FMDBStatementDeadlinesKey, deadlines, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return deadlines;
+}
+
+// ========== DEADLINES ================================================================================================
+#pragma mark - Deadlines
+
+- (NSTimeInterval)defaultStatementTimeout
+{
+  return [objc_getAssociatedObject(self, FMDBStatementDeadlinesKey) defaultStatementTimeout];
+}
+
+- (void)setDefaultStatementTimeout:(NSTimeInterval)defaultStatementTimeout
+{
+  NSParameterAssert(defaultStatementTimeout >= 0);
+  
+  FMDBStatementDeadlines * deadlines = [self statementDeadlines];
+  deadlines.defaultStatementTimeout = defaultStatementTimeout;
+  if (NO == [deadlines isEnforced])
+  {
+    sqlite3_progress_handler([self sqliteHandle], 0, NULL, NULL);
+  }
+}
+
+- (void)performWithDeadline:(NSDate *)deadline
+          cancellationToken:(FMDBCancellationToken *)cancellationToken
+                 usingBlock:(void (^)(void))block
+{
+  NSParameterAssert(block != nil);
+  
+  FMDBStatementDeadlines * deadlines = [self statementDeadlines];
+  NSTimeInterval outerDeadline = deadlines.deadline;
+  NSArray * outerCancellationTokens = deadlines.cancellationTokens;
+  if (deadline != nil)
+  {
+    deadlines.deadline = MIN(outerDeadline, deadline.timeIntervalSinceReferenceDate);
+  }
+  if (cancellationToken != nil)
+  {
+    deadlines.cancellationTokens = [outerCancellationTokens arrayByAddingObject:cancellationToken];
+  }
+  
+  // statements executed directly, rather than by the helper methods, are also interrupted by the block's deadline
+  deadlines.lastInterruption = FMDBStatementInterruptionNone;
+  [deadlines endStatement];
+  [self installDeadlineProgressHandler];
+  @try
+  {
+    block();
+  }
+  @finally
+  {
+    deadlines.deadline = outerDeadline;
+    deadlines.cancellationTokens = outerCancellationTokens;
+    [deadlines endStatement];
+    if (NO == [deadlines isEnforced])
+    {
+      sqlite3_progress_handler([self sqliteHandle], 0, NULL, NULL);
+    }
+  }
+}
+
+- (void)performWithTimeout:(NSTimeInterval)timeout
+                usingBlock:(void (^)(void))block
+{
+  [self performWithDeadline:[NSDate dateWithTimeIntervalSinceNow:timeout]
+          cancellationToken:nil
+                 usingBlock:block];
+}
+
+- (NSError *)lastStatementError
+{
+  FMDBStatementDeadlines * deadlines = objc_getAssociatedObject(self, FMDBStatementDeadlinesKey);
+  FMDBStatementInterruption interruption = deadlines.lastInterruption;
+  if (interruption == FMDBStatementInterruptionNone || [self lastErrorCode] != SQLITE_INTERRUPT)
+  {
+    return self.lastError;
+  }
+  
+  BOOL timedOut = (interruption == FMDBStatementInterruptionDeadline);
+  NSDictionary * userInfo = @{ NSLocalizedDescriptionKey: (timedOut
+                                                           ? @"The statement's deadline passed"
+                                                           : @"The statement was cancelled"),
+                               NSUnderlyingErrorKey: self.lastError };
+  return [NSError errorWithDomain:@"FMDatabase"
+                             code:(timedOut ? FMDBDeadlineExceededErrorCode : SQLITE_INTERRUPT)
+                         userInfo:userInfo];
+}
+
+// ---------- STATEMENT EXECUTION --------------------------------------------------------------------------------------
+#pragma mark Statement Execution
+
+- (void)beginInterruptibleStatement
+{
+  FMDBStatementDeadlines * deadlines = objc_getAssociatedObject(self, FMDBStatementDeadlinesKey);
+  if (NO == [deadlines isEnforced])
+  {
+    deadlines.lastInterruption = FMDBStatementInterruptionNone;
+    return;
+  }
+  
+  // the handler is installed for every statement, since the connection may have been reopened, or its handler replaced
+  [deadlines beginStatement];
+  [self installDeadlineProgressHandler];
+}
+
+- (void)endInterruptibleStatement
+{
+  [objc_getAssociatedObject(self, FMDBStatementDeadlinesKey) endStatement];
+}
+
+- (void)installDeadlineProgressHandler
+{
+  FMDBStatementDeadlines * deadlines = objc_getAssociatedObject(self, FMDBStatementDeadlinesKey);
+  if ([deadlines isEnforced])
+  {
+    sqlite3_progress_handler([self sqliteHandle],
+                             FMDBDeadlineProgressHandlerInterval,
+                             FMDBDeadlineProgressHandler,
+                             (__bridge void *)deadlines);
+  }
+}
+
+// ---------- COUNTERS -------------------------------------------------------------------------------------------------
+#pragma mark Counters
+
+- (NSUInteger)timedOutStatementCount
+{
+  return [objc_getAssociatedObject(self, FMDBStatementDeadlinesKey) timedOutStatementCount];
+}
+
+- (NSUInteger)cancelledStatementCount
+{
+  return [objc_getAssociatedObject(self, FMDBStatementDeadlinesKey) cancelledStatementCount];
+}
+
+- (void)resetInterruptedStatementCounts
+{
+  FMDBStatementDeadlines * deadlines = objc_getAssociatedObject(self, FMDBStatementDeadlinesKey);
+  deadlines.timedOutStatementCount = 0;
+  deadlines.cancelledStatementCount = 0;
+}
+
+@end
@@ -0,0 +1,166 @@
+#import "FMDatabase.h"
+
+/**
+ *  The key of each searched record's rank, from the BM25 algorithm. Lower ranks are better matches.
+ */
+extern NSString * const FMDBFullTextRankKey;
+
+/**
+ *  The key of each searched record's snippet, as requested by `snippetColumn`.
+ */
+extern NSString * const FMDBFullTextSnippetKey;
+
+/**
+ *  The key of each searched record's highlighted text, as requested by `highlightColumn`.
+ */
+extern NSString * const FMDBFullTextHighlightKey;
+
+/**
+ *  Options for `-[FMDatabase selectAllFrom:matchingText:inFullTextIndex:options:error:]`.
+ */
+@interface FMDBFullTextSearchOptions : NSObject
+
+/**
+ *  Whether records are sorted by their rank, best first, which is added to each record as `FMDBFullTextRankKey`.
+ *  Defaults to `YES`.
+ */
+@property (nonatomic, assign) BOOL ranked;
+
+/**
+ *  An indexed column from which a short snippet around the matched terms is added to each record as
+ *  `FMDBFullTextSnippetKey`, or `nil`.
+ */
+@property (nonatomic, copy) NSString * snippetColumn;
+
+/**
+ *  The approximate number of tokens in a snippet, up to 64. Defaults to 10.
+ */
+@property (nonatomic, assign) NSUInteger snippetTokenCount;
+
+/**
+ *  An indexed column whose whole text, with the matched terms marked, is added to each record as
+ *  `FMDBFullTextHighlightKey`, or `nil`.
+ */
+@property (nonatomic, copy) NSString * highlightColumn;
+
+/**
+ *  The text inserted before each matched term in snippets and highlighted text. Defaults to `<b>`.
+ */
+@property (nonatomic, copy) NSString * markStart;
+
+/**
+ *  The text inserted after each matched term in snippets and highlighted text. Defaults to `</b>`.
+ */
+@property (nonatomic, copy) NSString * markEnd;
+
+/**
+ *  The text marking text left out of a snippet. Defaults to an ellipsis.
+ */
+@property (nonatomic, copy) NSString * ellipsis;
+
+/**
+ *  The maximum number of records to return, or `nil` to return all matches. The limit is applied to the index's
+ *  matches, before they are joined to the table.
+ */
+@property (nonatomic, strong) NSNumber * limit;
+
+/**
+ *  The number of matches to skip, or `nil`.
+ */
+@property (nonatomic, strong) NSNumber * offset;
+
+@end
+
+@interface FMDatabase (FMDBFullTextSearch)
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+/// @name Full-Text Indexes
+
+/**
+ *  Creates a full-text index of a table's text columns, which is searched with
+ *  `-selectAllFrom:matchingText:inFullTextIndex:options:error:` rather than scanning the table with LIKE.
+ *
+ *  The index is an FTS5 virtual table, or FTS4 if sqlite wasn't built with FTS5. It is an external-content index: it
+ *  holds only the index, reading the columns' text from the table. Triggers on the table keep the index in sync with
+ *  inserted, updated, and deleted rows, and the table's existing rows are indexed before this returns, all within a
+ *  transaction.
+ *
+ *  The table must have a rowid, which the index uses to refer to rows, and an INTEGER PRIMARY KEY, if any, so that
+ *  rowids don't change when the table is vacuumed.
+ *
+ *  @param  indexName   The name of the index's virtual table.
+ *  @param  tableName   The table to index.
+ *  @param  columns     The columns to index.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)createFullTextIndexWithName:(NSString *)indexName
+                          tableName:(NSString *)tableName
+                            columns:(NSArray *)columns
+                              error:(NSError **)error_p;
+
+/**
+ *  Drops a full-text index and the triggers that keep it in sync.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)dropFullTextIndexWithName:(NSString *)indexName
+                            error:(NSError **)error_p;
+
+/**
+ *  Rebuilds a full-text index from its table's rows. Bulk loads are faster if the index is dropped, or its triggers
+ *  are bypassed, and the index is then rebuilt once.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)rebuildFullTextIndexWithName:(NSString *)indexName
+                               error:(NSError **)error_p;
+
+/**
+ *  Merges the segments of a full-text index into one, which makes searches faster, e.g. after a bulk load.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)optimizeFullTextIndexWithName:(NSString *)indexName
+                                error:(NSError **)error_p;
+
+// ========== SEARCH ===================================================================================================
+#pragma mark - Search
+
+/// @name Searching
+
+/**
+ *  Selects the rows of a table whose indexed text matches a full-text query.
+ *
+ *  Matches are found in the index, ranked with the BM25 algorithm and limited there, then joined to the table, so
+ *  only the returned rows are read from it. Ranks are computed by FTS5's `bm25()`, or for FTS4 indexes by an
+ *  equivalent function of `matchinfo()`. FTS4 has no `highlight()`, so for FTS4 indexes highlighted text is marked
+ *  using `offsets()`.
+ *
+ *  @param  tableName   The indexed table.
+ *  @param  text        A full-text query, e.g. `sqlite AND search*`.
+ *  @param  indexName   The table's full-text index.
+ *  @param  options     Ranking, snippet, highlight, and limit options, or `nil` for the defaults.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return The matching rows as dictionaries, with the keys requested by `options`, or `nil` if an error occurs.
+ */
+- (NSArray *)selectAllFrom:(NSString *)tableName
+              matchingText:(NSString *)text
+           inFullTextIndex:(NSString *)indexName
+                   options:(FMDBFullTextSearchOptions *)options
+                     error:(NSError **)error_p;
+
+/**
+ *  Counts the rows whose indexed text matches a full-text query, from the index alone.
+ *
+ *  @return The number of matching rows, or -1 if an error occurs.
+ */
+- (NSInteger)countMatchingText:(NSString *)text
+               inFullTextIndex:(NSString *)indexName
+                         error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,608 @@
+#import "FMDatabase+FMDBFullTextSearch.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import <objc/runtime.h>
+
+NSString * const FMDBFullTextRankKey = @"fmdb_rank";
+NSString * const FMDBFullTextSnippetKey = @"fmdb_snippet";
+NSString * const FMDBFullTextHighlightKey = @"fmdb_highlight";
+
+static NSString * const FMDBFullTextOffsetsKey = @"fmdb_offsets";
+
+static const void * FMDBFullTextFunctionsHandleKey = &FMDBFullTextFunctionsHandleKey;
+
+static const NSUInteger FMDBMaximumSnippetTokenCount = 64;
+
+// the defaults of FTS5's bm25()
+static const double FMDBBM25K1 = 1.2;
+static const double FMDBBM25B = 0.75;
+
+/**
+ *  Returns whether sqlite was built with FTS5 (3.9.0+). Otherwise indexes are created with FTS4.
+ */
+static BOOL FMDBIsFTS5Available(void)
+{
+  static BOOL isAvailable;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    isAvailable = (sqlite3_libversion_number() >= 3009000 && sqlite3_compileoption_used("ENABLE_FTS5"));
+  });
+  return isAvailable;
+}
+
+/**
+ *  Computes FTS5's bm25() rank for FTS4, from `matchinfo(index, 'pcnalx')`: a phrase's frequency is summed over all
+ *  columns, and a row's length is the total of its columns' lengths. As with bm25(), better matches have lower ranks.
+ */
+static void FMDBBM25Function(sqlite3_context * context, int argc, sqlite3_value ** argv)
+{
+  const unsigned int * matchInfo = sqlite3_value_blob(argv[0]);
+  NSUInteger valueCount = (NSUInteger)sqlite3_value_bytes(argv[0]) / sizeof(unsigned int);
+  if (matchInfo == NULL || valueCount < 3)
+  {
+    sqlite3_result_error(context, "fmdb_bm25() expects the result of matchinfo(index, 'pcnalx')", -1);
+    return;
+  }
+  
+  unsigned int phraseCount = matchInfo[0];
+  unsigned int columnCount = matchInfo[1];
+  if (valueCount < 3 + 2 * columnCount + 3 * phraseCount * columnCount)
+  {
+    sqlite3_result_error(context, "fmdb_bm25() expects the result of matchinfo(index, 'pcnalx')", -1);
+    return;
+  }
+  
+  double rowCount = matchInfo[2];
+  const unsigned int * averageLengths = matchInfo + 3;
+  const unsigned int * lengths = averageLengths + columnCount;
+  const unsigned int * hits = lengths + columnCount;
+  
+  double rowLength = 0;
+  double averageRowLength = 0;
+  for (unsigned int columnIdx = 0; columnIdx < columnCount; columnIdx++)
+  {
+    rowLength += lengths[columnIdx];
+    averageRowLength += averageLengths[columnIdx];
+  }
+  if (averageRowLength == 0)
+  {
+    averageRowLength = 1;
+  }
+  
+  double score = 0;
+  for (unsigned int phraseIdx = 0; phraseIdx < phraseCount; phraseIdx++)
+  {
+    double frequency = 0;
+    double matchingRowCount = 0;
+    for (unsigned int columnIdx = 0; columnIdx < columnCount; columnIdx++)
+    {
+      // hits in this row, hits in all rows, and rows with hits
+      const unsigned int * phraseHits = hits + 3 * (phraseIdx * columnCount + columnIdx);
+      frequency += phraseHits[0];
+      matchingRowCount = MAX(matchingRowCount, phraseHits[2]);
+    }
+    
+    double inverseFrequency = log((rowCount - matchingRowCount + 0.5) / (matchingRowCount + 0.5));
+    if (inverseFrequency <= 0)
+    {
+      inverseFrequency = 1e-6;
+    }
+    score += inverseFrequency * (frequency * (FMDBBM25K1 + 1)) /
+      (frequency + FMDBBM25K1 * (1 - FMDBBM25B + FMDBBM25B * rowLength / averageRowLength));
+  }
+  
+  sqlite3_result_double(context, -score);
+}
+
+// ========== FMDBFullTextSearchOptions ================================================================================
+#pragma mark - FMDBFullTextSearchOptions
+
+@implementation FMDBFullTextSearchOptions
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _ranked = YES;
+    _snippetTokenCount = 10;
+    _markStart = @"<b>";
+    _markEnd = @"</b>";
+    _ellipsis = @"…";
+  }
+  return self;
+}
+
+@end
+
+// ========== FMDatabase (FMDBFullTextSearch) ==========================================================================
+#pragma mark - FMDatabase (FMDBFullTextSearch)
+
+@implementation FMDatabase (FMDBFullTextSearch)
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+- (BOOL)createFullTextIndexWithName:(NSString *)indexName
+                          tableName:(NSString *)tableName
+                            columns:(NSArray *)columns
+                              error:(NSError **)error_p
+{
+  NSParameterAssert(indexName != nil);
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(columns.count > 0);
+  
+  NSArray * statements = (FMDBIsFTS5Available()
+                          ? [FMDatabase statementsToCreateFTS5Index:indexName tableName:tableName columns:columns]
+                          : [FMDatabase statementsToCreateFTS4Index:indexName tableName:tableName columns:columns]);
+  return [self executeFullTextStatementsInTransaction:statements
+                                                error:error_p];
+}
+
+- (BOOL)dropFullTextIndexWithName:(NSString *)indexName
+                            error:(NSError **)error_p
+{
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  for (NSString * event in @[ @"insert", @"delete", @"update", @"update_old", @"update_new" ])
+  {
+    [statements addObject:[@"DROP TRIGGER IF EXISTS " stringByAppendingString:
+                           [FMDatabase escapeIdentifier:[FMDatabase nameOfFullTextTriggerOnIndex:indexName
+                                                                                           event:event]]]];
+  }
+  [statements addObject:[@"DROP TABLE " stringByAppendingString:[FMDatabase escapeIdentifier:indexName]]];
+  
+  return [self executeFullTextStatementsInTransaction:statements
+                                                error:error_p];
+}
+
+- (BOOL)rebuildFullTextIndexWithName:(NSString *)indexName
+                               error:(NSError **)error_p
+{
+  return [self executeUpdate:[FMDatabase statementToCommand:@"rebuild" fullTextIndex:indexName]
+                       error:error_p];
+}
+
+- (BOOL)optimizeFullTextIndexWithName:(NSString *)indexName
+                                error:(NSError **)error_p
+{
+  return [self executeUpdate:[FMDatabase statementToCommand:@"optimize" fullTextIndex:indexName]
+                       error:error_p];
+}
+
+- (BOOL)executeFullTextStatementsInTransaction:(NSArray *)statements
+                                         error:(NSError **)error_p
+{
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return NO;
+  }
+  
+  BOOL succeeded = YES;
+  for (NSString * statement in statements)
+  {
+    succeeded = succeeded && [self executeUpdate:statement
+                                           error:error_p];
+  }
+  
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [self commit];
+      if (NO == succeeded && error_p != NULL) *error_p = self.lastError;
+    }
+    else
+    {
+      [self rollback];
+    }
+  }
+  return succeeded;
+}
+
+/**
+ *  Returns whether an index is an FTS5 table, from its schema, as it may have been created by an older sqlite.
+ */
+- (BOOL)isFTS5Index:(NSString *)indexName
+{
+  NSString * sql = [self.schemaCatalog sqlForTable:indexName].lowercaseString;
+  return ([sql rangeOfString:@"using fts5"].location != NSNotFound);
+}
+
+/**
+ *  Defines `fmdb_bm25()` on the connection, once for each time it is opened.
+ */
+- (void)defineFullTextFunctions
+{
+  NSValue * definedHandle = objc_getAssociatedObject(self, FMDBFullTextFunctionsHandleKey);
+  if (definedHandle != nil && definedHandle.pointerValue == [self sqliteHandle])
+  {
+    return;
+  }
+  
+  sqlite3_create_function([self sqliteHandle], "fmdb_bm25", 1, SQLITE_UTF8, NULL, FMDBBM25Function, NULL, NULL);
+  objc_setAssociatedObject(self,
+                           FMDBFullTextFunctionsHandleKey,
+                           [NSValue valueWithPointer:[self sqliteHandle]],
+                           OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+// ---------- STATEMENTS -----------------------------------------------------------------------------------------------
+#pragma mark Statements
+
+/**
+ *  Returns the name of a trigger that keeps an index in sync. Names are lowercase, so that they can be dropped however
+ *  the index is named.
+ */
++ (NSString *)nameOfFullTextTriggerOnIndex:(NSString *)indexName
+                                     event:(NSString *)event
+{
+  return [[NSString stringWithFormat:@"fmdb_fts_%@_%@", indexName, event] lowercaseString];
+}
+
++ (NSString *)statementToCommand:(NSString *)command
+                   fullTextIndex:(NSString *)indexName
+{
+  NSString * escapedIndexName = [FMDatabase escapeIdentifier:indexName];
+  return [NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES (%@)",
+          escapedIndexName,
+          escapedIndexName,
+          [FMDatabase escapeString:command]];
+}
+
+/**
+ *  Returns a list of columns of the given row of the table, e.g. `NEW."title", NEW."body"`.
+ */
++ (NSString *)listOfColumns:(NSArray *)columns
+                      inRow:(NSString *)row
+{
+  NSMutableArray * list = [[NSMutableArray alloc] initWithCapacity:columns.count];
+  for (NSString * column in columns)
+  {
+    [list addObject:[NSString stringWithFormat:@"%@.%@", row, [FMDatabase escapeIdentifier:column]]];
+  }
+  return [list componentsJoinedByString:@", "];
+}
+
++ (NSString *)listOfEscapedColumns:(NSArray *)columns
+{
+  NSMutableArray * list = [[NSMutableArray alloc] initWithCapacity:columns.count];
+  for (NSString * column in columns)
+  {
+    [list addObject:[FMDatabase escapeIdentifier:column]];
+  }
+  return [list componentsJoinedByString:@", "];
+}
+
++ (NSString *)statementToCreateFullTextTrigger:(NSString *)triggerName
+                                        timing:(NSString *)timing
+                                         event:(NSString *)event
+                                       onTable:(NSString *)tableName
+                                         steps:(NSArray *)steps
+{
+  NSMutableArray * createTrigger = [[NSMutableArray alloc] init];
+  [createTrigger addObject:@"CREATE TRIGGER"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:triggerName]];
+  [createTrigger addObject:timing];
+  [createTrigger addObject:event];
+  [createTrigger addObject:@"ON"];
+  [createTrigger addObject:[FMDatabase escapeIdentifier:tableName]];
+  [createTrigger addObject:@"FOR EACH ROW BEGIN"];
+  for (NSString * step in steps)
+  {
+    [createTrigger addObject:[step stringByAppendingString:@";"]];
+  }
+  [createTrigger addObject:@"END"];
+  
+  return [createTrigger componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns the statements that create an FTS5 index, the triggers that keep it in sync, and index the table's rows.
+ *  FTS5 removes a row from an external-content index given its old values, so all triggers run after the change.
+ */
++ (NSArray *)statementsToCreateFTS5Index:(NSString *)indexName
+                               tableName:(NSString *)tableName
+                                 columns:(NSArray *)columns
+{
+  NSString * escapedIndexName = [FMDatabase escapeIdentifier:indexName];
+  NSString * escapedColumns = [FMDatabase listOfEscapedColumns:columns];
+  NSString * insertStep = [NSString stringWithFormat:@"INSERT INTO %@ (rowid, %@) VALUES (NEW.rowid, %@)",
+                           escapedIndexName,
+                           escapedColumns,
+                           [FMDatabase listOfColumns:columns inRow:@"NEW"]];
+  NSString * deleteStep = [NSString stringWithFormat:@"INSERT INTO %@ (%@, rowid, %@) VALUES ('delete', OLD.rowid, %@)",
+                           escapedIndexName,
+                           escapedIndexName,
+                           escapedColumns,
+                           [FMDatabase listOfColumns:columns inRow:@"OLD"]];
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:[NSString stringWithFormat:@"CREATE VIRTUAL TABLE %@ USING fts5(%@, content=%@, "
+                         @"content_rowid='rowid')",
+                         escapedIndexName,
+                         escapedColumns,
+                         [FMDatabase escapeString:tableName]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"insert"]
+                                                        timing:@"AFTER"
+                                                         event:@"INSERT"
+                                                       onTable:tableName
+                                                         steps:@[ insertStep ]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"delete"]
+                                                        timing:@"AFTER"
+                                                         event:@"DELETE"
+                                                       onTable:tableName
+                                                         steps:@[ deleteStep ]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"update"]
+                                                        timing:@"AFTER"
+                                                         event:@"UPDATE"
+                                                       onTable:tableName
+                                                         steps:@[ deleteStep, insertStep ]]];
+  [statements addObject:[self statementToCommand:@"rebuild" fullTextIndex:indexName]];
+  return statements;
+}
+
+/**
+ *  Returns the statements that create an FTS4 index, the triggers that keep it in sync, and index the table's rows.
+ *  FTS4 reads the old values of a removed row from the table, so rows are removed from the index before they change.
+ */
++ (NSArray *)statementsToCreateFTS4Index:(NSString *)indexName
+                               tableName:(NSString *)tableName
+                                 columns:(NSArray *)columns
+{
+  NSString * escapedIndexName = [FMDatabase escapeIdentifier:indexName];
+  NSString * escapedColumns = [FMDatabase listOfEscapedColumns:columns];
+  NSString * insertStep = [NSString stringWithFormat:@"INSERT INTO %@ (docid, %@) VALUES (NEW.rowid, %@)",
+                           escapedIndexName,
+                           escapedColumns,
+                           [FMDatabase listOfColumns:columns inRow:@"NEW"]];
+  NSString * deleteStep = [NSString stringWithFormat:@"DELETE FROM %@ WHERE docid = OLD.rowid",
+                           escapedIndexName];
+  
+  NSMutableArray * statements = [[NSMutableArray alloc] init];
+  [statements addObject:[NSString stringWithFormat:@"CREATE VIRTUAL TABLE %@ USING fts4(%@, content=%@)",
+                         escapedIndexName,
+                         escapedColumns,
+                         [FMDatabase escapeString:tableName]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"insert"]
+                                                        timing:@"AFTER"
+                                                         event:@"INSERT"
+                                                       onTable:tableName
+                                                         steps:@[ insertStep ]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"delete"]
+                                                        timing:@"BEFORE"
+                                                         event:@"DELETE"
+                                                       onTable:tableName
+                                                         steps:@[ deleteStep ]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"update_old"]
+                                                        timing:@"BEFORE"
+                                                         event:@"UPDATE"
+                                                       onTable:tableName
+                                                         steps:@[ deleteStep ]]];
+  [statements addObject:[self statementToCreateFullTextTrigger:[self nameOfFullTextTriggerOnIndex:indexName
+                                                                                            event:@"update_new"]
+                                                        timing:@"AFTER"
+                                                         event:@"UPDATE"
+                                                       onTable:tableName
+                                                         steps:@[ insertStep ]]];
+  [statements addObject:[self statementToCommand:@"rebuild" fullTextIndex:indexName]];
+  return statements;
+}
+
+// ========== SEARCH ===================================================================================================
+#pragma mark - Search
+
+- (NSArray *)selectAllFrom:(NSString *)tableName
+              matchingText:(NSString *)text
+           inFullTextIndex:(NSString *)indexName
+                   options:(FMDBFullTextSearchOptions *)options
+                     error:(NSError **)error_p
+{
+  NSParameterAssert(text != nil);
+  options = options ?: [[FMDBFullTextSearchOptions alloc] init];
+  
+  BOOL isFTS5 = [self isFTS5Index:indexName];
+  if (NO == isFTS5)
+  {
+    [self defineFullTextFunctions];
+  }
+  
+  NSDictionary * indexSchema = [self.schemaCatalog schemaOfTable:indexName];
+  NSString * escapedIndexName = [FMDatabase escapeIdentifier:indexName];
+  NSString * escapedTableName = [FMDatabase escapeIdentifier:tableName];
+  NSMutableArray * columns = [[NSMutableArray alloc] init];
+  NSMutableArray * matchColumns = [[NSMutableArray alloc] init];
+  NSMutableArray * arguments = [[NSMutableArray alloc] init];
+  [columns addObject:[escapedTableName stringByAppendingString:@".*"]];
+  [matchColumns addObject:(isFTS5 ? @"rowid AS fmdb_rowid" : @"docid AS fmdb_rowid")];
+  
+  if (options.ranked)
+  {
+    NSString * rank = (isFTS5
+                       ? [NSString stringWithFormat:@"bm25(%@)", escapedIndexName]
+                       : [NSString stringWithFormat:@"fmdb_bm25(matchinfo(%@, 'pcnalx'))", escapedIndexName]);
+    [matchColumns addObject:[NSString stringWithFormat:@"%@ AS %@", rank, FMDBFullTextRankKey]];
+    [columns addObject:[@"m." stringByAppendingString:FMDBFullTextRankKey]];
+  }
+  
+  if (options.snippetColumn != nil)
+  {
+    NSNumber * columnIdx = indexSchema[options.snippetColumn][@"cid"];
+    NSParameterAssert(columnIdx != nil);
+    NSUInteger tokenCount = MAX(MIN(options.snippetTokenCount, FMDBMaximumSnippetTokenCount), 1);
+    NSString * snippet = (isFTS5
+                          ? [NSString stringWithFormat:@"snippet(%@, %@, ?, ?, ?, %lu)",
+                             escapedIndexName,
+                             columnIdx,
+                             (unsigned long)tokenCount]
+                          : [NSString stringWithFormat:@"snippet(%@, ?, ?, ?, %@, %lu)",
+                             escapedIndexName,
+                             columnIdx,
+                             (unsigned long)tokenCount]);
+    [matchColumns addObject:[NSString stringWithFormat:@"%@ AS %@", snippet, FMDBFullTextSnippetKey]];
+    [columns addObject:[@"m." stringByAppendingString:FMDBFullTextSnippetKey]];
+    [arguments addObjectsFromArray:@[ options.markStart, options.markEnd, options.ellipsis ]];
+  }
+  
+  NSNumber * highlightColumnIdx = nil;
+  if (options.highlightColumn != nil)
+  {
+    highlightColumnIdx = indexSchema[options.highlightColumn][@"cid"];
+    NSParameterAssert(highlightColumnIdx != nil);
+    if (isFTS5)
+    {
+      [matchColumns addObject:[NSString stringWithFormat:@"highlight(%@, %@, ?, ?) AS %@",
+                               escapedIndexName,
+                               highlightColumnIdx,
+                               FMDBFullTextHighlightKey]];
+      [columns addObject:[@"m." stringByAppendingString:FMDBFullTextHighlightKey]];
+      [arguments addObjectsFromArray:@[ options.markStart, options.markEnd ]];
+    }
+    else
+    {
+      [matchColumns addObject:[NSString stringWithFormat:@"offsets(%@) AS %@",
+                               escapedIndexName,
+                               FMDBFullTextOffsetsKey]];
+      [columns addObject:[@"m." stringByAppendingString:FMDBFullTextOffsetsKey]];
+    }
+  }
+  
+  // matches are ranked and limited in the index, so that only the returned rows are read from the table
+  // an offset needs a limit, and a negative limit is no limit
+  NSNumber * limit = options.limit ?: (options.offset != nil ? @(-1) : nil);
+  [arguments addObject:text];
+  if (limit != nil)
+  {
+    [arguments addObject:limit];
+  }
+  if (limit != nil && options.offset != nil)
+  {
+    [arguments addObject:options.offset];
+  }
+  NSString * matchSQL = [FMDatabase statementToSelect:matchColumns
+                                                 from:escapedIndexName
+                                                where:[NSString stringWithFormat:@"%@ MATCH ?", escapedIndexName]
+                                              groupBy:nil
+                                               having:nil
+                                              orderBy:(options.ranked ? FMDBFullTextRankKey : nil)
+                                                limit:limit
+                                               offset:options.offset];
+  
+  NSString * from = [NSString stringWithFormat:@"(%@) AS m JOIN %@ ON %@.rowid = m.fmdb_rowid",
+                     matchSQL,
+                     escapedTableName,
+                     escapedTableName];
+  NSString * orderBy = (options.ranked ? [@"m." stringByAppendingString:FMDBFullTextRankKey] : nil);
+  FMResultSet * results = [self selectResults:columns
+                                         from:from
+                                        where:nil
+                                      groupBy:nil
+                                       having:nil
+                                    arguments:arguments
+                                      orderBy:orderBy
+                                        limit:nil
+                                       offset:nil
+                                        error:error_p];
+  if (results == nil)
+  {
+    return nil;
+  }
+  
+  NSArray * records = results.allRecords;
+  if ([self hadError])
+  {
+    if (error_p != NULL) *error_p = [self lastStatementError];
+    return nil;
+  }
+  
+  if (highlightColumnIdx != nil && NO == isFTS5)
+  {
+    records = [FMDatabase recordsHighlightingOffsets:records
+                                            inColumn:options.highlightColumn
+                                         columnIndex:highlightColumnIdx.intValue
+                                             options:options];
+  }
+  return records;
+}
+
+- (NSInteger)countMatchingText:(NSString *)text
+               inFullTextIndex:(NSString *)indexName
+                         error:(NSError **)error_p
+{
+  NSParameterAssert(text != nil);
+  
+  NSString * escapedIndexName = [FMDatabase escapeIdentifier:indexName];
+  return [self count:nil
+                from:escapedIndexName
+               where:[NSString stringWithFormat:@"%@ MATCH ?", escapedIndexName]
+           arguments:@[ text ]
+               error:error_p];
+}
+
+/**
+ *  Replaces the `offsets()` of each FTS4 record with the text of a column with each matched term marked. Offsets are
+ *  quadruples of a column index, term index, and the byte offset and length of the term in the column's UTF-8 text.
+ */
++ (NSArray *)recordsHighlightingOffsets:(NSArray *)records
+                               inColumn:(NSString *)columnName
+                            columnIndex:(int)columnIdx
+                                options:(FMDBFullTextSearchOptions *)options
+{
+  NSData * markStart = [options.markStart dataUsingEncoding:NSUTF8StringEncoding];
+  NSData * markEnd = [options.markEnd dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableArray * highlightedRecords = [[NSMutableArray alloc] initWithCapacity:records.count];
+  for (NSDictionary * record in records)
+  {
+    NSMutableDictionary * highlightedRecord = [record mutableCopy];
+    [highlightedRecord removeObjectForKey:FMDBFullTextOffsetsKey];
+    
+    id value = record[columnName];
+    if (NO == [value isKindOfClass:[NSString class]])
+    {
+      highlightedRecord[FMDBFullTextHighlightKey] = value ?: [NSNull null];
+      [highlightedRecords addObject:highlightedRecord];
+      continue;
+    }
+    
+    NSData * utf8Text = [value dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData * highlightedText = [[NSMutableData alloc] initWithCapacity:utf8Text.length];
+    NSUInteger copiedLength = 0;
+    
+    // offsets are in the order the terms occur in the text, and terms don't overlap
+    NSArray * offsets = [record[FMDBFullTextOffsetsKey] componentsSeparatedByString:@" "];
+    for (NSUInteger offsetIdx = 0; offsetIdx + 3 < offsets.count; offsetIdx += 4)
+    {
+      NSUInteger termStart = (NSUInteger)[offsets[offsetIdx + 2] integerValue];
+      NSUInteger termLength = (NSUInteger)[offsets[offsetIdx + 3] integerValue];
+      if ([offsets[offsetIdx] intValue] != columnIdx ||
+          termStart < copiedLength ||
+          termStart + termLength > utf8Text.length)
+      {
+        continue;
+      }
+      
+      [highlightedText appendBytes:(const uint8_t *)utf8Text.bytes + copiedLength length:termStart - copiedLength];
+      [highlightedText appendData:markStart];
+      [highlightedText appendBytes:(const uint8_t *)utf8Text.bytes + termStart length:termLength];
+      [highlightedText appendData:markEnd];
+      copiedLength = termStart + termLength;
+    }
+    [highlightedText appendBytes:(const uint8_t *)utf8Text.bytes + copiedLength length:utf8Text.length - copiedLength];
+    
+    highlightedRecord[FMDBFullTextHighlightKey] = [[NSString alloc] initWithData:highlightedText
+                                                                        encoding:NSUTF8StringEncoding];
+    [highlightedRecords addObject:highlightedRecord];
+  }
+  return highlightedRecords;
+}
+
+@end
@@ -114,6 +114,8 @@ withParameterDictionary:(NSDictionary *)parameters
 /***
  *  Queries the entire database schema.
  *
+ *  Schema queries are answered from `-schemaCatalog`, which is only re-read when the schema changes.
+ *
  *  @return A dictionary whose keys are table names, and whose values are dictionaries matching the output of
  *          `-tableSchema:`
  */
@@ -359,6 +361,38 @@ withParameterDictionary:(NSDictionary *)parameters
                    orderBy:(NSString *)orderBy
                      error:(NSError **)error_p;
 
+/**
+ *  Reads rows from a table that match `where`, passing each to `block` as an `NSDictionary`. Unlike
+ *  `-selectAllFrom:where:arguments:orderBy:error:`, only the current row is held in memory.
+ *
+ *  @param  from        The table name, plus any joins.
+ *  @param  where       An optional WHERE clause.
+ *  @param  arguments   Optional arguments to the WHERE clause. Use '?' in `where` to bind them.
+ *  @param  orderBy     An optional ORDER BY clause.
+ *  @param  block       Called with each row. Set `*stop` to `YES` to stop reading rows.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)enumerateAllFrom:(NSString *)from
+                   where:(NSString *)where
+               arguments:(NSArray *)arguments
+                 orderBy:(NSString *)orderBy
+              usingBlock:(void (^)(NSDictionary * record, BOOL * stop))block
+                   error:(NSError **)error_p;
+
+/**
+ *  Fetches rows from a table that match `where`, and returns an array that reads them on demand. See
+ *  `-[FMResultSet lazyRecords]`.
+ *
+ *  @return An array of each selected row, as an `NSDictionary`, or `nil` if an error occurs.
+ */
+- (NSArray *)lazySelectAllFrom:(NSString *)from
+                         where:(NSString *)where
+                     arguments:(NSArray *)arguments
+                       orderBy:(NSString *)orderBy
+                         error:(NSError **)error_p;
+
 // ---------- RESULTS --------------------------------------------------------------------------------------------------
 #pragma mark Results
 
@@ -404,6 +438,9 @@ withParameterDictionary:(NSDictionary *)parameters
  *  Fetches rows from a table that match the given values and returns them as an `FMResultSet`. `valuesToMatch` contains
  *  column values keyed by the column name. Values can be strings, numbers, and NSArray instances. Only rows that match
  *  all values will be returned. When an array value is provided, rows that match any of the given values are returned.
+ *  An array of column names can be used as a key to match tuples of values, and once `matchingSetThreshold` is set,
+ *  arrays with more values than it are matched by loading them into a temporary table. See
+ *  `-prepareMatchingValues:preparedValues:error:`.
  *
  *  For example, the following returns all people named "Amelia" with any of the given titles (Mrs., Ms., or Mme.).
  *
@@ -545,4 +582,86 @@ withParameterDictionary:(NSDictionary *)parameters
               arguments:(NSArray *)arguments
                   error:(NSError **)error_p;
 
+// ========== STATEMENTS ===============================================================================================
+#pragma mark - Statements
+
+/// @name Building Statements
+
+/**
+ *  Returns a comma-separated list of the given columns, or `*` if `columnNames` is `nil`.
+ */
++ (NSString *)listOfColumns:(NSArray *)columnNames;
+
+/**
+ *  Returns the keys of a `matchingValues` dictionary in the order their columns are matched. Keys are column names, or
+ *  arrays of column names when matching tuples.
+ */
++ (NSArray *)columnKeysOfMatchingValues:(NSDictionary *)valuesToMatch;
+
+/**
+ *  Returns a WHERE clause that matches all values in `valuesToMatch`, as described in
+ *  `-selectResults:from:matchingValues:orderBy:limit:offset:error:`. Columns are matched in sorted order. Large sets of
+ *  keys are only matched with a table if they have been loaded by `-prepareMatchingValues:preparedValues:error:`.
+ *
+ *  @param  valuesToMatch A dictionary of values to match, keyed by the column names.
+ *  @param  arguments_p   Returns the arguments to bind to the clause.
+ */
++ (NSString *)whereClauseToMatchValues:(NSDictionary *)valuesToMatch
+                             arguments:(NSArray **)arguments_p;
+
+/**
+ *  Returns the arguments to bind to the clause returned by `+whereClauseToMatchValues:arguments:`, without building
+ *  the clause itself.
+ */
++ (NSArray *)argumentsToMatchValues:(NSDictionary *)valuesToMatch;
+
+/**
+ *  Returns an INSERT statement with `rowCount` tuples of arguments, or DEFAULT VALUES if `rowCount` is 0.
+ */
++ (NSString *)statementToInsertInto:(NSString *)tableName
+                            columns:(NSArray *)columnNames
+                           rowCount:(NSUInteger)rowCount;
+
+/**
+ *  Returns a SELECT statement that counts the given columns.
+ */
++ (NSString *)statementToCount:(NSArray *)columnNames
+                          from:(NSString *)from
+                         where:(NSString *)where;
+
+/**
+ *  Returns whether the limit and offset of a SELECT statement with the given clauses are bound as `?` placeholders.
+ *  They are, unless a clause uses named (`:name`) or numbered (`?NNN`) parameters, which a trailing `?` wouldn't
+ *  follow.
+ */
++ (BOOL)bindsLimitOfStatementWithClauses:(NSArray *)clauses;
+
+/**
+ *  Returns a SELECT statement. A limit and offset are included as `?` placeholders, so their values must be bound as
+ *  the statement's final arguments, unless `+bindsLimitOfStatementWithClauses:` returns `NO` for the statement's
+ *  clauses, in which case they are written into the statement.
+ */
++ (NSString *)statementToSelect:(NSArray *)columnNames
+                           from:(NSString *)from
+                          where:(NSString *)where
+                        groupBy:(NSString *)groupBy
+                         having:(NSString *)having
+                        orderBy:(NSString *)orderBy
+                          limit:(NSNumber *)limit
+                         offset:(NSNumber *)offset;
+
+/**
+ *  Returns an UPDATE statement that sets each column to the matching expression.
+ */
++ (NSString *)statementToUpdate:(NSString *)tableName
+                        columns:(NSArray *)columnNames
+                    expressions:(NSArray *)expressions
+                          where:(NSString *)where;
+
+/**
+ *  Returns a DELETE statement.
+ */
++ (NSString *)statementToDeleteFrom:(NSString *)tableName
+                              where:(NSString *)where;
+
 @end
@@ -1,4 +1,12 @@
 #import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBCountedTables.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBIndexAdvisor.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import "FMDatabase+FMDBResultCache.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMDatabase+FMDBStatementCache.h"
 #import "FMResultSet+FMDBHelpers.h"
 #import <FMDB/FMDatabaseAdditions.h>
 
@@ -115,11 +123,11 @@
   }
 #endif
   
-  BOOL successful = [self executeUpdate:sql
-                   withArgumentsInArray:arguments];
+  BOOL successful = [self executeProfiledUpdate:sql
+                           withArgumentsInArray:arguments];
   if (NO == successful && error_p != NULL)
   {
-    *error_p = self.lastError;
+    *error_p = [self lastStatementError];
   }
   return successful;
 }
@@ -139,7 +147,7 @@ withParameterDictionary:(NSDictionary *)arguments
                 withParameterDictionary:arguments];
   if (NO == successful && error_p != NULL)
   {
-    *error_p = self.lastError;
+    *error_p = [self lastStatementError];
   }
   return successful;
 }
@@ -149,10 +157,11 @@ withParameterDictionary:(NSDictionary *)arguments
 
 - (NSDictionary *)databaseSchema
 {
+  FMDBSchemaCatalog * catalog = [self schemaCatalog];
   NSMutableDictionary * tableSchemas = [[NSMutableDictionary alloc] init];
-  for (NSString * tableName in self.tableNames)
+  for (NSString * tableName in catalog.tableNames)
   {
-    NSDictionary * tableSchema = [self tableSchema:tableName];
+    NSDictionary * tableSchema = [catalog schemaOfTable:tableName];
     if (tableSchema != nil)
     {
       tableSchemas[tableName] = tableSchema;
@@ -164,6 +173,13 @@ withParameterDictionary:(NSDictionary *)arguments
 
 - (NSDictionary *)tableSchema:(NSString *)tableName
 {
+  NSDictionary * catalogSchema = [[self schemaCatalog] schemaOfTable:tableName];
+  if (catalogSchema != nil)
+  {
+    return catalogSchema;
+  }
+  
+  // views, and tables the catalog leaves out, are read with PRAGMA table_info
   NSMutableDictionary * tableSchema = [[NSMutableDictionary alloc] init];
   FMResultSet * resultSet = [self getTableSchema:tableName];
   while ([resultSet next])
@@ -174,43 +190,30 @@ withParameterDictionary:(NSDictionary *)arguments
       NSString * name = [resultSet columnNameForIndex:columnIndex];
       columnInfo[name] = resultSet[columnIndex];
     }
-    tableSchema[columnInfo[@"name"]] = columnInfo;
+    tableSchema[columnInfo[@"name"]] = [columnInfo copy];
   }
   
-  return tableSchema;
+  return [tableSchema copy];
 }
 
 - (NSSet *)tableNames
 {
-  FMResultSet * schema = [self getSchema];
-  NSMutableSet * tableNames = [[NSMutableSet alloc] init];
-  while ([schema next])
-  {
-    NSString * type = [schema stringForColumn:@"type"];
-    if ([type isEqualToString:@"table"])
-    {
-      [tableNames addObject:[schema stringForColumn:@"name"]];
-    }
-  }
-  return tableNames;
+  return [self schemaCatalog].tableNames ?: [NSSet set];
 }
 
 
 - (NSSet *)indexNamesOnTable:(NSString *)tableName
 {
-  FMResultSet * schema = [self getSchema];
-  NSMutableSet * indexNames = [[NSMutableSet alloc] init];
-  while ([schema next])
-  {
-    NSString * type = [schema stringForColumn:@"type"];
-    NSString * indexTableName = [schema stringForColumn:@"tbl_name"];
-    if ([type isEqualToString:@"index"]
-        && [indexTableName isEqualToString:tableName])
-    {
-      [indexNames addObject:[schema stringForColumn:@"name"]];
-    }
-  }
-  return indexNames;
+  return [[self schemaCatalog] indexNamesOnTable:tableName] ?: [NSSet set];
+}
+
+- (BOOL)executeSchemaChange:(NSString *)sql
+                      error:(NSError **)error_p
+{
+  // temporary tables don't change the main database's schema_version, so the catalog is discarded explicitly
+  [self invalidateSchemaCatalog];
+  return [self executeUpdate:sql
+                       error:error_p];
 }
 
 // ========== TABLES ===================================================================================================
@@ -268,8 +271,8 @@ withParameterDictionary:(NSDictionary *)arguments
 
   [createTable addObject:@")"];
   
-  return [self executeUpdate:[createTable componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[createTable componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 - (BOOL)renameTable:(NSString *)tableName
@@ -282,8 +285,8 @@ withParameterDictionary:(NSDictionary *)arguments
   [renameTable addObject:@"RENAME TO"];
   [renameTable addObject:[FMDatabase escapeIdentifier:newTableName]];
   
-  return [self executeUpdate:[renameTable componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[renameTable componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 - (BOOL)addColumn:(NSString *)columnDefinition
@@ -296,8 +299,8 @@ withParameterDictionary:(NSDictionary *)arguments
   [addColumn addObject:@"ADD COLUMN"];
   [addColumn addObject:columnDefinition];
   
-  return [self executeUpdate:[addColumn componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[addColumn componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 - (BOOL)dropTableWithName:(NSString *)tableName
@@ -330,8 +333,8 @@ withParameterDictionary:(NSDictionary *)arguments
   
   [dropTable addObject:[FMDatabase escapeIdentifier:tableName]];
 
-  return [self executeUpdate:[dropTable componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[dropTable componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 // ========== INDEXES ==================================================================================================
@@ -379,8 +382,8 @@ withParameterDictionary:(NSDictionary *)arguments
   [createIndex addObject:[columns componentsJoinedByString:@", "]]; 
   [createIndex addObject:@")"];
   
-  return [self executeUpdate:[createIndex componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[createIndex componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 
@@ -391,8 +394,8 @@ withParameterDictionary:(NSDictionary *)arguments
   [dropIndex addObject:@"DROP INDEX"];
   [dropIndex addObject:[FMDatabase escapeIdentifier:indexName]];
   
-  return [self executeUpdate:[dropIndex componentsJoinedByString:@" "]
-                       error:error_p];
+  return [self executeSchemaChange:[dropIndex componentsJoinedByString:@" "]
+                             error:error_p];
 }
 
 // ========== INSERT ===================================================================================================
@@ -415,15 +418,10 @@ withParameterDictionary:(NSDictionary *)arguments
   return [tupleString componentsJoinedByString:@" "];
 }
 
-- (BOOL)insertInto:(NSString *)tableName
-           columns:(NSArray *)columnNames
-            values:(NSArray *)values
-             error:(NSError **)error_p
++ (NSString *)statementToInsertInto:(NSString *)tableName
+                            columns:(NSArray *)columnNames
+                           rowCount:(NSUInteger)rowCount
 {
-  NSParameterAssert(columnNames != nil);
-  NSParameterAssert(columnNames.count > 0);
-  NSParameterAssert(tableName != nil);
-  
   NSMutableArray * insertSQL = [[NSMutableArray alloc] init];
   
   [insertSQL addObject:@"INSERT INTO"];
@@ -444,8 +442,7 @@ withParameterDictionary:(NSDictionary *)arguments
     [insertSQL addObject:@")"];
   }
   
-  NSMutableArray * flattenedValues = [[NSMutableArray alloc] initWithCapacity:(columnNames.count * values.count)];
-  if (values.count == 0)
+  if (rowCount == 0)
   {
     [insertSQL addObject:@"DEFAULT VALUES"];
   }
@@ -454,30 +451,63 @@ withParameterDictionary:(NSDictionary *)arguments
     [insertSQL addObject:@"VALUES"];
     
     NSString * argumentTuple = [FMDatabase argumentTupleOfSize:columnNames.count];
-    
-    [values enumerateObjectsUsingBlock:^(NSArray * row, NSUInteger rowIdx, BOOL *stop) {
-      
-      NSParameterAssert(row.count == columnNames.count);
+    for (NSUInteger rowIdx = 0; rowIdx < rowCount; rowIdx++)
+    {
       if (rowIdx > 0)
       {
         [insertSQL addObject:@","];
       }
       
       [insertSQL addObject:argumentTuple];
-      [flattenedValues addObjectsFromArray:row];
-    }];
+    }
   }
   
-  return [self executeUpdate:[insertSQL componentsJoinedByString:@" "]
-        withArgumentsInArray:flattenedValues
-                       error:error_p];
+  return [insertSQL componentsJoinedByString:@" "];
+}
+
+- (BOOL)insertInto:(NSString *)tableName
+           columns:(NSArray *)columnNames
+            values:(NSArray *)values
+             error:(NSError **)error_p
+{
+  NSParameterAssert(columnNames != nil);
+  NSParameterAssert(columnNames.count > 0);
+  NSParameterAssert(tableName != nil);
+  
+  NSMutableArray * flattenedValues = [[NSMutableArray alloc] initWithCapacity:(columnNames.count * values.count)];
+  for (NSArray * row in values)
+  {
+    NSParameterAssert(row.count == columnNames.count);
+    [flattenedValues addObjectsFromArray:row];
+  }
+  
+  NSString * insertSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"INSERT",
+                                                       tableName,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       @(values.count) ]];
+  } build:^NSString *{
+    return [FMDatabase statementToInsertInto:tableName
+                                     columns:columnNames
+                                    rowCount:values.count];
+  }];
+  
+  BOOL inserted = [self executeUpdate:insertSQL
+                 withArgumentsInArray:flattenedValues
+                                error:error_p];
+  if (inserted)
+  {
+    [self invalidateResultCacheForTable:tableName];
+  }
+  return inserted;
 }
 
 - (NSNumber *)insertInto:(NSString *)tableName
                      row:(NSDictionary *)rowValues
                    error:(NSError **)error_p
 {
-  NSArray * columns = rowValues.allKeys;
+  // columns are sorted so that rows with the same keys share a statement
+  NSArray * columns = [rowValues.allKeys sortedArrayUsingSelector:@selector(compare:)];
   NSMutableArray * values = [[NSMutableArray alloc] init];
   for (NSString * column in columns)
   {
@@ -508,7 +538,7 @@ withParameterDictionary:(NSDictionary *)arguments
   [countColumn appendString:@"count("];
   [countColumn appendString:[FMDatabase listOfColumns:columnNames]];
   [countColumn appendString:@")"];
-
+  
   return [self statementToSelect:@[ countColumn ]
                             from:from
                            where:where
@@ -544,15 +574,46 @@ withParameterDictionary:(NSDictionary *)arguments
     matchingValues:(NSDictionary *)valuesToMatch
              error:(NSError **)error_p
 {
-  NSArray * arguments = nil;
-  NSString * where = [FMDatabase whereClauseToMatchValues:valuesToMatch
-                                                arguments:&arguments];
+  if (columnNames == nil && self.shouldUseMaintainedCounts)
+  {
+    NSNumber * maintainedCount = [self maintainedCountFrom:from
+                                            matchingValues:valuesToMatch];
+    if (maintainedCount != nil)
+    {
+      return maintainedCount.integerValue;
+    }
+  }
   
-  return [self count:columnNames
-                from:from
-               where:where
-           arguments:arguments
-               error:error_p];
+  NSDictionary * preparedValues = nil;
+  if (NO == [self prepareMatchingValues:valuesToMatch
+                         preparedValues:&preparedValues
+                                  error:error_p])
+  {
+    return -1;
+  }
+  
+  NSString * countSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"COUNT",
+                                                       from,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       [FMDatabase statementShapeOfMatchingValues:preparedValues] ]];
+  } build:^NSString *{
+    return [FMDatabase statementToCount:columnNames
+                                   from:from
+                                  where:[FMDatabase whereClauseToMatchValues:preparedValues
+                                                                   arguments:NULL]];
+  }];
+  
+  NSArray * arguments = [FMDatabase argumentsToMatchValues:preparedValues];
+  [self adviseIndexesForStatement:countSQL
+                        arguments:arguments
+                        tableName:from
+                   matchingValues:preparedValues
+                          orderBy:nil];
+  
+  return [self countWithStatement:countSQL
+                        arguments:arguments
+                            error:error_p];
 }
 
 - (NSInteger)count:(NSArray *)columnNames
@@ -561,17 +622,70 @@ withParameterDictionary:(NSDictionary *)arguments
          arguments:(NSArray *)arguments
              error:(NSError **)error_p
 {
-  NSString * countSQL = [FMDatabase statementToCount:columnNames
-                                                from:from
-                                               where:where];
+  if (columnNames == nil && where == nil && self.shouldUseMaintainedCounts)
+  {
+    NSNumber * maintainedCount = [self maintainedCountFrom:from
+                                            matchingValues:nil];
+    if (maintainedCount != nil)
+    {
+      return maintainedCount.integerValue;
+    }
+  }
   
-  FMResultSet * results = [self executeQuery:countSQL
-                        withArgumentsInArray:arguments];
+  NSString * countSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"COUNT",
+                                                       from,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       where ?: @"" ]];
+  } build:^NSString *{
+    return [FMDatabase statementToCount:columnNames
+                                   from:from
+                                  where:where];
+  }];
+  
+  return [self countWithStatement:countSQL
+                        arguments:arguments
+                            error:error_p];
+}
+
+- (NSInteger)countWithStatement:(NSString *)countSQL
+                      arguments:(NSArray *)arguments
+                          error:(NSError **)error_p
+{
+  NSNumber * count = [self cachedResultOfStatement:countSQL
+                                         arguments:arguments
+                                             error:error_p
+                                             query:^id(NSError ** error_p) {
+    NSInteger rowCount = [self countUncachedWithStatement:countSQL
+                                                arguments:arguments
+                                                    error:error_p];
+    return (rowCount >= 0 ? @(rowCount) : nil);
+  }];
+  return (count != nil ? count.integerValue : -1);
+}
+
+- (NSInteger)countUncachedWithStatement:(NSString *)countSQL
+                              arguments:(NSArray *)arguments
+                                  error:(NSError **)error_p
+{
+  FMResultSet * results = [self executeProfiledQuery:countSQL
+                                withArgumentsInArray:arguments];
   if (results == nil)
   {
+    if (error_p != NULL)
+    {
+      *error_p = [self lastStatementError];
+    }
     return -1;
   }
-  else if ([results next])
+  
+  id profilingToken = [results beginProfiledSteps];
+  BOOL hasRow = [results next];
+  [results endProfiledSteps:profilingToken
+                   rowCount:(hasRow ? 1 : 0)
+                   finished:YES];
+  
+  if (hasRow)
   {
     if (sizeof(NSInteger) == sizeof(long))
     {
@@ -586,8 +700,20 @@ withParameterDictionary:(NSDictionary *)arguments
         return count;
     }
   }
+  else if ([self hadError])
+  {
+    // e.g. the statement was interrupted; the error is read before the results are closed
+    if (error_p != NULL)
+    {
+      *error_p = [self lastStatementError];
+    }
+    [results close];
+    return -1;
+  }
   else
   {
+    // close the results so a cached statement can be reused
+    [results close];
     return 0;
   }
 }
@@ -599,16 +725,11 @@ withParameterDictionary:(NSDictionary *)arguments
                    orderBy:(NSString *)orderBy
                      error:(NSError **)error_p
 {
-  return [self selectResults:nil
-                        from:tableName
+  return [self selectAllFrom:tableName
                        where:nil
-                     groupBy:nil
-                      having:nil
                    arguments:nil
                      orderBy:orderBy
-                       limit:nil
-                      offset:nil
-                       error:error_p].allRecords;
+                       error:error_p];
 }
 
 - (NSArray *)selectAllFrom:(NSString *)from
@@ -616,6 +737,83 @@ withParameterDictionary:(NSDictionary *)arguments
                  arguments:(NSArray *)arguments
                    orderBy:(NSString *)orderBy
                      error:(NSError **)error_p
+{
+  NSString * selectSQL = [self cachedStatementToSelect:nil
+                                                  from:from
+                                                 where:where
+                                               groupBy:nil
+                                                having:nil
+                                               orderBy:orderBy
+                                                 limit:nil
+                                                offset:nil];
+  
+  return [self cachedResultOfStatement:selectSQL
+                             arguments:arguments
+                                 error:error_p
+                                 query:^id(NSError ** error_p) {
+    FMResultSet * results = [self selectResultsWithStatement:selectSQL
+                                                   arguments:arguments
+                                                       error:error_p];
+    NSArray * records = results.allRecords;
+    if (results != nil && [self hadError])
+    {
+      if (error_p != NULL)
+      {
+        *error_p = [self lastStatementError];
+      }
+      return nil;
+    }
+    
+    if (records == nil || NO == self.shouldCacheResults)
+    {
+      return records;
+    }
+    
+    // cached records are shared, so they are made immutable
+    return [[NSArray alloc] initWithArray:records copyItems:YES];
+  }];
+}
+
+- (BOOL)enumerateAllFrom:(NSString *)from
+                   where:(NSString *)where
+               arguments:(NSArray *)arguments
+                 orderBy:(NSString *)orderBy
+              usingBlock:(void (^)(NSDictionary * record, BOOL * stop))block
+                   error:(NSError **)error_p
+{
+  FMResultSet * results = [self selectResults:nil
+                                         from:from
+                                        where:where
+                                      groupBy:nil
+                                       having:nil
+                                    arguments:arguments
+                                      orderBy:orderBy
+                                        limit:nil
+                                       offset:nil
+                                        error:error_p];
+  if (results == nil)
+  {
+    return NO;
+  }
+  
+  [results enumerateRecordsUsingBlock:block];
+  if ([self hadError])
+  {
+    if (error_p != NULL)
+    {
+      *error_p = [self lastStatementError];
+    }
+    return NO;
+  }
+  
+  return YES;
+}
+
+- (NSArray *)lazySelectAllFrom:(NSString *)from
+                         where:(NSString *)where
+                     arguments:(NSArray *)arguments
+                       orderBy:(NSString *)orderBy
+                         error:(NSError **)error_p
 {
   return [self selectResults:nil
                         from:from
@@ -626,12 +824,24 @@ withParameterDictionary:(NSDictionary *)arguments
                      orderBy:orderBy
                        limit:nil
                       offset:nil
-                       error:error_p].allRecords;
+                       error:error_p].lazyRecords;
 }
 
 // ---------- RESULTS --------------------------------------------------------------------------------------------------
 #pragma mark Results
 
++ (NSArray *)columnKeysOfMatchingValues:(NSDictionary *)valuesToMatch
+{
+  // columns are sorted so that equivalent dictionaries always produce the same statement
+  return [valuesToMatch.allKeys sortedArrayUsingComparator:^NSComparisonResult(id columnKey1, id columnKey2) {
+    NSString * columns1 = ([columnKey1 isKindOfClass:[NSArray class]] ? [columnKey1 componentsJoinedByString:@","]
+                                                                      : columnKey1);
+    NSString * columns2 = ([columnKey2 isKindOfClass:[NSArray class]] ? [columnKey2 componentsJoinedByString:@","]
+                                                                      : columnKey2);
+    return [columns1 compare:columns2];
+  }];
+}
+
 + (NSString *)whereClauseToMatchValues:(NSDictionary *)valuesToMatch
                              arguments:(NSArray **)arguments_p
 {
@@ -641,52 +851,207 @@ withParameterDictionary:(NSDictionary *)arguments
     return @"1";
   }
   
+  NSArray * columnKeys = [FMDatabase columnKeysOfMatchingValues:valuesToMatch];
+  
   NSMutableArray * where = [[NSMutableArray alloc] init];
   NSMutableArray * arguments  = [[NSMutableArray alloc] initWithCapacity:valuesToMatch.count];
-  [valuesToMatch enumerateKeysAndObjectsUsingBlock:^(NSString * columnName, id value, BOOL *stop) {
+  for (id columnKey in columnKeys)
+  {
+    id value = valuesToMatch[columnKey];
     
     if (where.count > 0)
     {
       [where addObject:@"AND"];
     }
     
-    [where addObject:[FMDatabase escapeIdentifier:columnName]];
-    
-    if (value == [NSNull null])
+    if ([value isKindOfClass:[FMDBMatchingSet class]])
     {
-      [where addObject:@"IS NULL"];
+      [where addObject:[FMDatabase conditionToMatchColumns:columnKey
+                                                    inSet:value]];
     }
-    else if ([value isKindOfClass:[NSArray class]])
+    else if ([columnKey isKindOfClass:[NSArray class]])
+    {
+      [where addObject:[FMDatabase conditionToMatchColumns:columnKey
+                                                 inTuples:value]];
+      for (NSArray * tuple in value)
+      {
+        NSParameterAssert(tuple.count == [columnKey count]);
+        [arguments addObjectsFromArray:tuple];
+      }
+    }
+    else
     {
-      [where addObject:@"IN ("];
+      [where addObject:[FMDatabase escapeIdentifier:columnKey]];
       
-      BOOL isFirst = YES;
-      for (id arg in value)
+      if (value == [NSNull null])
+      {
+        [where addObject:@"IS NULL"];
+      }
+      else if ([value isKindOfClass:[NSArray class]])
       {
-        if (!isFirst) {
-          [where addObject:@","];
+        [where addObject:@"IN ("];
+        
+        BOOL isFirst = YES;
+        for (id arg in value)
+        {
+          if (!isFirst) {
+            [where addObject:@","];
+          }
+          [where addObject:@"?"];
+          isFirst = NO;
+          
+          [arguments addObject:arg];
         }
-        [where addObject:@"?"];
-        isFirst = NO;
+        
+        [where addObject:@")"];
+      }
+      else
+      {
+        [where addObject:@"= ?"];
+        [arguments addObject:value];
+      }
+    }
+  }
+  
+  if (arguments_p != NULL)
+  {
+    *arguments_p = arguments;
+  }
+  
+  return [where componentsJoinedByString:@" "];
+}
 
-        [arguments addObject:arg];
++ (NSString *)conditionToMatchColumns:(id)columnKey
+                                inSet:(FMDBMatchingSet *)matchingSet
+{
+  NSMutableArray * condition = [[NSMutableArray alloc] init];
+  if ([columnKey isKindOfClass:[NSArray class]])
+  {
+    // the key columns have names that can't be mistaken for the outer table's columns
+    [condition addObject:@"EXISTS (SELECT 1 FROM"];
+    [condition addObject:matchingSet.tableName];
+    [condition addObject:@"WHERE"];
+    [columnKey enumerateObjectsUsingBlock:^(NSString * columnName, NSUInteger columnIdx, BOOL *stop) {
+      if (columnIdx > 0)
+      {
+        [condition addObject:@"AND"];
       }
       
-      [where addObject:@")"];
+      [condition addObject:matchingSet.keyColumnNames[columnIdx]];
+      [condition addObject:@"="];
+      [condition addObject:[FMDatabase escapeIdentifier:columnName]];
+    }];
+    [condition addObject:@")"];
+  }
+  else
+  {
+    [condition addObject:[FMDatabase escapeIdentifier:columnKey]];
+    [condition addObject:@"IN (SELECT"];
+    [condition addObject:matchingSet.keyColumnNames[0]];
+    [condition addObject:@"FROM"];
+    [condition addObject:matchingSet.tableName];
+    [condition addObject:@")"];
+  }
+  
+  return [condition componentsJoinedByString:@" "];
+}
+
++ (NSString *)conditionToMatchColumns:(NSArray *)columnNames
+                             inTuples:(NSArray *)tuples
+{
+  if (tuples.count == 0)
+  {
+    return @"0";
+  }
+  
+  NSMutableArray * columnConditions = [[NSMutableArray alloc] initWithCapacity:columnNames.count];
+  for (NSString * columnName in columnNames)
+  {
+    [columnConditions addObject:[[FMDatabase escapeIdentifier:columnName] stringByAppendingString:@" = ?"]];
+  }
+  NSString * tupleCondition = [NSString stringWithFormat:@"(%@)", [columnConditions componentsJoinedByString:@" AND "]];
+  
+  NSMutableArray * condition = [[NSMutableArray alloc] initWithCapacity:tuples.count];
+  for (NSUInteger tupleIdx = 0; tupleIdx < tuples.count; tupleIdx++)
+  {
+    [condition addObject:tupleCondition];
+  }
+  
+  return [NSString stringWithFormat:@"(%@)", [condition componentsJoinedByString:@" OR "]];
+}
+
++ (NSArray *)argumentsToMatchValues:(NSDictionary *)valuesToMatch
+{
+  // must match the order of the arguments in +whereClauseToMatchValues:arguments:
+  NSArray * columnKeys = [FMDatabase columnKeysOfMatchingValues:valuesToMatch];
+  
+  NSMutableArray * arguments  = [[NSMutableArray alloc] initWithCapacity:valuesToMatch.count];
+  for (id columnKey in columnKeys)
+  {
+    id value = valuesToMatch[columnKey];
+    if ([value isKindOfClass:[FMDBMatchingSet class]])
+    {
+      continue;
     }
-    else
+    else if ([columnKey isKindOfClass:[NSArray class]])
+    {
+      for (NSArray * tuple in value)
+      {
+        [arguments addObjectsFromArray:tuple];
+      }
+    }
+    else if ([value isKindOfClass:[NSArray class]])
+    {
+      [arguments addObjectsFromArray:value];
+    }
+    else if (value != [NSNull null])
     {
-      [where addObject:@"= ?"];
       [arguments addObject:value];
     }
-  }];
+  }
   
-  if (arguments_p != NULL)
+  return arguments;
+}
+
++ (NSArray *)arguments:(NSArray *)arguments
+             withLimit:(NSNumber *)limit
+                offset:(NSNumber *)offset
+{
+  if (limit == nil)
   {
-    *arguments_p = arguments;
+    return arguments;
   }
   
-  return [where componentsJoinedByString:@" "];
+  NSMutableArray * allArguments = [[NSMutableArray alloc] initWithArray:(arguments ?: @[])];
+  [allArguments addObject:limit];
+  if (offset != nil)
+  {
+    [allArguments addObject:offset];
+  }
+  return allArguments;
+}
+
++ (BOOL)bindsLimitOfStatementWithClauses:(NSArray *)clauses
+{
+  // a `?` after named (:name, @name, $name) or numbered (?NNN) parameters isn't necessarily bound to the argument
+  // after the clauses' own, so the limit is written into the statement instead; a match within a string literal only
+  // costs the statement's reuse
+  static NSRegularExpression * parameterExpression = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    parameterExpression = [NSRegularExpression regularExpressionWithPattern:@"[:@$][A-Za-z_]|\\?[0-9]"
+                                                                    options:0
+                                                                      error:NULL];
+  });
+  
+  for (NSString * clause in clauses)
+  {
+    if ([parameterExpression firstMatchInString:clause options:0 range:NSMakeRange(0, clause.length)] != nil)
+    {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 + (NSString *)statementToSelect:(NSArray *)columnNames
@@ -728,15 +1093,22 @@ withParameterDictionary:(NSDictionary *)arguments
     [selectSQL addObject:orderBy];
   }
   
+  // the limit and offset are bound as arguments (see +arguments:withLimit:offset:), so every page of a query shares
+  // the same statement, unless the clauses' own parameters are named or numbered
   if (limit != nil)
   {
-    [selectSQL addObject:@"LIMIT"];
-    [selectSQL addObject:limit.stringValue];
+    BOOL bindsLimit = [FMDatabase bindsLimitOfStatementWithClauses:@[ from ?: @"",
+                                                                      where ?: @"",
+                                                                      groupBy ?: @"",
+                                                                      having ?: @"",
+                                                                      orderBy ?: @"" ]];
+    [selectSQL addObject:(bindsLimit ? @"LIMIT ?" : [NSString stringWithFormat:@"LIMIT %lld", limit.longLongValue])];
     
     if (offset != nil)
     {
-      [selectSQL addObject:@"OFFSET"];
-      [selectSQL addObject:offset.stringValue];
+      [selectSQL addObject:(bindsLimit
+                            ? @"OFFSET ?"
+                            : [NSString stringWithFormat:@"OFFSET %lld", offset.longLongValue])];
     }
   }
   
@@ -781,20 +1153,46 @@ withParameterDictionary:(NSDictionary *)arguments
                         offset:(NSNumber *)offset
                          error:(NSError **)error_p
 {
-  NSArray * arguments = nil;
-  NSString * where = [FMDatabase whereClauseToMatchValues:valuesToMatch
-                                                arguments:&arguments];
+  NSDictionary * preparedValues = nil;
+  if (NO == [self prepareMatchingValues:valuesToMatch
+                         preparedValues:&preparedValues
+                                  error:error_p])
+  {
+    return nil;
+  }
   
-  return [self selectResults:columnNames
-                        from:from
-                       where:where
-                     groupBy:nil
-                      having:nil
-                   arguments:arguments
-                     orderBy:orderBy
-                       limit:limit
-                      offset:offset
-                       error:error_p];
+  NSString * selectSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"SELECT",
+                                                       from,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       [FMDatabase statementShapeOfMatchingValues:preparedValues],
+                                                       orderBy ?: @"",
+                                                       (limit != nil ? @"LIMIT" : @""),
+                                                       (limit != nil && offset != nil ? @"OFFSET" : @"") ]];
+  } build:^NSString *{
+    return [FMDatabase statementToSelect:columnNames
+                                    from:from
+                                   where:[FMDatabase whereClauseToMatchValues:preparedValues
+                                                                    arguments:NULL]
+                                 groupBy:nil
+                                  having:nil
+                                 orderBy:orderBy
+                                   limit:limit
+                                  offset:offset];
+  }];
+  
+  NSArray * arguments = [FMDatabase arguments:[FMDatabase argumentsToMatchValues:preparedValues]
+                                    withLimit:limit
+                                       offset:offset];
+  [self adviseIndexesForStatement:selectSQL
+                        arguments:arguments
+                        tableName:from
+                   matchingValues:preparedValues
+                          orderBy:orderBy];
+  
+  return [self selectResultsWithStatement:selectSQL
+                                arguments:arguments
+                                    error:error_p];
 }
 
 - (FMResultSet *)selectResultsFrom:(NSString *)tableName
@@ -826,7 +1224,7 @@ withParameterDictionary:(NSDictionary *)arguments
                         offset:(NSNumber *)offset
                          error:(NSError **)error_p
 {
-  NSString * selectSQL = [FMDatabase statementToSelect:columnNames
+  NSString * selectSQL = [self cachedStatementToSelect:columnNames
                                                   from:from
                                                  where:where
                                                groupBy:groupBy
@@ -835,11 +1233,67 @@ withParameterDictionary:(NSDictionary *)arguments
                                                  limit:limit
                                                 offset:offset];
   
-  FMResultSet * results = [self executeQuery:selectSQL
-                        withArgumentsInArray:arguments];
+  BOOL bindsLimit = [FMDatabase bindsLimitOfStatementWithClauses:@[ from,
+                                                                    where ?: @"",
+                                                                    groupBy ?: @"",
+                                                                    having ?: @"",
+                                                                    orderBy ?: @"" ]];
+  return [self selectResultsWithStatement:selectSQL
+                                arguments:(bindsLimit
+                                           ? [FMDatabase arguments:arguments withLimit:limit offset:offset]
+                                           : arguments)
+                                    error:error_p];
+}
+
+- (NSString *)cachedStatementToSelect:(NSArray *)columnNames
+                                 from:(NSString *)from
+                                where:(NSString *)where
+                              groupBy:(NSString *)groupBy
+                               having:(NSString *)having
+                              orderBy:(NSString *)orderBy
+                                limit:(NSNumber *)limit
+                               offset:(NSNumber *)offset
+{
+  return [self cachedSQLForShape:^NSString *{
+    // a limit that isn't bound is part of the statement, and so of its shape
+    BOOL bindsLimit = [FMDatabase bindsLimitOfStatementWithClauses:@[ from,
+                                                                      where ?: @"",
+                                                                      groupBy ?: @"",
+                                                                      having ?: @"",
+                                                                      orderBy ?: @"" ]];
+    return [FMDatabase statementShapeWithComponents:@[ @"SELECT",
+                                                       from,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       where ?: @"",
+                                                       groupBy ?: @"",
+                                                       having ?: @"",
+                                                       orderBy ?: @"",
+                                                       (limit != nil ? @"LIMIT" : @""),
+                                                       (limit != nil && offset != nil ? @"OFFSET" : @""),
+                                                       (bindsLimit ? @"" : [NSString stringWithFormat:@"%@ %@",
+                                                                            limit,
+                                                                            offset]) ]];
+  } build:^NSString *{
+    return [FMDatabase statementToSelect:columnNames
+                                    from:from
+                                   where:where
+                                 groupBy:groupBy
+                                  having:having
+                                 orderBy:orderBy
+                                   limit:limit
+                                  offset:offset];
+  }];
+}
+
+- (FMResultSet *)selectResultsWithStatement:(NSString *)selectSQL
+                                  arguments:(NSArray *)arguments
+                                      error:(NSError **)error_p
+{
+  FMResultSet * results = [self executeProfiledQuery:selectSQL
+                                withArgumentsInArray:arguments];
   if (results == nil && error_p != NULL)
   {
-    *error_p = self.lastError;
+    *error_p = [self lastStatementError];
   }
   return results;
 }
@@ -847,19 +1301,92 @@ withParameterDictionary:(NSDictionary *)arguments
 // ========== UPDATE ===================================================================================================
 #pragma mark - Update
 
++ (NSString *)statementToUpdate:(NSString *)tableName
+                        columns:(NSArray *)columnNames
+                    expressions:(NSArray *)expressions
+                          where:(NSString *)where
+{
+  NSMutableArray * updateSQL = [[NSMutableArray alloc] init];
+  [updateSQL addObject:@"UPDATE"];
+  [updateSQL addObject:[FMDatabase escapeIdentifier:tableName]];
+  [updateSQL addObject:@"SET"];
+  
+  [columnNames enumerateObjectsUsingBlock:^(NSString * columnName, NSUInteger idx, BOOL *stop) {
+    if (idx > 0)
+    {
+      [updateSQL addObject:@","];
+    }
+    
+    [updateSQL addObject:[FMDatabase escapeIdentifier:columnName]];
+    [updateSQL addObject:@"="];
+    [updateSQL addObject:expressions[idx]];
+  }];
+  
+  if (where != nil)
+  {
+    [updateSQL addObject:@"WHERE"];
+    [updateSQL addObject:where];
+  }
+  
+  return [updateSQL componentsJoinedByString:@" "];
+}
+
++ (NSArray *)expressionsToBindColumns:(NSArray *)columnNames
+{
+  NSMutableArray * expressions = [[NSMutableArray alloc] initWithCapacity:columnNames.count];
+  for (NSUInteger columnIdx = 0; columnIdx < columnNames.count; columnIdx++)
+  {
+    [expressions addObject:@"?"];
+  }
+  return expressions;
+}
+
 - (NSInteger)update:(NSString *)tableName
              values:(NSDictionary *)values
      matchingValues:(NSDictionary *)matchingValues
               error:(NSError **)error_p
 {
-  NSArray * arguments = nil;
-  NSString * where = [FMDatabase whereClauseToMatchValues:matchingValues
-                                                arguments:&arguments];
-  return [self update:tableName
-               values:values
-                where:where
-            arguments:arguments
-                error:error_p];
+  NSParameterAssert(values.count > 0);
+  
+  NSDictionary * preparedValues = nil;
+  if (NO == [self prepareMatchingValues:matchingValues
+                         preparedValues:&preparedValues
+                                  error:error_p])
+  {
+    return -1;
+  }
+  
+  NSArray * columnNames = [values.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  NSMutableArray * allArguments = [[NSMutableArray alloc] initWithCapacity:(values.count + preparedValues.count)];
+  for (NSString * columnName in columnNames)
+  {
+    [allArguments addObject:values[columnName]];
+  }
+  [allArguments addObjectsFromArray:[FMDatabase argumentsToMatchValues:preparedValues]];
+  
+  NSString * updateSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"UPDATE",
+                                                       tableName,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       [FMDatabase statementShapeOfMatchingValues:preparedValues] ]];
+  } build:^NSString *{
+    return [FMDatabase statementToUpdate:tableName
+                                 columns:columnNames
+                             expressions:[FMDatabase expressionsToBindColumns:columnNames]
+                                   where:[FMDatabase whereClauseToMatchValues:preparedValues
+                                                                    arguments:NULL]];
+  }];
+  
+  [self adviseIndexesForStatement:updateSQL
+                        arguments:allArguments
+                        tableName:tableName
+                   matchingValues:preparedValues
+                          orderBy:nil];
+  
+  return [self changesFromExecutingUpdate:updateSQL
+                     withArgumentsInArray:allArguments
+                                  ofTable:tableName
+                                    error:error_p];
 }
 
 - (NSInteger)update:(NSString *)tableName
@@ -868,15 +1395,13 @@ withParameterDictionary:(NSDictionary *)arguments
           arguments:(NSArray *)whereArguments
               error:(NSError **)error_p
 {
+  // columns are sorted so that updates of the same columns share a statement
+  NSArray * columnNames = [values.allKeys sortedArrayUsingSelector:@selector(compare:)];
   NSMutableArray * allArguments = [[NSMutableArray alloc] initWithCapacity:(values.count + whereArguments.count)];
-  NSMutableArray * columnNames = [[NSMutableArray alloc] init];
-  NSMutableArray * expressions = [[NSMutableArray alloc] init];
-  
-  [values enumerateKeysAndObjectsUsingBlock:^(NSString * columnName, id obj, BOOL *stop) {
-    [columnNames addObject:columnName];
-    [expressions addObject:@"?"];
-    [allArguments addObject:obj];
-  }];
+  for (NSString * columnName in columnNames)
+  {
+    [allArguments addObject:values[columnName]];
+  }
   
   if (whereArguments.count > 0)
   {
@@ -885,7 +1410,7 @@ withParameterDictionary:(NSDictionary *)arguments
   
   return [self update:tableName
               columns:columnNames
-          expressions:expressions
+          expressions:[FMDatabase expressionsToBindColumns:columnNames]
                 where:where
             arguments:allArguments
                 error:error_p];
@@ -901,29 +1426,31 @@ withParameterDictionary:(NSDictionary *)arguments
   NSParameterAssert(columnNames.count > 0);
   NSParameterAssert(expressions.count == columnNames.count);
   
-  NSMutableArray * updateSQL = [[NSMutableArray alloc] init];
-  [updateSQL addObject:@"UPDATE"];
-  [updateSQL addObject:[FMDatabase escapeIdentifier:tableName]];
-  [updateSQL addObject:@"SET"];
-  
-  [columnNames enumerateObjectsUsingBlock:^(NSString * columnName, NSUInteger idx, BOOL *stop) {
-    if (idx > 0)
-    {
-      [updateSQL addObject:@","];
-    }
-    
-    [updateSQL addObject:[FMDatabase escapeIdentifier:columnName]];
-    [updateSQL addObject:@"="];
-    [updateSQL addObject:expressions[idx]];
+  NSString * updateSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"UPDATE",
+                                                       tableName,
+                                                       [FMDatabase listOfColumns:columnNames],
+                                                       [expressions componentsJoinedByString:@","],
+                                                       where ?: @"" ]];
+  } build:^NSString *{
+    return [FMDatabase statementToUpdate:tableName
+                                 columns:columnNames
+                             expressions:expressions
+                                   where:where];
   }];
   
-  if (where != nil)
-  {
-    [updateSQL addObject:@"WHERE"];
-    [updateSQL addObject:where];
-  }
-  
-  BOOL successful = [self executeUpdate:[updateSQL componentsJoinedByString:@" "]
+  return [self changesFromExecutingUpdate:updateSQL
+                     withArgumentsInArray:arguments
+                                  ofTable:tableName
+                                    error:error_p];
+}
+
+- (NSInteger)changesFromExecutingUpdate:(NSString *)sql
+                   withArgumentsInArray:(NSArray *)arguments
+                                ofTable:(NSString *)tableName
+                                  error:(NSError **)error_p
+{
+  BOOL successful = [self executeUpdate:sql
                    withArgumentsInArray:arguments
                                   error:error_p];
   if (!successful)
@@ -931,31 +1458,15 @@ withParameterDictionary:(NSDictionary *)arguments
     return -1;
   }
   
+  [self invalidateResultCacheForTable:tableName];
   return self.changes;
 }
 
-
 // ========== DELETE ===================================================================================================
 #pragma mark - Delete
 
-- (NSInteger)deleteFrom:(NSString *)tableName
-         matchingValues:(NSDictionary *)matchingValues
-                  error:(NSError **)error_p
-{
-  NSArray * arguments = nil;
-  NSString * where = [FMDatabase whereClauseToMatchValues:matchingValues
-                                                arguments:&arguments];
-  return [self deleteFrom:tableName
-                    where:where
-                arguments:arguments
-                    error:error_p];
-}
-
-
-- (NSInteger)deleteFrom:(NSString *)tableName
-                  where:(NSString *)where
-              arguments:(NSArray *)arguments
-                  error:(NSError **)error_p
++ (NSString *)statementToDeleteFrom:(NSString *)tableName
+                              where:(NSString *)where
 {
   NSMutableArray * deleteSQL = [[NSMutableArray alloc] init];
   [deleteSQL addObject:@"DELETE FROM"];
@@ -967,15 +1478,63 @@ withParameterDictionary:(NSDictionary *)arguments
     [deleteSQL addObject:where];
   }
   
-  BOOL succeeded = [self executeUpdate:[deleteSQL componentsJoinedByString:@" "]
-                  withArgumentsInArray:arguments
-                                 error:error_p];
-  if (!succeeded)
+  return [deleteSQL componentsJoinedByString:@" "];
+}
+
+- (NSInteger)deleteFrom:(NSString *)tableName
+         matchingValues:(NSDictionary *)matchingValues
+                  error:(NSError **)error_p
+{
+  NSDictionary * preparedValues = nil;
+  if (NO == [self prepareMatchingValues:matchingValues
+                         preparedValues:&preparedValues
+                                  error:error_p])
   {
     return -1;
   }
   
-  return self.changes;
+  NSString * deleteSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"DELETE",
+                                                       tableName,
+                                                       [FMDatabase statementShapeOfMatchingValues:preparedValues] ]];
+  } build:^NSString *{
+    return [FMDatabase statementToDeleteFrom:tableName
+                                       where:[FMDatabase whereClauseToMatchValues:preparedValues
+                                                                        arguments:NULL]];
+  }];
+  
+  NSArray * arguments = [FMDatabase argumentsToMatchValues:preparedValues];
+  [self adviseIndexesForStatement:deleteSQL
+                        arguments:arguments
+                        tableName:tableName
+                   matchingValues:preparedValues
+                          orderBy:nil];
+  
+  return [self changesFromExecutingUpdate:deleteSQL
+                     withArgumentsInArray:arguments
+                                  ofTable:tableName
+                                    error:error_p];
+}
+
+
+- (NSInteger)deleteFrom:(NSString *)tableName
+                  where:(NSString *)where
+              arguments:(NSArray *)arguments
+                  error:(NSError **)error_p
+{
+  NSString * deleteSQL = [self cachedSQLForShape:^NSString *{
+    return [FMDatabase statementShapeWithComponents:@[ @"DELETE",
+                                                       tableName,
+                                                       where ?: @"" ]];
+  } build:^NSString *{
+    return [FMDatabase statementToDeleteFrom:tableName
+                                       where:where];
+  }];
+  
+  return [self changesFromExecutingUpdate:deleteSQL
+                     withArgumentsInArray:arguments
+                                  ofTable:tableName
+                                    error:error_p];
 }
 
 @end
@@ -0,0 +1,108 @@
+#import "FMDatabase.h"
+#import "FMResultSet.h"
+
+/**
+ *  The file formats read and written by the import and export helpers.
+ */
+typedef NS_ENUM(NSInteger, FMDBDataFormat)
+{
+  /**
+   *  Comma-separated values, as described by RFC 4180, starting with a header row of column names. Fields that
+   *  contain commas, quotes, or line breaks are quoted, with quotes doubled. An unquoted empty field is NULL, and a
+   *  quoted empty field (`""`) is an empty string. Blobs are written as base64.
+   */
+  FMDBDataFormatCSV,
+  /**
+   *  Newline-delimited JSON: one JSON object per line, keyed by column name. NULL is written as `null`, and blobs as
+   *  base64 strings.
+   */
+  FMDBDataFormatNDJSON,
+};
+
+@interface FMDatabase (FMDBImportExport)
+
+// ========== IMPORT ===================================================================================================
+#pragma mark - Import
+
+/// @name Importing Rows
+
+/**
+ *  Inserts the rows read from a file, parsing it a buffer at a time, so that memory use doesn't grow with the size of
+ *  the file.
+ *
+ *  Rows are inserted in batches of multi-row INSERT statements, as by
+ *  `-bulkInsertInto:columns:rowsFromBlock:commitInterval:error:`. The columns to insert are named by the header row
+ *  of a CSV file, or by the keys of the first object of an NDJSON file; later objects' missing keys are inserted as
+ *  NULL, and a later object with a key that the first object doesn't have fails the import.
+ *
+ *  Blank lines between CSV records are skipped, except in a file of a single column, where an empty line is a record
+ *  whose field is NULL.
+ *
+ *  CSV fields are bound straight from the read buffer, without creating objects, as integers or reals when the
+ *  column's declared type (from `-tableSchema:`) has integer, real, or numeric affinity and the field is a number.
+ *  Other fields are bound as text, except that fields of columns declared as BLOB are decoded from base64. NDJSON
+ *  values keep their JSON types, apart from the base64 strings of BLOB columns; nested arrays and objects are inserted
+ *  as JSON text.
+ *
+ *  Unless a transaction is already open, rows are inserted within a transaction that is committed every
+ *  `commitInterval` rows. If an error occurs, including a malformed line, that transaction is rolled back, but rows
+ *  committed earlier remain. When a transaction is already open, it is left to the caller to commit or roll back.
+ *
+ *  @param  tableName       The table into which rows are inserted.
+ *  @param  fileDescriptor  A file descriptor open for reading, e.g. from `open(2)` or `-[NSFileHandle fileDescriptor]`.
+ *                          It is read to the end, and isn't closed.
+ *  @param  format          The format of the file.
+ *  @param  commitInterval  The number of rows to insert per transaction. 0 inserts all rows in a single transaction.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return The number of rows inserted, or -1 if an error occurs.
+ */
+- (NSInteger)importInto:(NSString *)tableName
+     fromFileDescriptor:(int)fileDescriptor
+                 format:(FMDBDataFormat)format
+         commitInterval:(NSUInteger)commitInterval
+                  error:(NSError **)error_p;
+
+// ========== EXPORT ===================================================================================================
+#pragma mark - Export
+
+/// @name Exporting Rows
+
+/**
+ *  Writes all rows of a table to a file. See `-[FMResultSet writeRowsToFileDescriptor:format:error:]`.
+ *
+ *  @param  tableName       The table to export.
+ *  @param  orderBy         The order in which to write rows, e.g. `id`, or `nil`.
+ *  @param  fileDescriptor  A file descriptor open for writing. It isn't closed.
+ *  @param  format          The format to write.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return The number of rows written, or -1 if an error occurs.
+ */
+- (NSInteger)exportFrom:(NSString *)tableName
+                orderBy:(NSString *)orderBy
+       toFileDescriptor:(int)fileDescriptor
+                 format:(FMDBDataFormat)format
+                  error:(NSError **)error_p;
+
+@end
+
+@interface FMResultSet (FMDBImportExport)
+
+/**
+ *  Writes the remaining results to a file. Values are read with sqlite's typed column accessors and formatted into a
+ *  fixed-size buffer, which is written whenever it fills, so no objects are created for rows or values, other than
+ *  for blobs.
+ *
+ *  @param  fileDescriptor  A file descriptor open for writing, e.g. from `open(2)` or
+ *                          `-[NSFileHandle fileDescriptor]`. It isn't closed.
+ *  @param  format          The format to write. CSV starts with a header row of the result's column names.
+ *  @param  error_p         A pointer to any error that occurs.
+ *
+ *  @return The number of rows written, or -1 if an error occurs.
+ */
+- (NSInteger)writeRowsToFileDescriptor:(int)fileDescriptor
+                                format:(FMDBDataFormat)format
+                                 error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,1210 @@
+#import "FMDatabase+FMDBImportExport.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import <errno.h>
+#import <math.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <unistd.h>
+
+static const size_t FMDBImportReadBufferSize = 64 * 1024;
+
+static const size_t FMDBExportWriteBufferSize = 64 * 1024;
+
+/**
+ *  How the values of a column are bound, following the affinity of its declared type.
+ */
+typedef NS_ENUM(NSInteger, FMDBImportColumnType)
+{
+  /** TEXT affinity, or no declared type: fields are bound as text. */
+  FMDBImportColumnTypeText,
+  /** INTEGER or NUMERIC affinity: numbers are bound as integers, or reals if they aren't whole. */
+  FMDBImportColumnTypeInteger,
+  /** REAL affinity: numbers are bound as reals. */
+  FMDBImportColumnTypeReal,
+  /** Declared as BLOB: base64 is decoded. */
+  FMDBImportColumnTypeBlob,
+};
+
+typedef NS_ENUM(NSInteger, FMDBCSVState)
+{
+  FMDBCSVStateFieldStart,
+  FMDBCSVStateUnquoted,
+  FMDBCSVStateQuoted,
+  FMDBCSVStateQuoteInQuoted,
+};
+
+/**
+ *  A CSV field, stored in the importer's arena followed by a NUL.
+ */
+typedef struct
+{
+  size_t offset;
+  size_t length;
+  BOOL isNull;
+} FMDBImportField;
+
+/**
+ *  Bytes waiting to be written to a file descriptor.
+ */
+typedef struct
+{
+  int fileDescriptor;
+  char * bytes;
+  size_t length;
+  size_t capacity;
+  int error;
+} FMDBOutputBuffer;
+
+// ========== NUMBERS ==================================================================================================
+#pragma mark - Numbers
+
+static BOOL FMDBIsNumberStart(char c)
+{
+  // strtod also accepts words such as "inf" and "nan", which are kept as text
+  return ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.');
+}
+
+static BOOL FMDBParseInteger(const char * text, size_t length, int64_t * value_p)
+{
+  if (length == 0 || NO == FMDBIsNumberStart(text[0]))
+  {
+    return NO;
+  }
+  
+  char * end = NULL;
+  errno = 0;
+  long long value = strtoll(text, &end, 10);
+  if (errno != 0 || end != text + length)
+  {
+    return NO;
+  }
+  *value_p = value;
+  return YES;
+}
+
+static BOOL FMDBParseReal(const char * text, size_t length, double * value_p)
+{
+  if (length == 0 || NO == FMDBIsNumberStart(text[0]))
+  {
+    return NO;
+  }
+  
+  char * end = NULL;
+  double value = strtod(text, &end);
+  if (end != text + length)
+  {
+    return NO;
+  }
+  *value_p = value;
+  return YES;
+}
+
+/**
+ *  Formats a real with the fewest digits that read back as the same value.
+ */
+static int FMDBFormatReal(double value, char * buffer, size_t size)
+{
+  int length = snprintf(buffer, size, "%.15g", value);
+  if (strtod(buffer, NULL) != value)
+  {
+    length = snprintf(buffer, size, "%.17g", value);
+  }
+  return length;
+}
+
+// ========== OUTPUT ===================================================================================================
+#pragma mark - Output
+
+static void FMDBOutputFlush(FMDBOutputBuffer * output)
+{
+  size_t offset = 0;
+  while (output->error == 0 && offset < output->length)
+  {
+    ssize_t writtenLength = write(output->fileDescriptor, output->bytes + offset, output->length - offset);
+    if (writtenLength < 0)
+    {
+      if (errno != EINTR)
+      {
+        output->error = errno;
+      }
+      continue;
+    }
+    offset += (size_t)writtenLength;
+  }
+  output->length = 0;
+}
+
+static void FMDBOutputAppend(FMDBOutputBuffer * output, const void * bytes, size_t length)
+{
+  while (length > 0 && output->error == 0)
+  {
+    if (output->length == output->capacity)
+    {
+      FMDBOutputFlush(output);
+    }
+    
+    size_t copiedLength = MIN(length, output->capacity - output->length);
+    memcpy(output->bytes + output->length, bytes, copiedLength);
+    output->length += copiedLength;
+    bytes = (const char *)bytes + copiedLength;
+    length -= copiedLength;
+  }
+}
+
+static void FMDBOutputAppendString(FMDBOutputBuffer * output, const char * string)
+{
+  FMDBOutputAppend(output, string, strlen(string));
+}
+
+static void FMDBOutputAppendCSVField(FMDBOutputBuffer * output, const char * text, size_t length)
+{
+  // empty strings are quoted, so that they aren't read back as NULL
+  BOOL needsQuotes = (length == 0);
+  for (size_t idx = 0; idx < length && NO == needsQuotes; idx++)
+  {
+    char c = text[idx];
+    needsQuotes = (c == ',' || c == '"' || c == '\n' || c == '\r');
+  }
+  
+  if (NO == needsQuotes)
+  {
+    FMDBOutputAppend(output, text, length);
+    return;
+  }
+  
+  FMDBOutputAppend(output, "\"", 1);
+  size_t spanStart = 0;
+  for (size_t idx = 0; idx < length; idx++)
+  {
+    if (text[idx] == '"')
+    {
+      // the quote is written twice: once at the end of the span, and once more here
+      FMDBOutputAppend(output, text + spanStart, idx + 1 - spanStart);
+      FMDBOutputAppend(output, "\"", 1);
+      spanStart = idx + 1;
+    }
+  }
+  FMDBOutputAppend(output, text + spanStart, length - spanStart);
+  FMDBOutputAppend(output, "\"", 1);
+}
+
+static void FMDBOutputAppendJSONString(FMDBOutputBuffer * output, const char * text, size_t length)
+{
+  FMDBOutputAppend(output, "\"", 1);
+  size_t spanStart = 0;
+  for (size_t idx = 0; idx < length; idx++)
+  {
+    unsigned char c = (unsigned char)text[idx];
+    if (c >= 0x20 && c != '"' && c != '\\')
+    {
+      continue;
+    }
+    
+    FMDBOutputAppend(output, text + spanStart, idx - spanStart);
+    spanStart = idx + 1;
+    
+    char escape[8];
+    switch (c)
+    {
+      case '"':  FMDBOutputAppend(output, "\\\"", 2); break;
+      case '\\': FMDBOutputAppend(output, "\\\\", 2); break;
+      case '\n': FMDBOutputAppend(output, "\\n", 2); break;
+      case '\r': FMDBOutputAppend(output, "\\r", 2); break;
+      case '\t': FMDBOutputAppend(output, "\\t", 2); break;
+      default:
+        snprintf(escape, sizeof(escape), "\\u%04x", c);
+        FMDBOutputAppend(output, escape, 6);
+        break;
+    }
+  }
+  FMDBOutputAppend(output, text + spanStart, length - spanStart);
+  FMDBOutputAppend(output, "\"", 1);
+}
+
+// ========== FMDBImporter =============================================================================================
+#pragma mark - FMDBImporter
+
+/**
+ *  Parses a file a buffer at a time, and inserts its rows in batches.
+ */
+@interface FMDBImporter : NSObject
+
+- (instancetype)initWithDatabase:(FMDatabase *)database
+                       tableName:(NSString *)tableName
+                          format:(FMDBDataFormat)format
+                  commitInterval:(NSUInteger)commitInterval;
+
+- (NSInteger)importFromFileDescriptor:(int)fileDescriptor
+                                error:(NSError **)error_p;
+
+@end
+
+@implementation FMDBImporter
+{
+  FMDatabase * _database;
+  NSString * _tableName;
+  FMDBDataFormat _format;
+  NSUInteger _commitInterval;
+  BOOL _ownsTransaction;
+  NSError * _error;
+  
+  NSArray * _columnNames;
+  NSUInteger _columnCount;
+  FMDBImportColumnType * _columnTypes;
+  NSUInteger _rowsPerStatement;
+  sqlite3_stmt * _batchStatement;
+  
+  // rows of the current batch: CSV fields in the arena, or NDJSON values in arrays
+  char * _arena;
+  size_t _arenaLength;
+  size_t _arenaCapacity;
+  FMDBImportField * _fields;
+  NSUInteger _fieldCount;
+  NSUInteger _fieldCapacity;
+  NSMutableArray * _valueRows;
+  NSUInteger _batchRowCount;
+  
+  NSUInteger _recordCount;
+  NSInteger _insertedRowCount;
+  NSUInteger _rowsSinceCommit;
+  BOOL _hasReadBytes;
+  
+  // CSV parsing
+  FMDBCSVState _csvState;
+  BOOL _isFieldQuoted;
+  BOOL _skipsLineFeed;
+  size_t _fieldStart;
+  NSUInteger _rowFieldCount;
+}
+
+- (instancetype)initWithDatabase:(FMDatabase *)database
+                       tableName:(NSString *)tableName
+                          format:(FMDBDataFormat)format
+                  commitInterval:(NSUInteger)commitInterval
+{
+  self = [super init];
+  if (self)
+  {
+    _database = database;
+    _tableName = [tableName copy];
+    _format = format;
+    _commitInterval = commitInterval;
+    _valueRows = [[NSMutableArray alloc] init];
+    
+    _arenaCapacity = FMDBImportReadBufferSize;
+    _arena = malloc(_arenaCapacity);
+    _fieldCapacity = 64;
+    _fields = malloc(_fieldCapacity * sizeof(FMDBImportField));
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  sqlite3_finalize(_batchStatement);
+  free(_columnTypes);
+  free(_arena);
+  free(_fields);
+}
+
+- (NSInteger)importFromFileDescriptor:(int)fileDescriptor
+                                error:(NSError **)error_p
+{
+  _ownsTransaction = (NO == _database.inTransaction);
+  if (_ownsTransaction && NO == [_database beginTransaction])
+  {
+    if (error_p != NULL) *error_p = _database.lastError;
+    return -1;
+  }
+  
+  char * buffer = malloc(FMDBImportReadBufferSize);
+  BOOL succeeded = YES;
+  while (succeeded)
+  {
+    ssize_t readLength = read(fileDescriptor, buffer, FMDBImportReadBufferSize);
+    if (readLength < 0)
+    {
+      if (errno != EINTR)
+      {
+        succeeded = [self failWithError:[NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil]];
+      }
+      continue;
+    }
+    
+    if (readLength == 0)
+    {
+      succeeded = [self finishParsing] && [self insertBatch];
+      break;
+    }
+    
+    @autoreleasepool
+    {
+      const char * bytes = buffer;
+      size_t length = (size_t)readLength;
+      if (NO == _hasReadBytes && length >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0)
+      {
+        // skip a UTF-8 byte order mark
+        bytes += 3;
+        length -= 3;
+      }
+      _hasReadBytes = YES;
+      
+      if (_format == FMDBDataFormatCSV)
+      {
+        succeeded = [self parseCSVBytes:bytes
+                                 length:length];
+      }
+      else
+      {
+        succeeded = [self parseNDJSONBytes:bytes
+                                    length:length];
+      }
+    }
+  }
+  free(buffer);
+  
+  if (_ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = ([_database commit] || [self failWithError:_database.lastError]);
+    }
+    else if (_database.inTransaction)
+    {
+      [_database rollback];
+    }
+  }
+  
+  if (NO == succeeded)
+  {
+    if (error_p != NULL) *error_p = _error;
+    return -1;
+  }
+  return _insertedRowCount;
+}
+
+- (BOOL)failWithError:(NSError *)error
+{
+  _error = error;
+  return NO;
+}
+
+- (BOOL)failWithOutOfMemory
+{
+  NSString * description = [NSString stringWithFormat:@"%@ %lu doesn't fit in memory",
+                            (_format == FMDBDataFormatCSV ? @"Record" : @"Line"),
+                            (unsigned long)(_recordCount + 1)];
+  return [self failWithError:[NSError errorWithDomain:@"FMDatabase"
+                                                 code:SQLITE_NOMEM
+                                             userInfo:@{ NSLocalizedDescriptionKey: description }]];
+}
+
+- (BOOL)failWithDescription:(NSString *)description
+{
+  NSString * recordDescription = [NSString stringWithFormat:@"%@ %lu %@",
+                                  (_format == FMDBDataFormatCSV ? @"Record" : @"Line"),
+                                  (unsigned long)_recordCount,
+                                  description];
+  return [self failWithError:[NSError errorWithDomain:@"FMDatabase"
+                                                 code:SQLITE_MISMATCH
+                                             userInfo:@{ NSLocalizedDescriptionKey: recordDescription }]];
+}
+
+// ---------- COLUMNS --------------------------------------------------------------------------------------------------
+#pragma mark Columns
+
+- (BOOL)setColumnNames:(NSArray *)columnNames
+{
+  if (columnNames.count == 0)
+  {
+    return [self failWithDescription:@"doesn't name any columns"];
+  }
+  
+  _columnNames = [columnNames copy];
+  _columnCount = columnNames.count;
+  _rowsPerStatement = [_database maximumRowsPerStatementWithColumnCount:_columnCount];
+  if (_commitInterval > 0)
+  {
+    // keep batches from straddling transactions
+    _rowsPerStatement = MIN(_rowsPerStatement, _commitInterval);
+  }
+  
+  NSMutableDictionary * declaredTypes = [[NSMutableDictionary alloc] init];
+  NSDictionary * tableSchema = [_database tableSchema:_tableName];
+  for (NSString * name in tableSchema)
+  {
+    declaredTypes[name.lowercaseString] = tableSchema[name][@"type"];
+  }
+  
+  _columnTypes = calloc(_columnCount, sizeof(FMDBImportColumnType));
+  for (NSUInteger columnIdx = 0; columnIdx < _columnCount; columnIdx++)
+  {
+    NSString * columnName = columnNames[columnIdx];
+    _columnTypes[columnIdx] = [FMDBImporter columnTypeOfDeclaredType:declaredTypes[columnName.lowercaseString]];
+  }
+  return YES;
+}
+
+/**
+ *  Follows sqlite's rules for the affinity of a declared type.
+ */
++ (FMDBImportColumnType)columnTypeOfDeclaredType:(NSString *)declaredType
+{
+  NSString * type = declaredType.uppercaseString;
+  if ([type rangeOfString:@"INT"].location != NSNotFound)
+  {
+    return FMDBImportColumnTypeInteger;
+  }
+  else if (type.length == 0 ||
+           [type rangeOfString:@"CHAR"].location != NSNotFound ||
+           [type rangeOfString:@"CLOB"].location != NSNotFound ||
+           [type rangeOfString:@"TEXT"].location != NSNotFound)
+  {
+    return FMDBImportColumnTypeText;
+  }
+  else if ([type rangeOfString:@"BLOB"].location != NSNotFound)
+  {
+    return FMDBImportColumnTypeBlob;
+  }
+  else if ([type rangeOfString:@"REAL"].location != NSNotFound ||
+           [type rangeOfString:@"FLOA"].location != NSNotFound ||
+           [type rangeOfString:@"DOUB"].location != NSNotFound)
+  {
+    return FMDBImportColumnTypeReal;
+  }
+  return FMDBImportColumnTypeInteger;
+}
+
+// ---------- CSV ------------------------------------------------------------------------------------------------------
+#pragma mark CSV
+
+- (BOOL)parseCSVBytes:(const char *)bytes
+               length:(size_t)length
+{
+  size_t idx = 0;
+  while (idx < length)
+  {
+    char c = bytes[idx];
+    if (_skipsLineFeed)
+    {
+      _skipsLineFeed = NO;
+      if (c == '\n')
+      {
+        idx++;
+        continue;
+      }
+    }
+    
+    switch (_csvState)
+    {
+      case FMDBCSVStateFieldStart:
+      case FMDBCSVStateUnquoted:
+      {
+        if ((c == '\n' || c == '\r') && _csvState == FMDBCSVStateFieldStart && _rowFieldCount == 0 &&
+            (_columnNames == nil || _columnCount > 1))
+        {
+          // a blank line, which in a file of a single column is instead a record with a NULL field
+          _recordCount++;
+          _skipsLineFeed = (c == '\r');
+          idx++;
+          break;
+        }
+        
+        if (c == '"' && _csvState == FMDBCSVStateFieldStart)
+        {
+          _csvState = FMDBCSVStateQuoted;
+          _isFieldQuoted = YES;
+          idx++;
+          break;
+        }
+        
+        // copy the rest of the field at once
+        size_t fieldEnd = idx;
+        while (fieldEnd < length && bytes[fieldEnd] != ',' && bytes[fieldEnd] != '\n' && bytes[fieldEnd] != '\r')
+        {
+          fieldEnd++;
+        }
+        if (NO == [self appendBytes:bytes + idx
+                             length:fieldEnd - idx])
+        {
+          return NO;
+        }
+        idx = fieldEnd;
+        
+        if (idx == length)
+        {
+          _csvState = FMDBCSVStateUnquoted;
+        }
+        else if (NO == [self endCSVFieldWithSeparator:bytes[idx++]])
+        {
+          return NO;
+        }
+        break;
+      }
+      
+      case FMDBCSVStateQuoted:
+      {
+        const char * quote = memchr(bytes + idx, '"', length - idx);
+        size_t quotedEnd = (quote != NULL ? (size_t)(quote - bytes) : length);
+        if (NO == [self appendBytes:bytes + idx
+                             length:quotedEnd - idx])
+        {
+          return NO;
+        }
+        idx = quotedEnd;
+        
+        if (quote != NULL)
+        {
+          _csvState = FMDBCSVStateQuoteInQuoted;
+          idx++;
+        }
+        break;
+      }
+      
+      case FMDBCSVStateQuoteInQuoted:
+      {
+        if (c == '"')
+        {
+          // a doubled quote
+          if (NO == [self appendBytes:"\""
+                               length:1])
+          {
+            return NO;
+          }
+          _csvState = FMDBCSVStateQuoted;
+          idx++;
+        }
+        else if (c == ',' || c == '\n' || c == '\r')
+        {
+          idx++;
+          if (NO == [self endCSVFieldWithSeparator:c])
+          {
+            return NO;
+          }
+        }
+        else
+        {
+          // text after the closing quote is kept, rather than rejecting the file
+          _csvState = FMDBCSVStateUnquoted;
+        }
+        break;
+      }
+    }
+  }
+  return YES;
+}
+
+- (BOOL)endCSVFieldWithSeparator:(char)separator
+{
+  if (NO == [self endCSVField])
+  {
+    return NO;
+  }
+  
+  if (separator != ',')
+  {
+    _skipsLineFeed = (separator == '\r');
+    return [self endCSVRecord];
+  }
+  return YES;
+}
+
+- (BOOL)endCSVField
+{
+  FMDBImportField field = { .offset = _fieldStart, .length = _arenaLength - _fieldStart };
+  field.isNull = (field.length == 0 && NO == _isFieldQuoted);
+  
+  // fields are terminated, so that numbers can be parsed in place
+  if (NO == [self appendBytes:"\0"
+                       length:1])
+  {
+    return NO;
+  }
+  
+  if (_fieldCount == _fieldCapacity)
+  {
+    FMDBImportField * fields = realloc(_fields, _fieldCapacity * 2 * sizeof(FMDBImportField));
+    if (fields == NULL)
+    {
+      return [self failWithOutOfMemory];
+    }
+    _fields = fields;
+    _fieldCapacity *= 2;
+  }
+  _fields[_fieldCount++] = field;
+  _rowFieldCount++;
+  
+  _fieldStart = _arenaLength;
+  _isFieldQuoted = NO;
+  _csvState = FMDBCSVStateFieldStart;
+  
+  if (_columnNames != nil && _rowFieldCount > _columnCount)
+  {
+    _recordCount++;
+    return [self failWithDescription:[NSString stringWithFormat:@"has more than %lu fields",
+                                      (unsigned long)_columnCount]];
+  }
+  return YES;
+}
+
+- (BOOL)endCSVRecord
+{
+  _recordCount++;
+  NSUInteger rowFieldCount = _rowFieldCount;
+  _rowFieldCount = 0;
+  
+  FMDBImportField * rowFields = &_fields[_fieldCount - rowFieldCount];
+  if (_columnNames == nil)
+  {
+    NSMutableArray * columnNames = [[NSMutableArray alloc] initWithCapacity:rowFieldCount];
+    for (NSUInteger fieldIdx = 0; fieldIdx < rowFieldCount; fieldIdx++)
+    {
+      NSString * columnName = [[NSString alloc] initWithBytes:_arena + rowFields[fieldIdx].offset
+                                                       length:rowFields[fieldIdx].length
+                                                     encoding:NSUTF8StringEncoding];
+      [columnNames addObject:columnName ?: @""];
+    }
+    [self removeRowFieldsStartingAt:rowFields];
+    return [self setColumnNames:columnNames];
+  }
+  
+  if (rowFieldCount != _columnCount)
+  {
+    return [self failWithDescription:[NSString stringWithFormat:@"has %lu fields, rather than %lu",
+                                      (unsigned long)rowFieldCount,
+                                      (unsigned long)_columnCount]];
+  }
+  
+  return [self addRowToBatch];
+}
+
+- (void)removeRowFieldsStartingAt:(FMDBImportField *)rowFields
+{
+  _arenaLength = rowFields[0].offset;
+  _fieldStart = _arenaLength;
+  _fieldCount = (NSUInteger)(rowFields - _fields);
+}
+
+- (BOOL)appendBytes:(const char *)bytes
+             length:(size_t)length
+{
+  if (_arenaLength + length > _arenaCapacity)
+  {
+    size_t arenaCapacity = _arenaCapacity;
+    while (_arenaLength + length > arenaCapacity)
+    {
+      arenaCapacity *= 2;
+    }
+    char * arena = realloc(_arena, arenaCapacity);
+    if (arena == NULL)
+    {
+      return [self failWithOutOfMemory];
+    }
+    _arena = arena;
+    _arenaCapacity = arenaCapacity;
+  }
+  memcpy(_arena + _arenaLength, bytes, length);
+  _arenaLength += length;
+  return YES;
+}
+
+// ---------- NDJSON ---------------------------------------------------------------------------------------------------
+#pragma mark NDJSON
+
+- (BOOL)parseNDJSONBytes:(const char *)bytes
+                  length:(size_t)length
+{
+  size_t idx = 0;
+  while (idx < length)
+  {
+    const char * lineFeed = memchr(bytes + idx, '\n', length - idx);
+    if (lineFeed == NULL)
+    {
+      // the rest of the line is in the next buffer
+      return [self appendBytes:bytes + idx
+                        length:length - idx];
+    }
+    
+    size_t lineEnd = (size_t)(lineFeed - bytes);
+    BOOL succeeded;
+    if (_arenaLength == 0)
+    {
+      succeeded = [self parseNDJSONLine:bytes + idx
+                                 length:lineEnd - idx];
+    }
+    else
+    {
+      succeeded = ([self appendBytes:bytes + idx
+                              length:lineEnd - idx] &&
+                   [self parseNDJSONLine:_arena
+                                  length:_arenaLength]);
+      _arenaLength = 0;
+    }
+    
+    if (NO == succeeded)
+    {
+      return NO;
+    }
+    idx = lineEnd + 1;
+  }
+  return YES;
+}
+
+- (BOOL)parseNDJSONLine:(const char *)bytes
+                 length:(size_t)length
+{
+  _recordCount++;
+  while (length > 0 && (bytes[length - 1] == '\r' || bytes[length - 1] == ' ' || bytes[length - 1] == '\t'))
+  {
+    length--;
+  }
+  if (length == 0)
+  {
+    return YES;
+  }
+  
+  NSData * line = [[NSData alloc] initWithBytesNoCopy:(void *)bytes
+                                               length:length
+                                         freeWhenDone:NO];
+  NSError * error = nil;
+  NSDictionary * object = [NSJSONSerialization JSONObjectWithData:line
+                                                          options:0
+                                                            error:&error];
+  if (NO == [object isKindOfClass:[NSDictionary class]])
+  {
+    return [self failWithDescription:(error != nil
+                                      ? [@"isn't valid JSON: " stringByAppendingString:error.localizedDescription]
+                                      : @"isn't a JSON object")];
+  }
+  
+  if (_columnNames == nil && NO == [self setColumnNames:[object.allKeys sortedArrayUsingSelector:@selector(compare:)]])
+  {
+    return NO;
+  }
+  
+  NSMutableArray * values = [[NSMutableArray alloc] initWithCapacity:_columnCount];
+  NSUInteger matchedKeyCount = 0;
+  for (NSUInteger columnIdx = 0; columnIdx < _columnCount; columnIdx++)
+  {
+    id value = object[_columnNames[columnIdx]];
+    if (value != nil)
+    {
+      matchedKeyCount++;
+    }
+    else
+    {
+      value = [NSNull null];
+    }
+    if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]])
+    {
+      NSData * json = [NSJSONSerialization dataWithJSONObject:value options:0 error:NULL];
+      value = [[NSString alloc] initWithData:json encoding:NSUTF8StringEncoding];
+    }
+    else if (_columnTypes[columnIdx] == FMDBImportColumnTypeBlob && [value isKindOfClass:[NSString class]])
+    {
+      value = [[NSData alloc] initWithBase64EncodedString:value options:0] ?: value;
+    }
+    [values addObject:value];
+  }
+  
+  // the columns are fixed by the first object, so a later object's other keys would otherwise be lost
+  if (matchedKeyCount < object.count)
+  {
+    NSMutableArray * unknownKeys = [object.allKeys mutableCopy];
+    [unknownKeys removeObjectsInArray:_columnNames];
+    [unknownKeys sortUsingSelector:@selector(compare:)];
+    return [self failWithDescription:[@"has keys that the first line doesn't: " stringByAppendingString:
+                                      [unknownKeys componentsJoinedByString:@", "]]];
+  }
+  [_valueRows addObject:values];
+  
+  return [self addRowToBatch];
+}
+
+// ---------- BATCHES --------------------------------------------------------------------------------------------------
+#pragma mark Batches
+
+- (BOOL)finishParsing
+{
+  if (_format == FMDBDataFormatCSV)
+  {
+    if (_csvState == FMDBCSVStateQuoted)
+    {
+      _recordCount++;
+      return [self failWithDescription:@"has an unterminated quoted field"];
+    }
+    
+    // the last record needn't end with a line break
+    if (_csvState != FMDBCSVStateFieldStart || _rowFieldCount > 0)
+    {
+      return [self endCSVField] && [self endCSVRecord];
+    }
+    return YES;
+  }
+  
+  if (_arenaLength > 0)
+  {
+    size_t length = _arenaLength;
+    _arenaLength = 0;
+    return [self parseNDJSONLine:_arena
+                          length:length];
+  }
+  return YES;
+}
+
+- (BOOL)addRowToBatch
+{
+  _batchRowCount++;
+  if (_batchRowCount < _rowsPerStatement)
+  {
+    return YES;
+  }
+  return [self insertBatch];
+}
+
+- (BOOL)insertBatch
+{
+  if (_batchRowCount == 0)
+  {
+    return YES;
+  }
+  
+  // the final, partial batch is the only one of its size
+  sqlite3_stmt * statement = NULL;
+  if (_batchRowCount == _rowsPerStatement && _batchStatement != NULL)
+  {
+    statement = _batchStatement;
+  }
+  else
+  {
+    NSString * insertSQL = [FMDatabase statementToInsertInto:_tableName
+                                                     columns:_columnNames
+                                                    rowCount:_batchRowCount];
+    if (sqlite3_prepare_v2(_database.sqliteHandle, insertSQL.UTF8String, -1, &statement, NULL) != SQLITE_OK)
+    {
+      sqlite3_finalize(statement);
+      return [self failWithError:_database.lastError];
+    }
+    
+    if (_batchRowCount == _rowsPerStatement)
+    {
+      _batchStatement = statement;
+    }
+  }
+  
+  int result = SQLITE_OK;
+  int parameterIdx = 1;
+  for (NSUInteger rowIdx = 0; rowIdx < _batchRowCount && result == SQLITE_OK; rowIdx++)
+  {
+    for (NSUInteger columnIdx = 0; columnIdx < _columnCount && result == SQLITE_OK; columnIdx++)
+    {
+      if (_format == FMDBDataFormatCSV)
+      {
+        result = [self bindField:_fields[rowIdx * _columnCount + columnIdx]
+                        ofColumn:columnIdx
+                     toStatement:statement
+                         atIndex:parameterIdx++];
+      }
+      else
+      {
+        result = [_database bindValue:_valueRows[rowIdx][columnIdx]
+                          toStatement:statement
+                              atIndex:parameterIdx++];
+      }
+    }
+  }
+  
+  if (result == SQLITE_OK)
+  {
+    result = sqlite3_step(statement);
+  }
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+  if (statement != _batchStatement)
+  {
+    sqlite3_finalize(statement);
+  }
+  
+  if (result != SQLITE_DONE)
+  {
+    return [self failWithError:_database.lastError];
+  }
+  
+  _insertedRowCount += _batchRowCount;
+  _rowsSinceCommit += _batchRowCount;
+  _batchRowCount = 0;
+  _fieldCount = 0;
+  _arenaLength = 0;
+  _fieldStart = 0;
+  [_valueRows removeAllObjects];
+  
+  if (_ownsTransaction && _commitInterval > 0 && _rowsSinceCommit >= _commitInterval)
+  {
+    _rowsSinceCommit = 0;
+    if (NO == [_database commit] || NO == [_database beginTransaction])
+    {
+      return [self failWithError:_database.lastError];
+    }
+  }
+  return YES;
+}
+
+- (int)bindField:(FMDBImportField)field
+        ofColumn:(NSUInteger)columnIdx
+     toStatement:(sqlite3_stmt *)statement
+         atIndex:(int)idx
+{
+  if (field.isNull)
+  {
+    return sqlite3_bind_null(statement, idx);
+  }
+  
+  // the arena isn't changed until the statement has run, so text is bound without copying it
+  const char * text = _arena + field.offset;
+  int64_t integer = 0;
+  double real = 0;
+  switch (_columnTypes[columnIdx])
+  {
+    case FMDBImportColumnTypeInteger:
+      if (FMDBParseInteger(text, field.length, &integer))
+      {
+        return sqlite3_bind_int64(statement, idx, integer);
+      }
+      else if (FMDBParseReal(text, field.length, &real))
+      {
+        return sqlite3_bind_double(statement, idx, real);
+      }
+      break;
+    
+    case FMDBImportColumnTypeReal:
+      if (FMDBParseReal(text, field.length, &real))
+      {
+        return sqlite3_bind_double(statement, idx, real);
+      }
+      break;
+    
+    case FMDBImportColumnTypeBlob:
+    {
+      NSData * base64 = [[NSData alloc] initWithBytesNoCopy:(void *)text
+                                                     length:field.length
+                                               freeWhenDone:NO];
+      NSData * blob = [[NSData alloc] initWithBase64EncodedData:base64 options:0];
+      if (blob != nil)
+      {
+        const void * bytes = (blob.length > 0 ? blob.bytes : "");
+        return sqlite3_bind_blob(statement, idx, bytes, (int)blob.length, SQLITE_TRANSIENT);
+      }
+      break;
+    }
+    
+    case FMDBImportColumnTypeText:
+      break;
+  }
+  return sqlite3_bind_text(statement, idx, text, (int)field.length, SQLITE_STATIC);
+}
+
+@end
+
+// ========== FMDatabase (FMDBImportExport) ============================================================================
+#pragma mark - FMDatabase (FMDBImportExport)
+
+@implementation FMDatabase (FMDBImportExport)
+
+- (NSInteger)importInto:(NSString *)tableName
+     fromFileDescriptor:(int)fileDescriptor
+                 format:(FMDBDataFormat)format
+         commitInterval:(NSUInteger)commitInterval
+                  error:(NSError **)error_p
+{
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(fileDescriptor >= 0);
+  
+  FMDBImporter * importer = [[FMDBImporter alloc] initWithDatabase:self
+                                                         tableName:tableName
+                                                            format:format
+                                                    commitInterval:commitInterval];
+  return [importer importFromFileDescriptor:fileDescriptor
+                                      error:error_p];
+}
+
+- (NSInteger)exportFrom:(NSString *)tableName
+                orderBy:(NSString *)orderBy
+       toFileDescriptor:(int)fileDescriptor
+                 format:(FMDBDataFormat)format
+                  error:(NSError **)error_p
+{
+  FMResultSet * results = [self selectResultsFrom:tableName
+                                          orderBy:orderBy
+                                            error:error_p];
+  if (results == nil)
+  {
+    return -1;
+  }
+  
+  NSInteger rowCount = [results writeRowsToFileDescriptor:fileDescriptor
+                                                   format:format
+                                                    error:error_p];
+  [results close];
+  return rowCount;
+}
+
+@end
+
+// ========== FMResultSet (FMDBImportExport) ===========================================================================
+#pragma mark - FMResultSet (FMDBImportExport)
+
+@implementation FMResultSet (FMDBImportExport)
+
+- (NSInteger)writeRowsToFileDescriptor:(int)fileDescriptor
+                                format:(FMDBDataFormat)format
+                                 error:(NSError **)error_p
+{
+  NSParameterAssert(fileDescriptor >= 0);
+  
+  sqlite3_stmt * statement = self.statement.statement;
+  int columnCount = sqlite3_column_count(statement);
+  BOOL isCSV = (format == FMDBDataFormatCSV);
+  
+  FMDBOutputBuffer output = { .fileDescriptor = fileDescriptor, .capacity = FMDBExportWriteBufferSize };
+  output.bytes = malloc(output.capacity);
+  
+  // column names are escaped once, as the CSV header or as each JSON object's keys
+  NSMutableArray * keys = [[NSMutableArray alloc] initWithCapacity:columnCount];
+  for (int columnIdx = 0; columnIdx < columnCount; columnIdx++)
+  {
+    const char * columnName = sqlite3_column_name(statement, columnIdx);
+    if (isCSV)
+    {
+      if (columnIdx > 0) FMDBOutputAppend(&output, ",", 1);
+      FMDBOutputAppendCSVField(&output, columnName, strlen(columnName));
+    }
+    else
+    {
+      FMDBOutputBuffer key = { .fileDescriptor = -1, .capacity = strlen(columnName) * 6 + 4 };
+      key.bytes = malloc(key.capacity);
+      FMDBOutputAppend(&key, (columnIdx > 0 ? "," : "{"), 1);
+      FMDBOutputAppendJSONString(&key, columnName, strlen(columnName));
+      FMDBOutputAppend(&key, ":", 1);
+      [keys addObject:[[NSData alloc] initWithBytesNoCopy:key.bytes
+                                                   length:key.length
+                                             freeWhenDone:YES]];
+    }
+  }
+  if (isCSV)
+  {
+    FMDBOutputAppend(&output, "\r\n", 2);
+  }
+  
+  id profilingToken = [self beginProfiledSteps];
+  NSInteger rowCount = 0;
+  char number[32];
+  while (output.error == 0 && [self next])
+  {
+    for (int columnIdx = 0; columnIdx < columnCount; columnIdx++)
+    {
+      if (isCSV)
+      {
+        if (columnIdx > 0) FMDBOutputAppend(&output, ",", 1);
+      }
+      else
+      {
+        NSData * key = keys[columnIdx];
+        FMDBOutputAppend(&output, key.bytes, key.length);
+      }
+      
+      switch (sqlite3_column_type(statement, columnIdx))
+      {
+        case SQLITE_NULL:
+          if (NO == isCSV) FMDBOutputAppend(&output, "null", 4);
+          break;
+        
+        case SQLITE_INTEGER:
+          snprintf(number, sizeof(number), "%lld", (long long)sqlite3_column_int64(statement, columnIdx));
+          FMDBOutputAppendString(&output, number);
+          break;
+        
+        case SQLITE_FLOAT:
+        {
+          double real = sqlite3_column_double(statement, columnIdx);
+          if (NO == isCSV && NO == isfinite(real))
+          {
+            // JSON has no infinities
+            FMDBOutputAppend(&output, "null", 4);
+            break;
+          }
+          FMDBFormatReal(real, number, sizeof(number));
+          FMDBOutputAppendString(&output, number);
+          break;
+        }
+        
+        case SQLITE_TEXT:
+        {
+          const char * text = (const char *)sqlite3_column_text(statement, columnIdx);
+          size_t length = (size_t)sqlite3_column_bytes(statement, columnIdx);
+          if (isCSV)
+          {
+            FMDBOutputAppendCSVField(&output, text, length);
+          }
+          else
+          {
+            FMDBOutputAppendJSONString(&output, text, length);
+          }
+          break;
+        }
+        
+        case SQLITE_BLOB:
+        {
+          NSData * blob = [[NSData alloc] initWithBytesNoCopy:(void *)sqlite3_column_blob(statement, columnIdx)
+                                                       length:(NSUInteger)sqlite3_column_bytes(statement, columnIdx)
+                                                 freeWhenDone:NO];
+          NSData * base64 = [blob base64EncodedDataWithOptions:0];
+          if (isCSV)
+          {
+            FMDBOutputAppendCSVField(&output, base64.bytes, base64.length);
+          }
+          else
+          {
+            FMDBOutputAppend(&output, "\"", 1);
+            FMDBOutputAppend(&output, base64.bytes, base64.length);
+            FMDBOutputAppend(&output, "\"", 1);
+          }
+          break;
+        }
+      }
+    }
+    
+    if (isCSV)
+    {
+      FMDBOutputAppend(&output, "\r\n", 2);
+    }
+    else
+    {
+      FMDBOutputAppend(&output, (columnCount > 0 ? "}\n" : "{}\n"), (columnCount > 0 ? 2 : 3));
+    }
+    rowCount++;
+  }
+  
+  FMDBOutputFlush(&output);
+  free(output.bytes);
+  
+  BOOL succeeded = (output.error == 0 && NO == [self.parentDB hadError]);
+  [self endProfiledSteps:profilingToken
+                rowCount:(NSUInteger)rowCount
+                finished:succeeded];
+  
+  if (NO == succeeded)
+  {
+    if (error_p != NULL)
+    {
+      *error_p = (output.error != 0
+                  ? [NSError errorWithDomain:NSPOSIXErrorDomain code:output.error userInfo:nil]
+                  : self.parentDB.lastError);
+    }
+    return -1;
+  }
+  return rowCount;
+}
+
+@end
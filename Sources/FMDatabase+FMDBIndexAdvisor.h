@@ -0,0 +1,119 @@
+#import "FMDatabase.h"
+
+/**
+ *  A proposed index, backed by the query plans of statements that scanned a table or sorted results in a temporary
+ *  b-tree because no suitable index exists.
+ */
+@interface FMDBIndexAdvice : NSObject <NSCopying>
+
+/**
+ *  The table to index.
+ */
+@property (nonatomic, copy, readonly) NSString * tableName;
+
+/**
+ *  The columns to index, in order: columns matched to a single value, then columns matched to a list or set of
+ *  values, then the columns results were ordered by.
+ */
+@property (nonatomic, copy, readonly) NSArray * columnNames;
+
+/**
+ *  A name for the index, made from the table and column names.
+ */
+@property (nonatomic, copy, readonly) NSString * indexName;
+
+/**
+ *  The SQL of the statements that would use the index.
+ */
+@property (nonatomic, copy, readonly) NSSet * statements;
+
+/**
+ *  Whether any of the statements scanned the whole table, directly or through an index.
+ */
+@property (nonatomic, assign, readonly) BOOL causesFullScan;
+
+/**
+ *  Whether any of the statements sorted results in a temporary b-tree.
+ */
+@property (nonatomic, assign, readonly) BOOL causesTemporarySort;
+
+/**
+ *  The number of times the statements were executed while index advice was enabled.
+ */
+@property (nonatomic, assign, readonly) NSUInteger executionCount;
+
+/**
+ *  An estimate of the rows visited without the index: for each execution, the size of the table when it was scanned,
+ *  or the logarithm of its size when results were only sorted. Advice is ranked by this cost. The size of a table
+ *  without row IDs is only known from `sqlite_stat1` after `ANALYZE`, as counting it would scan it.
+ */
+@property (nonatomic, assign, readonly) double estimatedCost;
+
+@end
+
+@interface FMDatabase (FMDBIndexAdvisor)
+
+// ========== INDEX ADVICE =============================================================================================
+#pragma mark - Index Advice
+
+/// @name Advising Indexes
+
+/**
+ *  Whether statements built from `matchingValues` are checked for missing indexes. The first time a select, count,
+ *  update, or delete of a new shape is executed, its plan is read with `EXPLAIN QUERY PLAN`. Plans that scan the table
+ *  or sort with a temporary b-tree produce `FMDBIndexAdvice` for the matched columns and ORDER BY terms, unless an
+ *  existing index already serves those columns, and later executions of the same statement add to the advice's
+ *  frequency. The plans of the most recent 1000 or so statements are remembered. Defaults to `NO`.
+ */
+@property (nonatomic, assign) BOOL shouldAdviseIndexes;
+
+/**
+ *  Called the first time a statement produces index advice, e.g. so a test can fail when a query needs an index.
+ */
+@property (nonatomic, copy) void (^indexAdviceHandler)(FMDBIndexAdvice * advice, NSString * statement);
+
+/**
+ *  Returns a snapshot of the index advice collected so far, ordered from the highest to the lowest estimated cost.
+ */
+- (NSArray *)indexAdvice;
+
+/**
+ *  Discards all index advice, and forgets which statements have already been checked.
+ */
+- (void)resetIndexAdvice;
+
+/**
+ *  Creates the indexes proposed by the given advice with `-createIndexIfNeeded:created:error:`, so an index isn't
+ *  created if an existing index already serves it. The advice is discarded, and its statements are checked again the
+ *  next time they're executed.
+ *
+ *  @param  advice    An array of `FMDBIndexAdvice`, e.g. from `-indexAdvice`.
+ *  @param  error_p   A pointer to any error that occurs.
+ *
+ *  @return `YES` if every index was created, `NO` if not.
+ */
+- (BOOL)applyIndexAdvice:(NSArray *)advice
+                   error:(NSError **)error_p;
+
+// ---------- RECORDING ------------------------------------------------------------------------------------------------
+#pragma mark Recording
+
+/// @name Recording Statements
+
+/**
+ *  Checks a statement's plan the first time it's seen, and counts executions of statements that produced advice. Does
+ *  nothing unless `shouldAdviseIndexes` is enabled.
+ *
+ *  @param  sql             The statement's SQL.
+ *  @param  arguments       The statement's arguments.
+ *  @param  tableName       The table the statement reads from or writes to.
+ *  @param  valuesToMatch   The values the statement matches, as passed to the helper.
+ *  @param  orderBy         The statement's ORDER BY clause, or `nil`.
+ */
+- (void)adviseIndexesForStatement:(NSString *)sql
+                        arguments:(NSArray *)arguments
+                        tableName:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch
+                          orderBy:(NSString *)orderBy;
+
+@end
@@ -0,0 +1,455 @@
+#import "FMDatabase+FMDBIndexAdvisor.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBIndexes.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMDatabase+FMDBStatementCache.h"
+#import <FMDB/FMDatabaseAdditions.h>
+#import <objc/runtime.h>
+
+static const void * FMDBIndexAdvisorKey = &FMDBIndexAdvisorKey;
+
+// the number of statements whose plans are remembered, so that a stream of distinct statements can't grow them forever
+static const NSUInteger FMDBIndexAdvisorStatementLimit = 1000;
+
+// ========== FMDBIndexAdvice ==========================================================================================
+#pragma mark - FMDBIndexAdvice
+
+@interface FMDBIndexAdvice ()
+
+@property (nonatomic, copy, readwrite) NSString * tableName;
+@property (nonatomic, copy, readwrite) NSArray * columnNames;
+@property (nonatomic, copy, readwrite) NSSet * statements;
+@property (nonatomic, assign, readwrite) BOOL causesFullScan;
+@property (nonatomic, assign, readwrite) BOOL causesTemporarySort;
+@property (nonatomic, assign, readwrite) NSUInteger executionCount;
+@property (nonatomic, assign, readwrite) double estimatedCost;
+
+@end
+
+@implementation FMDBIndexAdvice
+
+- (NSString *)indexName
+{
+  return [[@[ self.tableName ] arrayByAddingObjectsFromArray:self.columnNames] componentsJoinedByString:@"_"];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  FMDBIndexAdvice * copy = [[[self class] allocWithZone:zone] init];
+  copy.tableName = self.tableName;
+  copy.columnNames = self.columnNames;
+  copy.statements = self.statements;
+  copy.causesFullScan = self.causesFullScan;
+  copy.causesTemporarySort = self.causesTemporarySort;
+  copy.executionCount = self.executionCount;
+  copy.estimatedCost = self.estimatedCost;
+  return copy;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@ %@ (%@), %lu executions, cost %.0f%@%@>",
+          NSStringFromClass([self class]),
+          self.tableName,
+          [self.columnNames componentsJoinedByString:@", "],
+          (unsigned long)self.executionCount,
+          self.estimatedCost,
+          (self.causesFullScan ? @", full scan" : @""),
+          (self.causesTemporarySort ? @", temporary sort" : @"")];
+}
+
+@end
+
+// ========== FMDBAdvisedStatement =====================================================================================
+#pragma mark - FMDBAdvisedStatement
+
+/**
+ *  A statement whose plan produced advice, and the cost added to the advice each time it's executed.
+ */
+@interface FMDBAdvisedStatement : NSObject
+
+@property (nonatomic, strong) FMDBIndexAdvice * advice;
+@property (nonatomic, assign) double costPerExecution;
+
+@end
+
+@implementation FMDBAdvisedStatement
+
+@end
+
+// ========== FMDBIndexAdvisor =========================================================================================
+#pragma mark - FMDBIndexAdvisor
+
+@interface FMDBIndexAdvisor : NSObject
+
+@property (nonatomic, assign) BOOL enabled;
+@property (nonatomic, copy) void (^handler)(FMDBIndexAdvice * advice, NSString * statement);
+
+// statements whose plans have been read, including those that need no index; evicted statements are checked again
+@property (nonatomic, strong, readonly) NSCache * checkedStatements;
+@property (nonatomic, strong, readonly) NSCache * advisedStatementsBySQL;
+@property (nonatomic, strong, readonly) NSMutableDictionary * adviceByKey;
+
+@end
+
+@implementation FMDBIndexAdvisor
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _checkedStatements = [[NSCache alloc] init];
+    _checkedStatements.countLimit = FMDBIndexAdvisorStatementLimit;
+    _advisedStatementsBySQL = [[NSCache alloc] init];
+    _advisedStatementsBySQL.countLimit = FMDBIndexAdvisorStatementLimit;
+    _adviceByKey = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+@end
+
+// ========== FMDatabase (FMDBIndexAdvisor) ============================================================================
+#pragma mark - FMDatabase (FMDBIndexAdvisor)
+
+@implementation FMDatabase (FMDBIndexAdvisor)
+
+- (FMDBIndexAdvisor *)indexAdvisor
+{
+  FMDBIndexAdvisor * advisor = objc_getAssociatedObject(self, FMDBIndexAdvisorKey);
+  if (advisor == nil)
+  {
+    advisor = [[FMDBIndexAdvisor alloc] init];
+    objc_setAssociatedObject(self, FMDBIndexAdvisorKey, advisor, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return advisor;
+}
+
+- (BOOL)shouldAdviseIndexes
+{
+  return [objc_getAssociatedObject(self, FMDBIndexAdvisorKey) enabled];
+}
+
+- (void)setShouldAdviseIndexes:(BOOL)shouldAdviseIndexes
+{
+  self.indexAdvisor.enabled = shouldAdviseIndexes;
+}
+
+- (void (^)(FMDBIndexAdvice *, NSString *))indexAdviceHandler
+{
+  return [objc_getAssociatedObject(self, FMDBIndexAdvisorKey) handler];
+}
+
+- (void)setIndexAdviceHandler:(void (^)(FMDBIndexAdvice *, NSString *))indexAdviceHandler
+{
+  self.indexAdvisor.handler = indexAdviceHandler;
+}
+
+- (NSArray *)indexAdvice
+{
+  FMDBIndexAdvisor * advisor = objc_getAssociatedObject(self, FMDBIndexAdvisorKey);
+  NSMutableArray * advice = [[NSMutableArray alloc] initWithCapacity:advisor.adviceByKey.count];
+  for (FMDBIndexAdvice * tableAdvice in advisor.adviceByKey.objectEnumerator)
+  {
+    [advice addObject:[tableAdvice copy]];
+  }
+  
+  [advice sortUsingComparator:^NSComparisonResult(FMDBIndexAdvice * advice1, FMDBIndexAdvice * advice2) {
+    if (advice1.estimatedCost == advice2.estimatedCost)
+    {
+      return [advice1.indexName compare:advice2.indexName];
+    }
+    return (advice1.estimatedCost > advice2.estimatedCost ? NSOrderedAscending : NSOrderedDescending);
+  }];
+  return advice;
+}
+
+- (void)resetIndexAdvice
+{
+  FMDBIndexAdvisor * advisor = objc_getAssociatedObject(self, FMDBIndexAdvisorKey);
+  [advisor.checkedStatements removeAllObjects];
+  [advisor.advisedStatementsBySQL removeAllObjects];
+  [advisor.adviceByKey removeAllObjects];
+}
+
+- (BOOL)applyIndexAdvice:(NSArray *)advice
+                   error:(NSError **)error_p
+{
+  FMDBIndexAdvisor * advisor = objc_getAssociatedObject(self, FMDBIndexAdvisorKey);
+  for (FMDBIndexAdvice * tableAdvice in advice)
+  {
+    FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:tableAdvice.indexName
+                                                                    tableName:tableAdvice.tableName
+                                                                         keys:tableAdvice.columnNames];
+    if (NO == [self createIndexIfNeeded:index
+                                created:NULL
+                                  error:error_p])
+    {
+      return NO;
+    }
+    
+    // the statements' plans are read again, in case the index isn't enough
+    [advisor.adviceByKey removeObjectForKey:[FMDatabase keyOfIndexAdvice:tableAdvice]];
+    for (NSString * statement in tableAdvice.statements)
+    {
+      [advisor.checkedStatements removeObjectForKey:statement];
+      [advisor.advisedStatementsBySQL removeObjectForKey:statement];
+    }
+  }
+  return YES;
+}
+
++ (NSString *)keyOfIndexAdvice:(FMDBIndexAdvice *)advice
+{
+  NSArray * components = [@[ advice.tableName ] arrayByAddingObjectsFromArray:advice.columnNames];
+  return [FMDatabase statementShapeWithComponents:components].lowercaseString;
+}
+
+// ---------- RECORDING ------------------------------------------------------------------------------------------------
+#pragma mark Recording
+
+- (void)adviseIndexesForStatement:(NSString *)sql
+                        arguments:(NSArray *)arguments
+                        tableName:(NSString *)tableName
+                   matchingValues:(NSDictionary *)valuesToMatch
+                          orderBy:(NSString *)orderBy
+{
+  FMDBIndexAdvisor * advisor = objc_getAssociatedObject(self, FMDBIndexAdvisorKey);
+  if (NO == advisor.enabled)
+  {
+    return;
+  }
+  
+  FMDBAdvisedStatement * advisedStatement = [advisor.advisedStatementsBySQL objectForKey:sql];
+  if (advisedStatement != nil)
+  {
+    advisedStatement.advice.executionCount++;
+    advisedStatement.advice.estimatedCost += advisedStatement.costPerExecution;
+    return;
+  }
+  else if ([advisor.checkedStatements objectForKey:sql] != nil)
+  {
+    return;
+  }
+  [advisor.checkedStatements setObject:@YES forKey:sql];
+  
+  // only tables can be indexed, so statements that select from joins or views are skipped
+  NSDictionary * tableSchema = [self.schemaCatalog schemaOfTable:tableName];
+  if (tableSchema == nil)
+  {
+    return;
+  }
+  
+  BOOL scansTable = NO;
+  BOOL sortsTemporarily = NO;
+  for (NSString * detail in [self queryPlanOfStatement:sql arguments:arguments])
+  {
+    scansTable = scansTable || [FMDatabase queryPlanDetail:detail scansTable:tableName];
+    sortsTemporarily = sortsTemporarily || [detail rangeOfString:@"USE TEMP B-TREE"].location != NSNotFound;
+  }
+  
+  if (NO == scansTable && NO == sortsTemporarily)
+  {
+    return;
+  }
+  
+  NSArray * columnNames = [FMDatabase columnsToIndexForMatchingValues:valuesToMatch
+                                                              orderBy:orderBy
+                                                          tableSchema:tableSchema];
+  if (columnNames.count == 0)
+  {
+    return;
+  }
+  
+  FMDBIndexAdvice * advice = [[FMDBIndexAdvice alloc] init];
+  advice.tableName = tableName;
+  advice.columnNames = columnNames;
+  
+  // a scan through an index that already leads with these columns, e.g. one that only serves the ORDER BY of an
+  // unfiltered select, isn't helped by another index
+  FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:advice.indexName
+                                                                  tableName:tableName
+                                                                       keys:columnNames];
+  if ([self existingIndexServing:index] != nil)
+  {
+    return;
+  }
+  
+  NSString * adviceKey = [FMDatabase keyOfIndexAdvice:advice];
+  FMDBIndexAdvice * existingAdvice = advisor.adviceByKey[adviceKey];
+  if (existingAdvice != nil)
+  {
+    advice = existingAdvice;
+  }
+  else
+  {
+    advice.statements = [NSSet set];
+    advisor.adviceByKey[adviceKey] = advice;
+  }
+  
+  double rowCount = [self estimatedRowCountOfTable:tableName];
+  advisedStatement = [[FMDBAdvisedStatement alloc] init];
+  advisedStatement.advice = advice;
+  advisedStatement.costPerExecution = (scansTable ? MAX(rowCount, 1) : log2(MAX(rowCount, 2)));
+  [advisor.advisedStatementsBySQL setObject:advisedStatement forKey:sql];
+  
+  advice.statements = [advice.statements setByAddingObject:sql];
+  advice.causesFullScan = advice.causesFullScan || scansTable;
+  advice.causesTemporarySort = advice.causesTemporarySort || sortsTemporarily;
+  advice.executionCount++;
+  advice.estimatedCost += advisedStatement.costPerExecution;
+  
+  if (advisor.handler != nil)
+  {
+    advisor.handler([advice copy], sql);
+  }
+}
+
+- (NSArray *)queryPlanOfStatement:(NSString *)sql
+                        arguments:(NSArray *)arguments
+{
+  FMResultSet * results = [self executeQuery:[@"EXPLAIN QUERY PLAN " stringByAppendingString:sql]
+                        withArgumentsInArray:arguments];
+  
+  // the detail column is named the same in every version of sqlite, unlike the columns before it
+  NSMutableArray * details = [[NSMutableArray alloc] init];
+  while ([results next])
+  {
+    NSString * detail = [results stringForColumn:@"detail"];
+    if (detail != nil)
+    {
+      [details addObject:detail];
+    }
+  }
+  return details;
+}
+
++ (BOOL)queryPlanDetail:(NSString *)detail
+             scansTable:(NSString *)tableName
+{
+  // e.g. "SCAN TABLE people (~1000000 rows)" before sqlite 3.24, and "SCAN people" since. A scan "USING INDEX" or
+  // "USING COVERING INDEX" still reads every row, in the index's order, so it counts as well
+  NSScanner * scanner = [NSScanner scannerWithString:detail];
+  scanner.caseSensitive = NO;
+  if (NO == [scanner scanString:@"SCAN" intoString:NULL])
+  {
+    return NO;
+  }
+  [scanner scanString:@"TABLE" intoString:NULL];
+  
+  NSString * scannedName = nil;
+  [scanner scanUpToCharactersFromSet:[NSCharacterSet whitespaceCharacterSet]
+                          intoString:&scannedName];
+  return (scannedName != nil && [scannedName caseInsensitiveCompare:tableName] == NSOrderedSame);
+}
+
++ (NSArray *)columnsToIndexForMatchingValues:(NSDictionary *)valuesToMatch
+                                     orderBy:(NSString *)orderBy
+                                 tableSchema:(NSDictionary *)tableSchema
+{
+  // columns compared for equality come first, so that an index on them also serves ranges and ordering
+  NSMutableArray * equalityColumnNames = [[NSMutableArray alloc] init];
+  NSMutableArray * listColumnNames = [[NSMutableArray alloc] init];
+  for (id columnKey in [FMDatabase columnKeysOfMatchingValues:valuesToMatch])
+  {
+    id value = valuesToMatch[columnKey];
+    if ([columnKey isKindOfClass:[NSArray class]])
+    {
+      [listColumnNames addObjectsFromArray:columnKey];
+    }
+    else if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[FMDBMatchingSet class]])
+    {
+      [listColumnNames addObject:columnKey];
+    }
+    else
+    {
+      [equalityColumnNames addObject:columnKey];
+    }
+  }
+  
+  NSMutableArray * candidateColumnNames = [[NSMutableArray alloc] init];
+  [candidateColumnNames addObjectsFromArray:equalityColumnNames];
+  [candidateColumnNames addObjectsFromArray:listColumnNames];
+  [candidateColumnNames addObjectsFromArray:[FMDatabase columnNamesOfOrderBy:orderBy]];
+  
+  NSMutableArray * columnNames = [[NSMutableArray alloc] initWithCapacity:candidateColumnNames.count];
+  NSMutableSet * seenColumnNames = [[NSMutableSet alloc] init];
+  for (NSString * candidateColumnName in candidateColumnNames)
+  {
+    // column names are matched case-insensitively, like sqlite does
+    NSString * columnName = nil;
+    for (NSString * schemaColumnName in tableSchema)
+    {
+      if ([schemaColumnName caseInsensitiveCompare:candidateColumnName] == NSOrderedSame)
+      {
+        columnName = schemaColumnName;
+        break;
+      }
+    }
+    
+    if (columnName != nil && NO == [seenColumnNames containsObject:columnName.lowercaseString])
+    {
+      [seenColumnNames addObject:columnName.lowercaseString];
+      [columnNames addObject:columnName];
+    }
+  }
+  return columnNames;
+}
+
++ (NSArray *)columnNamesOfOrderBy:(NSString *)orderBy
+{
+  NSMutableArray * columnNames = [[NSMutableArray alloc] init];
+  NSCharacterSet * quoteCharacters = [NSCharacterSet characterSetWithCharactersInString:@"\"`[]"];
+  for (NSString * term in [orderBy componentsSeparatedByString:@","])
+  {
+    NSMutableArray * words = [[[term stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]
+                               componentsSeparatedByString:@" "] mutableCopy];
+    [words removeObject:@""];
+    
+    NSString * lastWord = words.lastObject;
+    if (words.count == 2 &&
+        ([lastWord caseInsensitiveCompare:@"ASC"] == NSOrderedSame ||
+         [lastWord caseInsensitiveCompare:@"DESC"] == NSOrderedSame))
+    {
+      [words removeLastObject];
+    }
+    
+    // an index can't be ordered by an expression, or by any terms after one
+    NSString * columnName = [words.firstObject stringByTrimmingCharactersInSet:quoteCharacters];
+    if (words.count != 1 || [columnName rangeOfString:@"("].location != NSNotFound)
+    {
+      break;
+    }
+    [columnNames addObject:columnName];
+  }
+  return columnNames;
+}
+
+- (double)estimatedRowCountOfTable:(NSString *)tableName
+{
+  NSString * tableSQL = [self.schemaCatalog sqlForTable:tableName];
+  BOOL hasRowIds = ([tableSQL rangeOfString:@"WITHOUT ROWID"
+                                    options:NSCaseInsensitiveSearch].location == NSNotFound);
+  
+  // the largest row ID is found without a scan, and is close to the number of rows unless many have been deleted.
+  // Tables without row IDs would have to be counted, so they're estimated from sqlite_stat1 after ANALYZE, whose stats
+  // start with the number of rows, or not at all
+  FMResultSet * results = nil;
+  if (hasRowIds)
+  {
+    results = [self executeQuery:[@"SELECT max(rowid) FROM " stringByAppendingString:
+                                  [FMDatabase escapeIdentifier:tableName]]];
+  }
+  else if ([self tableExists:@"sqlite_stat1"])
+  {
+    results = [self executeQuery:@"SELECT max(CAST(stat AS INTEGER)) FROM sqlite_stat1 WHERE tbl = ? COLLATE NOCASE"
+            withArgumentsInArray:@[ tableName ]];
+  }
+  double rowCount = ([results next] ? [results doubleForColumnIndex:0] : 0);
+  [results close];
+  return rowCount;
+}
+
+@end
@@ -0,0 +1,161 @@
+#import "FMDatabase.h"
+
+/**
+ *  A key of an index: a column or an expression, with an optional collation and sort order.
+ */
+@interface FMDBIndexKey : NSObject <NSCopying>
+
+/**
+ *  Returns a key on a column, in ascending order with the column's collation.
+ */
++ (instancetype)keyWithColumn:(NSString *)columnName;
+
+/**
+ *  Returns a key on a column with a collation, e.g. `NOCASE`, or `nil` for the column's, and a sort order.
+ */
++ (instancetype)keyWithColumn:(NSString *)columnName
+                    collation:(NSString *)collation
+                   descending:(BOOL)descending;
+
+/**
+ *  Returns a key on an expression of the table's columns, e.g. `lower(email)`. The expression is SQL, and must only
+ *  use deterministic functions. Expression keys require sqlite 3.9.0.
+ */
++ (instancetype)keyWithExpression:(NSString *)expression;
+
+/**
+ *  The indexed column, or `nil` for an expression.
+ */
+@property (nonatomic, copy, readonly) NSString * columnName;
+
+/**
+ *  The indexed expression, or `nil` for a column.
+ */
+@property (nonatomic, copy, readonly) NSString * expression;
+
+/**
+ *  The collation of the key, or `nil` for the column's or expression's.
+ */
+@property (nonatomic, copy, readonly) NSString * collation;
+
+/**
+ *  Whether the key is sorted in descending order.
+ */
+@property (nonatomic, assign, readonly) BOOL descending;
+
+/**
+ *  The key as an indexed column of CREATE INDEX, e.g. `"email" COLLATE "NOCASE" DESC`.
+ */
+- (NSString *)sql;
+
+@end
+
+/**
+ *  An index, either one to create with `-[FMDatabase createIndex:error:]`, or one that exists, as described by
+ *  `-[FMDatabase indexesOnTable:]`.
+ */
+@interface FMDBIndexDescription : NSObject <NSCopying>
+
+/**
+ *  Describes an index on the given keys.
+ *
+ *  @param  indexName   The name of the index.
+ *  @param  tableName   The table to index.
+ *  @param  keys        `FMDBIndexKey` instances, or column names as strings.
+ */
+- (instancetype)initWithName:(NSString *)indexName
+                   tableName:(NSString *)tableName
+                        keys:(NSArray *)keys;
+
+@property (nonatomic, copy, readonly) NSString * indexName;
+@property (nonatomic, copy, readonly) NSString * tableName;
+
+/**
+ *  The index's keys, as `FMDBIndexKey` instances.
+ */
+@property (nonatomic, copy, readonly) NSArray * keys;
+
+/**
+ *  Columns stored in the index after its keys, so that queries that select only those columns and the keys are
+ *  answered from the index alone, without reading the table. sqlite has no INCLUDE clause, so these columns are
+ *  indexed as trailing keys, and an existing index describes them as keys.
+ */
+@property (nonatomic, copy) NSArray * includedColumnNames;
+
+/**
+ *  A WHERE clause, without the WHERE keyword, limiting the index to the rows that match it, or `nil` to index every
+ *  row. A partial index on a rare value is much smaller, and cheaper to maintain, than one on every row. Queries only
+ *  use a partial index if their WHERE clause implies its own. Partial indexes require sqlite 3.8.0.
+ */
+@property (nonatomic, copy) NSString * where;
+
+/**
+ *  Whether the index is unique. Defaults to `NO`.
+ */
+@property (nonatomic, assign, getter = isUnique) BOOL unique;
+
+/**
+ *  The index's keys followed by keys on its included columns.
+ */
+- (NSArray *)allKeys;
+
+/**
+ *  Returns the CREATE INDEX statement for the index.
+ */
+- (NSString *)sql;
+
+/**
+ *  Returns whether this index makes another redundant, as it can be used for every query that could use the other.
+ *  That's the case when both are on the same table, the other's keys are the leading keys of this index, with the same
+ *  collations and sort orders, this index includes the other's included columns, and this index covers at least the
+ *  rows of the other: it has no WHERE clause, or the same WHERE clause. A unique index only serves a unique index on
+ *  the same keys, as it is also a constraint.
+ */
+- (BOOL)servesIndex:(FMDBIndexDescription *)index;
+
+@end
+
+@interface FMDatabase (FMDBIndexes)
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+/// @name Describing Indexes
+
+/**
+ *  Returns descriptions of all indexes on a table, including those created by PRIMARY KEY and UNIQUE constraints, in
+ *  the order that `PRAGMA index_list` lists them.
+ */
+- (NSArray *)indexesOnTable:(NSString *)tableName;
+
+/**
+ *  Returns an existing index that serves every query the given index would, as described by
+ *  `-[FMDBIndexDescription servesIndex:]`, or `nil` if there is none. When several do, the first returned by
+ *  `-indexesOnTable:` is chosen.
+ */
+- (FMDBIndexDescription *)existingIndexServing:(FMDBIndexDescription *)index;
+
+/// @name Creating Indexes
+
+/**
+ *  Creates an index with its keys' collations and sort orders, its included columns, and its WHERE clause.
+ *
+ *  @return `YES` if successful, `NO` if an error occurs, or the index uses features this version of sqlite lacks.
+ */
+- (BOOL)createIndex:(FMDBIndexDescription *)index
+              error:(NSError **)error_p;
+
+/**
+ *  Creates an index unless an existing index already serves it, as returned by `-existingIndexServing:`.
+ *
+ *  @param  index       The index to create.
+ *  @param  created_p   Returns whether the index was created. May be `NULL`.
+ *  @param  error_p     A pointer to any error that occurs.
+ *
+ *  @return `YES` if the index was created or is already served, `NO` if an error occurs.
+ */
+- (BOOL)createIndexIfNeeded:(FMDBIndexDescription *)index
+                    created:(BOOL *)created_p
+                      error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,554 @@
+#import "FMDatabase+FMDBIndexes.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+
+// a quoted or bare identifier, as sqlite accepts them
+static NSString * const FMDBIdentifierPattern =
+  @"(\"(?:[^\"]|\"\")+\"|\\[[^\\]]+\\]|`(?:[^`]|``)+`|[A-Za-z_][A-Za-z0-9_$]*)";
+
+/**
+ *  Returns SQL with runs of whitespace collapsed and letters lowercased, so that equivalent expressions and WHERE
+ *  clauses written differently compare equal.
+ */
+static NSString * FMDBNormalizedSQL(NSString * sql)
+{
+  NSArray * words = [sql.lowercaseString componentsSeparatedByCharactersInSet:
+                     [NSCharacterSet whitespaceAndNewlineCharacterSet]];
+  return [[words filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]]
+          componentsJoinedByString:@" "];
+}
+
+/**
+ *  Returns the first match of a case-insensitive regular expression in a string, or `nil`.
+ */
+static NSTextCheckingResult * FMDBFirstMatch(NSString * pattern, NSString * string)
+{
+  NSRegularExpression * regex = [NSRegularExpression regularExpressionWithPattern:pattern
+                                                                          options:NSRegularExpressionCaseInsensitive
+                                                                            error:NULL];
+  return [regex firstMatchInString:string
+                           options:0
+                             range:NSMakeRange(0, string.length)];
+}
+
+/**
+ *  Returns an identifier without its quotes.
+ */
+static NSString * FMDBUnquotedIdentifier(NSString * identifier)
+{
+  if (identifier.length < 2)
+  {
+    return identifier;
+  }
+  
+  unichar firstCharacter = [identifier characterAtIndex:0];
+  NSString * unquoted = [identifier substringWithRange:NSMakeRange(1, identifier.length - 2)];
+  switch (firstCharacter)
+  {
+    case '"':
+      return [unquoted stringByReplacingOccurrencesOfString:@"\"\"" withString:@"\""];
+    case '`':
+      return [unquoted stringByReplacingOccurrencesOfString:@"``" withString:@"`"];
+    case '[':
+    case '\'':
+      return unquoted;
+    default:
+      return identifier;
+  }
+}
+
+// ========== FMDBIndexKey =============================================================================================
+#pragma mark - FMDBIndexKey
+
+@interface FMDBIndexKey ()
+
+@property (nonatomic, copy, readwrite) NSString * columnName;
+@property (nonatomic, copy, readwrite) NSString * expression;
+@property (nonatomic, copy, readwrite) NSString * collation;
+@property (nonatomic, assign, readwrite) BOOL descending;
+
++ (instancetype)keyWithSQL:(NSString *)sql;
+
+@end
+
+@implementation FMDBIndexKey
+
++ (instancetype)keyWithColumn:(NSString *)columnName
+{
+  return [self keyWithColumn:columnName
+                   collation:nil
+                  descending:NO];
+}
+
++ (instancetype)keyWithColumn:(NSString *)columnName
+                    collation:(NSString *)collation
+                   descending:(BOOL)descending
+{
+  NSParameterAssert(columnName != nil);
+  
+  FMDBIndexKey * key = [[self alloc] init];
+  key.columnName = columnName;
+  key.collation = collation;
+  key.descending = descending;
+  return key;
+}
+
++ (instancetype)keyWithExpression:(NSString *)expression
+{
+  NSParameterAssert(expression.length > 0);
+  
+  FMDBIndexKey * key = [[self alloc] init];
+  key.expression = expression;
+  return key;
+}
+
+/**
+ *  Parses an indexed column of CREATE INDEX, e.g. `lower("email") COLLATE NOCASE DESC`.
+ */
++ (instancetype)keyWithSQL:(NSString *)sql
+{
+  NSString * term = [sql stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+  
+  BOOL descending = NO;
+  NSTextCheckingResult * order = FMDBFirstMatch(@"\\s+(ASC|DESC)$", term);
+  if (order != nil)
+  {
+    descending = ([[term substringWithRange:[order rangeAtIndex:1]] caseInsensitiveCompare:@"DESC"] == NSOrderedSame);
+    term = [term substringToIndex:order.range.location];
+  }
+  
+  NSString * collation = nil;
+  NSString * collationPattern = [NSString stringWithFormat:@"\\s+COLLATE\\s+(%@|'[^']+')$", FMDBIdentifierPattern];
+  NSTextCheckingResult * collate = FMDBFirstMatch(collationPattern, term);
+  if (collate != nil)
+  {
+    collation = FMDBUnquotedIdentifier([term substringWithRange:[collate rangeAtIndex:1]]);
+    term = [term substringToIndex:collate.range.location];
+  }
+  
+  NSString * identifierPattern = [NSString stringWithFormat:@"^%@$", FMDBIdentifierPattern];
+  if (FMDBFirstMatch(identifierPattern, term) != nil)
+  {
+    return [self keyWithColumn:FMDBUnquotedIdentifier(term)
+                     collation:collation
+                    descending:descending];
+  }
+  
+  FMDBIndexKey * key = [self keyWithExpression:term];
+  key.collation = collation;
+  key.descending = descending;
+  return key;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  // keys are immutable
+  return self;
+}
+
+- (NSUInteger)hash
+{
+  return (self.columnName.lowercaseString ?: FMDBNormalizedSQL(self.expression)).hash;
+}
+
+- (BOOL)isEqual:(FMDBIndexKey *)other
+{
+  if (NO == [other isKindOfClass:[FMDBIndexKey class]])
+  {
+    return NO;
+  }
+  
+  BOOL sameTerm = (self.columnName != nil
+                   ? (other.columnName != nil &&
+                      [self.columnName caseInsensitiveCompare:other.columnName] == NSOrderedSame)
+                   : (other.expression != nil &&
+                      [FMDBNormalizedSQL(self.expression) isEqualToString:FMDBNormalizedSQL(other.expression)]));
+  BOOL sameCollation = (self.collation != nil
+                        ? (other.collation != nil &&
+                           [self.collation caseInsensitiveCompare:other.collation] == NSOrderedSame)
+                        : other.collation == nil);
+  return (sameTerm && sameCollation && self.descending == other.descending);
+}
+
+- (NSString *)sql
+{
+  NSMutableArray * keySQL = [[NSMutableArray alloc] init];
+  [keySQL addObject:(self.columnName != nil ? [FMDatabase escapeIdentifier:self.columnName] : self.expression)];
+  if (self.collation != nil)
+  {
+    [keySQL addObject:@"COLLATE"];
+    [keySQL addObject:[FMDatabase escapeIdentifier:self.collation]];
+  }
+  if (self.descending)
+  {
+    [keySQL addObject:@"DESC"];
+  }
+  return [keySQL componentsJoinedByString:@" "];
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %@>", [self class], [self sql]];
+}
+
+@end
+
+// ========== FMDBIndexDescription =====================================================================================
+#pragma mark - FMDBIndexDescription
+
+@interface FMDBIndexDescription ()
+
+@property (nonatomic, copy, readwrite) NSString * indexName;
+@property (nonatomic, copy, readwrite) NSString * tableName;
+@property (nonatomic, copy, readwrite) NSArray * keys;
+
+@end
+
+@implementation FMDBIndexDescription
+
+- (instancetype)initWithName:(NSString *)indexName
+                   tableName:(NSString *)tableName
+                        keys:(NSArray *)keys
+{
+  NSParameterAssert(indexName != nil);
+  NSParameterAssert(tableName != nil);
+  NSParameterAssert(keys.count > 0);
+  
+  self = [super init];
+  if (self)
+  {
+    NSMutableArray * indexKeys = [[NSMutableArray alloc] initWithCapacity:keys.count];
+    for (id key in keys)
+    {
+      [indexKeys addObject:([key isKindOfClass:[FMDBIndexKey class]] ? key : [FMDBIndexKey keyWithColumn:key])];
+    }
+    
+    _indexName = [indexName copy];
+    _tableName = [tableName copy];
+    _keys = [indexKeys copy];
+    _includedColumnNames = @[];
+  }
+  return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  FMDBIndexDescription * copy = [[[self class] allocWithZone:zone] initWithName:self.indexName
+                                                                      tableName:self.tableName
+                                                                           keys:self.keys];
+  copy.includedColumnNames = self.includedColumnNames;
+  copy.where = self.where;
+  copy.unique = self.unique;
+  return copy;
+}
+
+- (void)setIncludedColumnNames:(NSArray *)includedColumnNames
+{
+  _includedColumnNames = [includedColumnNames copy] ?: @[];
+}
+
+- (NSArray *)allKeys
+{
+  NSMutableArray * allKeys = [self.keys mutableCopy];
+  for (NSString * columnName in self.includedColumnNames)
+  {
+    [allKeys addObject:[FMDBIndexKey keyWithColumn:columnName]];
+  }
+  return allKeys;
+}
+
+- (NSString *)sql
+{
+  NSMutableArray * keySQL = [[NSMutableArray alloc] init];
+  for (FMDBIndexKey * key in [self allKeys])
+  {
+    [keySQL addObject:[key sql]];
+  }
+  
+  NSMutableArray * createIndex = [[NSMutableArray alloc] init];
+  [createIndex addObject:@"CREATE"];
+  if (self.unique)
+  {
+    [createIndex addObject:@"UNIQUE"];
+  }
+  [createIndex addObject:@"INDEX"];
+  [createIndex addObject:[FMDatabase escapeIdentifier:self.indexName]];
+  [createIndex addObject:@"ON"];
+  [createIndex addObject:[FMDatabase escapeIdentifier:self.tableName]];
+  [createIndex addObject:[NSString stringWithFormat:@"(%@)", [keySQL componentsJoinedByString:@", "]]];
+  if (self.where.length > 0)
+  {
+    [createIndex addObject:@"WHERE"];
+    [createIndex addObject:self.where];
+  }
+  return [createIndex componentsJoinedByString:@" "];
+}
+
+- (BOOL)servesIndex:(FMDBIndexDescription *)index
+{
+  if ([self.tableName caseInsensitiveCompare:index.tableName] != NSOrderedSame)
+  {
+    return NO;
+  }
+  
+  // a partial index only serves queries whose WHERE clause implies its own
+  BOOL sameWhere = (self.where.length > 0
+                    ? (index.where.length > 0 &&
+                       [FMDBNormalizedSQL(self.where) isEqualToString:FMDBNormalizedSQL(index.where)])
+                    : index.where.length == 0);
+  if (self.where.length > 0 && NO == sameWhere)
+  {
+    return NO;
+  }
+  
+  NSArray * allKeys = [self allKeys];
+  if (index.keys.count > allKeys.count ||
+      NO == [[allKeys subarrayWithRange:NSMakeRange(0, index.keys.count)] isEqualToArray:index.keys])
+  {
+    return NO;
+  }
+  
+  // a unique index is a constraint on exactly its keys, including any included columns, and rows
+  if (index.unique && (NO == self.unique || NO == sameWhere || NO == [allKeys isEqualToArray:[index allKeys]]))
+  {
+    return NO;
+  }
+  
+  NSMutableSet * columnNames = [[NSMutableSet alloc] init];
+  for (FMDBIndexKey * key in allKeys)
+  {
+    if (key.columnName != nil)
+    {
+      [columnNames addObject:key.columnName.lowercaseString];
+    }
+  }
+  for (NSString * columnName in index.includedColumnNames)
+  {
+    if (NO == [columnNames containsObject:columnName.lowercaseString])
+    {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@: %@>", [self class], [self sql]];
+}
+
+@end
+
+// ========== FMDatabase (FMDBIndexes) =================================================================================
+#pragma mark - FMDatabase (FMDBIndexes)
+
+@implementation FMDatabase (FMDBIndexes)
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+- (NSArray *)indexesOnTable:(NSString *)tableName
+{
+  FMDBSchemaCatalog * catalog = [self schemaCatalog];
+  NSMutableArray * indexes = [[NSMutableArray alloc] init];
+  
+  // indexes created by constraints have no SQL, and aren't in the catalog
+  FMResultSet * results = [self executeQuery:[NSString stringWithFormat:@"PRAGMA index_list(%@)",
+                                              [FMDatabase escapeIdentifier:tableName]]];
+  NSMutableArray * indexNames = [[NSMutableArray alloc] init];
+  NSMutableArray * uniqueFlags = [[NSMutableArray alloc] init];
+  while ([results next])
+  {
+    [indexNames addObject:[results stringForColumn:@"name"]];
+    [uniqueFlags addObject:@([results boolForColumn:@"unique"])];
+  }
+  [results close];
+  
+  // indexes are described in the order PRAGMA index_list lists them, so that callers choose among them consistently
+  for (NSUInteger indexIdx = 0; indexIdx < indexNames.count; indexIdx++)
+  {
+    NSString * indexName = indexNames[indexIdx];
+    NSString * sql = [catalog sqlForIndex:indexName];
+    FMDBIndexDescription * index = (sql != nil
+                                    ? [FMDatabase indexWithSQL:sql name:indexName tableName:tableName]
+                                    : [self indexWithName:indexName tableName:tableName]);
+    if (index != nil)
+    {
+      index.unique = [uniqueFlags[indexIdx] boolValue];
+      [indexes addObject:index];
+    }
+  }
+  return indexes;
+}
+
+- (FMDBIndexDescription *)existingIndexServing:(FMDBIndexDescription *)index
+{
+  for (FMDBIndexDescription * existingIndex in [self indexesOnTable:index.tableName])
+  {
+    if ([existingIndex servesIndex:index])
+    {
+      return existingIndex;
+    }
+  }
+  return nil;
+}
+
+- (BOOL)createIndex:(FMDBIndexDescription *)index
+              error:(NSError **)error_p
+{
+  BOOL hasExpressions = NO;
+  for (FMDBIndexKey * key in index.keys)
+  {
+    hasExpressions = hasExpressions || (key.expression != nil);
+  }
+  
+  NSString * unsupportedFeature = nil;
+  if (index.where.length > 0 && sqlite3_libversion_number() < 3008000)
+  {
+    unsupportedFeature = @"Partial indexes require sqlite 3.8.0";
+  }
+  else if (hasExpressions && sqlite3_libversion_number() < 3009000)
+  {
+    unsupportedFeature = @"Indexes on expressions require sqlite 3.9.0";
+  }
+  
+  if (unsupportedFeature != nil)
+  {
+    if (error_p != NULL)
+    {
+      *error_p = [NSError errorWithDomain:@"FMDatabase"
+                                     code:SQLITE_ERROR
+                                 userInfo:@{ NSLocalizedDescriptionKey: unsupportedFeature }];
+    }
+    return NO;
+  }
+  
+  // temporary tables don't change the main database's schema_version, so the catalog is discarded explicitly
+  [self invalidateSchemaCatalog];
+  return [self executeUpdate:[index sql]
+                       error:error_p];
+}
+
+- (BOOL)createIndexIfNeeded:(FMDBIndexDescription *)index
+                    created:(BOOL *)created_p
+                      error:(NSError **)error_p
+{
+  if (created_p != NULL) *created_p = NO;
+  if ([self existingIndexServing:index] != nil)
+  {
+    return YES;
+  }
+  
+  BOOL created = [self createIndex:index
+                             error:error_p];
+  if (created_p != NULL) *created_p = created;
+  return created;
+}
+
+// ---------- PARSING --------------------------------------------------------------------------------------------------
+#pragma mark Parsing
+
+/**
+ *  Describes an index from the SQL that created it, whose keys and WHERE clause follow its first parenthesis.
+ */
++ (FMDBIndexDescription *)indexWithSQL:(NSString *)sql
+                                  name:(NSString *)indexName
+                             tableName:(NSString *)tableName
+{
+  NSMutableArray * keys = [[NSMutableArray alloc] init];
+  NSString * where = nil;
+  unichar quote = 0;
+  NSUInteger depth = 0;
+  NSUInteger termStart = 0;
+  for (NSUInteger charIdx = 0; charIdx < sql.length && where == nil; charIdx++)
+  {
+    unichar character = [sql characterAtIndex:charIdx];
+    if (quote != 0)
+    {
+      // a doubled quote closes and reopens the quoted text
+      if (character == quote) quote = 0;
+      continue;
+    }
+    
+    switch (character)
+    {
+      case '\'':
+      case '"':
+      case '`':
+        quote = character;
+        break;
+      
+      case '[':
+        quote = ']';
+        break;
+      
+      case '(':
+        depth++;
+        if (depth == 1) termStart = charIdx + 1;
+        break;
+      
+      case ',':
+      case ')':
+        if (depth == 1)
+        {
+          [keys addObject:[FMDBIndexKey keyWithSQL:[sql substringWithRange:NSMakeRange(termStart,
+                                                                                       charIdx - termStart)]]];
+          termStart = charIdx + 1;
+        }
+        if (character == ')' && depth > 0 && --depth == 0)
+        {
+          where = [[sql substringFromIndex:charIdx + 1]
+                   stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        }
+        break;
+    }
+  }
+  
+  if (keys.count == 0)
+  {
+    return nil;
+  }
+  
+  FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:indexName
+                                                                  tableName:tableName
+                                                                       keys:keys];
+  NSRange whereRange = (where != nil
+                        ? [where rangeOfString:@"WHERE" options:(NSAnchoredSearch | NSCaseInsensitiveSearch)]
+                        : NSMakeRange(NSNotFound, 0));
+  if (whereRange.location != NSNotFound)
+  {
+    index.where = [[where substringFromIndex:NSMaxRange(whereRange)]
+                   stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+  }
+  return index;
+}
+
+/**
+ *  Describes an index created by a constraint from its columns.
+ */
+- (FMDBIndexDescription *)indexWithName:(NSString *)indexName
+                              tableName:(NSString *)tableName
+{
+  FMResultSet * results = [self executeQuery:[NSString stringWithFormat:@"PRAGMA index_info(%@)",
+                                              [FMDatabase escapeIdentifier:indexName]]];
+  NSMutableArray * keys = [[NSMutableArray alloc] init];
+  while ([results next])
+  {
+    NSString * columnName = [results stringForColumn:@"name"];
+    if (columnName != nil)
+    {
+      [keys addObject:[FMDBIndexKey keyWithColumn:columnName]];
+    }
+  }
+  [results close];
+  
+  if (keys.count == 0)
+  {
+    return nil;
+  }
+  return [[FMDBIndexDescription alloc] initWithName:indexName
+                                          tableName:tableName
+                                               keys:keys];
+}
+
+@end
@@ -0,0 +1,117 @@
+#import "FMDatabase.h"
+
+/**
+ *  Pages through the rows matching a query by seeking past the last row of the previous page, rather than skipping
+ *  rows with OFFSET. Each page costs the same no matter how deep it is, provided the sort columns are indexed.
+ *
+ *  The sort columns must uniquely identify a row, e.g. by ending with the primary key, and must not contain NULLs.
+ *  They must also be selected, so that the key of the last row can be remembered.
+ *
+ *  A cursor can be saved as a token and resumed later by a cursor for the same query. For example, an HTTP handler
+ *  might return a page like so:
+ *
+ *        NSArray * sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"lastName" ascending:YES],
+ *                                       [NSSortDescriptor sortDescriptorWithKey:@"id" ascending:YES] ];
+ *        FMDBPageCursor * cursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+ *                                                                columns:nil
+ *                                                         matchingValues:nil
+ *                                                        sortDescriptors:sortDescriptors
+ *                                                               pageSize:50];
+ *        if (request.pageToken != nil && NO == [cursor resumeFromToken:request.pageToken])
+ *        {
+ *          // invalid token
+ *        }
+ *
+ *        NSArray * people = [db selectNextPageWithCursor:cursor error:&error];
+ *        response.nextPageToken = (cursor.hasMorePages ? cursor.token : nil);
+ */
+@interface FMDBPageCursor : NSObject
+
+/**
+ *  Creates a cursor positioned before the first page.
+ *
+ *  @param  from            The table name, plus any joins.
+ *  @param  columnNames     The columns to select. `nil` selects all columns.
+ *  @param  valuesToMatch   Values to match, as described in
+ *                          `-[FMDatabase selectResults:from:matchingValues:orderBy:limit:offset:error:]`.
+ *  @param  sortDescriptors `NSSortDescriptor` instances whose keys are the columns to sort by.
+ *  @param  pageSize        The maximum number of rows in each page.
+ */
+- (instancetype)initWithFrom:(NSString *)from
+                     columns:(NSArray *)columnNames
+              matchingValues:(NSDictionary *)valuesToMatch
+             sortDescriptors:(NSArray *)sortDescriptors
+                    pageSize:(NSUInteger)pageSize;
+
+@property (nonatomic, copy, readonly) NSString * from;
+@property (nonatomic, copy, readonly) NSArray * columnNames;
+@property (nonatomic, copy, readonly) NSDictionary * valuesToMatch;
+@property (nonatomic, copy, readonly) NSArray * sortDescriptors;
+@property (nonatomic, assign, readonly) NSUInteger pageSize;
+
+/**
+ *  The values of the sort columns in the last row read, or `nil` if no page has been read.
+ */
+@property (nonatomic, copy, readonly) NSArray * lastKey;
+
+/**
+ *  Whether there may be more pages. Becomes `NO` once a page with fewer than `pageSize` rows is read.
+ */
+@property (nonatomic, assign, readonly) BOOL hasMorePages;
+
+/**
+ *  Returns the cursor's position as an opaque, URL-safe string, or `nil` if the last key can't be represented in JSON.
+ */
+- (NSString *)token;
+
+/**
+ *  Moves the cursor to the position saved in a token.
+ *
+ *  @return `YES` if the token is valid, and was created by a cursor with the same sort columns; `NO` if not.
+ */
+- (BOOL)resumeFromToken:(NSString *)token;
+
+/**
+ *  Moves the cursor back before the first page.
+ */
+- (void)reset;
+
+@end
+
+@interface FMDatabase (FMDBKeysetPagination)
+
+// ========== PAGINATION ===============================================================================================
+#pragma mark - Pagination
+
+/// @name Paging Through Results
+
+/**
+ *  Reads the next page of rows for a cursor, and advances the cursor past them.
+ *
+ *  @param  cursor    The cursor to read from.
+ *  @param  error_p   A pointer to any error that occurs.
+ *
+ *  @return The page's rows as dictionaries, an empty array if there are no more rows, or `nil` if an error occurs.
+ */
+- (NSArray *)selectNextPageWithCursor:(FMDBPageCursor *)cursor
+                                error:(NSError **)error_p;
+
+/**
+ *  Returns a condition matching the rows that sort after `key`, and the arguments to bind to it. The condition is
+ *  written as `a >= ? AND (a > ? OR (a = ? AND b > ?))`, rather than as a row value comparison, so that sqlite can use
+ *  an index on the sort columns to seek to the first row, and older versions of sqlite are supported.
+ *
+ *  @param  key               The values of the sort columns.
+ *  @param  sortDescriptors   The sort columns and their directions.
+ *  @param  arguments_p       Returns the arguments to bind to the condition.
+ */
++ (NSString *)conditionToSeekPastKey:(NSArray *)key
+                     sortDescriptors:(NSArray *)sortDescriptors
+                           arguments:(NSArray **)arguments_p;
+
+/**
+ *  Returns an ORDER BY clause for the given sort descriptors.
+ */
++ (NSString *)orderByClauseWithSortDescriptors:(NSArray *)sortDescriptors;
+
+@end
@@ -0,0 +1,294 @@
+#import "FMDatabase+FMDBKeysetPagination.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMResultSet+FMDBHelpers.h"
+
+static const NSInteger FMDBPageCursorTokenVersion = 1;
+
+// ========== FMDBPageCursor ===========================================================================================
+#pragma mark - FMDBPageCursor
+
+@interface FMDBPageCursor ()
+
+@property (nonatomic, copy, readwrite) NSArray * lastKey;
+@property (nonatomic, assign, readwrite) BOOL hasMorePages;
+
+@end
+
+@implementation FMDBPageCursor
+
+- (instancetype)initWithFrom:(NSString *)from
+                     columns:(NSArray *)columnNames
+              matchingValues:(NSDictionary *)valuesToMatch
+             sortDescriptors:(NSArray *)sortDescriptors
+                    pageSize:(NSUInteger)pageSize
+{
+  NSParameterAssert(from != nil);
+  NSParameterAssert(sortDescriptors.count > 0);
+  NSParameterAssert(pageSize > 0);
+  
+  self = [super init];
+  if (self)
+  {
+    _from = [from copy];
+    _columnNames = [columnNames copy];
+    _valuesToMatch = [valuesToMatch copy];
+    _sortDescriptors = [sortDescriptors copy];
+    _pageSize = pageSize;
+    _hasMorePages = YES;
+  }
+  return self;
+}
+
+- (void)reset
+{
+  self.lastKey = nil;
+  self.hasMorePages = YES;
+}
+
+// ---------- TOKENS ---------------------------------------------------------------------------------------------------
+#pragma mark Tokens
+
+- (NSArray *)sortSignature
+{
+  NSMutableArray * sortSignature = [[NSMutableArray alloc] initWithCapacity:self.sortDescriptors.count];
+  for (NSSortDescriptor * sortDescriptor in self.sortDescriptors)
+  {
+    [sortSignature addObject:[sortDescriptor.key stringByAppendingString:(sortDescriptor.ascending ? @"+" : @"-")]];
+  }
+  return sortSignature;
+}
+
+- (NSString *)token
+{
+  NSDictionary * state = @{ @"v":     @(FMDBPageCursorTokenVersion),
+                            @"sort":  [self sortSignature],
+                            @"key":   (self.lastKey ?: [NSNull null]),
+                            @"more":  @(self.hasMorePages) };
+  if (NO == [NSJSONSerialization isValidJSONObject:state])
+  {
+    return nil;
+  }
+  
+  NSData * json = [NSJSONSerialization dataWithJSONObject:state
+                                                  options:0
+                                                    error:NULL];
+  
+  // base64url, without padding
+  NSString * token = [json base64EncodedStringWithOptions:0];
+  token = [token stringByReplacingOccurrencesOfString:@"+" withString:@"-"];
+  token = [token stringByReplacingOccurrencesOfString:@"/" withString:@"_"];
+  return [token stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"="]];
+}
+
+- (BOOL)resumeFromToken:(NSString *)token
+{
+  NSMutableString * base64 = [token mutableCopy];
+  [base64 replaceOccurrencesOfString:@"-" withString:@"+" options:0 range:NSMakeRange(0, base64.length)];
+  [base64 replaceOccurrencesOfString:@"_" withString:@"/" options:0 range:NSMakeRange(0, base64.length)];
+  while (base64.length % 4 != 0)
+  {
+    [base64 appendString:@"="];
+  }
+  
+  NSData * json = [[NSData alloc] initWithBase64EncodedString:base64 options:0];
+  if (json == nil)
+  {
+    return NO;
+  }
+  
+  NSDictionary * state = [NSJSONSerialization JSONObjectWithData:json
+                                                         options:0
+                                                           error:NULL];
+  if (NO == [state isKindOfClass:[NSDictionary class]]
+      || NO == [state[@"v"] isEqual:@(FMDBPageCursorTokenVersion)]
+      || NO == [state[@"sort"] isEqual:[self sortSignature]])
+  {
+    return NO;
+  }
+  
+  id lastKey = state[@"key"];
+  if (lastKey == [NSNull null])
+  {
+    lastKey = nil;
+  }
+  else if (NO == [lastKey isKindOfClass:[NSArray class]] || [lastKey count] != self.sortDescriptors.count)
+  {
+    return NO;
+  }
+  
+  self.lastKey = lastKey;
+  self.hasMorePages = [state[@"more"] boolValue];
+  return YES;
+}
+
+// ---------- PAGES ----------------------------------------------------------------------------------------------------
+#pragma mark Pages
+
+- (void)advancePastRecords:(NSArray *)records
+{
+  if (records.count > 0)
+  {
+    NSDictionary * lastRecord = records.lastObject;
+    NSMutableArray * lastKey = [[NSMutableArray alloc] initWithCapacity:self.sortDescriptors.count];
+    for (NSSortDescriptor * sortDescriptor in self.sortDescriptors)
+    {
+      id value = lastRecord[sortDescriptor.key];
+      if (value == nil)
+      {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                       reason:[NSString stringWithFormat:@"Sort column is not selected: %@",
+                                               sortDescriptor.key]
+                                     userInfo:nil];
+      }
+      [lastKey addObject:value];
+    }
+    self.lastKey = lastKey;
+  }
+  
+  self.hasMorePages = (records.count == self.pageSize);
+}
+
+@end
+
+// ========== FMDatabase (FMDBKeysetPagination) ========================================================================
+#pragma mark - FMDatabase (FMDBKeysetPagination)
+
+@implementation FMDatabase (FMDBKeysetPagination)
+
+- (NSArray *)selectNextPageWithCursor:(FMDBPageCursor *)cursor
+                                error:(NSError **)error_p
+{
+  NSParameterAssert(cursor != nil);
+  if (NO == cursor.hasMorePages)
+  {
+    return @[];
+  }
+  
+  NSDictionary * preparedValues = nil;
+  if (NO == [self prepareMatchingValues:cursor.valuesToMatch
+                         preparedValues:&preparedValues
+                                  error:error_p])
+  {
+    return nil;
+  }
+  
+  NSMutableArray * where = [[NSMutableArray alloc] init];
+  NSMutableArray * arguments = [[NSMutableArray alloc] init];
+  if (preparedValues.count > 0)
+  {
+    NSArray * matchArguments = nil;
+    [where addObject:[FMDatabase whereClauseToMatchValues:preparedValues
+                                                arguments:&matchArguments]];
+    [arguments addObjectsFromArray:matchArguments];
+  }
+  
+  if (cursor.lastKey != nil)
+  {
+    NSArray * seekArguments = nil;
+    NSString * seekCondition = [FMDatabase conditionToSeekPastKey:cursor.lastKey
+                                                  sortDescriptors:cursor.sortDescriptors
+                                                        arguments:&seekArguments];
+    if (where.count > 0)
+    {
+      [where addObject:@"AND"];
+    }
+    [where addObject:[NSString stringWithFormat:@"(%@)", seekCondition]];
+    [arguments addObjectsFromArray:seekArguments];
+  }
+  
+  FMResultSet * results = [self selectResults:cursor.columnNames
+                                         from:cursor.from
+                                        where:(where.count > 0 ? [where componentsJoinedByString:@" "] : nil)
+                                      groupBy:nil
+                                       having:nil
+                                    arguments:arguments
+                                      orderBy:[FMDatabase orderByClauseWithSortDescriptors:cursor.sortDescriptors]
+                                        limit:@(cursor.pageSize)
+                                       offset:nil
+                                        error:error_p];
+  if (results == nil)
+  {
+    return nil;
+  }
+  
+  NSArray * records = [results allRecords];
+  if ([self hadError])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  [cursor advancePastRecords:records];
+  return records;
+}
+
++ (NSString *)conditionToSeekPastKey:(NSArray *)key
+                     sortDescriptors:(NSArray *)sortDescriptors
+                           arguments:(NSArray **)arguments_p
+{
+  NSParameterAssert(key.count == sortDescriptors.count);
+  
+  NSMutableArray * condition = [[NSMutableArray alloc] init];
+  NSMutableArray * arguments = [[NSMutableArray alloc] initWithCapacity:(key.count * 2)];
+  NSUInteger lastIdx = sortDescriptors.count - 1;
+  
+  // bounding the first column lets sqlite seek directly to the first row
+  if (lastIdx > 0)
+  {
+    NSSortDescriptor * sortDescriptor = sortDescriptors[0];
+    [condition addObject:[FMDatabase escapeIdentifier:sortDescriptor.key]];
+    [condition addObject:(sortDescriptor.ascending ? @">= ?" : @"<= ?")];
+    [condition addObject:@"AND"];
+    [arguments addObject:key[0]];
+  }
+  
+  [sortDescriptors enumerateObjectsUsingBlock:^(NSSortDescriptor * sortDescriptor, NSUInteger idx, BOOL *stop) {
+    NSString * columnName = [FMDatabase escapeIdentifier:sortDescriptor.key];
+    NSString * comparison = (sortDescriptor.ascending ? @"> ?" : @"< ?");
+    if (idx < lastIdx)
+    {
+      [condition addObject:@"("];
+      [condition addObject:columnName];
+      [condition addObject:comparison];
+      [condition addObject:@"OR ("];
+      [condition addObject:columnName];
+      [condition addObject:@"= ?"];
+      [condition addObject:@"AND"];
+      [arguments addObject:key[idx]];
+      [arguments addObject:key[idx]];
+    }
+    else
+    {
+      [condition addObject:columnName];
+      [condition addObject:comparison];
+      [arguments addObject:key[idx]];
+    }
+  }];
+  
+  for (NSUInteger idx = 0; idx < lastIdx; idx++)
+  {
+    [condition addObject:@"))"];
+  }
+  
+  if (arguments_p != NULL)
+  {
+    *arguments_p = arguments;
+  }
+  
+  return [condition componentsJoinedByString:@" "];
+}
+
++ (NSString *)orderByClauseWithSortDescriptors:(NSArray *)sortDescriptors
+{
+  NSMutableArray * orderBy = [[NSMutableArray alloc] initWithCapacity:sortDescriptors.count];
+  for (NSSortDescriptor * sortDescriptor in sortDescriptors)
+  {
+    [orderBy addObject:[NSString stringWithFormat:@"%@ %@",
+                        [FMDatabase escapeIdentifier:sortDescriptor.key],
+                        (sortDescriptor.ascending ? @"ASC" : @"DESC")]];
+  }
+  return [orderBy componentsJoinedByString:@", "];
+}
+
+@end
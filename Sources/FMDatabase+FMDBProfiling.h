@@ -0,0 +1,172 @@
+#import "FMDatabase.h"
+#import "FMResultSet.h"
+
+/**
+ *  The number of buckets in a statement's latency histogram.
+ */
+extern const NSUInteger FMDBStatementLatencyBucketCount;
+
+/**
+ *  Aggregated measurements of every execution of a statement. Statements are grouped by their SQL, which for the helper
+ *  methods is determined by the statement's shape, since values are always bound as arguments.
+ */
+@interface FMDBStatementProfile : NSObject <NSCopying>
+
+/**
+ *  The statement's SQL.
+ */
+@property (nonatomic, copy, readonly) NSString * statement;
+
+/**
+ *  The number of times the statement was executed.
+ */
+@property (nonatomic, assign, readonly) NSUInteger executionCount;
+
+/**
+ *  The total time spent preparing the statement and binding its arguments.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval totalPrepareTime;
+
+/**
+ *  The total time spent stepping through the statement's results.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval totalStepTime;
+
+/**
+ *  The total time spent executing the statement, i.e. the sum of `totalPrepareTime` and `totalStepTime`.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval totalTime;
+
+/**
+ *  The longest time spent on a single execution.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval maximumTime;
+
+/**
+ *  The total number of rows returned or changed by the statement, not including rows changed by triggers.
+ */
+@property (nonatomic, assign, readonly) uint64_t rowCount;
+
+/**
+ *  The total number of times sqlite stepped forward in a full table scan (`SQLITE_STMTSTATUS_FULLSCAN_STEP`). A large
+ *  number usually means the statement would benefit from an index.
+ */
+@property (nonatomic, assign, readonly) uint64_t fullScanStepCount;
+
+/**
+ *  The total number of sort operations (`SQLITE_STMTSTATUS_SORT`).
+ */
+@property (nonatomic, assign, readonly) uint64_t sortCount;
+
+/**
+ *  The total number of rows inserted into automatic indexes (`SQLITE_STMTSTATUS_AUTOINDEX`).
+ */
+@property (nonatomic, assign, readonly) uint64_t automaticIndexRowCount;
+
+/**
+ *  The total number of virtual machine operations (`SQLITE_STMTSTATUS_VM_STEP`). Always 0 before sqlite 3.8.0.
+ */
+@property (nonatomic, assign, readonly) uint64_t virtualMachineStepCount;
+
+/**
+ *  The number of executions in each latency bucket, as an array of `FMDBStatementLatencyBucketCount` numbers. The
+ *  first bucket counts executions that took less than a microsecond; each following bucket `i` counts executions that
+ *  took at least 2^(i-1) and less than 2^i microseconds. The last bucket also counts anything slower.
+ */
+@property (nonatomic, copy, readonly) NSArray * latencyHistogram;
+
+/**
+ *  Returns an upper bound on the latency of the given percentile of executions, from the latency histogram.
+ *
+ *  @param  percentile  A percentile between 0 and 100, e.g. 99.
+ */
+- (NSTimeInterval)latencyAtPercentile:(double)percentile;
+
+@end
+
+@interface FMDatabase (FMDBProfiling)
+
+// ========== PROFILING ================================================================================================
+#pragma mark - Profiling
+
+/// @name Profiling Statements
+
+/**
+ *  Whether statements executed by the helper methods are profiled. Each execution records the time spent preparing
+ *  and stepping the statement, the rows it returned or changed, and for queries, the statement's `sqlite3_stmt_status`
+ *  counters, which are aggregated into a profile per statement. Defaults to `NO`.
+ *
+ *  Recording an execution takes a few clock reads and a dictionary lookup, so profiling can be left enabled in
+ *  production. Time spent reading a result set is only measured when it is read by a helper method such as
+ *  `-[FMResultSet allRecords]` or `-[FMResultSet enumerateRecordsUsingBlock:]`.
+ */
+@property (nonatomic, assign) BOOL shouldProfileStatements;
+
+/**
+ *  Returns a snapshot of the profile of each statement executed while profiling was enabled, ordered from the most to
+ *  the least total time.
+ */
+- (NSArray *)statementProfiles;
+
+/**
+ *  Returns a snapshot of the profile of a statement, or `nil` if the statement hasn't been profiled.
+ */
+- (FMDBStatementProfile *)profileForStatement:(NSString *)sql;
+
+/**
+ *  Discards all statement profiles.
+ */
+- (void)resetStatementProfiles;
+
+/**
+ *  Returns a table of all statement profiles, suitable for logging.
+ */
+- (NSString *)statementProfileReport;
+
+// ---------- RECORDING ------------------------------------------------------------------------------------------------
+#pragma mark Recording
+
+/// @name Recording Profiles
+
+/**
+ *  Executes a query like `-executeQuery:withArgumentsInArray:`, profiling it if `shouldProfileStatements` is enabled.
+ *  The time spent reading the results is recorded by `-[FMResultSet beginProfiledSteps]`. The query is interrupted if
+ *  its deadline passes, as described in `-[FMDatabase performWithDeadline:cancellationToken:usingBlock:]`.
+ */
+- (FMResultSet *)executeProfiledQuery:(NSString *)sql
+                 withArgumentsInArray:(NSArray *)arguments;
+
+/**
+ *  Executes an update with `-executeUpdate:withArgumentsInArray:`, profiling it if `shouldProfileStatements` is
+ *  enabled, and interrupting it if its deadline passes.
+ *
+ *  The update runs exactly as it does unprofiled, so errors and changes are reported the same way. As FMDB prepares,
+ *  steps, and resets the statement itself, its time is recorded as step time, and its `sqlite3_stmt_status` counters
+ *  aren't recorded.
+ */
+- (BOOL)executeProfiledUpdate:(NSString *)sql
+         withArgumentsInArray:(NSArray *)arguments;
+
+@end
+
+@interface FMResultSet (FMDBProfiling)
+
+/**
+ *  Begins measuring the time spent reading the results of a profiled query. Returns a token that must be passed to
+ *  `-endProfiledSteps:rowCount:finished:`, or `nil` if the query isn't being profiled.
+ */
+- (id)beginProfiledSteps;
+
+/**
+ *  Ends a measurement started by `-beginProfiledSteps`, adding the time spent and the rows read to the execution. The
+ *  execution is added to its statement's profile once the results are finished, or when the result set is released.
+ *
+ *  @param  token     The token returned by `-beginProfiledSteps`. Does nothing if `nil`.
+ *  @param  rowCount  The number of rows read since `-beginProfiledSteps`.
+ *  @param  finished  Whether there are no more rows to read.
+ */
+- (void)endProfiledSteps:(id)token
+                rowCount:(NSUInteger)rowCount
+                finished:(BOOL)finished;
+
+@end
@@ -0,0 +1,549 @@
+#import "FMDatabase+FMDBProfiling.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import <objc/runtime.h>
+
+#ifndef SQLITE_STMTSTATUS_VM_STEP
+#define SQLITE_STMTSTATUS_VM_STEP 4
+#endif
+
+static const void * FMDBStatementProfilerKey = &FMDBStatementProfilerKey;
+static const void * FMDBStatementExecutionKey = &FMDBStatementExecutionKey;
+
+const NSUInteger FMDBStatementLatencyBucketCount = 32;
+
+typedef NS_ENUM(NSUInteger, FMDBStatementCounter)
+{
+  FMDBStatementCounterFullScanStep,
+  FMDBStatementCounterSort,
+  FMDBStatementCounterAutomaticIndex,
+  FMDBStatementCounterVirtualMachineStep,
+  
+  FMDBStatementCounterCount
+};
+
+static const int FMDBStatementStatusOps[FMDBStatementCounterCount] = {
+  SQLITE_STMTSTATUS_FULLSCAN_STEP,
+  SQLITE_STMTSTATUS_SORT,
+  SQLITE_STMTSTATUS_AUTOINDEX,
+  SQLITE_STMTSTATUS_VM_STEP,
+};
+
+static NSUInteger FMDBAvailableStatementCounterCount(void)
+{
+  // older versions of sqlite read past the end of their counters when asked for SQLITE_STMTSTATUS_VM_STEP
+  return (sqlite3_libversion_number() >= 3008000 ? FMDBStatementCounterCount : FMDBStatementCounterVirtualMachineStep);
+}
+
+static void FMDBReadStatementCounters(sqlite3_stmt * statement, uint64_t * counters, BOOL reset)
+{
+  if (statement == NULL)
+  {
+    return;
+  }
+  
+  NSUInteger counterCount = FMDBAvailableStatementCounterCount();
+  for (NSUInteger counterIdx = 0; counterIdx < counterCount; counterIdx++)
+  {
+    int value = sqlite3_stmt_status(statement, FMDBStatementStatusOps[counterIdx], reset);
+    if (counters != NULL)
+    {
+      counters[counterIdx] += (uint64_t)value;
+    }
+  }
+}
+
+static NSUInteger FMDBLatencyBucketForTime(NSTimeInterval time)
+{
+  double microseconds = time * 1e6;
+  NSUInteger bucket = 0;
+  while (microseconds >= 1 && bucket < FMDBStatementLatencyBucketCount - 1)
+  {
+    microseconds /= 2;
+    bucket++;
+  }
+  return bucket;
+}
+
+// ========== FMDBStatementProfile =====================================================================================
+#pragma mark - FMDBStatementProfile
+
+@implementation FMDBStatementProfile
+{
+  uint64_t _counters[FMDBStatementCounterCount];
+  NSUInteger _latencyCounts[FMDBStatementLatencyBucketCount];
+}
+
+- (instancetype)initWithStatement:(NSString *)statement
+{
+  self = [super init];
+  if (self)
+  {
+    _statement = [statement copy];
+  }
+  return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  FMDBStatementProfile * copy = [[[self class] allocWithZone:zone] initWithStatement:self.statement];
+  copy->_executionCount = _executionCount;
+  copy->_totalPrepareTime = _totalPrepareTime;
+  copy->_totalStepTime = _totalStepTime;
+  copy->_maximumTime = _maximumTime;
+  copy->_rowCount = _rowCount;
+  memcpy(copy->_counters, _counters, sizeof(_counters));
+  memcpy(copy->_latencyCounts, _latencyCounts, sizeof(_latencyCounts));
+  return copy;
+}
+
+- (void)addExecutionWithPrepareTime:(NSTimeInterval)prepareTime
+                           stepTime:(NSTimeInterval)stepTime
+                           rowCount:(uint64_t)rowCount
+                           counters:(const uint64_t *)counters
+{
+  NSTimeInterval time = prepareTime + stepTime;
+  
+  _executionCount++;
+  _totalPrepareTime += prepareTime;
+  _totalStepTime += stepTime;
+  _maximumTime = MAX(_maximumTime, time);
+  _rowCount += rowCount;
+  for (NSUInteger counterIdx = 0; counterIdx < FMDBStatementCounterCount; counterIdx++)
+  {
+    _counters[counterIdx] += counters[counterIdx];
+  }
+  _latencyCounts[FMDBLatencyBucketForTime(time)]++;
+}
+
+- (NSTimeInterval)totalTime
+{
+  return self.totalPrepareTime + self.totalStepTime;
+}
+
+- (uint64_t)fullScanStepCount
+{
+  return _counters[FMDBStatementCounterFullScanStep];
+}
+
+- (uint64_t)sortCount
+{
+  return _counters[FMDBStatementCounterSort];
+}
+
+- (uint64_t)automaticIndexRowCount
+{
+  return _counters[FMDBStatementCounterAutomaticIndex];
+}
+
+- (uint64_t)virtualMachineStepCount
+{
+  return _counters[FMDBStatementCounterVirtualMachineStep];
+}
+
+- (NSArray *)latencyHistogram
+{
+  NSMutableArray * histogram = [[NSMutableArray alloc] initWithCapacity:FMDBStatementLatencyBucketCount];
+  for (NSUInteger bucketIdx = 0; bucketIdx < FMDBStatementLatencyBucketCount; bucketIdx++)
+  {
+    [histogram addObject:@(_latencyCounts[bucketIdx])];
+  }
+  return histogram;
+}
+
+- (NSTimeInterval)latencyAtPercentile:(double)percentile
+{
+  if (self.executionCount == 0)
+  {
+    return 0;
+  }
+  
+  double threshold = MAX(1, ceil(MIN(MAX(percentile, 0), 100) / 100 * self.executionCount));
+  NSUInteger executionCount = 0;
+  for (NSUInteger bucketIdx = 0; bucketIdx < FMDBStatementLatencyBucketCount; bucketIdx++)
+  {
+    executionCount += _latencyCounts[bucketIdx];
+    if (executionCount >= threshold)
+    {
+      // no execution took longer than the slowest one, so it bounds every bucket
+      return MIN(ldexp(1e-6, (int)bucketIdx), self.maximumTime);
+    }
+  }
+  return self.maximumTime;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@ %lu executions, %.3fms total: %@>",
+          NSStringFromClass([self class]),
+          (unsigned long)self.executionCount,
+          self.totalTime * 1000,
+          self.statement];
+}
+
+@end
+
+// ========== FMDBStatementProfiler ====================================================================================
+#pragma mark - FMDBStatementProfiler
+
+@interface FMDBStatementProfiler : NSObject
+
+@property (nonatomic, assign) BOOL enabled;
+
+- (void)addExecutionOfStatement:(NSString *)statement
+                    prepareTime:(NSTimeInterval)prepareTime
+                       stepTime:(NSTimeInterval)stepTime
+                       rowCount:(uint64_t)rowCount
+                       counters:(const uint64_t *)counters;
+
+- (NSArray *)profiles;
+
+- (FMDBStatementProfile *)profileForStatement:(NSString *)statement;
+
+- (void)reset;
+
+@end
+
+@implementation FMDBStatementProfiler
+{
+  // guarded by @synchronized (self), since executions may be recorded when a result set is released on another thread
+  NSMutableDictionary * _profilesByStatement;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _profilesByStatement = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+- (void)addExecutionOfStatement:(NSString *)statement
+                    prepareTime:(NSTimeInterval)prepareTime
+                       stepTime:(NSTimeInterval)stepTime
+                       rowCount:(uint64_t)rowCount
+                       counters:(const uint64_t *)counters
+{
+  @synchronized (self)
+  {
+    FMDBStatementProfile * profile = _profilesByStatement[statement];
+    if (profile == nil)
+    {
+      profile = [[FMDBStatementProfile alloc] initWithStatement:statement];
+      _profilesByStatement[profile.statement] = profile;
+    }
+    
+    [profile addExecutionWithPrepareTime:prepareTime
+                                stepTime:stepTime
+                                rowCount:rowCount
+                                counters:counters];
+  }
+}
+
+- (NSArray *)profiles
+{
+  NSMutableArray * profiles = [[NSMutableArray alloc] init];
+  @synchronized (self)
+  {
+    for (FMDBStatementProfile * profile in _profilesByStatement.objectEnumerator)
+    {
+      [profiles addObject:[profile copy]];
+    }
+  }
+  
+  [profiles sortUsingComparator:^NSComparisonResult(FMDBStatementProfile * profile1, FMDBStatementProfile * profile2) {
+    if (profile1.totalTime == profile2.totalTime)
+    {
+      return [profile1.statement compare:profile2.statement];
+    }
+    return (profile1.totalTime > profile2.totalTime ? NSOrderedAscending : NSOrderedDescending);
+  }];
+  return profiles;
+}
+
+- (FMDBStatementProfile *)profileForStatement:(NSString *)statement
+{
+  @synchronized (self)
+  {
+    return [_profilesByStatement[statement] copy];
+  }
+}
+
+- (void)reset
+{
+  @synchronized (self)
+  {
+    [_profilesByStatement removeAllObjects];
+  }
+}
+
+@end
+
+// ========== FMDBStatementExecution ===================================================================================
+#pragma mark - FMDBStatementExecution
+
+/**
+ *  Measurements of a single execution of a profiled query, which are added to the statement's profile once its results
+ *  have been read.
+ */
+@interface FMDBStatementExecution : NSObject
+
+- (instancetype)initWithProfiler:(FMDBStatementProfiler *)profiler
+                       statement:(NSString *)statement
+                     prepareTime:(NSTimeInterval)prepareTime;
+
+- (void)beginStepsOfStatement:(FMStatement *)statement;
+
+- (void)endStepsWithRowCount:(NSUInteger)rowCount
+                    finished:(BOOL)finished;
+
+@end
+
+@implementation FMDBStatementExecution
+{
+  FMDBStatementProfiler * _profiler;
+  NSString * _statement;
+  NSTimeInterval _prepareTime;
+  NSTimeInterval _stepTime;
+  uint64_t _rowCount;
+  uint64_t _counters[FMDBStatementCounterCount];
+  BOOL _isRecorded;
+  
+  // retained while stepping, so the statement's counters can still be read after the result set closes it
+  FMStatement * _steppingStatement;
+  NSTimeInterval _stepStartTime;
+}
+
+- (instancetype)initWithProfiler:(FMDBStatementProfiler *)profiler
+                       statement:(NSString *)statement
+                     prepareTime:(NSTimeInterval)prepareTime
+{
+  self = [super init];
+  if (self)
+  {
+    _profiler = profiler;
+    _statement = [statement copy];
+    _prepareTime = prepareTime;
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  // results that weren't read to the end are recorded when they're released
+  [self record];
+}
+
+- (void)beginStepsOfStatement:(FMStatement *)statement
+{
+  _steppingStatement = statement;
+  _stepStartTime = [NSDate timeIntervalSinceReferenceDate];
+}
+
+- (void)endStepsWithRowCount:(NSUInteger)rowCount
+                    finished:(BOOL)finished
+{
+  _stepTime += [NSDate timeIntervalSinceReferenceDate] - _stepStartTime;
+  _rowCount += rowCount;
+  
+  FMDBReadStatementCounters(_steppingStatement.statement, _counters, YES);
+  _steppingStatement = nil;
+  
+  if (finished)
+  {
+    [self record];
+  }
+}
+
+- (void)record
+{
+  if (_isRecorded)
+  {
+    return;
+  }
+  _isRecorded = YES;
+  
+  [_profiler addExecutionOfStatement:_statement
+                         prepareTime:_prepareTime
+                            stepTime:_stepTime
+                            rowCount:_rowCount
+                            counters:_counters];
+}
+
+@end
+
+// ========== FMDatabase (FMDBProfiling) ===============================================================================
+#pragma mark - FMDatabase (FMDBProfiling)
+
+@implementation FMDatabase (FMDBProfiling)
+
+- (FMDBStatementProfiler *)statementProfiler
+{
+  FMDBStatementProfiler * profiler = objc_getAssociatedObject(self, FMDBStatementProfilerKey);
+  if (profiler == nil)
+  {
+    profiler = [[FMDBStatementProfiler alloc] init];
+    objc_setAssociatedObject(self, FMDBStatementProfilerKey, profiler, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return profiler;
+}
+
+- (BOOL)shouldProfileStatements
+{
+  return [objc_getAssociatedObject(self, FMDBStatementProfilerKey) enabled];
+}
+
+- (void)setShouldProfileStatements:(BOOL)shouldProfileStatements
+{
+  self.statementProfiler.enabled = shouldProfileStatements;
+}
+
+- (NSArray *)statementProfiles
+{
+  return [objc_getAssociatedObject(self, FMDBStatementProfilerKey) profiles] ?: @[];
+}
+
+- (FMDBStatementProfile *)profileForStatement:(NSString *)sql
+{
+  return [objc_getAssociatedObject(self, FMDBStatementProfilerKey) profileForStatement:sql];
+}
+
+- (void)resetStatementProfiles
+{
+  [objc_getAssociatedObject(self, FMDBStatementProfilerKey) reset];
+}
+
+- (NSString *)statementProfileReport
+{
+  NSMutableString * report = [[NSMutableString alloc] init];
+  [report appendFormat:@"%10s %12s %10s %10s %10s %10s %12s %12s %8s %10s %14s  %@\n",
+   "count", "total ms", "mean ms", "p50 ms", "p99 ms", "max ms", "rows", "scan steps", "sorts", "auto index",
+   "vm steps", @"statement"];
+  
+  for (FMDBStatementProfile * profile in self.statementProfiles)
+  {
+    [report appendFormat:@"%10lu %12.3f %10.3f %10.3f %10.3f %10.3f %12llu %12llu %8llu %10llu %14llu  %@\n",
+     (unsigned long)profile.executionCount,
+     profile.totalTime * 1000,
+     profile.totalTime * 1000 / MAX(profile.executionCount, (NSUInteger)1),
+     [profile latencyAtPercentile:50] * 1000,
+     [profile latencyAtPercentile:99] * 1000,
+     profile.maximumTime * 1000,
+     (unsigned long long)profile.rowCount,
+     (unsigned long long)profile.fullScanStepCount,
+     (unsigned long long)profile.sortCount,
+     (unsigned long long)profile.automaticIndexRowCount,
+     (unsigned long long)profile.virtualMachineStepCount,
+     profile.statement];
+  }
+  
+  return report;
+}
+
+// ---------- RECORDING ------------------------------------------------------------------------------------------------
+#pragma mark Recording
+
+- (FMResultSet *)executeProfiledQuery:(NSString *)sql
+                 withArgumentsInArray:(NSArray *)arguments
+{
+  [self beginInterruptibleStatement];
+  
+  FMDBStatementProfiler * profiler = objc_getAssociatedObject(self, FMDBStatementProfilerKey);
+  if (NO == profiler.enabled)
+  {
+    return [self executeQuery:sql
+         withArgumentsInArray:arguments];
+  }
+  
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  FMResultSet * results = [self executeQuery:sql
+                        withArgumentsInArray:arguments];
+  NSTimeInterval prepareTime = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  if (results == nil)
+  {
+    return nil;
+  }
+  
+  // cached statements keep counting from their previous executions
+  FMDBReadStatementCounters(results.statement.statement, NULL, YES);
+  
+  FMDBStatementExecution * execution = [[FMDBStatementExecution alloc] initWithProfiler:profiler
+                                                                              statement:sql
+                                                                            prepareTime:prepareTime];
+  objc_setAssociatedObject(results, FMDBStatementExecutionKey, execution, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  return results;
+}
+
+- (BOOL)executeProfiledUpdate:(NSString *)sql
+         withArgumentsInArray:(NSArray *)arguments
+{
+  [self beginInterruptibleStatement];
+  
+  FMDBStatementProfiler * profiler = objc_getAssociatedObject(self, FMDBStatementProfilerKey);
+  if (NO == profiler.enabled)
+  {
+    BOOL successful = [self executeUpdate:sql
+                     withArgumentsInArray:arguments];
+    [self endInterruptibleStatement];
+    return successful;
+  }
+  
+  // the update is executed by FMDB just as when it isn't profiled, so it's timed as a whole, without counters
+  int totalChangesBefore = sqlite3_total_changes([self sqliteHandle]);
+  NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+  BOOL successful = [self executeUpdate:sql
+                   withArgumentsInArray:arguments];
+  NSTimeInterval stepTime = [NSDate timeIntervalSinceReferenceDate] - startTime;
+  [self endInterruptibleStatement];
+  if (NO == successful)
+  {
+    return NO;
+  }
+  
+  // sqlite3_changes() excludes rows changed by triggers, but only INSERT, UPDATE, and DELETE update it, so it's only
+  // read once the total shows that the statement changed some rows
+  uint64_t rowCount = 0;
+  if (sqlite3_total_changes([self sqliteHandle]) != totalChangesBefore)
+  {
+    rowCount = (uint64_t)MAX(sqlite3_changes([self sqliteHandle]), 0);
+  }
+  
+  uint64_t counters[FMDBStatementCounterCount] = { 0 };
+  [profiler addExecutionOfStatement:sql
+                        prepareTime:0
+                           stepTime:stepTime
+                           rowCount:rowCount
+                           counters:counters];
+  return YES;
+}
+
+@end
+
+// ========== FMResultSet (FMDBProfiling) ==============================================================================
+#pragma mark - FMResultSet (FMDBProfiling)
+
+@implementation FMResultSet (FMDBProfiling)
+
+- (id)beginProfiledSteps
+{
+  FMDBStatementExecution * execution = objc_getAssociatedObject(self, FMDBStatementExecutionKey);
+  [execution beginStepsOfStatement:self.statement];
+  return execution;
+}
+
+- (void)endProfiledSteps:(id)token
+                rowCount:(NSUInteger)rowCount
+                finished:(BOOL)finished
+{
+  [(FMDBStatementExecution *)token endStepsWithRowCount:rowCount
+                                               finished:finished];
+  
+  // a statement that has been read to the end, or that failed, no longer needs its budget
+  if (finished || [self.parentDB hadError])
+  {
+    [self.parentDB endInterruptibleStatement];
+  }
+}
+
+@end
@@ -0,0 +1,96 @@
+#import "FMDatabase.h"
+
+@interface FMDatabase (FMDBResultCache)
+
+// ========== RESULT CACHE =============================================================================================
+#pragma mark - Result Cache
+
+/// @name Caching Results
+
+/**
+ *  Whether the results of `-selectAllFrom:orderBy:error:`, `-selectAllFrom:where:arguments:orderBy:error:`, and the
+ *  count helpers are cached, keyed by their SQL and arguments, so that repeating a read returns the cached result
+ *  without running a statement. Defaults to `NO`.
+ *
+ *  Each result is tagged with the tables its statement reads, found once per SQL from the statement's program
+ *  (`EXPLAIN`), so joins, subqueries, and views are included. Changes made through this connection remove the results
+ *  that read the changed table: sqlite's update hook reports each changed row, and the helpers' insert, update, and
+ *  delete methods also invalidate their table. Any schema change, noticed as statements are prepared, clears the
+ *  whole cache.
+ *
+ *  The cache takes over the connection's update hook and authorizer: enabling it replaces any set with
+ *  `sqlite3_update_hook()` or `sqlite3_set_authorizer()`, and disabling it removes them. sqlite has no way to read the
+ *  hooks already set, so they can't be chained to, and must not be set while the cache is enabled.
+ *
+ *  So that every deleted row is reported, enabling the cache turns off sqlite's truncate optimization: `DELETE`
+ *  without a WHERE clause deletes rows one at a time. Within a transaction, results that read a table changed by it
+ *  aren't cached, so that a rollback doesn't leave them behind.
+ *
+ *  Changes made through other connections aren't seen, so only enable the cache on the connection that makes all
+ *  changes to the tables it reads. Statements that read virtual tables or attached databases aren't cached, and
+ *  neither are matches against large sets of values. Results of SQL using non-deterministic functions, e.g.
+ *  `random()` or `datetime('now')`, are cached as for any other SQL, so avoid them in cached reads.
+ *
+ *  Cached records are shared by all callers, and must not be mutated.
+ */
+@property (nonatomic, assign) BOOL shouldCacheResults;
+
+/**
+ *  The approximate number of bytes that cached results may use. When it is exceeded, the least recently used results
+ *  are removed. Defaults to 4 MB.
+ */
+@property (nonatomic, assign) NSUInteger resultCacheByteLimit;
+
+/**
+ *  The approximate number of bytes used by cached results.
+ */
+@property (nonatomic, assign, readonly) NSUInteger resultCacheBytes;
+
+/**
+ *  The number of cached results.
+ */
+@property (nonatomic, assign, readonly) NSUInteger resultCacheCount;
+
+/**
+ *  The number of reads answered from the cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger resultCacheHits;
+
+/**
+ *  The number of reads that had to run their statement.
+ */
+@property (nonatomic, assign, readonly) NSUInteger resultCacheMisses;
+
+/**
+ *  The fraction of reads answered from the cache, between 0 and 1, or 0 before any reads.
+ */
+@property (nonatomic, assign, readonly) double resultCacheHitRate;
+
+/**
+ *  Removes all cached results, and resets the hit and miss counters.
+ */
+- (void)clearResultCache;
+
+/**
+ *  Removes the cached results that read a table, e.g. after it has been changed in a way sqlite doesn't report.
+ */
+- (void)invalidateResultCacheForTable:(NSString *)tableName;
+
+/**
+ *  Returns the cached result of a statement, running `query` to produce it if necessary. When the cache is disabled,
+ *  `query` is always called.
+ *
+ *  @param  sql         The statement's SQL.
+ *  @param  arguments   The statement's arguments.
+ *  @param  error_p     A pointer to any error that occurs.
+ *  @param  query       Runs the statement and returns an immutable result, or `nil` if an error occurs. Results that
+ *                      are `nil` aren't cached.
+ *
+ *  @return The statement's result, or `nil` if an error occurs.
+ */
+- (id)cachedResultOfStatement:(NSString *)sql
+                    arguments:(NSArray *)arguments
+                        error:(NSError **)error_p
+                        query:(id (^)(NSError ** error_p))query;
+
+@end
@@ -0,0 +1,740 @@
+#import "FMDatabase+FMDBResultCache.h"
+#import <objc/runtime.h>
+
+static const void * FMDBResultCacheKey = &FMDBResultCacheKey;
+
+static const NSUInteger FMDBDefaultResultCacheByteLimit = 4 * 1024 * 1024;
+
+// the temporary tables of FMDBMatchingSet and FMDBBatchUpdate are recreated or refilled as needed, and never read by
+// cached statements
+static const char * FMDBHelperTablePrefixes[] = { "fmdb_matching_set_", "fmdb_batch_update_" };
+
+/**
+ *  Returns roughly how many bytes an immutable result uses.
+ */
+static NSUInteger FMDBEstimatedCostOfResult(id result)
+{
+  if ([result isKindOfClass:[NSString class]])
+  {
+    return 16 + [result length] * 2;
+  }
+  else if ([result isKindOfClass:[NSData class]])
+  {
+    return 16 + [result length];
+  }
+  else if ([result isKindOfClass:[NSDictionary class]])
+  {
+    // records share their keys, so only values are counted
+    NSUInteger cost = 48;
+    for (id key in result)
+    {
+      cost += 16 + FMDBEstimatedCostOfResult(result[key]);
+    }
+    return cost;
+  }
+  else if ([result isKindOfClass:[NSArray class]])
+  {
+    NSUInteger cost = 32;
+    for (id element in result)
+    {
+      cost += 8 + FMDBEstimatedCostOfResult(element);
+    }
+    return cost;
+  }
+  else if (result == [NSNull null])
+  {
+    return 0;
+  }
+  return 16;
+}
+
+// ========== FMDBCachedStatement ======================================================================================
+#pragma mark - FMDBCachedStatement
+
+/**
+ *  Identifies a read by its SQL and arguments.
+ */
+@interface FMDBCachedStatement : NSObject <NSCopying>
+
+- (instancetype)initWithSQL:(NSString *)sql
+                  arguments:(NSArray *)arguments;
+
+@property (nonatomic, copy, readonly) NSString * sql;
+@property (nonatomic, copy, readonly) NSArray * arguments;
+
+@end
+
+@implementation FMDBCachedStatement
+{
+  NSUInteger _hash;
+}
+
+- (instancetype)initWithSQL:(NSString *)sql
+                  arguments:(NSArray *)arguments
+{
+  self = [super init];
+  if (self)
+  {
+    _sql = [sql copy];
+    _arguments = [arguments copy] ?: @[];
+    
+    // NSArray's hash is only its count, so arguments are hashed individually
+    _hash = _sql.hash;
+    for (id argument in _arguments)
+    {
+      _hash = _hash * 31 + [argument hash];
+    }
+  }
+  return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+- (NSUInteger)hash
+{
+  return _hash;
+}
+
+- (BOOL)isEqual:(FMDBCachedStatement *)other
+{
+  if (self == other)
+  {
+    return YES;
+  }
+  if (NO == [other isKindOfClass:[FMDBCachedStatement class]] ||
+      other->_hash != _hash ||
+      other.arguments.count != self.arguments.count ||
+      NO == [other.sql isEqualToString:self.sql])
+  {
+    return NO;
+  }
+  
+  for (NSUInteger argumentIdx = 0; argumentIdx < self.arguments.count; argumentIdx++)
+  {
+    id argument = self.arguments[argumentIdx];
+    id otherArgument = other.arguments[argumentIdx];
+    if (NO == [argument isEqual:otherArgument])
+    {
+      return NO;
+    }
+    
+    // 1 and 1.0 are equal numbers, but are bound differently, and so can match different text
+    if ([argument isKindOfClass:[NSNumber class]] && strcmp([argument objCType], [otherArgument objCType]) != 0)
+    {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+@end
+
+// ========== FMDBCachedResult =========================================================================================
+#pragma mark - FMDBCachedResult
+
+/**
+ *  A cached result, in a list ordered from most to least recently used.
+ */
+@interface FMDBCachedResult : NSObject
+
+@property (nonatomic, strong) FMDBCachedStatement * statement;
+@property (nonatomic, strong) id result;
+@property (nonatomic, copy) NSSet * tableNames;
+@property (nonatomic, assign) NSUInteger cost;
+@property (nonatomic, unsafe_unretained) FMDBCachedResult * previous;
+@property (nonatomic, unsafe_unretained) FMDBCachedResult * next;
+
+@end
+
+@implementation FMDBCachedResult
+
+@end
+
+// ========== FMDBResultCache ==========================================================================================
+#pragma mark - FMDBResultCache
+
+@interface FMDBResultCache : NSObject
+
+@property (nonatomic, assign) BOOL enabled;
+@property (nonatomic, assign) NSUInteger byteLimit;
+@property (nonatomic, assign) NSUInteger bytes;
+@property (nonatomic, assign) NSUInteger hits;
+@property (nonatomic, assign) NSUInteger misses;
+@property (nonatomic, strong, readonly) NSMutableDictionary * resultsByStatement;
+
+- (void)attachToDatabase:(FMDatabase *)database;
+- (void)detachFromDatabase:(FMDatabase *)database;
+
+- (FMDBCachedResult *)cachedResultOfStatement:(FMDBCachedStatement *)statement;
+- (void)addResult:(id)result
+     forStatement:(FMDBCachedStatement *)statement
+         database:(FMDatabase *)database;
+
+- (void)invalidateTable:(NSString *)tableName;
+- (void)removeAllResults;
+
+@end
+
+@implementation FMDBResultCache
+{
+  sqlite3 * _handle;
+  FMDBCachedResult * _mostRecentResult;
+  FMDBCachedResult * _leastRecentResult;
+  NSMutableDictionary * _resultsByTable;
+  
+  // tables read by each SQL, or NSNull for SQL that can't be cached
+  NSMutableDictionary * _tableNamesBySQL;
+  NSDictionary * _tableNamesByRootPage;
+  
+  // tables changed by the open transaction, whose results aren't cached until it ends
+  NSMutableSet * _tablesChangedInTransaction;
+  
+  // the update hook reports every row, so repeated reports for the same table are skipped
+  char * _lastInvalidatedTableName;
+  BOOL _lastInvalidationWasInTransaction;
+  
+  // DROP TABLE is also authorized as a DELETE, which mustn't be ignored
+  BOOL _isDroppingTable;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _byteLimit = FMDBDefaultResultCacheByteLimit;
+    _resultsByStatement = [[NSMutableDictionary alloc] init];
+    _resultsByTable = [[NSMutableDictionary alloc] init];
+    _tableNamesBySQL = [[NSMutableDictionary alloc] init];
+    _tablesChangedInTransaction = [[NSMutableSet alloc] init];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_lastInvalidatedTableName);
+}
+
+// ---------- HOOKS ----------------------------------------------------------------------------------------------------
+#pragma mark Hooks
+
+static void FMDBResultCacheUpdateHook(void * context,
+                                      int operation,
+                                      const char * databaseName,
+                                      const char * tableName,
+                                      sqlite3_int64 rowId)
+{
+  FMDBResultCache * cache = (__bridge FMDBResultCache *)context;
+  BOOL isInTransaction = (NO == sqlite3_get_autocommit(cache->_handle));
+  if (cache->_lastInvalidatedTableName != NULL &&
+      cache->_lastInvalidationWasInTransaction == isInTransaction &&
+      strcmp(cache->_lastInvalidatedTableName, tableName) == 0)
+  {
+    return;
+  }
+  
+  [cache invalidateTable:[[NSString alloc] initWithUTF8String:tableName]];
+  free(cache->_lastInvalidatedTableName);
+  cache->_lastInvalidatedTableName = strdup(tableName);
+  cache->_lastInvalidationWasInTransaction = isInTransaction;
+}
+
+static BOOL FMDBIsHelperObject(const char * name)
+{
+  if (name == NULL)
+  {
+    return NO;
+  }
+  size_t prefixCount = sizeof(FMDBHelperTablePrefixes) / sizeof(*FMDBHelperTablePrefixes);
+  for (size_t prefixIdx = 0; prefixIdx < prefixCount; prefixIdx++)
+  {
+    if (strncmp(name, FMDBHelperTablePrefixes[prefixIdx], strlen(FMDBHelperTablePrefixes[prefixIdx])) == 0)
+    {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+static int FMDBResultCacheAuthorizer(void * context,
+                                     int action,
+                                     const char * argument1,
+                                     const char * argument2,
+                                     const char * databaseName,
+                                     const char * triggerName)
+{
+  FMDBResultCache * cache = (__bridge FMDBResultCache *)context;
+  switch (action)
+  {
+    case SQLITE_DELETE:
+      if (cache->_isDroppingTable ||
+          FMDBIsHelperObject(argument1) ||
+          (argument1 != NULL && strncmp(argument1, "sqlite_", 7) == 0))
+      {
+        // dropping a table deletes its rows and its schema, which an ignored DELETE would skip
+        cache->_isDroppingTable = NO;
+        return SQLITE_OK;
+      }
+      // disables the truncate optimization, which deletes all rows without reporting them to the update hook
+      return SQLITE_IGNORE;
+    
+    case SQLITE_CREATE_TEMP_TABLE:
+    case SQLITE_DROP_TEMP_TABLE:
+    case SQLITE_CREATE_TEMP_INDEX:
+    case SQLITE_DROP_TEMP_INDEX:
+      cache->_isDroppingTable = (action == SQLITE_DROP_TEMP_TABLE);
+      if (NO == FMDBIsHelperObject(argument1))
+      {
+        [cache removeAllResults];
+      }
+      return SQLITE_OK;
+    
+    case SQLITE_DROP_TABLE:
+    case SQLITE_DROP_VIEW:
+    case SQLITE_DROP_TEMP_VIEW:
+      cache->_isDroppingTable = YES;
+      [cache removeAllResults];
+      return SQLITE_OK;
+    
+    case SQLITE_CREATE_INDEX:
+    case SQLITE_CREATE_TABLE:
+    case SQLITE_CREATE_TEMP_TRIGGER:
+    case SQLITE_CREATE_TEMP_VIEW:
+    case SQLITE_CREATE_TRIGGER:
+    case SQLITE_CREATE_VIEW:
+    case SQLITE_DROP_INDEX:
+    case SQLITE_DROP_TEMP_TRIGGER:
+    case SQLITE_DROP_TRIGGER:
+    case SQLITE_ALTER_TABLE:
+    case SQLITE_ATTACH:
+    case SQLITE_DETACH:
+    case SQLITE_CREATE_VTABLE:
+    case SQLITE_DROP_VTABLE:
+      [cache removeAllResults];
+      return SQLITE_OK;
+    
+    default:
+      return SQLITE_OK;
+  }
+}
+
+- (void)attachToDatabase:(FMDatabase *)database
+{
+  // hooks belong to the connection, so they are installed again if the database has been reopened; sqlite doesn't
+  // return the hooks they replace, only the update hook's context, so they can't be chained to
+  sqlite3 * handle = [database sqliteHandle];
+  if (handle == _handle)
+  {
+    return;
+  }
+  
+  [self removeAllResults];
+  _handle = handle;
+  if (handle != NULL)
+  {
+    sqlite3_update_hook(handle, FMDBResultCacheUpdateHook, (__bridge void *)self);
+    sqlite3_set_authorizer(handle, FMDBResultCacheAuthorizer, (__bridge void *)self);
+  }
+}
+
+- (void)detachFromDatabase:(FMDatabase *)database
+{
+  if (_handle != NULL && _handle == [database sqliteHandle])
+  {
+    sqlite3_update_hook(_handle, NULL, NULL);
+    sqlite3_set_authorizer(_handle, NULL, NULL);
+  }
+  _handle = NULL;
+  [self removeAllResults];
+}
+
+// ---------- RESULTS --------------------------------------------------------------------------------------------------
+#pragma mark Results
+
+- (FMDBCachedResult *)cachedResultOfStatement:(FMDBCachedStatement *)statement
+{
+  if (_tablesChangedInTransaction.count > 0 && _handle != NULL && sqlite3_get_autocommit(_handle))
+  {
+    [_tablesChangedInTransaction removeAllObjects];
+    [self forgetLastInvalidatedTable];
+  }
+  
+  FMDBCachedResult * cachedResult = self.resultsByStatement[statement];
+  if (cachedResult != nil)
+  {
+    [self unlinkResult:cachedResult];
+    [self linkResultAsMostRecent:cachedResult];
+  }
+  return cachedResult;
+}
+
+- (void)addResult:(id)result
+     forStatement:(FMDBCachedStatement *)statement
+         database:(FMDatabase *)database
+{
+  NSSet * tableNames = [self tableNamesReadBySQL:statement.sql
+                                        database:database];
+  if (tableNames == nil || [tableNames intersectsSet:_tablesChangedInTransaction])
+  {
+    return;
+  }
+  
+  FMDBCachedResult * cachedResult = [[FMDBCachedResult alloc] init];
+  cachedResult.statement = statement;
+  cachedResult.result = result;
+  cachedResult.tableNames = tableNames;
+  cachedResult.cost = FMDBEstimatedCostOfResult(result) + statement.sql.length * 2;
+  if (cachedResult.cost > self.byteLimit)
+  {
+    return;
+  }
+  
+  [self removeResult:self.resultsByStatement[statement]];
+  self.resultsByStatement[statement] = cachedResult;
+  [self linkResultAsMostRecent:cachedResult];
+  self.bytes += cachedResult.cost;
+  for (NSString * tableName in tableNames)
+  {
+    NSMutableSet * results = _resultsByTable[tableName];
+    if (results == nil)
+    {
+      results = [[NSMutableSet alloc] init];
+      _resultsByTable[tableName] = results;
+    }
+    [results addObject:cachedResult];
+  }
+  [self forgetLastInvalidatedTable];
+  
+  while (self.bytes > self.byteLimit && _leastRecentResult != nil)
+  {
+    [self removeResult:_leastRecentResult];
+  }
+}
+
+- (void)removeResult:(FMDBCachedResult *)cachedResult
+{
+  if (cachedResult == nil)
+  {
+    return;
+  }
+  
+  for (NSString * tableName in cachedResult.tableNames)
+  {
+    [_resultsByTable[tableName] removeObject:cachedResult];
+  }
+  [self unlinkResult:cachedResult];
+  self.bytes -= cachedResult.cost;
+  [self.resultsByStatement removeObjectForKey:cachedResult.statement];
+}
+
+- (void)invalidateTable:(NSString *)tableName
+{
+  NSString * key = tableName.lowercaseString;
+  if (_handle != NULL && NO == sqlite3_get_autocommit(_handle))
+  {
+    [_tablesChangedInTransaction addObject:key];
+  }
+  
+  NSSet * results = [_resultsByTable[key] copy];
+  for (FMDBCachedResult * cachedResult in results)
+  {
+    [self removeResult:cachedResult];
+  }
+}
+
+- (void)removeAllResults
+{
+  [self.resultsByStatement removeAllObjects];
+  [_resultsByTable removeAllObjects];
+  [_tableNamesBySQL removeAllObjects];
+  _tableNamesByRootPage = nil;
+  _mostRecentResult = nil;
+  _leastRecentResult = nil;
+  self.bytes = 0;
+}
+
+- (void)forgetLastInvalidatedTable
+{
+  free(_lastInvalidatedTableName);
+  _lastInvalidatedTableName = NULL;
+}
+
+- (void)linkResultAsMostRecent:(FMDBCachedResult *)cachedResult
+{
+  cachedResult.previous = nil;
+  cachedResult.next = _mostRecentResult;
+  _mostRecentResult.previous = cachedResult;
+  _mostRecentResult = cachedResult;
+  if (_leastRecentResult == nil)
+  {
+    _leastRecentResult = cachedResult;
+  }
+}
+
+- (void)unlinkResult:(FMDBCachedResult *)cachedResult
+{
+  if (cachedResult.previous != nil)
+  {
+    cachedResult.previous.next = cachedResult.next;
+  }
+  else
+  {
+    _mostRecentResult = cachedResult.next;
+  }
+  
+  if (cachedResult.next != nil)
+  {
+    cachedResult.next.previous = cachedResult.previous;
+  }
+  else
+  {
+    _leastRecentResult = cachedResult.previous;
+  }
+  
+  cachedResult.previous = nil;
+  cachedResult.next = nil;
+}
+
+// ---------- TABLES ---------------------------------------------------------------------------------------------------
+#pragma mark Tables
+
+/**
+ *  Returns the lowercased names of the tables a statement reads, from the b-trees opened by its program, or `nil` if
+ *  its results can't be cached.
+ */
+- (NSSet *)tableNamesReadBySQL:(NSString *)sql
+                      database:(FMDatabase *)database
+{
+  id tableNames = _tableNamesBySQL[sql];
+  if (tableNames == nil)
+  {
+    tableNames = [self readTableNamesReadBySQL:sql] ?: [NSNull null];
+    _tableNamesBySQL[sql] = tableNames;
+  }
+  return (tableNames != [NSNull null] ? tableNames : nil);
+}
+
+- (NSSet *)readTableNamesReadBySQL:(NSString *)sql
+{
+  if (_tableNamesByRootPage == nil)
+  {
+    _tableNamesByRootPage = [self readTableNamesByRootPage];
+  }
+  
+  NSString * explainSQL = [@"EXPLAIN " stringByAppendingString:sql];
+  sqlite3_stmt * statement = NULL;
+  if (sqlite3_prepare_v2(_handle, explainSQL.UTF8String, -1, &statement, NULL) != SQLITE_OK)
+  {
+    sqlite3_finalize(statement);
+    return nil;
+  }
+  
+  NSMutableSet * tableNames = [[NSMutableSet alloc] init];
+  BOOL isCacheable = YES;
+  while (isCacheable && sqlite3_step(statement) == SQLITE_ROW)
+  {
+    const char * opcode = (const char *)sqlite3_column_text(statement, 1);
+    if (opcode == NULL)
+    {
+      continue;
+    }
+    
+    if (strcmp(opcode, "VOpen") == 0)
+    {
+      isCacheable = NO;
+    }
+    else if (strcmp(opcode, "OpenRead") == 0)
+    {
+      int rootPage = sqlite3_column_int(statement, 3);
+      int databaseIdx = sqlite3_column_int(statement, 4);
+      id tableName = _tableNamesByRootPage[[NSString stringWithFormat:@"%d:%d", databaseIdx, rootPage]];
+      if (tableName == nil || tableName == [NSNull null])
+      {
+        // an attached database, or a table whose changes aren't reported
+        isCacheable = NO;
+      }
+      else
+      {
+        [tableNames addObject:tableName];
+      }
+    }
+  }
+  sqlite3_finalize(statement);
+  
+  return (isCacheable ? tableNames : nil);
+}
+
+/**
+ *  Maps the root pages of the main and temporary databases to the lowercased names of their tables, or to `NSNull`
+ *  for `WITHOUT ROWID` tables, whose changes sqlite doesn't report, and for the helpers' temporary tables, whose
+ *  contents aren't part of the statement's SQL or arguments.
+ */
+- (NSDictionary *)readTableNamesByRootPage
+{
+  NSMutableDictionary * tableNamesByRootPage = [[NSMutableDictionary alloc] init];
+  tableNamesByRootPage[@"0:1"] = @"sqlite_master";
+  tableNamesByRootPage[@"1:1"] = @"sqlite_temp_master";
+  
+  NSArray * masterTables = @[ @"sqlite_master", @"sqlite_temp_master" ];
+  for (int databaseIdx = 0; databaseIdx < (int)masterTables.count; databaseIdx++)
+  {
+    // an index is classified by the SQL of the table it belongs to, as autoindexes have no SQL of their own
+    NSString * query = [NSString stringWithFormat:@"SELECT m.rootpage, m.tbl_name, t.sql LIKE '%%WITHOUT ROWID%%' "
+                        @"FROM %@ AS m LEFT JOIN %@ AS t ON t.type = 'table' AND t.name = m.tbl_name COLLATE NOCASE "
+                        @"WHERE m.rootpage > 0",
+                        masterTables[databaseIdx],
+                        masterTables[databaseIdx]];
+    sqlite3_stmt * statement = NULL;
+    if (sqlite3_prepare_v2(_handle, query.UTF8String, -1, &statement, NULL) == SQLITE_OK)
+    {
+      while (sqlite3_step(statement) == SQLITE_ROW)
+      {
+        NSString * key = [NSString stringWithFormat:@"%d:%d", databaseIdx, sqlite3_column_int(statement, 0)];
+        const char * tableName = (const char *)sqlite3_column_text(statement, 1);
+        if (sqlite3_column_int(statement, 2) != 0 || tableName == NULL || FMDBIsHelperObject(tableName))
+        {
+          tableNamesByRootPage[key] = [NSNull null];
+        }
+        else
+        {
+          tableNamesByRootPage[key] = [[NSString alloc] initWithUTF8String:tableName].lowercaseString;
+        }
+      }
+    }
+    sqlite3_finalize(statement);
+  }
+  return tableNamesByRootPage;
+}
+
+@end
+
+// ========== FMDatabase (FMDBResultCache) =============================================================================
+#pragma mark - FMDatabase (FMDBResultCache)
+
+@implementation FMDatabase (FMDBResultCache)
+
+- (FMDBResultCache *)resultCache
+{
+  FMDBResultCache * resultCache = objc_getAssociatedObject(self, FMDBResultCacheKey);
+  if (resultCache == nil)
+  {
+    resultCache = [[FMDBResultCache alloc] init];
+    objc_setAssociatedObject(self, FMDBResultCacheKey, resultCache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return resultCache;
+}
+
+- (BOOL)shouldCacheResults
+{
+  return [objc_getAssociatedObject(self, FMDBResultCacheKey) enabled];
+}
+
+- (void)setShouldCacheResults:(BOOL)shouldCacheResults
+{
+  FMDBResultCache * resultCache = self.resultCache;
+  resultCache.enabled = shouldCacheResults;
+  if (shouldCacheResults)
+  {
+    [resultCache attachToDatabase:self];
+  }
+  else
+  {
+    [resultCache detachFromDatabase:self];
+  }
+}
+
+- (NSUInteger)resultCacheByteLimit
+{
+  return self.resultCache.byteLimit;
+}
+
+- (void)setResultCacheByteLimit:(NSUInteger)resultCacheByteLimit
+{
+  self.resultCache.byteLimit = resultCacheByteLimit;
+}
+
+- (NSUInteger)resultCacheBytes
+{
+  return [objc_getAssociatedObject(self, FMDBResultCacheKey) bytes];
+}
+
+- (NSUInteger)resultCacheCount
+{
+  return [[objc_getAssociatedObject(self, FMDBResultCacheKey) resultsByStatement] count];
+}
+
+- (NSUInteger)resultCacheHits
+{
+  return [objc_getAssociatedObject(self, FMDBResultCacheKey) hits];
+}
+
+- (NSUInteger)resultCacheMisses
+{
+  return [objc_getAssociatedObject(self, FMDBResultCacheKey) misses];
+}
+
+- (double)resultCacheHitRate
+{
+  NSUInteger readCount = self.resultCacheHits + self.resultCacheMisses;
+  return (readCount > 0 ? (double)self.resultCacheHits / readCount : 0);
+}
+
+- (void)clearResultCache
+{
+  FMDBResultCache * resultCache = objc_getAssociatedObject(self, FMDBResultCacheKey);
+  [resultCache removeAllResults];
+  resultCache.hits = 0;
+  resultCache.misses = 0;
+}
+
+- (void)invalidateResultCacheForTable:(NSString *)tableName
+{
+  NSParameterAssert(tableName != nil);
+  
+  FMDBResultCache * resultCache = objc_getAssociatedObject(self, FMDBResultCacheKey);
+  if (resultCache.enabled)
+  {
+    // the name may be qualified, e.g. temp.people, and escaped
+    NSString * unqualifiedName = [[tableName componentsSeparatedByString:@"."] lastObject];
+    NSCharacterSet * quotes = [NSCharacterSet characterSetWithCharactersInString:@"\"'`[]"];
+    [resultCache invalidateTable:[unqualifiedName stringByTrimmingCharactersInSet:quotes]];
+  }
+}
+
+- (id)cachedResultOfStatement:(NSString *)sql
+                    arguments:(NSArray *)arguments
+                        error:(NSError **)error_p
+                        query:(id (^)(NSError ** error_p))query
+{
+  FMDBResultCache * resultCache = objc_getAssociatedObject(self, FMDBResultCacheKey);
+  if (resultCache.enabled == NO)
+  {
+    return query(error_p);
+  }
+  
+  [resultCache attachToDatabase:self];
+  FMDBCachedStatement * statement = [[FMDBCachedStatement alloc] initWithSQL:sql
+                                                                   arguments:arguments];
+  FMDBCachedResult * cachedResult = [resultCache cachedResultOfStatement:statement];
+  if (cachedResult != nil)
+  {
+    resultCache.hits++;
+    return cachedResult.result;
+  }
+  
+  resultCache.misses++;
+  id result = query(error_p);
+  if (result != nil)
+  {
+    [resultCache addResult:result
+              forStatement:statement
+                  database:self];
+  }
+  return result;
+}
+
+@end
@@ -0,0 +1,74 @@
+#import "FMDatabase.h"
+
+/**
+ *  An in-memory snapshot of a database's tables, columns, indexes, and triggers. Lookups by name are case-insensitive,
+ *  like sqlite's.
+ */
+@interface FMDBSchemaCatalog : NSObject
+
+/**
+ *  The value of `PRAGMA schema_version` when the catalog was read.
+ */
+@property (nonatomic, assign, readonly) int64_t schemaVersion;
+
+/**
+ *  The names of all tables.
+ */
+@property (nonatomic, copy, readonly) NSSet * tableNames;
+
+/**
+ *  Returns the columns of a table, keyed by column name, in the format of `-[FMDatabase tableSchema:]`, or `nil` if
+ *  there is no such table.
+ */
+- (NSDictionary *)schemaOfTable:(NSString *)tableName;
+
+/**
+ *  Returns the names of all indexes on a table.
+ */
+- (NSSet *)indexNamesOnTable:(NSString *)tableName;
+
+/**
+ *  Returns the SQL that created a table, or `nil` if there is no such table.
+ */
+- (NSString *)sqlForTable:(NSString *)tableName;
+
+/**
+ *  Returns the SQL that created an index, or `nil` if there is no such index, or it was created by a constraint.
+ */
+- (NSString *)sqlForIndex:(NSString *)indexName;
+
+/**
+ *  Returns the name of the table an index belongs to, or `nil` if there is no such index.
+ */
+- (NSString *)tableNameForIndex:(NSString *)indexName;
+
+/**
+ *  Returns the names of all triggers on a table.
+ */
+- (NSSet *)triggerNamesOnTable:(NSString *)tableName;
+
+@end
+
+@interface FMDatabase (FMDBSchemaCatalog)
+
+// ========== SCHEMA CATALOG ===========================================================================================
+#pragma mark - Schema Catalog
+
+/// @name Caching the Schema
+
+/**
+ *  Returns a catalog of the database's schema. The catalog is read once, in a single pass over `sqlite_master`, and is
+ *  reused until `PRAGMA schema_version` changes or a schema helper like
+ *  `-createTableWithName:columns:constraints:error:` is called. Changes to temporary tables made outside of the helpers
+ *  require `-invalidateSchemaCatalog`.
+ *
+ *  @return The catalog, or `nil` if the schema can't be read.
+ */
+- (FMDBSchemaCatalog *)schemaCatalog;
+
+/**
+ *  Discards the cached schema catalog, so that it is read again when next needed.
+ */
+- (void)invalidateSchemaCatalog;
+
+@end
@@ -0,0 +1,245 @@
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import <FMDB/FMDatabaseAdditions.h>
+#import <objc/runtime.h>
+
+static const void * FMDBSchemaCatalogKey = &FMDBSchemaCatalogKey;
+
+// reads every table, index, and trigger with its columns in one statement, using the table_info table-valued
+// function (sqlite 3.16+). Column names are not used, since they are ambiguous. Temporary tables used to match sets
+// and to batch updates are left out.
+static NSString * const FMDBSchemaCatalogQuery =
+  @"SELECT m.type, m.name, m.tbl_name, m.sql, p.cid, p.name, p.type, p.\"notnull\", p.dflt_value, p.pk"
+  @" FROM (SELECT type, name, tbl_name, sql FROM sqlite_master"
+  @"       UNION ALL SELECT type, name, tbl_name, sql FROM sqlite_temp_master) AS m"
+  @" LEFT JOIN pragma_table_info(m.name) AS p ON m.type = 'table'"
+  @" WHERE m.type IN ('table', 'index', 'trigger')"
+  @"   AND m.name NOT LIKE 'sqlite_%' AND m.name NOT LIKE 'fmdb_matching_set_%'"
+  @"   AND m.name NOT LIKE 'fmdb_batch_update_%'"
+  @" ORDER BY m.name, p.cid";
+
+// used when table-valued pragma functions aren't available; columns are then read with one PRAGMA per table
+static NSString * const FMDBSchemaCatalogFallbackQuery =
+  @"SELECT type, name, tbl_name, sql"
+  @" FROM (SELECT type, name, tbl_name, sql FROM sqlite_master"
+  @"       UNION ALL SELECT type, name, tbl_name, sql FROM sqlite_temp_master)"
+  @" WHERE type IN ('table', 'index', 'trigger')"
+  @"   AND name NOT LIKE 'sqlite_%' AND name NOT LIKE 'fmdb_matching_set_%'"
+  @"   AND name NOT LIKE 'fmdb_batch_update_%'";
+
+static NSString * const FMDBTableInfoColumnNames[] = { @"cid", @"name", @"type", @"notnull", @"dflt_value", @"pk" };
+
+// ========== FMDBSchemaCatalog ========================================================================================
+#pragma mark - FMDBSchemaCatalog
+
+@interface FMDBSchemaCatalog ()
+
+@property (nonatomic, assign, readwrite) int64_t schemaVersion;
+@property (nonatomic, copy, readwrite) NSSet * tableNames;
+
+// all keyed by lowercase name
+@property (nonatomic, strong) NSMutableDictionary * tableSchemas;
+@property (nonatomic, strong) NSMutableDictionary * tableSQL;
+@property (nonatomic, strong) NSMutableDictionary * indexNamesByTable;
+@property (nonatomic, strong) NSMutableDictionary * indexSQL;
+@property (nonatomic, strong) NSMutableDictionary * indexTableNames;
+@property (nonatomic, strong) NSMutableDictionary * triggerNamesByTable;
+
+@end
+
+@implementation FMDBSchemaCatalog
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _tableSchemas = [[NSMutableDictionary alloc] init];
+    _tableSQL = [[NSMutableDictionary alloc] init];
+    _indexNamesByTable = [[NSMutableDictionary alloc] init];
+    _indexSQL = [[NSMutableDictionary alloc] init];
+    _indexTableNames = [[NSMutableDictionary alloc] init];
+    _triggerNamesByTable = [[NSMutableDictionary alloc] init];
+  }
+  return self;
+}
+
+- (NSDictionary *)schemaOfTable:(NSString *)tableName
+{
+  return [self.tableSchemas[tableName.lowercaseString] copy];
+}
+
+- (NSSet *)indexNamesOnTable:(NSString *)tableName
+{
+  return [self.indexNamesByTable[tableName.lowercaseString] copy] ?: [NSSet set];
+}
+
+- (NSString *)sqlForTable:(NSString *)tableName
+{
+  return self.tableSQL[tableName.lowercaseString];
+}
+
+- (NSString *)sqlForIndex:(NSString *)indexName
+{
+  return self.indexSQL[indexName.lowercaseString];
+}
+
+- (NSString *)tableNameForIndex:(NSString *)indexName
+{
+  return self.indexTableNames[indexName.lowercaseString];
+}
+
+- (NSSet *)triggerNamesOnTable:(NSString *)tableName
+{
+  return [self.triggerNamesByTable[tableName.lowercaseString] copy] ?: [NSSet set];
+}
+
+// ---------- BUILDING -------------------------------------------------------------------------------------------------
+#pragma mark Building
+
+- (void)addObjectOfType:(NSString *)type
+                   name:(NSString *)name
+              tableName:(NSString *)tableName
+                    sql:(id)sql
+{
+  NSString * key = name.lowercaseString;
+  if ([type isEqualToString:@"table"])
+  {
+    if (self.tableSchemas[key] == nil)
+    {
+      self.tableSchemas[key] = [[NSMutableDictionary alloc] init];
+    }
+    if (sql != [NSNull null])
+    {
+      self.tableSQL[key] = sql;
+    }
+  }
+  else if ([type isEqualToString:@"trigger"])
+  {
+    NSString * tableKey = tableName.lowercaseString;
+    NSMutableSet * triggerNames = self.triggerNamesByTable[tableKey];
+    if (triggerNames == nil)
+    {
+      triggerNames = [[NSMutableSet alloc] init];
+      self.triggerNamesByTable[tableKey] = triggerNames;
+    }
+    [triggerNames addObject:name];
+  }
+  else
+  {
+    NSString * tableKey = tableName.lowercaseString;
+    NSMutableSet * indexNames = self.indexNamesByTable[tableKey];
+    if (indexNames == nil)
+    {
+      indexNames = [[NSMutableSet alloc] init];
+      self.indexNamesByTable[tableKey] = indexNames;
+    }
+    [indexNames addObject:name];
+    
+    self.indexTableNames[key] = tableName;
+    if (sql != [NSNull null])
+    {
+      self.indexSQL[key] = sql;
+    }
+  }
+}
+
+- (void)addColumn:(NSDictionary *)columnInfo
+          toTable:(NSString *)tableName
+{
+  NSMutableDictionary * tableSchema = self.tableSchemas[tableName.lowercaseString];
+  tableSchema[columnInfo[@"name"]] = [columnInfo copy];
+}
+
+@end
+
+// ========== FMDatabase (FMDBSchemaCatalog) ===========================================================================
+#pragma mark - FMDatabase (FMDBSchemaCatalog)
+
+@implementation FMDatabase (FMDBSchemaCatalog)
+
+- (FMDBSchemaCatalog *)schemaCatalog
+{
+  int64_t schemaVersion = [self longForQuery:@"PRAGMA schema_version"];
+  
+  FMDBSchemaCatalog * catalog = objc_getAssociatedObject(self, FMDBSchemaCatalogKey);
+  if (catalog != nil && catalog.schemaVersion == schemaVersion)
+  {
+    return catalog;
+  }
+  
+  catalog = [self readSchemaCatalog];
+  catalog.schemaVersion = schemaVersion;
+  objc_setAssociatedObject(self, FMDBSchemaCatalogKey, catalog, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  return catalog;
+}
+
+- (void)invalidateSchemaCatalog
+{
+  objc_setAssociatedObject(self, FMDBSchemaCatalogKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (FMDBSchemaCatalog *)readSchemaCatalog
+{
+  FMDBSchemaCatalog * catalog = [[FMDBSchemaCatalog alloc] init];
+  NSMutableSet * tableNames = [[NSMutableSet alloc] init];
+  
+  FMResultSet * results = [self executeQuery:FMDBSchemaCatalogQuery];
+  BOOL readColumns = (results != nil);
+  if (results == nil)
+  {
+    results = [self executeQuery:FMDBSchemaCatalogFallbackQuery];
+    if (results == nil)
+    {
+      return nil;
+    }
+  }
+  
+  while ([results next])
+  {
+    NSString * type = [results stringForColumnIndex:0];
+    NSString * name = [results stringForColumnIndex:1];
+    if ([type isEqualToString:@"table"])
+    {
+      [tableNames addObject:name];
+    }
+    
+    [catalog addObjectOfType:type
+                        name:name
+                   tableName:[results stringForColumnIndex:2]
+                         sql:results[3]];
+    
+    if (readColumns && [results columnIndexIsNull:4] == NO)
+    {
+      NSMutableDictionary * columnInfo = [[NSMutableDictionary alloc] initWithCapacity:6];
+      for (int columnIdx = 0; columnIdx < 6; columnIdx++)
+      {
+        columnInfo[FMDBTableInfoColumnNames[columnIdx]] = results[4 + columnIdx];
+      }
+      [catalog addColumn:columnInfo
+                 toTable:name];
+    }
+  }
+  
+  if (NO == readColumns)
+  {
+    for (NSString * tableName in tableNames)
+    {
+      FMResultSet * tableInfo = [self getTableSchema:tableName];
+      while ([tableInfo next])
+      {
+        NSMutableDictionary * columnInfo = [[NSMutableDictionary alloc] init];
+        for (int columnIdx = 0; columnIdx < [tableInfo columnCount]; columnIdx++)
+        {
+          columnInfo[[tableInfo columnNameForIndex:columnIdx]] = tableInfo[columnIdx];
+        }
+        [catalog addColumn:columnInfo
+                   toTable:tableName];
+      }
+    }
+  }
+  
+  catalog.tableNames = tableNames;
+  return catalog;
+}
+
+@end
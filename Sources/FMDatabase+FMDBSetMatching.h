@@ -0,0 +1,69 @@
+#import "FMDatabase.h"
+
+/**
+ *  A set of keys loaded into a temporary table, used in place of an array in a `matchingValues` dictionary. Matching
+ *  against a table uses the same statement regardless of the number of keys, and isn't limited by the number of
+ *  arguments that can be bound to a statement.
+ */
+@interface FMDBMatchingSet : NSObject
+
+/**
+ *  The name of the temporary table holding the keys.
+ */
+@property (nonatomic, copy, readonly) NSString * tableName;
+
+/**
+ *  The names of the temporary table's key columns, one for each matched column.
+ */
+@property (nonatomic, copy, readonly) NSArray * keyColumnNames;
+
+/**
+ *  The number of keys loaded into the table, including duplicates.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+@end
+
+@interface FMDatabase (FMDBSetMatching)
+
+// ========== SET MATCHING =============================================================================================
+#pragma mark - Set Matching
+
+/// @name Matching Sets of Keys
+
+/**
+ *  Arrays in a `matchingValues` dictionary with more than this many values are loaded into a temporary table and
+ *  joined, rather than expanded to `IN (?, ?, ...)`. Set to 0 to always use a table, so that a single statement serves
+ *  any number of keys. Defaults to `NSUIntegerMax`, which never uses a table.
+ *
+ *  Loading a table writes to the temporary database, within a transaction if one isn't already open, and replaces the
+ *  keys of the previous set loaded in the same position, so enable this only where results that match a set are read
+ *  before the next set is matched.
+ */
+@property (nonatomic, assign) NSUInteger matchingSetThreshold;
+
+/**
+ *  Loads large sets of keys in a `matchingValues` dictionary into temporary tables, as described by
+ *  `matchingSetThreshold`. Called by the helpers that accept `matchingValues`, and only needed when building statements
+ *  with `+whereClauseToMatchValues:arguments:` directly.
+ *
+ *  Keys can match a single column, or a tuple of columns when the dictionary key is an array of column names. For
+ *  example, the following matches people by first and last name:
+ *
+ *        @{ @[ @"firstName", @"lastName" ]: @[ @[ @"Amelia", @"Grey" ],
+ *                                             @[ @"James",  @"Green" ] ] }
+ *
+ *  Each table is reused by the next statement that matches a set in the same position, so results that match a set
+ *  should be read before matching another.
+ *
+ *  @param  valuesToMatch     A dictionary of values to match.
+ *  @param  preparedValues_p  Returns `valuesToMatch`, with large arrays replaced by `FMDBMatchingSet` instances.
+ *  @param  error_p           A pointer to any error that occurs.
+ *
+ *  @return `YES` if successful, `NO` if not.
+ */
+- (BOOL)prepareMatchingValues:(NSDictionary *)valuesToMatch
+               preparedValues:(NSDictionary **)preparedValues_p
+                        error:(NSError **)error_p;
+
+@end
@@ -0,0 +1,179 @@
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import <objc/runtime.h>
+
+static const void * FMDBMatchingSetThresholdKey = &FMDBMatchingSetThresholdKey;
+
+static const NSUInteger FMDBDefaultMatchingSetThreshold = NSUIntegerMax;
+
+// ========== FMDBMatchingSet ==========================================================================================
+#pragma mark - FMDBMatchingSet
+
+@interface FMDBMatchingSet ()
+
+@property (nonatomic, copy, readwrite) NSString * tableName;
+@property (nonatomic, copy, readwrite) NSArray * keyColumnNames;
+@property (nonatomic, assign, readwrite) NSUInteger count;
+
+@end
+
+@implementation FMDBMatchingSet
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"<%@ %@ (%lu keys)>",
+          NSStringFromClass([self class]),
+          self.tableName,
+          (unsigned long)self.count];
+}
+
+@end
+
+// ========== FMDatabase (FMDBSetMatching) =============================================================================
+#pragma mark - FMDatabase (FMDBSetMatching)
+
+@implementation FMDatabase (FMDBSetMatching)
+
+- (NSUInteger)matchingSetThreshold
+{
+  NSNumber * threshold = objc_getAssociatedObject(self, FMDBMatchingSetThresholdKey);
+  return (threshold != nil ? threshold.unsignedIntegerValue : FMDBDefaultMatchingSetThreshold);
+}
+
+- (void)setMatchingSetThreshold:(NSUInteger)matchingSetThreshold
+{
+  objc_setAssociatedObject(self,
+                           FMDBMatchingSetThresholdKey,
+                           @(matchingSetThreshold),
+                           OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (BOOL)prepareMatchingValues:(NSDictionary *)valuesToMatch
+               preparedValues:(NSDictionary **)preparedValues_p
+                        error:(NSError **)error_p
+{
+  NSUInteger threshold = self.matchingSetThreshold;
+  NSMutableDictionary * preparedValues = nil;
+  
+  // sets are numbered in the same order the columns are matched, so the same keys always use the same tables
+  NSArray * columnKeys = [FMDatabase columnKeysOfMatchingValues:valuesToMatch];
+  for (NSUInteger setIdx = 0; setIdx < columnKeys.count; setIdx++)
+  {
+    id columnKey = columnKeys[setIdx];
+    id value = valuesToMatch[columnKey];
+    if (NO == [value isKindOfClass:[NSArray class]] || [value count] <= threshold)
+    {
+      continue;
+    }
+    
+    NSUInteger columnCount = ([columnKey isKindOfClass:[NSArray class]] ? [columnKey count] : 1);
+    FMDBMatchingSet * matchingSet = [self loadMatchingSetAtIndex:setIdx
+                                                     columnCount:columnCount
+                                                            keys:value
+                                                           error:error_p];
+    if (matchingSet == nil)
+    {
+      return NO;
+    }
+    
+    if (preparedValues == nil)
+    {
+      preparedValues = [valuesToMatch mutableCopy];
+    }
+    preparedValues[columnKey] = matchingSet;
+  }
+  
+  if (preparedValues_p != NULL)
+  {
+    *preparedValues_p = (preparedValues ?: valuesToMatch);
+  }
+  return YES;
+}
+
+- (FMDBMatchingSet *)loadMatchingSetAtIndex:(NSUInteger)setIdx
+                                columnCount:(NSUInteger)columnCount
+                                       keys:(NSArray *)keys
+                                      error:(NSError **)error_p
+{
+  NSString * tableName = [NSString stringWithFormat:@"fmdb_matching_set_%lu_%lu",
+                          (unsigned long)setIdx,
+                          (unsigned long)columnCount];
+  NSString * qualifiedTableName = [@"temp." stringByAppendingString:tableName];
+  
+  NSMutableArray * keyColumnNames = [[NSMutableArray alloc] initWithCapacity:columnCount];
+  for (NSUInteger columnIdx = 0; columnIdx < columnCount; columnIdx++)
+  {
+    [keyColumnNames addObject:[NSString stringWithFormat:@"fmdb_key_%lu", (unsigned long)columnIdx]];
+  }
+  NSString * keyColumnList = [keyColumnNames componentsJoinedByString:@", "];
+  
+  NSArray * statements = @[ [NSString stringWithFormat:@"CREATE TEMP TABLE IF NOT EXISTS %@ (%@)",
+                             tableName,
+                             keyColumnList],
+                            [NSString stringWithFormat:@"CREATE INDEX IF NOT EXISTS temp.%@_index ON %@ (%@)",
+                             tableName,
+                             tableName,
+                             keyColumnList],
+                            [NSString stringWithFormat:@"DELETE FROM %@", qualifiedTableName] ];
+  
+  // a deferred transaction keeps the main database unlocked while the keys are written to the temporary database
+  BOOL ownsTransaction = (NO == self.inTransaction);
+  if (ownsTransaction && NO == [self beginDeferredTransaction])
+  {
+    if (error_p != NULL) *error_p = self.lastError;
+    return nil;
+  }
+  
+  BOOL succeeded = YES;
+  for (NSString * statement in statements)
+  {
+    succeeded = succeeded && [self executeUpdate:statement
+                                           error:error_p];
+  }
+  
+  if (succeeded)
+  {
+    __block NSUInteger keyIdx = 0;
+    FMDBBulkInsertResult * result = [self bulkInsertInto:qualifiedTableName
+                                                 columns:keyColumnNames
+                                           rowsFromBlock:^NSArray *{
+                                             if (keyIdx == keys.count)
+                                             {
+                                               return nil;
+                                             }
+                                             
+                                             id key = keys[keyIdx++];
+                                             return (columnCount == 1 ? @[ key ] : key);
+                                           }
+                                          commitInterval:0
+                                                   error:error_p];
+    succeeded = (result != nil);
+  }
+  
+  if (ownsTransaction)
+  {
+    if (succeeded)
+    {
+      succeeded = [self commit];
+      if (NO == succeeded && error_p != NULL) *error_p = self.lastError;
+    }
+    else
+    {
+      [self rollback];
+    }
+  }
+  
+  if (NO == succeeded)
+  {
+    return nil;
+  }
+  
+  FMDBMatchingSet * matchingSet = [[FMDBMatchingSet alloc] init];
+  matchingSet.tableName = qualifiedTableName;
+  matchingSet.keyColumnNames = keyColumnNames;
+  matchingSet.count = keys.count;
+  return matchingSet;
+}
+
+@end
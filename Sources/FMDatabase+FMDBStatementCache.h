@@ -0,0 +1,63 @@
+#import "FMDatabase.h"
+
+@interface FMDatabase (FMDBStatementCache)
+
+// ========== STATEMENT CACHE ==========================================================================================
+#pragma mark - Statement Cache
+
+/// @name Caching Statements
+
+/**
+ *  Whether SQL generated by the helper methods is cached by the shape of the statement. A statement's shape is its
+ *  operation, table, column list, and the keys of any `matchingValues` dictionary along with the arity of their
+ *  values. Statements with the same shape share their SQL text, so it is only built once.
+ *
+ *  Enabling the cache also enables FMDB's prepared statement cache (`shouldCacheStatements`), so that the shared SQL is
+ *  only prepared once by sqlite. Disabling it restores the previous value of `shouldCacheStatements`. Defaults to `NO`.
+ */
+@property (nonatomic, assign) BOOL shouldCacheStatementShapes;
+
+/**
+ *  The maximum number of statement shapes to cache. Defaults to 256.
+ */
+@property (nonatomic, assign) NSUInteger statementShapeCacheLimit;
+
+/**
+ *  The number of times SQL was found in the statement cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger statementShapeCacheHits;
+
+/**
+ *  The number of times SQL had to be built because it wasn't found in the statement cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger statementShapeCacheMisses;
+
+/**
+ *  Removes all cached SQL and prepared statements, and resets the hit and miss counters.
+ */
+- (void)clearStatementShapeCache;
+
+/**
+ *  Returns the SQL for a statement shape, building it if necessary. When the cache is disabled `build` is always
+ *  called, and `shape` is not.
+ *
+ *  @param  shape       Returns a key describing the statement's shape. See `+statementShapeWithComponents:`.
+ *  @param  build       Returns the SQL for the statement.
+ *
+ *  @return The statement's SQL.
+ */
+- (NSString *)cachedSQLForShape:(NSString * (^)(void))shape
+                          build:(NSString * (^)(void))build;
+
+/**
+ *  Returns a key for a statement shape made of the given components, e.g. `@[ @"SELECT", tableName, columns ]`.
+ */
++ (NSString *)statementShapeWithComponents:(NSArray *)components;
+
+/**
+ *  Returns the shape of a `matchingValues` dictionary: its sorted keys, and whether each value is `NULL`, a single
+ *  value, an array of a given size, or an `FMDBMatchingSet`.
+ */
++ (NSString *)statementShapeOfMatchingValues:(NSDictionary *)valuesToMatch;
+
+@end
@@ -0,0 +1,187 @@
+#import "FMDatabase+FMDBStatementCache.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import <objc/runtime.h>
+
+static const void * FMDBStatementCacheKey = &FMDBStatementCacheKey;
+
+static const NSUInteger FMDBDefaultStatementShapeCacheLimit = 256;
+
+// ========== FMDBStatementCache =======================================================================================
+#pragma mark - FMDBStatementCache
+
+@interface FMDBStatementCache : NSObject
+
+@property (nonatomic, assign) BOOL enabled;
+
+/**
+ *  The value of `shouldCacheStatements` before the cache was enabled, which is restored when it is disabled.
+ */
+@property (nonatomic, assign) BOOL previouslyCachedStatements;
+@property (nonatomic, assign) NSUInteger hits;
+@property (nonatomic, assign) NSUInteger misses;
+@property (nonatomic, strong, readonly) NSCache * sqlByShape;
+
+@end
+
+@implementation FMDBStatementCache
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self)
+  {
+    _sqlByShape = [[NSCache alloc] init];
+    _sqlByShape.countLimit = FMDBDefaultStatementShapeCacheLimit;
+  }
+  return self;
+}
+
+@end
+
+// ========== FMDatabase (FMDBStatementCache) ==========================================================================
+#pragma mark - FMDatabase (FMDBStatementCache)
+
+@implementation FMDatabase (FMDBStatementCache)
+
+- (FMDBStatementCache *)statementCache
+{
+  FMDBStatementCache * statementCache = objc_getAssociatedObject(self, FMDBStatementCacheKey);
+  if (statementCache == nil)
+  {
+    statementCache = [[FMDBStatementCache alloc] init];
+    objc_setAssociatedObject(self, FMDBStatementCacheKey, statementCache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return statementCache;
+}
+
+- (BOOL)shouldCacheStatementShapes
+{
+  return [objc_getAssociatedObject(self, FMDBStatementCacheKey) enabled];
+}
+
+- (void)setShouldCacheStatementShapes:(BOOL)shouldCacheStatementShapes
+{
+  FMDBStatementCache * statementCache = self.statementCache;
+  if (statementCache.enabled == shouldCacheStatementShapes)
+  {
+    return;
+  }
+  
+  statementCache.enabled = shouldCacheStatementShapes;
+  if (shouldCacheStatementShapes)
+  {
+    statementCache.previouslyCachedStatements = [self shouldCacheStatements];
+    [self setShouldCacheStatements:YES];
+  }
+  else
+  {
+    [statementCache.sqlByShape removeAllObjects];
+    [self setShouldCacheStatements:statementCache.previouslyCachedStatements];
+  }
+}
+
+- (NSUInteger)statementShapeCacheLimit
+{
+  return self.statementCache.sqlByShape.countLimit;
+}
+
+- (void)setStatementShapeCacheLimit:(NSUInteger)statementShapeCacheLimit
+{
+  self.statementCache.sqlByShape.countLimit = statementShapeCacheLimit;
+}
+
+- (NSUInteger)statementShapeCacheHits
+{
+  return [objc_getAssociatedObject(self, FMDBStatementCacheKey) hits];
+}
+
+- (NSUInteger)statementShapeCacheMisses
+{
+  return [objc_getAssociatedObject(self, FMDBStatementCacheKey) misses];
+}
+
+- (void)clearStatementShapeCache
+{
+  FMDBStatementCache * statementCache = objc_getAssociatedObject(self, FMDBStatementCacheKey);
+  [statementCache.sqlByShape removeAllObjects];
+  statementCache.hits = 0;
+  statementCache.misses = 0;
+  
+  if (statementCache.enabled)
+  {
+    [self clearCachedStatements];
+  }
+}
+
+- (NSString *)cachedSQLForShape:(NSString * (^)(void))shape
+                          build:(NSString * (^)(void))build
+{
+  FMDBStatementCache * statementCache = objc_getAssociatedObject(self, FMDBStatementCacheKey);
+  if (statementCache.enabled == NO)
+  {
+    return build();
+  }
+  
+  NSString * shapeKey = shape();
+  NSString * sql = [statementCache.sqlByShape objectForKey:shapeKey];
+  if (sql != nil)
+  {
+    statementCache.hits++;
+    return sql;
+  }
+  
+  statementCache.misses++;
+  sql = build();
+  [statementCache.sqlByShape setObject:sql
+                                forKey:shapeKey];
+  return sql;
+}
+
+// ---------- SHAPES ---------------------------------------------------------------------------------------------------
+#pragma mark Shapes
+
++ (NSString *)statementShapeWithComponents:(NSArray *)components
+{
+  // components are separated by a unit separator, which won't appear in table or column names
+  return [components componentsJoinedByString:@"\x1F"];
+}
+
++ (NSString *)statementShapeOfMatchingValues:(NSDictionary *)valuesToMatch
+{
+  NSArray * columnKeys = [FMDatabase columnKeysOfMatchingValues:valuesToMatch];
+  NSMutableString * shape = [[NSMutableString alloc] init];
+  for (id columnKey in columnKeys)
+  {
+    id value = valuesToMatch[columnKey];
+    if ([columnKey isKindOfClass:[NSArray class]])
+    {
+      [shape appendFormat:@"(%@)", [FMDatabase listOfColumns:columnKey]];
+    }
+    else
+    {
+      [shape appendString:columnKey];
+    }
+    
+    if (value == [NSNull null])
+    {
+      [shape appendString:@" IS NULL,"];
+    }
+    else if ([value isKindOfClass:[FMDBMatchingSet class]])
+    {
+      // the set's table is determined by the column's position, so any set in this position has the same shape
+      [shape appendString:@" IN SET,"];
+    }
+    else if ([value isKindOfClass:[NSArray class]])
+    {
+      [shape appendFormat:@" IN %lu,", (unsigned long)[value count]];
+    }
+    else
+    {
+      [shape appendString:@" =,"];
+    }
+  }
+  return shape;
+}
+
+@end
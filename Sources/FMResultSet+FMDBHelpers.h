@@ -1,4 +1,11 @@
 #import "FMResultSet.h"
+#import "FMDBColumnBuffer.h"
+
+/**
+ *  The name of the exception raised by an array from `-lazyRecords` when sqlite fails to read a row. The `NSError`
+ *  describing the failure is under `NSUnderlyingErrorKey` in its `userInfo`.
+ */
+extern NSString * const FMDBRecordReadException;
 
 @interface FMResultSet (FMDBHelpers)
 
@@ -7,4 +14,140 @@
  */
 - (NSArray *)allRecords;
 
+// ========== STREAMING ================================================================================================
+#pragma mark - Streaming
+
+/// @name Streaming Records
+
+/**
+ *  Whether blob values are left out of records, so that they aren't copied into `NSData`. Records of rows whose value
+ *  is a blob have no key for that column. Defaults to `NO`.
+ *
+ *  sqlite still reads the values as each row is stepped; leave large blob columns out of the selected columns, and
+ *  read them with `-[FMDatabase openBlobIn:column:rowId:writable:error:]`, to avoid reading them at all.
+ */
+@property (nonatomic, assign) BOOL excludesBlobColumns;
+
+/**
+ *  Returns the current row as a dictionary keyed by column name. Unlike `-resultDictionary`, all records from the same
+ *  result set share a single set of keys, so column names aren't copied and hashed for every row.
+ */
+- (NSDictionary *)currentRecord;
+
+/**
+ *  Reads results one at a time, passing each row to `block` as a dictionary. Only the current record needs to be held
+ *  in memory. The result set is closed when enumeration ends.
+ *
+ *  @param  block   Called with each record. Set `*stop` to `YES` to stop reading results.
+ */
+- (void)enumerateRecordsUsingBlock:(void (^)(NSDictionary * record, BOOL * stop))block;
+
+/**
+ *  Reads results in batches of up to `batchSize` rows, passing each batch to `block` as an array of dictionaries. The
+ *  result set is closed when enumeration ends.
+ *
+ *  @param  batchSize   The maximum number of records in each batch.
+ *  @param  block       Called with each batch. Set `*stop` to `YES` to stop reading results.
+ */
+- (void)enumerateRecordsInBatchesOfSize:(NSUInteger)batchSize
+                             usingBlock:(void (^)(NSArray * records, BOOL * stop))block;
+
+/**
+ *  Returns an array whose records are read from the result set on demand, rather than all at once. Only a small window
+ *  of records is kept in memory; accessing an earlier record re-runs the statement, and `-count` reads through the
+ *  remaining rows without creating records for them.
+ *
+ *  As `NSArray` has no way to return an error, a row that sqlite fails to read, e.g. with `SQLITE_BUSY` or
+ *  `SQLITE_INTERRUPT`, raises an `FMDBRecordReadException` rather than ending the array early. The next access
+ *  re-runs the statement.
+ *
+ *  The array takes over the result set, which should not be used afterwards. It is closed when the array is released.
+ */
+- (NSArray *)lazyRecords;
+
+// ========== OBJECTS ==================================================================================================
+#pragma mark - Objects
+
+/// @name Reading Objects
+
+/**
+ *  Returns the current row as a new instance of `modelClass`, created with `-init`. Each column is assigned to the
+ *  property with the same name, compared case-insensitively, and columns without a property are ignored.
+ *
+ *  Values are read with sqlite's typed accessors and passed straight to the property's setter, without a dictionary
+ *  or key-value coding. Scalar properties (integers, `BOOL`, `float`, and `double`) are set without boxing, and
+ *  `NSString`, `NSNumber`, `NSData`, and `NSDate` properties are read the same way as FMDB's accessors. Read-only
+ *  properties are set through their instance variables. NULL leaves a property at its initial value.
+ *
+ *  How columns map to properties is worked out once for each class and set of columns, and shared by all result sets.
+ */
+- (id)currentObjectOfClass:(Class)modelClass;
+
+/**
+ *  Reads all results and returns them as an array of `modelClass` instances. See `-currentObjectOfClass:`.
+ */
+- (NSArray *)allObjectsOfClass:(Class)modelClass;
+
+/**
+ *  Reads results one at a time, passing each row to `block` as an instance of `modelClass`. See
+ *  `-currentObjectOfClass:`. The result set is closed when enumeration ends.
+ *
+ *  @param  modelClass  The class of the objects to create.
+ *  @param  block       Called with each object. Set `*stop` to `YES` to stop reading results.
+ */
+- (void)enumerateObjectsOfClass:(Class)modelClass
+                     usingBlock:(void (^)(id object, BOOL * stop))block;
+
+// ========== COLUMNS ==================================================================================================
+#pragma mark - Columns
+
+/// @name Reading Columns
+
+/**
+ *  Reads the next chunk of rows into column buffers, without creating objects for each value. Each buffer is reset, and
+ *  then filled from its column until the smallest buffer is full or there are no more rows. Call repeatedly to read
+ *  the results in chunks; buffers are reused between calls.
+ *
+ *  For example, the following sums a column of prices:
+ *
+ *        FMDBColumnBuffer * prices = [[FMDBColumnBuffer alloc] initWithColumnIndex:0
+ *                                                                              type:FMDBColumnBufferTypeReal
+ *                                                                          capacity:4096];
+ *        double total = 0;
+ *        NSUInteger rowCount;
+ *        while ((rowCount = [results readColumnsIntoBuffers:@[ prices ]]) > 0)
+ *        {
+ *          for (NSUInteger rowIdx = 0; rowIdx < rowCount; rowIdx++) total += prices.reals[rowIdx];
+ *        }
+ *
+ *  @param  buffers   The `FMDBColumnBuffer` instances to fill.
+ *
+ *  @return The number of rows read, or 0 when there are no more rows.
+ */
+- (NSUInteger)readColumnsIntoBuffers:(NSArray *)buffers;
+
+/**
+ *  Reads up to `maxRows` values of an integer column into caller-supplied storage.
+ *
+ *  @param  columnIdx   The index of the column to read.
+ *  @param  values      Storage for at least `maxRows` values.
+ *  @param  nullBitmap  Storage for at least `(maxRows + 7) / 8` bytes, or `NULL` if NULLs needn't be distinguished.
+ *  @param  maxRows     The maximum number of rows to read.
+ *
+ *  @return The number of rows read, or 0 when there are no more rows.
+ */
+- (NSUInteger)readIntegerColumn:(int)columnIdx
+                     intoValues:(int64_t *)values
+                     nullBitmap:(uint8_t *)nullBitmap
+                        maxRows:(NSUInteger)maxRows;
+
+/**
+ *  Reads up to `maxRows` values of a real column into caller-supplied storage. See
+ *  `-readIntegerColumn:intoValues:nullBitmap:maxRows:`.
+ */
+- (NSUInteger)readRealColumn:(int)columnIdx
+                  intoValues:(double *)values
+                  nullBitmap:(uint8_t *)nullBitmap
+                     maxRows:(NSUInteger)maxRows;
+
 @end
@@ -1,15 +1,876 @@
 #import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import <objc/runtime.h>
+
+static const void * FMDBRecordColumnNamesKey = &FMDBRecordColumnNamesKey;
+static const void * FMDBRecordKeySetKey = &FMDBRecordKeySetKey;
+static const void * FMDBObjectMappingKey = &FMDBObjectMappingKey;
+static const void * FMDBExcludesBlobColumnsKey = &FMDBExcludesBlobColumnsKey;
+
+static const NSUInteger FMDBLazyRecordWindowSize = 64;
+
+NSString * const FMDBRecordReadException = @"FMDBRecordReadException";
+
+// ========== FMDBLazyRecordArray ======================================================================================
+#pragma mark - FMDBLazyRecordArray
+
+/**
+ *  An array that steps its statement as records are accessed. Records are read into a window of up to
+ *  `FMDBLazyRecordWindowSize` consecutive rows.
+ */
+@interface FMDBLazyRecordArray : NSArray
+
+- (instancetype)initWithResultSet:(FMResultSet *)resultSet;
+
+@end
+
+@implementation FMDBLazyRecordArray
+{
+  FMResultSet * _resultSet;
+  NSUInteger _count;
+  NSUInteger _nextRowIdx;
+  NSUInteger _windowStart;
+  NSMutableArray * _window;
+  unsigned long _mutations;
+}
+
+- (instancetype)initWithResultSet:(FMResultSet *)resultSet
+{
+  self = [super init];
+  if (self)
+  {
+    _resultSet = resultSet;
+    _count = NSNotFound;
+    _nextRowIdx = 0;
+    _windowStart = 0;
+    _window = [[NSMutableArray alloc] initWithCapacity:FMDBLazyRecordWindowSize];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [_resultSet close];
+}
+
+- (NSUInteger)count
+{
+  if (_count == NSNotFound)
+  {
+    // finish reading the rows, without creating records for them
+    while ([self step])
+    {
+    }
+  }
+  return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+  if (NO == [self readWindowAtIndex:index])
+  {
+    @throw [NSException exceptionWithName:NSRangeException
+                                   reason:[NSString stringWithFormat:@"Index %lu beyond bounds [0 .. %ld]",
+                                           (unsigned long)index,
+                                           (long)self.count - 1]
+                                 userInfo:nil];
+  }
+  return _window[index - _windowStart];
+}
+
+/**
+ *  Makes sure the window holds the record at an index, reading it and the records after it if needed. Returns `NO` if
+ *  there is no such record.
+ */
+- (BOOL)readWindowAtIndex:(NSUInteger)index
+{
+  if (index >= _windowStart && index < _windowStart + _window.count)
+  {
+    return YES;
+  }
+  
+  if (index < _nextRowIdx)
+  {
+    [self rewind];
+  }
+  
+  // skip to the requested row, then fill the window from there
+  while (_nextRowIdx < index && [self step])
+  {
+  }
+  
+  [_window removeAllObjects];
+  _windowStart = index;
+  while (_window.count < FMDBLazyRecordWindowSize && [self step])
+  {
+    [_window addObject:_resultSet.currentRecord];
+  }
+  
+  return (_window.count > 0);
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state
+                                  objects:(id __unsafe_unretained [])buffer
+                                    count:(NSUInteger)len
+{
+  // enumerate a window at a time, without requiring a count
+  NSUInteger rowIdx = state->state;
+  if (state->state == 0)
+  {
+    state->mutationsPtr = &_mutations;
+  }
+  
+  if (NO == [self readWindowAtIndex:rowIdx])
+  {
+    return 0;
+  }
+  
+  NSUInteger offset = rowIdx - _windowStart;
+  NSUInteger enumerated = MIN(len, _window.count - offset);
+  for (NSUInteger idx = 0; idx < enumerated; idx++)
+  {
+    buffer[idx] = _window[offset + idx];
+  }
+  
+  state->state = rowIdx + enumerated;
+  state->itemsPtr = buffer;
+  return enumerated;
+}
+
+- (BOOL)step
+{
+  sqlite3_stmt * statement = _resultSet.statement.statement;
+  if (statement == NULL || (_count != NSNotFound && _nextRowIdx >= _count))
+  {
+    return NO;
+  }
+  
+  // the statement is stepped directly, since -[FMResultSet next] closes the result set once it's finished
+  int stepResult = sqlite3_step(statement);
+  if (stepResult == SQLITE_ROW)
+  {
+    _nextRowIdx++;
+    return YES;
+  }
+  else if (stepResult == SQLITE_DONE)
+  {
+    _count = _nextRowIdx;
+    return NO;
+  }
+  
+  // a failed step isn't the end of the rows; reset the statement so that the next access starts again
+  sqlite3 * db = sqlite3_db_handle(statement);
+  NSError * error = [NSError errorWithDomain:@"FMDatabase"
+                                        code:sqlite3_errcode(db)
+                                    userInfo:@{ NSLocalizedDescriptionKey: @(sqlite3_errmsg(db)) }];
+  [self rewind];
+  [_window removeAllObjects];
+  @throw [NSException exceptionWithName:FMDBRecordReadException
+                                 reason:error.localizedDescription
+                               userInfo:@{ NSUnderlyingErrorKey: error }];
+}
+
+- (void)rewind
+{
+  sqlite3_stmt * statement = _resultSet.statement.statement;
+  if (statement != NULL)
+  {
+    sqlite3_reset(statement);
+  }
+  _nextRowIdx = 0;
+}
+
+@end
+
+// ========== FMDBObjectMapping ========================================================================================
+#pragma mark - FMDBObjectMapping
+
+typedef NS_ENUM(NSInteger, FMDBPropertyType)
+{
+  FMDBPropertyTypeChar,
+  FMDBPropertyTypeUnsignedChar,
+  FMDBPropertyTypeShort,
+  FMDBPropertyTypeUnsignedShort,
+  FMDBPropertyTypeInt,
+  FMDBPropertyTypeUnsignedInt,
+  FMDBPropertyTypeLong,
+  FMDBPropertyTypeUnsignedLong,
+  FMDBPropertyTypeLongLong,
+  FMDBPropertyTypeUnsignedLongLong,
+  FMDBPropertyTypeBool,
+  FMDBPropertyTypeFloat,
+  FMDBPropertyTypeDouble,
+  FMDBPropertyTypeString,
+  FMDBPropertyTypeNumber,
+  FMDBPropertyTypeData,
+  FMDBPropertyTypeDate,
+  FMDBPropertyTypeObject,
+};
+
+/**
+ *  How one column is assigned to a property: through the property's setter when it has one, or else directly to its
+ *  instance variable.
+ */
+typedef struct
+{
+  int columnIdx;
+  FMDBPropertyType type;
+  SEL setter;
+  IMP setterIMP;
+  ptrdiff_t ivarOffset;
+  __unsafe_unretained NSString * key;
+} FMDBPropertyMapping;
+
+/**
+ *  A plan for creating objects of a class from rows with a given set of columns. Plans are built once for each class
+ *  and set of columns, and shared by all result sets.
+ */
+@interface FMDBObjectMapping : NSObject
+
+@property (nonatomic, strong, readonly) Class modelClass;
+
++ (instancetype)mappingForClass:(Class)modelClass
+                    columnNames:(NSArray *)columnNames;
+
+- (id)objectFromResultSet:(FMResultSet *)resultSet;
+
+@end
+
+@implementation FMDBObjectMapping
+{
+  FMDBPropertyMapping * _properties;
+  NSUInteger _propertyCount;
+  NSMutableArray * _keys;
+}
+
++ (NSCache *)mappingCache
+{
+  static NSCache * mappingCache = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mappingCache = [[NSCache alloc] init];
+  });
+  return mappingCache;
+}
+
++ (instancetype)mappingForClass:(Class)modelClass
+                    columnNames:(NSArray *)columnNames
+{
+  NSString * cacheKey = [NSString stringWithFormat:@"%@ %@",
+                         NSStringFromClass(modelClass),
+                         [columnNames componentsJoinedByString:@","]];
+  
+  FMDBObjectMapping * mapping = [[self mappingCache] objectForKey:cacheKey];
+  if (mapping == nil)
+  {
+    mapping = [[self alloc] initWithClass:modelClass
+                              columnNames:columnNames];
+    [[self mappingCache] setObject:mapping forKey:cacheKey];
+  }
+  return mapping;
+}
+
+- (instancetype)initWithClass:(Class)modelClass
+                  columnNames:(NSArray *)columnNames
+{
+  self = [super init];
+  if (self)
+  {
+    _modelClass = modelClass;
+    _properties = calloc(MAX(columnNames.count, (NSUInteger)1), sizeof(FMDBPropertyMapping));
+    _keys = [[NSMutableArray alloc] initWithCapacity:columnNames.count];
+    
+    NSDictionary * propertyNames = [FMDBObjectMapping propertyNamesOfClass:modelClass];
+    [columnNames enumerateObjectsUsingBlock:^(NSString * columnName, NSUInteger columnIdx, BOOL *stop) {
+      NSString * propertyName = propertyNames[columnName.lowercaseString];
+      if (propertyName != nil && [self addProperty:propertyName
+                                         forColumn:(int)columnIdx])
+      {
+        [_keys addObject:propertyName];
+        _properties[_propertyCount - 1].key = propertyName;
+      }
+    }];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_properties);
+}
+
+/**
+ *  Returns the names of a class's properties, including inherited ones, keyed by their lowercase names.
+ */
++ (NSDictionary *)propertyNamesOfClass:(Class)modelClass
+{
+  NSMutableDictionary * propertyNames = [[NSMutableDictionary alloc] init];
+  for (Class cls = modelClass; cls != Nil && cls != [NSObject class]; cls = class_getSuperclass(cls))
+  {
+    unsigned int propertyCount = 0;
+    objc_property_t * properties = class_copyPropertyList(cls, &propertyCount);
+    for (unsigned int propertyIdx = 0; propertyIdx < propertyCount; propertyIdx++)
+    {
+      NSString * propertyName = @(property_getName(properties[propertyIdx]));
+      
+      // a subclass's redeclaration takes precedence
+      if (propertyNames[propertyName.lowercaseString] == nil)
+      {
+        propertyNames[propertyName.lowercaseString] = propertyName;
+      }
+    }
+    free(properties);
+  }
+  return propertyNames;
+}
+
+- (BOOL)addProperty:(NSString *)propertyName
+          forColumn:(int)columnIdx
+{
+  objc_property_t property = class_getProperty(self.modelClass, propertyName.UTF8String);
+  NSString * attributes = @(property_getAttributes(property));
+  
+  FMDBPropertyMapping mapping = { .columnIdx = columnIdx };
+  NSString * ivarName = nil;
+  BOOL isReadOnly = NO;
+  SEL setter = NULL;
+  
+  for (NSString * attribute in [attributes componentsSeparatedByString:@","])
+  {
+    if (attribute.length == 0)
+    {
+      continue;
+    }
+    
+    switch ([attribute characterAtIndex:0])
+    {
+      case 'T':
+        if (NO == [FMDBObjectMapping getPropertyType:&mapping.type fromTypeEncoding:[attribute substringFromIndex:1]])
+        {
+          return NO;
+        }
+        break;
+      
+      case 'R':
+        isReadOnly = YES;
+        break;
+      
+      case 'S':
+        setter = NSSelectorFromString([attribute substringFromIndex:1]);
+        break;
+      
+      case 'V':
+        ivarName = [attribute substringFromIndex:1];
+        break;
+    }
+  }
+  
+  if (NO == isReadOnly)
+  {
+    if (setter == NULL)
+    {
+      setter = NSSelectorFromString([NSString stringWithFormat:@"set%@%@:",
+                                     [propertyName substringToIndex:1].uppercaseString,
+                                     [propertyName substringFromIndex:1]]);
+    }
+    mapping.setter = setter;
+    mapping.setterIMP = class_getMethodImplementation(self.modelClass, setter);
+  }
+  else if (ivarName != nil)
+  {
+    // read-only scalars are written to their instance variables, and objects through key-value coding, which retains
+    // them correctly
+    Ivar ivar = class_getInstanceVariable(self.modelClass, ivarName.UTF8String);
+    if (ivar == NULL)
+    {
+      return NO;
+    }
+    mapping.ivarOffset = ivar_getOffset(ivar);
+  }
+  else
+  {
+    return NO;
+  }
+  
+  _properties[_propertyCount++] = mapping;
+  return YES;
+}
+
++ (BOOL)getPropertyType:(FMDBPropertyType *)type_p
+       fromTypeEncoding:(NSString *)typeEncoding
+{
+  if ([typeEncoding hasPrefix:@"@"])
+  {
+    // object types are encoded as @"ClassName", or just @ for id
+    Class propertyClass = Nil;
+    if (typeEncoding.length > 3)
+    {
+      propertyClass = NSClassFromString([typeEncoding substringWithRange:NSMakeRange(2, typeEncoding.length - 3)]);
+    }
+    
+    if (propertyClass == [NSString class])
+    {
+      *type_p = FMDBPropertyTypeString;
+    }
+    else if (propertyClass == [NSNumber class])
+    {
+      *type_p = FMDBPropertyTypeNumber;
+    }
+    else if (propertyClass == [NSData class])
+    {
+      *type_p = FMDBPropertyTypeData;
+    }
+    else if (propertyClass == [NSDate class])
+    {
+      *type_p = FMDBPropertyTypeDate;
+    }
+    else
+    {
+      *type_p = FMDBPropertyTypeObject;
+    }
+    return YES;
+  }
+  
+  switch ([typeEncoding characterAtIndex:0])
+  {
+    case 'c': *type_p = FMDBPropertyTypeChar; return YES;
+    case 'C': *type_p = FMDBPropertyTypeUnsignedChar; return YES;
+    case 's': *type_p = FMDBPropertyTypeShort; return YES;
+    case 'S': *type_p = FMDBPropertyTypeUnsignedShort; return YES;
+    case 'i': *type_p = FMDBPropertyTypeInt; return YES;
+    case 'I': *type_p = FMDBPropertyTypeUnsignedInt; return YES;
+    case 'l': *type_p = FMDBPropertyTypeLong; return YES;
+    case 'L': *type_p = FMDBPropertyTypeUnsignedLong; return YES;
+    case 'q': *type_p = FMDBPropertyTypeLongLong; return YES;
+    case 'Q': *type_p = FMDBPropertyTypeUnsignedLongLong; return YES;
+    case 'B': *type_p = FMDBPropertyTypeBool; return YES;
+    case 'f': *type_p = FMDBPropertyTypeFloat; return YES;
+    case 'd': *type_p = FMDBPropertyTypeDouble; return YES;
+    default:  return NO;
+  }
+}
+
+// assigns a scalar through the property's setter, or directly to its instance variable
+#define FMDBSetScalarProperty(type, value) \
+  if (property->setter != NULL) \
+  { \
+    ((void (*)(id, SEL, type))property->setterIMP)(object, property->setter, (type)(value)); \
+  } \
+  else \
+  { \
+    *(type *)((uint8_t *)(__bridge void *)object + property->ivarOffset) = (type)(value); \
+  }
+
+- (id)objectFromResultSet:(FMResultSet *)resultSet
+{
+  sqlite3_stmt * statement = resultSet.statement.statement;
+  id object = [[self.modelClass alloc] init];
+  
+  for (NSUInteger propertyIdx = 0; propertyIdx < _propertyCount; propertyIdx++)
+  {
+    FMDBPropertyMapping * property = &_properties[propertyIdx];
+    int columnIdx = property->columnIdx;
+    
+    // NULL leaves scalars at zero and objects at nil, as they are in a new object
+    if (sqlite3_column_type(statement, columnIdx) == SQLITE_NULL)
+    {
+      continue;
+    }
+    
+    switch (property->type)
+    {
+      case FMDBPropertyTypeChar:
+        FMDBSetScalarProperty(char, sqlite3_column_int(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeUnsignedChar:
+        FMDBSetScalarProperty(unsigned char, sqlite3_column_int(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeShort:
+        FMDBSetScalarProperty(short, sqlite3_column_int(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeUnsignedShort:
+        FMDBSetScalarProperty(unsigned short, sqlite3_column_int(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeInt:
+        FMDBSetScalarProperty(int, sqlite3_column_int(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeUnsignedInt:
+        FMDBSetScalarProperty(unsigned int, sqlite3_column_int64(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeLong:
+        FMDBSetScalarProperty(long, sqlite3_column_int64(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeUnsignedLong:
+        FMDBSetScalarProperty(unsigned long, sqlite3_column_int64(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeLongLong:
+        FMDBSetScalarProperty(long long, sqlite3_column_int64(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeUnsignedLongLong:
+        FMDBSetScalarProperty(unsigned long long, sqlite3_column_int64(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeBool:
+        FMDBSetScalarProperty(bool, sqlite3_column_int64(statement, columnIdx) != 0);
+        break;
+      
+      case FMDBPropertyTypeFloat:
+        FMDBSetScalarProperty(float, sqlite3_column_double(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeDouble:
+        FMDBSetScalarProperty(double, sqlite3_column_double(statement, columnIdx));
+        break;
+      
+      case FMDBPropertyTypeString:
+      {
+        const char * text = (const char *)sqlite3_column_text(statement, columnIdx);
+        NSString * value = [[NSString alloc] initWithBytes:text
+                                                    length:sqlite3_column_bytes(statement, columnIdx)
+                                                  encoding:NSUTF8StringEncoding];
+        [self setObject:value forProperty:property ofObject:object];
+        break;
+      }
+      
+      case FMDBPropertyTypeNumber:
+      {
+        NSNumber * value = nil;
+        switch (sqlite3_column_type(statement, columnIdx))
+        {
+          case SQLITE_INTEGER:
+            value = @(sqlite3_column_int64(statement, columnIdx));
+            break;
+          
+          default:
+            value = @(sqlite3_column_double(statement, columnIdx));
+            break;
+        }
+        [self setObject:value forProperty:property ofObject:object];
+        break;
+      }
+      
+      case FMDBPropertyTypeData:
+        [self setObject:[resultSet dataForColumnIndex:columnIdx] forProperty:property ofObject:object];
+        break;
+      
+      case FMDBPropertyTypeDate:
+        [self setObject:[resultSet dateForColumnIndex:columnIdx] forProperty:property ofObject:object];
+        break;
+      
+      case FMDBPropertyTypeObject:
+        [self setObject:[resultSet objectForColumnIndex:columnIdx] forProperty:property ofObject:object];
+        break;
+    }
+  }
+  
+  return object;
+}
+
+#undef FMDBSetScalarProperty
+
+- (void)setObject:(id)value
+      forProperty:(FMDBPropertyMapping *)property
+         ofObject:(id)object
+{
+  if (property->setter != NULL)
+  {
+    ((void (*)(id, SEL, id))property->setterIMP)(object, property->setter, value);
+  }
+  else
+  {
+    [object setValue:value forKey:property->key];
+  }
+}
+
+@end
+
+// ========== FMResultSet (FMDBHelpers) ================================================================================
+#pragma mark - FMResultSet (FMDBHelpers)
 
 @implementation FMResultSet (FMDBHelpers)
 
 - (NSArray *)allRecords
 {
+  id profilingToken = [self beginProfiledSteps];
   NSMutableArray * allRecords = [[NSMutableArray alloc] init];
   while ([self next])
   {
-    [allRecords addObject:self.resultDictionary];
+    [allRecords addObject:self.currentRecord];
   }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:allRecords.count
+                finished:YES];
   return allRecords;
 }
 
+// ========== STREAMING ================================================================================================
+#pragma mark - Streaming
+
+- (NSArray *)recordColumnNames
+{
+  NSArray * columnNames = objc_getAssociatedObject(self, FMDBRecordColumnNamesKey);
+  if (columnNames == nil)
+  {
+    int columnCount = [self columnCount];
+    NSMutableArray * names = [[NSMutableArray alloc] initWithCapacity:columnCount];
+    for (int columnIdx = 0; columnIdx < columnCount; columnIdx++)
+    {
+      [names addObject:[self columnNameForIndex:columnIdx]];
+    }
+    
+    columnNames = names;
+    objc_setAssociatedObject(self, FMDBRecordColumnNamesKey, columnNames, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    objc_setAssociatedObject(self,
+                             FMDBRecordKeySetKey,
+                             [NSDictionary sharedKeySetForKeys:columnNames],
+                             OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return columnNames;
+}
+
+- (BOOL)excludesBlobColumns
+{
+  return [objc_getAssociatedObject(self, FMDBExcludesBlobColumnsKey) boolValue];
+}
+
+- (void)setExcludesBlobColumns:(BOOL)excludesBlobColumns
+{
+  objc_setAssociatedObject(self, FMDBExcludesBlobColumnsKey, @(excludesBlobColumns), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (NSDictionary *)currentRecord
+{
+  NSArray * columnNames = self.recordColumnNames;
+  NSMutableDictionary * record =
+    [NSMutableDictionary dictionaryWithSharedKeySet:objc_getAssociatedObject(self, FMDBRecordKeySetKey)];
+  
+  BOOL excludesBlobColumns = self.excludesBlobColumns;
+  sqlite3_stmt * statement = self.statement.statement;
+  [columnNames enumerateObjectsUsingBlock:^(NSString * columnName, NSUInteger columnIdx, BOOL *stop) {
+    if (excludesBlobColumns && sqlite3_column_type(statement, (int)columnIdx) == SQLITE_BLOB)
+    {
+      return;
+    }
+    record[columnName] = [self objectForColumnIndex:(int)columnIdx];
+  }];
+  
+  return record;
+}
+
+- (void)enumerateRecordsUsingBlock:(void (^)(NSDictionary * record, BOOL * stop))block
+{
+  NSParameterAssert(block != nil);
+  
+  id profilingToken = [self beginProfiledSteps];
+  NSUInteger rowCount = 0;
+  BOOL stop = NO;
+  while (NO == stop && [self next])
+  {
+    rowCount++;
+    @autoreleasepool
+    {
+      block(self.currentRecord, &stop);
+    }
+  }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:rowCount
+                finished:YES];
+  [self close];
+}
+
+- (void)enumerateRecordsInBatchesOfSize:(NSUInteger)batchSize
+                             usingBlock:(void (^)(NSArray * records, BOOL * stop))block
+{
+  NSParameterAssert(batchSize > 0);
+  NSParameterAssert(block != nil);
+  
+  id profilingToken = [self beginProfiledSteps];
+  NSUInteger rowCount = 0;
+  BOOL stop = NO;
+  BOOL finished = NO;
+  while (NO == stop && NO == finished)
+  {
+    @autoreleasepool
+    {
+      NSMutableArray * batch = [[NSMutableArray alloc] initWithCapacity:batchSize];
+      while (batch.count < batchSize)
+      {
+        if (NO == [self next])
+        {
+          finished = YES;
+          break;
+        }
+        [batch addObject:self.currentRecord];
+      }
+      
+      rowCount += batch.count;
+      if (batch.count > 0)
+      {
+        block(batch, &stop);
+      }
+    }
+  }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:rowCount
+                finished:YES];
+  [self close];
+}
+
+- (NSArray *)lazyRecords
+{
+  return [[FMDBLazyRecordArray alloc] initWithResultSet:self];
+}
+
+// ========== OBJECTS ==================================================================================================
+#pragma mark - Objects
+
+- (FMDBObjectMapping *)objectMappingForClass:(Class)modelClass
+{
+  FMDBObjectMapping * mapping = objc_getAssociatedObject(self, FMDBObjectMappingKey);
+  if (mapping.modelClass != modelClass)
+  {
+    mapping = [FMDBObjectMapping mappingForClass:modelClass
+                                     columnNames:self.recordColumnNames];
+    objc_setAssociatedObject(self, FMDBObjectMappingKey, mapping, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+  }
+  return mapping;
+}
+
+- (id)currentObjectOfClass:(Class)modelClass
+{
+  NSParameterAssert(modelClass != Nil);
+  
+  return [[self objectMappingForClass:modelClass] objectFromResultSet:self];
+}
+
+- (NSArray *)allObjectsOfClass:(Class)modelClass
+{
+  NSParameterAssert(modelClass != Nil);
+  
+  id profilingToken = [self beginProfiledSteps];
+  FMDBObjectMapping * mapping = nil;
+  NSMutableArray * allObjects = [[NSMutableArray alloc] init];
+  while ([self next])
+  {
+    if (mapping == nil)
+    {
+      mapping = [self objectMappingForClass:modelClass];
+    }
+    [allObjects addObject:[mapping objectFromResultSet:self]];
+  }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:allObjects.count
+                finished:YES];
+  return allObjects;
+}
+
+- (void)enumerateObjectsOfClass:(Class)modelClass
+                     usingBlock:(void (^)(id object, BOOL * stop))block
+{
+  NSParameterAssert(modelClass != Nil);
+  NSParameterAssert(block != nil);
+  
+  id profilingToken = [self beginProfiledSteps];
+  FMDBObjectMapping * mapping = nil;
+  NSUInteger rowCount = 0;
+  BOOL stop = NO;
+  while (NO == stop && [self next])
+  {
+    if (mapping == nil)
+    {
+      mapping = [self objectMappingForClass:modelClass];
+    }
+    
+    rowCount++;
+    @autoreleasepool
+    {
+      block([mapping objectFromResultSet:self], &stop);
+    }
+  }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:rowCount
+                finished:YES];
+  [self close];
+}
+
+// ========== COLUMNS ==================================================================================================
+#pragma mark - Columns
+
+- (NSUInteger)readColumnsIntoBuffers:(NSArray *)buffers
+{
+  NSParameterAssert(buffers.count > 0);
+  
+  NSUInteger maxRows = NSUIntegerMax;
+  for (FMDBColumnBuffer * buffer in buffers)
+  {
+    [buffer reset];
+    maxRows = MIN(maxRows, buffer.capacity);
+  }
+  
+  id profilingToken = [self beginProfiledSteps];
+  NSUInteger rowCount = 0;
+  BOOL finished = NO;
+  while (rowCount < maxRows)
+  {
+    if (NO == [self next])
+    {
+      finished = YES;
+      break;
+    }
+    
+    sqlite3_stmt * statement = self.statement.statement;
+    for (FMDBColumnBuffer * buffer in buffers)
+    {
+      [buffer appendValueFromStatement:statement];
+    }
+    rowCount++;
+  }
+  
+  [self endProfiledSteps:profilingToken
+                rowCount:rowCount
+                finished:finished];
+  return rowCount;
+}
+
+- (NSUInteger)readIntegerColumn:(int)columnIdx
+                     intoValues:(int64_t *)values
+                     nullBitmap:(uint8_t *)nullBitmap
+                        maxRows:(NSUInteger)maxRows
+{
+  FMDBColumnBuffer * buffer = [[FMDBColumnBuffer alloc] initWithColumnIndex:columnIdx
+                                                                       type:FMDBColumnBufferTypeInteger
+                                                                   capacity:maxRows
+                                                                     values:values
+                                                                 nullBitmap:nullBitmap];
+  return [self readColumnsIntoBuffers:@[ buffer ]];
+}
+
+- (NSUInteger)readRealColumn:(int)columnIdx
+                  intoValues:(double *)values
+                  nullBitmap:(uint8_t *)nullBitmap
+                     maxRows:(NSUInteger)maxRows
+{
+  FMDBColumnBuffer * buffer = [[FMDBColumnBuffer alloc] initWithColumnIndex:columnIdx
+                                                                       type:FMDBColumnBufferTypeReal
+                                                                   capacity:maxRows
+                                                                     values:values
+                                                                 nullBitmap:nullBitmap];
+  return [self readColumnsIntoBuffers:@[ buffer ]];
+}
+
 @end
@@ -0,0 +1,137 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDBConnectionPool.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import <FMDB/FMDatabaseAdditions.h>
+#import <libkern/OSAtomic.h>
+
+SpecBegin(FMDBConnectionPool)
+
+__block NSString * path;
+__block FMDBConnectionPool * pool;
+beforeEach(^{
+  path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+  pool = [[FMDBConnectionPool alloc] initWithPath:path
+                                      readerCount:4];
+  [pool open:NULL];
+  
+  [pool inWriter:^(FMDatabase * db) {
+    [db createTableWithName:@"people"
+                    columns:@[ @"firstName", @"lastName" ]
+                constraints:nil
+                      error:NULL];
+  }];
+  [pool insertInto:@"people"
+           columns:@[ @"firstName", @"lastName" ]
+            values:@[ @[ @"Amelia", @"Grey" ],
+                      @[ @"Earl",   @"Grey" ],
+                      @[ @"James",  @"Green" ] ]
+             error:NULL];
+});
+
+afterEach(^{
+  [pool close];
+  pool = nil;
+  
+  for (NSString * suffix in @[ @"", @"-wal", @"-shm" ])
+  {
+    [[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix]
+                                               error:NULL];
+  }
+});
+
+// ========== CONNECTIONS ==============================================================================================
+#pragma mark - Connections
+
+describe(@"- open:", ^{
+  
+  it(@"puts the database in WAL mode", ^{
+    __block NSString * journalMode = nil;
+    [pool inWriter:^(FMDatabase * db) {
+      journalMode = [db stringForQuery:@"PRAGMA journal_mode"];
+    }];
+    
+    expect(journalMode).to.equal(@"wal");
+  });
+
+});
+
+describe(@"- inReader:", ^{
+  
+  it(@"passes a read-only connection", ^{
+    __block BOOL succeeded = YES;
+    [pool inReader:^(FMDatabase * db) {
+      succeeded = [db deleteFrom:@"people"
+                           where:nil
+                       arguments:nil
+                           error:NULL] >= 0;
+    }];
+    
+    expect(succeeded).to.beFalsy();
+    expect([pool countFrom:@"people" error:NULL]).to.equal(3);
+  });
+
+});
+
+describe(@"- inReadersConcurrently:", ^{
+  
+  it(@"runs every block", ^{
+    __block int32_t blockCount = 0;
+    NSMutableArray * blocks = [[NSMutableArray alloc] init];
+    for (NSUInteger blockIdx = 0; blockIdx < 16; blockIdx++)
+    {
+      [blocks addObject:[^(FMDatabase * db) {
+        if ([db countFrom:@"people" error:NULL] == 3)
+        {
+          OSAtomicIncrement32(&blockCount);
+        }
+      } copy]];
+    }
+    
+    [pool inReadersConcurrently:blocks];
+    
+    expect(blockCount).to.equal(16);
+  });
+
+});
+
+// ========== READS AND WRITES =========================================================================================
+#pragma mark - Reads and Writes
+
+describe(@"- update:values:matchingValues:error:", ^{
+  
+  it(@"is visible to readers once written", ^{
+    NSInteger changes = [pool update:@"people"
+                              values:@{ @"lastName": @"Gray" }
+                      matchingValues:@{ @"lastName": @"Grey" }
+                               error:NULL];
+    
+    expect(changes).to.equal(2);
+    expect([pool countFrom:@"people"
+            matchingValues:@{ @"lastName": @"Gray" }
+                     error:NULL]).to.equal(2);
+  });
+
+});
+
+describe(@"- inWriterTransaction:", ^{
+  
+  it(@"rolls back when asked", ^{
+    [pool inWriterTransaction:^(FMDatabase * db, BOOL * rollback) {
+      [db deleteFrom:@"people"
+               where:nil
+           arguments:nil
+               error:NULL];
+      *rollback = YES;
+    }];
+    
+    expect([pool selectAllFrom:@"people"
+                       orderBy:@"firstName"
+                         error:NULL].count).to.equal(3);
+  });
+
+});
+
+SpecEnd
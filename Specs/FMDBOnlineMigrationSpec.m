@@ -0,0 +1,211 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDBOnlineMigration.h"
+#import "FMDBWriteQueue.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+#import <FMDB/FMDatabaseAdditions.h>
+
+SpecBegin(FMDBOnlineMigration)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1,  @"Amelia", @"Grey" ],
+                          @[ @2,  @"Earl",   @"Grey" ],
+                          @[ @5,  @"James",  [NSNull null] ],
+                          @[ @8,  @"Grace",  @"Kelly" ],
+                          @[ @13, @"Ada",    @"King" ] ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== COPY =====================================================================================================
+#pragma mark - Copy
+
+describe(@"+ copyMigrationWithName:tableName:columns:constraints:", ^{
+  
+  __block FMDBOnlineMigration * migration;
+  beforeEach(^{
+    migration = [FMDBOnlineMigration copyMigrationWithName:@"people_v2"
+                                                 tableName:@"people"
+                                                   columns:@[ @"id INTEGER PRIMARY KEY", @"name TEXT", @"lastName" ]
+                                               constraints:nil];
+    [migration setExpression:@"firstName || ' ' || coalesce(lastName, '')"
+                   forColumn:@"name"];
+    [migration addIndexWithName:@"people_lastName"
+                        columns:@[ @"lastName" ]
+                         unique:NO];
+    migration.chunkSize = 2;
+  });
+  
+  it(@"rebuilds the table a chunk at a time", ^{
+    __block NSUInteger stepCount = 0;
+    migration.progressHandler = ^(FMDBOnlineMigration * progressingMigration) {
+      stepCount++;
+    };
+    
+    expect([migration runInDatabase:database error:&error]).to.beTruthy();
+    expect(error).to.beNil();
+    expect(migration.isFinished).to.beTruthy();
+    expect(migration.migratedRowCount).to.equal(5);
+    expect(stepCount).to.equal(5);
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error][2]).to.equal(@{ @"id": @5,
+                                                                                       @"name": @"James ",
+                                                                                       @"lastName": [NSNull null] });
+    expect([database indexNamesOnTable:@"people"]).to.equal([NSSet setWithObject:@"people_lastName"]);
+    expect([database tableNames]).notTo.contain(@"fmdb_copy_of_people");
+  });
+  
+  it(@"keeps copied rows up to date", ^{
+    [migration migrateNextChunkInDatabase:database error:&error];
+    [migration migrateNextChunkInDatabase:database error:&error];
+    
+    expect(migration.lastRowId).to.equal(2);
+    [database update:@"people"
+              values:@{ @"lastName": @"Gray" }
+               where:@"id = ?"
+           arguments:@[ @2 ]];
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @1 ]];
+    [database insertInto:@"people"
+                 columns:@[ @"id", @"firstName", @"lastName" ]
+                  values:@[ @[ @21, @"Alan", @"Turing" ] ]];
+    
+    expect([migration runInDatabase:database error:&error]).to.beTruthy();
+    expect([database countFrom:@"people"]).to.equal(5);
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error][0][@"name"]).to.equal(@"Earl Gray");
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error][4][@"name"]).to.equal(@"Alan Turing");
+  });
+  
+  it(@"fails on rows that violate the new table's constraints", ^{
+    [migration addIndexWithName:@"people_name"
+                        columns:@[ @"lastName" ]
+                         unique:YES];
+    
+    expect([migration runInDatabase:database error:&error]).to.beFalsy();
+    expect(error).notTo.beNil();
+    expect(migration.isFinished).to.beFalsy();
+    expect([[database tableSchema:@"people"] allKeys]).to.contain(@"firstName");
+    expect([database countFrom:@"people"]).to.equal(5);
+  });
+  
+  it(@"doesn't delete rows that reference the table", ^{
+    [database executeUpdate:@"PRAGMA foreign_keys = ON"];
+    [database createTableWithName:@"pets"
+                          columns:@[ @"id INTEGER PRIMARY KEY",
+                                     @"ownerId INTEGER REFERENCES people (id) ON DELETE CASCADE" ]];
+    [database insertInto:@"pets"
+                 columns:@[ @"ownerId" ]
+                  values:@[ @[ @1 ], @[ @2 ], @[ @2 ] ]];
+    
+    expect([migration runInDatabase:database error:&error]).to.beTruthy();
+    expect(error).to.beNil();
+    expect([database countFrom:@"pets"]).to.equal(3);
+    expect([database longForQuery:@"PRAGMA foreign_keys"]).to.equal(1);
+  });
+  
+  it(@"resumes from its saved progress", ^{
+    [migration migrateNextChunkInDatabase:database error:&error];
+    [migration migrateNextChunkInDatabase:database error:&error];
+    
+    FMDBOnlineMigration * resumedMigration = [FMDBOnlineMigration copyMigrationWithName:@"people_v2"
+                                                                              tableName:@"people"
+                                                                                columns:@[ @"id INTEGER PRIMARY KEY",
+                                                                                           @"name TEXT",
+                                                                                           @"lastName" ]
+                                                                            constraints:nil];
+    
+    expect([resumedMigration runInDatabase:database error:&error]).to.beTruthy();
+    expect(resumedMigration.migratedRowCount).to.equal(5);
+    expect([[database tableSchema:@"people"] allKeys]).to.contain(@"name");
+    expect([database countFrom:@"people"]).to.equal(5);
+  });
+  
+  it(@"isn't run again once finished", ^{
+    [migration runInDatabase:database error:&error];
+    
+    FMDBOnlineMigration * finishedMigration = [FMDBOnlineMigration copyMigrationWithName:@"people_v2"
+                                                                               tableName:@"people"
+                                                                                 columns:@[ @"id INTEGER PRIMARY KEY" ]
+                                                                             constraints:nil];
+    
+    expect([finishedMigration runInDatabase:database error:&error]).to.beTruthy();
+    expect([[database tableSchema:@"people"] allKeys]).to.contain(@"name");
+  });
+  
+  it(@"stops when cancelled", ^{
+    [migration migrateNextChunkInDatabase:database error:&error];
+    [migration cancel];
+    
+    expect([migration runInDatabase:database error:&error]).to.beFalsy();
+    expect(error.code).to.equal(SQLITE_INTERRUPT);
+    expect(migration.isFinished).to.beFalsy();
+    expect([[database tableSchema:@"people"] allKeys]).to.contain(@"firstName");
+  });
+  
+  it(@"can be discarded", ^{
+    [migration migrateNextChunkInDatabase:database error:&error];
+    [migration migrateNextChunkInDatabase:database error:&error];
+    
+    expect([migration discardInDatabase:database error:&error]).to.beTruthy();
+    expect([database tableNames]).notTo.contain(@"fmdb_copy_of_people");
+    expect([[database schemaCatalog] triggerNamesOnTable:@"people"]).to.equal([NSSet set]);
+    expect([database countFrom:@"fmdb_online_migrations"]).to.equal(0);
+  });
+
+});
+
+// ========== BACKFILL =================================================================================================
+#pragma mark - Backfill
+
+describe(@"+ backfillMigrationWithName:tableName:expressions:", ^{
+  
+  __block FMDBOnlineMigration * migration;
+  beforeEach(^{
+    [database addColumn:@"fullName TEXT"
+                toTable:@"people"
+                  error:NULL];
+    migration = [FMDBOnlineMigration backfillMigrationWithName:@"people_fullName"
+                                                     tableName:@"people"
+                                                   expressions:@{ @"fullName": @"firstName || ' ' || lastName" }];
+    [migration setWhere:@"lastName IS NOT ?"
+              arguments:@[ @"King" ]];
+    migration.chunkSize = 2;
+  });
+  
+  it(@"sets columns of matching rows", ^{
+    expect([migration runInDatabase:database error:&error]).to.beTruthy();
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"fullName": [NSNull null] }
+                         error:&error]).to.equal(2);
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error][3][@"fullName"]).to.equal(@"Grace Kelly");
+  });
+  
+  it(@"runs on a write queue", ^{
+    FMDBWriteQueue * writeQueue = [[FMDBWriteQueue alloc] initWithDatabase:database];
+    __block BOOL didFinish = NO;
+    [migration runInWriteQueue:writeQueue
+                    completion:^(BOOL finished, NSError * migrationError) {
+                      didFinish = finished;
+                    }];
+    
+    expect(didFinish).will.beTruthy();
+    expect(migration.migratedRowCount).to.equal(4);
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,219 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDBShardedTable.h"
+#import "FMDBConnectionPool.h"
+
+SpecBegin(FMDBShardedTable)
+
+__block NSArray * paths;
+__block FMDBShardedTable * table;
+__block NSError * error;
+beforeEach(^{
+  NSMutableArray * shardPaths = [[NSMutableArray alloc] init];
+  for (NSUInteger shardIdx = 0; shardIdx < 3; shardIdx++)
+  {
+    [shardPaths addObject:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+  }
+  paths = shardPaths;
+  
+  table = [[FMDBShardedTable alloc] initWithName:@"people"
+                                  shardKeyColumn:@"id"
+                                           paths:paths
+                             readerCountPerShard:2];
+  [table open:NULL];
+  [table createTableWithColumns:@[ @"id INTEGER PRIMARY KEY", @"name", @"city" ]
+                    constraints:nil
+                          error:NULL];
+  
+  NSArray * cities = @[ @"Leeds", @"Paris", @"Oslo" ];
+  NSMutableArray * rows = [[NSMutableArray alloc] init];
+  for (NSUInteger personIdx = 1; personIdx <= 30; personIdx++)
+  {
+    [rows addObject:@{ @"id": @(personIdx),
+                       @"name": [NSString stringWithFormat:@"Person %02lu", (unsigned long)(31 - personIdx)],
+                       @"city": cities[personIdx % cities.count] }];
+  }
+  [table insertRows:rows error:NULL];
+});
+
+afterEach(^{
+  [table close];
+  table = nil;
+  error = nil;
+  
+  for (NSString * path in paths)
+  {
+    for (NSString * suffix in @[ @"", @"-wal", @"-shm" ])
+    {
+      [[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix]
+                                                 error:NULL];
+    }
+  }
+});
+
+// ========== SHARDING =================================================================================================
+#pragma mark - Sharding
+
+describe(@"+ hashOfShardKey:", ^{
+  
+  it(@"hashes equal numbers equally", ^{
+    expect([FMDBShardedTable hashOfShardKey:@1]).to.equal([FMDBShardedTable hashOfShardKey:@1.0]);
+    expect([FMDBShardedTable hashOfShardKey:@1]).notTo.equal([FMDBShardedTable hashOfShardKey:@1.5]);
+    expect([FMDBShardedTable hashOfShardKey:@"1"]).notTo.equal([FMDBShardedTable hashOfShardKey:@1]);
+  });
+
+});
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+describe(@"- insertRows:error:", ^{
+  
+  it(@"spreads rows across shards by their keys", ^{
+    NSInteger totalCount = 0;
+    for (NSUInteger shardIdx = 0; shardIdx < table.shards.count; shardIdx++)
+    {
+      FMDBConnectionPool * shard = table.shards[shardIdx];
+      NSArray * records = [shard selectAllFrom:@"people" orderBy:nil error:&error];
+      for (NSDictionary * record in records)
+      {
+        expect([table shardIndexOfKey:record[@"id"]]).to.equal(shardIdx);
+      }
+      expect(records.count).to.beGreaterThan(0);
+      totalCount += records.count;
+    }
+    
+    expect(totalCount).to.equal(30);
+  });
+
+});
+
+describe(@"- updateValues:matchingValues:error:", ^{
+  
+  it(@"updates rows in the shards of their keys", ^{
+    NSInteger changes = [table updateValues:@{ @"city": @"Rome" }
+                             matchingValues:@{ @"id": @[ @1, @2, @3, @4, @31 ] }
+                                      error:&error];
+    
+    expect(error).to.beNil();
+    expect(changes).to.equal(4);
+    expect([table countMatchingValues:@{ @"city": @"Rome" } error:&error]).to.equal(4);
+  });
+
+});
+
+describe(@"- deleteWhere:arguments:error:", ^{
+  
+  it(@"deletes from every shard", ^{
+    NSInteger changes = [table deleteWhere:@"city = ?"
+                                 arguments:@[ @"Oslo" ]
+                                     error:&error];
+    
+    expect(changes).to.equal(10);
+    expect([table countWhere:nil arguments:nil error:&error]).to.equal(20);
+  });
+
+});
+
+// ========== READS ====================================================================================================
+#pragma mark - Reads
+
+describe(@"- countMatchingValues:error:", ^{
+  
+  it(@"sums the counts of every shard", ^{
+    expect([table countMatchingValues:nil error:&error]).to.equal(30);
+    expect([table countMatchingValues:@{ @"city": @"Paris" } error:&error]).to.equal(10);
+  });
+  
+  it(@"counts a single key in its shard", ^{
+    expect([table countMatchingValues:@{ @"id": @7 } error:&error]).to.equal(1);
+    expect([table countMatchingValues:@{ @"id": @[] } error:&error]).to.equal(0);
+  });
+  
+  it(@"routes keys by the shard key column's affinity", ^{
+    expect([table countMatchingValues:@{ @"id": @"7" } error:&error]).to.equal(1);
+    expect([table countMatchingValues:@{ @"id": @[ @"7", @"8", @" 9" ] } error:&error]).to.equal(3);
+  });
+
+});
+
+describe(@"- selectColumns:where:arguments:sortDescriptors:limit:offset:error:", ^{
+  
+  it(@"merges sorted rows from every shard", ^{
+    NSArray * records = [table selectColumns:@[ @"id", @"name" ]
+                                       where:@"city = ?"
+                                   arguments:@[ @"Leeds" ]
+                             sortDescriptors:@[ [NSSortDescriptor sortDescriptorWithKey:@"name" ascending:YES] ]
+                                       limit:@3
+                                      offset:@2
+                                       error:&error];
+    
+    expect(error).to.beNil();
+    expect(records).to.equal(@[ @{ @"id": @24, @"name": @"Person 07" },
+                                @{ @"id": @21, @"name": @"Person 10" },
+                                @{ @"id": @18, @"name": @"Person 13" } ]);
+  });
+  
+  it(@"selects sort columns that weren't asked for", ^{
+    NSArray * records = [table selectColumns:@[ @"id" ]
+                                       where:@"city = ?"
+                                   arguments:@[ @"Leeds" ]
+                             sortDescriptors:@[ [NSSortDescriptor sortDescriptorWithKey:@"name" ascending:YES] ]
+                                       limit:@3
+                                      offset:@2
+                                       error:&error];
+    
+    expect(error).to.beNil();
+    expect(records).to.equal(@[ @{ @"id": @24 }, @{ @"id": @21 }, @{ @"id": @18 } ]);
+  });
+  
+  it(@"merges in descending order", ^{
+    NSArray * records = [table selectColumns:@[ @"id" ]
+                                       where:nil
+                                   arguments:nil
+                             sortDescriptors:@[ [NSSortDescriptor sortDescriptorWithKey:@"id" ascending:NO] ]
+                                       limit:nil
+                                      offset:nil
+                                       error:&error];
+    
+    NSMutableArray * ids = [[NSMutableArray alloc] init];
+    for (NSInteger personId = 30; personId > 0; personId--)
+    {
+      [ids addObject:@(personId)];
+    }
+    expect([records valueForKey:@"id"]).to.equal(ids);
+  });
+  
+  it(@"fails if any shard fails", ^{
+    NSArray * records = [table selectColumns:nil
+                                       where:@"nonexistent = 1"
+                                   arguments:nil
+                             sortDescriptors:nil
+                                       limit:nil
+                                      offset:nil
+                                       error:&error];
+    
+    expect(records).to.beNil();
+    expect(error).notTo.beNil();
+  });
+
+});
+
+describe(@"- selectColumns:matchingValues:sortDescriptors:limit:offset:error:", ^{
+  
+  it(@"selects a single key from its shard", ^{
+    NSArray * records = [table selectColumns:nil
+                              matchingValues:@{ @"id": @5 }
+                             sortDescriptors:nil
+                                       limit:nil
+                                      offset:nil
+                                       error:&error];
+    
+    expect(records).to.equal(@[ @{ @"id": @5, @"name": @"Person 26", @"city": @"Oslo" } ]);
+  });
+
+});
+
+SpecEnd
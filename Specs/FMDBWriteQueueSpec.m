@@ -0,0 +1,231 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDBWriteQueue.h"
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDBWriteQueue)
+
+__block FMDatabase * database;
+__block FMDBWriteQueue * writeQueue;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName UNIQUE", @"lastName" ]];
+  
+  writeQueue = [[FMDBWriteQueue alloc] initWithDatabase:database];
+});
+
+afterEach(^{
+  writeQueue = nil;
+  database = nil;
+});
+
+// ========== WRITES ===================================================================================================
+#pragma mark - Writes
+
+describe(@"- insertInto:row:completion:", ^{
+  
+  it(@"completes with the new row's ID", ^{
+    __block NSNumber * rowId = nil;
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia", @"lastName": @"Grey" }
+                completion:^(NSNumber * newRowId, NSError * error) {
+                  rowId = newRowId;
+                }];
+    
+    expect(rowId).will.equal(@1);
+  });
+  
+  it(@"fails only the writes that fail", ^{
+    __block NSError * firstError = nil;
+    __block NSError * secondError = nil;
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia" }
+                completion:^(NSNumber * rowId, NSError * error) {
+                  firstError = error;
+                }];
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia" }
+                completion:^(NSNumber * rowId, NSError * error) {
+                  secondError = error;
+                }];
+    [writeQueue flush];
+    
+    expect(secondError).will.notTo.beNil();
+    expect(firstError).to.beNil();
+    expect([database countFrom:@"people"]).to.equal(1);
+  });
+  
+  it(@"rolls back the changes of writes that fail", ^{
+    __block NSError * writeError = nil;
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia" }
+                completion:nil];
+    [writeQueue performWrite:^id(FMDatabase * db, NSError ** error_p) {
+      if (NO == [db executeUpdate:@"INSERT INTO people (firstName) VALUES ('Earl')"] ||
+          NO == [db executeUpdate:@"INSERT INTO people (firstName) VALUES ('Amelia')"])
+      {
+        return nil;
+      }
+      return @YES;
+    } completion:^(id result, NSError * error) {
+      writeError = error;
+    }];
+    [writeQueue flush];
+    
+    expect(writeError).will.notTo.beNil();
+    expect([[database selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"firstName"]).to.equal(@[ @"Amelia" ]);
+  });
+  
+  it(@"fails earlier writes when a write rolls back the transaction", ^{
+    [database executeUpdate:@"CREATE TRIGGER people_rollback BEFORE INSERT ON people WHEN NEW.lastName = 'Rollback' "
+                            @"BEGIN SELECT RAISE(ROLLBACK, 'rolled back'); END"];
+    
+    __block NSError * firstError = nil;
+    __block NSError * secondError = nil;
+    __block NSError * thirdError = [NSError errorWithDomain:@"FMDatabase" code:SQLITE_ERROR userInfo:nil];
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia" }
+                completion:^(NSNumber * rowId, NSError * error) {
+                  firstError = error;
+                }];
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Earl", @"lastName": @"Rollback" }
+                completion:^(NSNumber * rowId, NSError * error) {
+                  secondError = error;
+                }];
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Grace" }
+                completion:^(NSNumber * rowId, NSError * error) {
+                  thirdError = error;
+                }];
+    [writeQueue flush];
+    
+    expect(thirdError).will.beNil();
+    expect(firstError).notTo.beNil();
+    expect(secondError).notTo.beNil();
+    expect([[database selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"firstName"]).to.equal(@[ @"Grace" ]);
+  });
+
+});
+
+describe(@"- update:values:matchingValues:completion:", ^{
+  
+  it(@"completes with the number of changed rows", ^{
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia", @"lastName": @"Grey" }
+                completion:nil];
+    
+    __block NSInteger changes = -1;
+    [writeQueue update:@"people"
+                values:@{ @"lastName": @"Gray" }
+        matchingValues:@{ @"lastName": @"Grey" }
+            completion:^(NSInteger changedRowCount, NSError * error) {
+              changes = changedRowCount;
+            }];
+    
+    expect(changes).will.equal(1);
+  });
+
+});
+
+describe(@"- deleteFrom:where:arguments:completion:", ^{
+  
+  it(@"completes with the number of deleted rows", ^{
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia", @"lastName": @"Grey" }
+                completion:nil];
+    
+    __block NSInteger changes = -1;
+    [writeQueue deleteFrom:@"people"
+                     where:@"lastName = ?"
+                 arguments:@[ @"Grey" ]
+                completion:^(NSInteger deletedRowCount, NSError * error) {
+                  changes = deletedRowCount;
+                }];
+    
+    expect(changes).will.equal(1);
+  });
+
+});
+
+describe(@"- performWriteOutsideTransaction:completion:", ^{
+  
+  it(@"runs after earlier writes have been committed", ^{
+    writeQueue.batchInterval = 60;
+    
+    __block BOOL wasInTransaction = YES;
+    __block NSInteger count = -1;
+    [writeQueue insertInto:@"people"
+                       row:@{ @"firstName": @"Amelia" }
+                completion:nil];
+    [writeQueue performWriteOutsideTransaction:^id(FMDatabase * db, NSError ** error_p) {
+      wasInTransaction = db.inTransaction;
+      return @([db countFrom:@"people"]);
+    } completion:^(id result, NSError * error) {
+      count = [result integerValue];
+    }];
+    
+    expect(count).will.equal(1);
+    expect(wasInTransaction).to.beFalsy();
+  });
+
+});
+
+// ========== BATCHES ==================================================================================================
+#pragma mark - Batches
+
+describe(@"- flush", ^{
+  
+  it(@"commits queued writes in a single transaction", ^{
+    writeQueue.batchInterval = 60;
+    
+    __block NSUInteger transactionCount = 0;
+    for (NSUInteger rowIdx = 0; rowIdx < 100; rowIdx++)
+    {
+      [writeQueue performWrite:^id(FMDatabase * db, NSError ** error_p) {
+        if (rowIdx == 0 && db.inTransaction)
+        {
+          transactionCount++;
+        }
+        return [db insertInto:@"people"
+                          row:@{ @"firstName": [NSString stringWithFormat:@"Person %lu", (unsigned long)rowIdx] }
+                        error:error_p];
+      } completion:nil];
+    }
+    [writeQueue flush];
+    
+    expect(transactionCount).to.equal(1);
+    expect([database countFrom:@"people"]).to.equal(100);
+    expect(database.inTransaction).to.beFalsy();
+  });
+  
+  it(@"splits writes into batches of batchSize", ^{
+    writeQueue.batchSize = 10;
+    writeQueue.batchInterval = 60;
+    
+    __block NSUInteger transactionCount = 0;
+    __block BOOL wasInTransaction = NO;
+    for (NSUInteger rowIdx = 0; rowIdx < 25; rowIdx++)
+    {
+      [writeQueue performWrite:^id(FMDatabase * db, NSError ** error_p) {
+        if (rowIdx % 10 == 0 && db.inTransaction)
+        {
+          transactionCount++;
+        }
+        wasInTransaction = db.inTransaction;
+        return @YES;
+      } completion:nil];
+    }
+    [writeQueue flush];
+    
+    expect(transactionCount).to.equal(3);
+    expect(wasInTransaction).to.beTruthy();
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,134 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBatchUpdate.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBBatchUpdate)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1, @"Amelia", @"Grey" ],
+                          @[ @2, @"Earl",   @"Grey" ],
+                          @[ @3, @"James",  @"Green" ] ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== BATCH UPDATE =============================================================================================
+#pragma mark - Batch Update
+
+describe(@"- batchUpdate:keyColumns:rows:error:", ^{
+  
+  it(@"updates each row with its own values", ^{
+    NSArray * rows = @[ @{ @"id": @1, @"firstName": @"Ada",   @"lastName": @"Lovelace" },
+                        @{ @"id": @3, @"firstName": @"Grace", @"lastName": @"Kelly" } ];
+    FMDBBatchUpdateResult * result = [database batchUpdate:@"people"
+                                                keyColumns:@[ @"id" ]
+                                                      rows:rows
+                                                     error:&error];
+    
+    expect(error).to.beNil();
+    expect(result.rowCount).to.equal(2);
+    expect(result.changeCounts).to.equal(@[ @2 ]);
+    expect(result.changeCount).to.equal(2);
+    expect([database selectAllFrom:@"people"
+                           orderBy:@"id"]).to.equal(@[ @{ @"id": @1, @"firstName": @"Ada", @"lastName": @"Lovelace" },
+                                                       @{ @"id": @2, @"firstName": @"Earl", @"lastName": @"Grey" },
+                                                       @{ @"id": @3, @"firstName": @"Grace", @"lastName": @"Kelly" } ]);
+  });
+  
+  it(@"matches rows by a composite key", ^{
+    NSArray * rows = @[ @{ @"firstName": @"Earl", @"lastName": @"Grey",  @"id": @20 },
+                        @{ @"firstName": @"Earl", @"lastName": @"Green", @"id": @30 } ];
+    FMDBBatchUpdateResult * result = [database batchUpdate:@"people"
+                                                keyColumns:@[ @"firstName", @"lastName" ]
+                                                      rows:rows
+                                                     error:&error];
+    
+    expect(result.changeCounts).to.equal(@[ @1 ]);
+    expect([database selectAllFrom:@"people"
+                           orderBy:@"id"]).to.equal(@[ @{ @"id": @1, @"firstName": @"Amelia", @"lastName": @"Grey" },
+                                                       @{ @"id": @3, @"firstName": @"James", @"lastName": @"Green" },
+                                                       @{ @"id": @20, @"firstName": @"Earl", @"lastName": @"Grey" } ]);
+  });
+  
+  it(@"splits rows that set different columns into separate chunks", ^{
+    FMDBBatchUpdateResult * result = [database batchUpdate:@"people"
+                                                keyColumns:@[ @"id" ]
+                                                      rows:@[ @{ @"id": @1, @"firstName": @"Ada" },
+                                                              @{ @"id": @2, @"firstName": @"Alan" },
+                                                              @{ @"id": @3, @"lastName": @"Kelly" },
+                                                              @{ @"id": @4, @"lastName": @"Turing" } ]
+                                                     error:&error];
+    
+    expect(result.changeCounts).to.equal(@[ @2, @1 ]);
+    expect([database selectAllFrom:@"people"
+                           orderBy:@"id"]).to.equal(@[ @{ @"id": @1, @"firstName": @"Ada", @"lastName": @"Grey" },
+                                                       @{ @"id": @2, @"firstName": @"Alan", @"lastName": @"Grey" },
+                                                       @{ @"id": @3, @"firstName": @"James", @"lastName": @"Kelly" } ]);
+  });
+  
+  it(@"applies the last values for a repeated key", ^{
+    [database batchUpdate:@"people"
+               keyColumns:@[ @"id" ]
+                     rows:@[ @{ @"id": @1, @"firstName": @"Ada" },
+                             @{ @"id": @1, @"firstName": @"Grace" } ]
+                    error:&error];
+    
+    expect([database selectAllFrom:@"people"
+                           orderBy:@"id"][0][@"firstName"]).to.equal(@"Grace");
+  });
+  
+  it(@"updates more rows than fit in a single chunk", ^{
+    NSUInteger rowCount = [database maximumRowsPerStatementWithColumnCount:2] * 2 + 7;
+    NSMutableArray * rows = [[NSMutableArray alloc] initWithCapacity:rowCount];
+    for (NSUInteger rowIdx = 0; rowIdx < rowCount; rowIdx++)
+    {
+      [rows addObject:@{ @"id": @(rowIdx + 1), @"lastName": @"Smith" }];
+    }
+    
+    FMDBBatchUpdateResult * result = [database batchUpdate:@"people"
+                                                keyColumns:@[ @"id" ]
+                                                      rows:rows
+                                                     error:&error];
+    
+    expect(error).to.beNil();
+    expect(result.rowCount).to.equal(rowCount);
+    expect(result.changeCounts.count).to.equal(3);
+    expect(result.changeCount).to.equal(3);
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"lastName": @"Smith" }
+                         error:&error]).to.equal(3);
+  });
+  
+  it(@"provides an error and rolls back if the rows cannot be updated", ^{
+    FMDBBatchUpdateResult * result = [database batchUpdate:@"people"
+                                                keyColumns:@[ @"id" ]
+                                                      rows:@[ @{ @"id": @1, @"firstName": @"Ada" },
+                                                              @{ @"id": @2, @"age": @21 } ] // age is an unknown column
+                                                     error:&error];
+    
+    expect(result).to.beNil();
+    expect(error).notTo.beNil();
+    expect(database.inTransaction).to.beFalsy();
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"firstName": @"Ada" }
+                         error:&error]).to.equal(0);
+  });
+
+});
+
+SpecEnd
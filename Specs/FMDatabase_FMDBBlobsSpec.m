@@ -0,0 +1,187 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBlobs.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+#import "FMResultSet+FMDBHelpers.h"
+
+SpecBegin(FMDatabase_FMDBBlobs)
+
+__block FMDatabase * database;
+__block NSError * error;
+__block NSData * contents;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"attachments"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"name TEXT", @"contents BLOB" ]];
+  
+  NSMutableData * bytes = [[NSMutableData alloc] initWithLength:200 * 1024];
+  for (NSUInteger byteIdx = 0; byteIdx < bytes.length; byteIdx++)
+  {
+    ((uint8_t *)bytes.mutableBytes)[byteIdx] = (uint8_t)(byteIdx % 251);
+  }
+  contents = bytes;
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+  contents = nil;
+});
+
+// ========== INSERTING ================================================================================================
+#pragma mark - Inserting
+
+describe(@"- insertInto:row:reservingBlobOfLength:inColumn:error:", ^{
+  
+  it(@"inserts a blob of zeros", ^{
+    NSNumber * rowId = [database insertInto:@"attachments"
+                                        row:@{ @"name": @"empty.bin" }
+                      reservingBlobOfLength:16
+                                   inColumn:@"contents"
+                                      error:&error];
+    
+    expect(error).to.beNil();
+    expect([database selectAllFrom:@"attachments" orderBy:nil error:&error]).to.equal(@[
+      @{ @"id": rowId, @"name": @"empty.bin", @"contents": [[NSMutableData alloc] initWithLength:16] },
+    ]);
+  });
+
+});
+
+describe(@"- insertInto:row:blobColumn:fromInputStream:length:error:", ^{
+  
+  it(@"streams a blob into a new row", ^{
+    NSInputStream * inputStream = [NSInputStream inputStreamWithData:contents];
+    [inputStream open];
+    NSNumber * rowId = [database insertInto:@"attachments"
+                                        row:@{ @"name": @"photo.jpg" }
+                                 blobColumn:@"contents"
+                            fromInputStream:inputStream
+                                     length:contents.length
+                                      error:&error];
+    [inputStream close];
+    
+    expect(error).to.beNil();
+    expect(rowId).to.equal(@1);
+    expect([database selectAllFrom:@"attachments" orderBy:nil error:&error][0][@"contents"]).to.equal(contents);
+  });
+  
+  it(@"rolls back when the stream is too short", ^{
+    NSInputStream * inputStream = [NSInputStream inputStreamWithData:contents];
+    [inputStream open];
+    NSNumber * rowId = [database insertInto:@"attachments"
+                                        row:@{ @"name": @"photo.jpg" }
+                                 blobColumn:@"contents"
+                            fromInputStream:inputStream
+                                     length:contents.length + 1
+                                      error:&error];
+    [inputStream close];
+    
+    expect(rowId).to.beNil();
+    expect(error.code).to.equal(SQLITE_MISMATCH);
+    expect([database countFrom:@"attachments"]).to.equal(0);
+  });
+
+});
+
+// ========== BLOBS ====================================================================================================
+#pragma mark - Blobs
+
+describe(@"- openBlobIn:column:rowId:writable:error:", ^{
+  
+  beforeEach(^{
+    [database insertInto:@"attachments"
+                 columns:@[ @"id", @"name", @"contents" ]
+                  values:@[ @[ @1, @"photo.jpg", contents ],
+                            @[ @2, @"note.txt", [@"Hello" dataUsingEncoding:NSUTF8StringEncoding] ] ]];
+  });
+  
+  it(@"reads a blob in chunks", ^{
+    FMDBBlob * blob = [database openBlobIn:@"attachments"
+                                    column:@"contents"
+                                     rowId:1
+                                  writable:NO
+                                     error:&error];
+    expect(blob.length).to.equal(contents.length);
+    
+    NSMutableData * readContents = [[NSMutableData alloc] init];
+    uint8_t buffer[4096];
+    NSInteger readLength;
+    while ((readLength = [blob read:buffer maxLength:sizeof(buffer) error:&error]) > 0)
+    {
+      [readContents appendBytes:buffer length:(NSUInteger)readLength];
+    }
+    
+    expect(readLength).to.equal(0);
+    expect(readContents).to.equal(contents);
+  });
+  
+  it(@"writes in place", ^{
+    FMDBBlob * blob = [database openBlobIn:@"attachments"
+                                    column:@"contents"
+                                     rowId:2
+                                  writable:YES
+                                     error:&error];
+    
+    expect([blob writeBytes:"J" length:1 atOffset:0 error:&error]).to.beTruthy();
+    expect([blob writeBytes:"!!" length:2 atOffset:4 error:&error]).to.beFalsy();
+    expect(error.code).to.equal(SQLITE_RANGE);
+    [blob close];
+    
+    NSData * note = [database selectAllFrom:@"attachments" orderBy:@"id" error:&error][1][@"contents"];
+    expect([[NSString alloc] initWithData:note encoding:NSUTF8StringEncoding]).to.equal(@"Jello");
+  });
+  
+  it(@"copies to an output stream", ^{
+    FMDBBlob * blob = [database openBlobIn:@"attachments"
+                                    column:@"contents"
+                                     rowId:1
+                                  writable:NO
+                                     error:&error];
+    NSOutputStream * outputStream = [NSOutputStream outputStreamToMemory];
+    [outputStream open];
+    
+    expect([blob writeToOutputStream:outputStream error:&error]).to.equal(contents.length);
+    expect([outputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey]).to.equal(contents);
+  });
+  
+  it(@"moves to another row", ^{
+    FMDBBlob * blob = [database openBlobIn:@"attachments"
+                                    column:@"contents"
+                                     rowId:1
+                                  writable:NO
+                                     error:&error];
+    
+    expect([blob reopenWithRowId:2 error:&error]).to.beTruthy();
+    expect(blob.length).to.equal(5);
+    expect([blob reopenWithRowId:3 error:&error]).to.beFalsy();
+    expect(blob.length).to.equal(0);
+  });
+  
+  it(@"fails for a missing row", ^{
+    FMDBBlob * blob = [database openBlobIn:@"attachments"
+                                    column:@"contents"
+                                     rowId:3
+                                  writable:NO
+                                     error:&error];
+    
+    expect(blob).to.beNil();
+    expect(error).notTo.beNil();
+  });
+  
+  it(@"can be left out of records", ^{
+    FMResultSet * results = [database selectResultsFrom:@"attachments"
+                                                orderBy:@"id"
+                                                  error:&error];
+    results.excludesBlobColumns = YES;
+    
+    expect(results.allRecords).to.equal(@[ @{ @"id": @1, @"name": @"photo.jpg" },
+                                           @{ @"id": @2, @"name": @"note.txt" } ]);
+  });
+
+});
+
+SpecEnd
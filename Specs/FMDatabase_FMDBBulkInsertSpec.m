@@ -0,0 +1,115 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBulkInsert.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBBulkInsert)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== BULK INSERT ==============================================================================================
+#pragma mark - Bulk Insert
+
+describe(@"- bulkInsertInto:columns:rowsFromBlock:commitInterval:error:", ^{
+  
+  it(@"inserts more rows than fit in a single statement", ^{
+    NSUInteger rowCount = [database maximumRowsPerStatementWithColumnCount:2] * 2 + 7;
+    __block NSUInteger rowIdx = 0;
+    FMDBBulkInsertResult * result = [database bulkInsertInto:@"people"
+                                                     columns:@[ @"firstName", @"lastName" ]
+                                               rowsFromBlock:^NSArray *{
+                                                 if (rowIdx == rowCount) return nil;
+                                                 rowIdx++;
+                                                 NSString * firstName = [NSString stringWithFormat:@"Person %lu",
+                                                                         (unsigned long)rowIdx];
+                                                 return @[ firstName, @"Smith" ];
+                                               }
+                                              commitInterval:0
+                                                       error:&error];
+    
+    expect(error).to.beNil();
+    expect(result.rowCount).to.equal(rowCount);
+    expect(result.lastRowId).to.equal(rowCount);
+    expect([database countFrom:@"people"]).to.equal(rowCount);
+  });
+  
+  it(@"inserts more rows of a single column than fit in a compound SELECT", ^{
+    [database createTableWithName:@"numbers"
+                          columns:@[ @"number" ]];
+    __block NSUInteger rowIdx = 0;
+    FMDBBulkInsertResult * result = [database bulkInsertInto:@"numbers"
+                                                     columns:@[ @"number" ]
+                                               rowsFromBlock:^NSArray *{
+                                                 if (rowIdx == 1200) return nil;
+                                                 return @[ @(rowIdx++) ];
+                                               }
+                                              commitInterval:0
+                                                       error:&error];
+    
+    expect(error).to.beNil();
+    expect(result.rowCount).to.equal(1200);
+    expect([database countFrom:@"numbers"]).to.equal(1200);
+    if (sqlite3_libversion_number() < 3008008)
+    {
+      expect([database maximumRowsPerStatementWithColumnCount:1]).to.beLessThanOrEqualTo(500);
+    }
+  });
+  
+  it(@"commits at the given interval", ^{
+    NSArray * rows = @[ @[ @"Amelia", @"Ferris" ], @[ @"Earl", @"Grey" ], @[ @"James", @"Dean" ] ];
+    FMDBBulkInsertResult * result = [database bulkInsertInto:@"people"
+                                                     columns:@[ @"firstName", @"lastName" ]
+                                          rowsFromEnumerator:rows.objectEnumerator
+                                              commitInterval:2
+                                                       error:&error];
+    
+    expect(result.rowCount).to.equal(3);
+    expect(database.inTransaction).to.beFalsy();
+    expect([database selectAllFrom:@"people"
+                           orderBy:@"id"]).to.equal(@[ @{ @"id": @1, @"firstName": @"Amelia", @"lastName": @"Ferris" },
+                                                       @{ @"id": @2, @"firstName": @"Earl",   @"lastName": @"Grey" },
+                                                       @{ @"id": @3, @"firstName": @"James",  @"lastName": @"Dean" } ]);
+  });
+  
+  it(@"leaves an open transaction for the caller", ^{
+    [database beginTransaction];
+    [database bulkInsertInto:@"people"
+                     columns:@[ @"firstName", @"lastName" ]
+          rowsFromEnumerator:@[ @[ @"Amelia", @"Ferris" ] ].objectEnumerator
+              commitInterval:0
+                       error:&error];
+    
+    expect(database.inTransaction).to.beTruthy();
+    [database rollback];
+    expect([database countFrom:@"people"]).to.equal(0);
+  });
+  
+  it(@"provides an error and rolls back if the rows cannot be inserted", ^{
+    FMDBBulkInsertResult * result = [database bulkInsertInto:@"people"
+                                                     columns:@[ @"firstName", @"age" ] // age is an unknown column
+                                          rowsFromEnumerator:@[ @[ @"Amelia", @21 ] ].objectEnumerator
+                                              commitInterval:0
+                                                       error:&error];
+    
+    expect(result).to.beNil();
+    expect(error).notTo.beNil();
+    expect(database.inTransaction).to.beFalsy();
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,282 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBChangesets.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBChangesets)
+
+__block FMDatabase * database;
+__block FMDatabase * replica;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  replica = [FMDatabase openInMemoryDatabase];
+  for (FMDatabase * db in @[ database, replica ])
+  {
+    [db createTableWithName:@"people"
+                    columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName", @"photo BLOB" ]];
+    [db insertInto:@"people"
+           columns:@[ @"id", @"firstName", @"lastName" ]
+            values:@[ @[ @1, @"Amelia", @"Grey" ],
+                      @[ @2, @"Earl",   @"Grey" ] ]];
+  }
+});
+
+afterEach(^{
+  database = nil;
+  replica = nil;
+  error = nil;
+});
+
+// ========== CHANGE TRACKING ==========================================================================================
+#pragma mark - Change Tracking
+
+describe(@"- trackChangesToTable:error:", ^{
+  
+  it(@"records changes from the current change number", ^{
+    [database trackChangesToTable:@"people" error:&error];
+    
+    expect(error).to.beNil();
+    expect([database isTrackingChangesToTable:@"people"]).to.beTruthy();
+    expect([database currentChangeNumber]).to.equal(0);
+    
+    [database insertInto:@"people"
+                 columns:@[ @"firstName", @"lastName" ]
+                  values:@[ @[ @"Grace", @"Hopper" ] ]];
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @1 ]];
+    expect([database currentChangeNumber]).to.equal(2);
+  });
+  
+  it(@"reads change numbers beyond 32 bits", ^{
+    [database trackChangesToTable:@"people" error:&error];
+    [database executeUpdate:@"UPDATE fmdb_change_number SET value = 5000000000"];
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @1 ]];
+    
+    expect([database currentChangeNumber]).to.equal(5000000001LL);
+  });
+  
+  it(@"requires a primary key", ^{
+    [database createTableWithName:@"events"
+                          columns:@[ @"name" ]];
+    
+    expect([database trackChangesToTable:@"events" error:&error]).to.beFalsy();
+    expect(error).notTo.beNil();
+    expect([database isTrackingChangesToTable:@"events"]).to.beFalsy();
+  });
+
+});
+
+describe(@"- stopTrackingChangesToTable:error:", ^{
+  
+  it(@"drops the table's triggers and log", ^{
+    [database trackChangesToTable:@"people" error:NULL];
+    [database stopTrackingChangesToTable:@"people" error:&error];
+    
+    expect(error).to.beNil();
+    expect([database isTrackingChangesToTable:@"people"]).to.beFalsy();
+    expect([[database tableNames] containsObject:@"fmdb_changes_people"]).to.beFalsy();
+  });
+
+});
+
+// ========== CHANGESETS ===============================================================================================
+#pragma mark - Changesets
+
+describe(@"- changesetOfTables:sinceChangeNumber:lastChangeNumber:error:", ^{
+  
+  beforeEach(^{
+    [database trackChangesToTable:@"people" error:NULL];
+  });
+  
+  it(@"replicates inserted, updated, and deleted rows", ^{
+    uint8_t bytes[] = { 0, 1, 255 };
+    [database insertInto:@"people"
+                 columns:@[ @"id", @"firstName", @"lastName", @"photo" ]
+                  values:@[ @[ @3, @"Grace", @"Hopper", [NSData dataWithBytes:bytes length:sizeof(bytes)] ],
+                            @[ @-4, @"Ada", @1.5, [NSNull null] ] ]];
+    [database update:@"people"
+              values:@{ @"lastName": @"Gray" }
+               where:@"id = ?"
+           arguments:@[ @2 ]];
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @1 ]];
+    
+    int64_t lastChangeNumber = 0;
+    NSData * changeset = [database changesetOfTables:@[ @"people" ]
+                                   sinceChangeNumber:0
+                                    lastChangeNumber:&lastChangeNumber
+                                               error:&error];
+    NSInteger changedRowCount = [replica applyChangeset:changeset
+                                         conflictPolicy:FMDBChangesetConflictPolicyReplace
+                                                  error:&error];
+    
+    expect(error).to.beNil();
+    expect(lastChangeNumber).to.equal([database currentChangeNumber]);
+    expect(changedRowCount).to.equal(4);
+    expect([replica selectAllFrom:@"people" orderBy:@"id"]).to.equal([database selectAllFrom:@"people" orderBy:@"id"]);
+  });
+  
+  it(@"includes each changed row once, with its current values", ^{
+    for (NSInteger updateIdx = 0; updateIdx < 10; updateIdx++)
+    {
+      [database update:@"people"
+                values:@{ @"firstName": [NSString stringWithFormat:@"Earl %ld", (long)updateIdx] }
+                 where:@"id = ?"
+             arguments:@[ @2 ]];
+    }
+    
+    NSData * changeset = [database changesetOfTables:@[ @"people" ]
+                                   sinceChangeNumber:0
+                                    lastChangeNumber:NULL
+                                               error:&error];
+    
+    expect([replica applyChangeset:changeset
+                    conflictPolicy:FMDBChangesetConflictPolicyReplace
+                             error:&error]).to.equal(1);
+    expect([replica selectAllFrom:@"people" orderBy:@"id"][1][@"firstName"]).to.equal(@"Earl 9");
+  });
+  
+  it(@"only includes rows changed after the change number", ^{
+    [database update:@"people"
+              values:@{ @"firstName": @"Amy" }
+               where:@"id = ?"
+           arguments:@[ @1 ]];
+    
+    int64_t lastChangeNumber = 0;
+    [database changesetOfTables:@[ @"people" ]
+              sinceChangeNumber:0
+               lastChangeNumber:&lastChangeNumber
+                          error:NULL];
+    [database update:@"people"
+              values:@{ @"firstName": @"Earle" }
+               where:@"id = ?"
+           arguments:@[ @2 ]];
+    NSData * changeset = [database changesetOfTables:@[ @"people" ]
+                                   sinceChangeNumber:lastChangeNumber
+                                    lastChangeNumber:NULL
+                                               error:&error];
+    [replica applyChangeset:changeset conflictPolicy:FMDBChangesetConflictPolicyReplace error:&error];
+    
+    expect(error).to.beNil();
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"firstName"]).to.equal(@[ @"Amelia",
+                                                                                                  @"Earle" ]);
+  });
+  
+  it(@"moves rows whose key changes", ^{
+    [database update:@"people"
+              values:@{ @"id": @5 }
+               where:@"id = ?"
+           arguments:@[ @1 ]];
+    
+    NSData * changeset = [database changesetOfTables:@[ @"people" ]
+                                   sinceChangeNumber:0
+                                    lastChangeNumber:NULL
+                                               error:&error];
+    [replica applyChangeset:changeset conflictPolicy:FMDBChangesetConflictPolicyReplace error:&error];
+    
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"id"]).to.equal(@[ @2, @5 ]);
+  });
+  
+  it(@"doesn't include discarded changes", ^{
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @1 ]];
+    [database discardChangesThroughChangeNumber:[database currentChangeNumber] error:&error];
+    
+    NSData * changeset = [database changesetOfTables:@[ @"people" ]
+                                   sinceChangeNumber:0
+                                    lastChangeNumber:NULL
+                                               error:&error];
+    
+    expect(error).to.beNil();
+    expect([replica applyChangeset:changeset
+                    conflictPolicy:FMDBChangesetConflictPolicyReplace
+                             error:&error]).to.equal(0);
+  });
+  
+  it(@"fails for tables that aren't tracked", ^{
+    [database createTableWithName:@"events"
+                          columns:@[ @"id INTEGER PRIMARY KEY" ]];
+    
+    expect([database changesetOfTables:@[ @"events" ]
+                     sinceChangeNumber:0
+                      lastChangeNumber:NULL
+                                 error:&error]).to.beNil();
+    expect(error).notTo.beNil();
+  });
+
+});
+
+describe(@"- applyChangeset:conflictPolicy:error:", ^{
+  
+  __block NSData * changeset;
+  beforeEach(^{
+    [database trackChangesToTable:@"people" error:NULL];
+    [database update:@"people"
+              values:@{ @"lastName": @"Gray" }
+               where:@"id > ?"
+           arguments:@[ @0 ]];
+    changeset = [database changesetOfTables:@[ @"people" ]
+                          sinceChangeNumber:0
+                           lastChangeNumber:NULL
+                                      error:NULL];
+    
+    [replica trackChangesToTable:@"people" error:NULL];
+    [replica update:@"people"
+             values:@{ @"lastName": @"Greye" }
+              where:@"id = ?"
+          arguments:@[ @1 ]];
+  });
+  
+  it(@"replaces local changes", ^{
+    expect([replica applyChangeset:changeset
+                    conflictPolicy:FMDBChangesetConflictPolicyReplace
+                             error:&error]).to.equal(2);
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"lastName"]).to.equal(@[ @"Gray", @"Gray" ]);
+    
+    // the applied changes aren't sent back
+    NSData * replicaChangeset = [replica changesetOfTables:@[ @"people" ]
+                                         sinceChangeNumber:0
+                                          lastChangeNumber:NULL
+                                                     error:NULL];
+    expect([database applyChangeset:replicaChangeset
+                     conflictPolicy:FMDBChangesetConflictPolicyReplace
+                              error:&error]).to.equal(0);
+  });
+  
+  it(@"keeps local changes", ^{
+    expect([replica applyChangeset:changeset
+                    conflictPolicy:FMDBChangesetConflictPolicyIgnore
+                             error:&error]).to.equal(1);
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"lastName"]).to.equal(@[ @"Greye", @"Gray" ]);
+  });
+  
+  it(@"aborts on local changes", ^{
+    expect([replica applyChangeset:changeset
+                    conflictPolicy:FMDBChangesetConflictPolicyAbort
+                             error:&error]).to.equal(-1);
+    expect(error.code).to.equal(SQLITE_ABORT);
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"lastName"]).to.equal(@[ @"Greye", @"Grey" ]);
+  });
+  
+  it(@"fails on malformed changesets", ^{
+    NSData * truncatedChangeset = [changeset subdataWithRange:NSMakeRange(0, changeset.length - 4)];
+    
+    expect([replica applyChangeset:truncatedChangeset
+                    conflictPolicy:FMDBChangesetConflictPolicyReplace
+                             error:&error]).to.equal(-1);
+    expect(error.code).to.equal(SQLITE_CORRUPT);
+    expect([[replica selectAllFrom:@"people" orderBy:@"id"] valueForKey:@"lastName"]).to.equal(@[ @"Greye", @"Grey" ]);
+  });
+
+});
+
+SpecEnd
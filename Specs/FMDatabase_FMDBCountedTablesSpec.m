@@ -0,0 +1,171 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBCountedTables.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBCountedTables)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1, @"Amelia", @"Grey" ],
+                          @[ @2, @"Earl",   @"Grey" ],
+                          @[ @3, @"James",  [NSNull null] ] ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== MAINTAINED COUNTS ========================================================================================
+#pragma mark - Maintained Counts
+
+describe(@"- maintainCountsOfTable:groupedByColumns:error:", ^{
+  
+  beforeEach(^{
+    [database maintainCountsOfTable:@"people"
+                   groupedByColumns:@[ @"lastName" ]
+                              error:&error];
+  });
+  
+  it(@"counts existing rows and values", ^{
+    expect(error).to.beNil();
+    expect(database.shouldUseMaintainedCounts).to.beTruthy();
+    expect([database maintainedCountFrom:@"people" matchingValues:nil]).to.equal(@3);
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"lastName": @"Grey" }]).to.equal(@2);
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"lastName": [NSNull null] }]).to.equal(@1);
+  });
+  
+  it(@"keeps counts as rows are inserted, updated, and deleted", ^{
+    [database insertInto:@"people"
+                 columns:@[ @"firstName", @"lastName" ]
+                  values:@[ @[ @"Grace", @"Hopper" ], @[ @"Ada", [NSNull null] ] ]];
+    [database update:@"people"
+              values:@{ @"lastName": @"Hopper" }
+               where:@"id = ?"
+           arguments:@[ @1 ]];
+    [database deleteFrom:@"people"
+                   where:@"id = ?"
+               arguments:@[ @3 ]];
+    
+    expect([database maintainedCountFrom:@"people" matchingValues:nil]).to.equal(@4);
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"lastName": @"Grey" }]).to.equal(@1);
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"lastName": @"Hopper" }]).to.equal(@2);
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"lastName": [NSNull null] }]).to.equal(@1);
+    expect([database maintainedCountFrom:@"people"
+                          matchingValues:@{ @"lastName": @[ @"Grey", @"Hopper" ] }]).to.equal(@3);
+  });
+  
+  it(@"answers count helpers from the counts", ^{
+    // counts that disagree with the table show where the answer came from
+    [database executeUpdate:@"UPDATE fmdb_row_counts SET row_count = 42"];
+    
+    expect([database countFrom:@"people"]).to.equal(42);
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"lastName": @"Grey" }
+                         error:&error]).to.equal(42);
+  });
+  
+  it(@"counts rows that its counts can't answer", ^{
+    expect([database maintainedCountFrom:@"people" matchingValues:@{ @"firstName": @"Earl" }]).to.beNil();
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"firstName": @"Earl" }
+                         error:&error]).to.equal(1);
+  });
+  
+  it(@"counts rows when the column's affinity would convert the values", ^{
+    [database createTableWithName:@"accounts"
+                          columns:@[ @"id INTEGER PRIMARY KEY", @"status INTEGER", @"code TEXT" ]];
+    [database insertInto:@"accounts"
+                 columns:@[ @"status", @"code" ]
+                  values:@[ @[ @1, @"5" ], @[ @"1", @"6" ], @[ @2, @7 ] ]];
+    [database maintainCountsOfTable:@"accounts"
+                   groupedByColumns:@[ @"status", @"code" ]
+                              error:&error];
+    
+    expect([database maintainedCountFrom:@"accounts" matchingValues:@{ @"status": @1 }]).to.equal(@2);
+    expect([database maintainedCountFrom:@"accounts" matchingValues:@{ @"status": @"1" }]).to.beNil();
+    expect([database maintainedCountFrom:@"accounts" matchingValues:@{ @"code": @[ @"5", @7 ] }]).to.beNil();
+    expect([database countFrom:@"accounts"
+                matchingValues:@{ @"status": @"1" }
+                         error:&error]).to.equal(2);
+    expect([database countFrom:@"accounts"
+                matchingValues:@{ @"code": @[ @"5", @7 ] }
+                         error:&error]).to.equal(2);
+  });
+  
+  it(@"counts rows when the column declares a collation", ^{
+    [database createTableWithName:@"accounts"
+                          columns:@[ @"id INTEGER PRIMARY KEY", @"email TEXT COLLATE NOCASE", @"code TEXT" ]];
+    [database insertInto:@"accounts"
+                 columns:@[ @"email", @"code" ]
+                  values:@[ @[ @"ada@example.com", @"a" ], @[ @"ADA@example.com", @"b" ] ]];
+    [database maintainCountsOfTable:@"accounts"
+                   groupedByColumns:@[ @"email", @"code" ]
+                              error:&error];
+    
+    expect([database maintainedCountFrom:@"accounts" matchingValues:@{ @"email": @"ada@example.com" }]).to.beNil();
+    expect([database maintainedCountFrom:@"accounts" matchingValues:@{ @"code": @"a" }]).to.equal(@1);
+    expect([database countFrom:@"accounts"
+                matchingValues:@{ @"email": @"ada@example.com" }
+                         error:&error]).to.equal(2);
+  });
+  
+  it(@"stops counting", ^{
+    [database stopMaintainingCountsOfTable:@"people"
+                                     error:&error];
+    
+    expect(error).to.beNil();
+    expect([database maintainedCountFrom:@"people" matchingValues:nil]).to.beNil();
+    expect([database countFrom:@"people"]).to.equal(3);
+  });
+  
+  it(@"forgets the counts of a dropped table", ^{
+    [database dropTableWithName:@"people"];
+    [database createTableWithName:@"people"
+                          columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+    
+    expect([database maintainedCountFrom:@"people" matchingValues:nil]).to.beNil();
+    expect([database countFrom:@"people"]).to.equal(0);
+  });
+
+});
+
+// ========== APPROXIMATE COUNTS =======================================================================================
+#pragma mark - Approximate Counts
+
+describe(@"- approximateCountFrom:matchingValues:error:", ^{
+  
+  it(@"estimates counts from the table's statistics", ^{
+    [database createIndexWithName:@"lastName_index"
+                        tableName:@"people"
+                          columns:@[ @"lastName" ]];
+    [database executeUpdate:@"ANALYZE"];
+    [database executeUpdate:@"UPDATE sqlite_stat1 SET stat = '1000 10' WHERE idx = 'lastName_index'"];
+    
+    expect([database approximateCountFrom:@"people"
+                           matchingValues:nil
+                                    error:&error]).to.equal(1000);
+    expect([database approximateCountFrom:@"people"
+                           matchingValues:@{ @"lastName": @[ @"Grey", @"Green" ] }
+                                    error:&error]).to.equal(20);
+  });
+  
+  it(@"counts rows when the table hasn't been analyzed", ^{
+    expect([database approximateCountFrom:@"people"
+                           matchingValues:@{ @"lastName": @"Grey" }
+                                    error:&error]).to.equal(2);
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,123 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBDeadlines.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+// a billion rows, which can't be counted before the deadlines below
+static NSString * const FMDBSlowFrom = @"numbers AS a, numbers AS b, numbers AS c";
+
+SpecBegin(FMDatabase_FMDBDeadlines)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"numbers"
+                        columns:@[ @"value" ]];
+  
+  NSMutableArray * values = [[NSMutableArray alloc] init];
+  for (NSUInteger value = 0; value < 1000; value++)
+  {
+    [values addObject:@[ @(value) ]];
+  }
+  [database insertInto:@"numbers"
+               columns:@[ @"value" ]
+                values:values];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== DEADLINES ================================================================================================
+#pragma mark - Deadlines
+
+describe(@"- performWithDeadline:cancellationToken:usingBlock:", ^{
+  
+  it(@"interrupts statements once the deadline passes", ^{
+    __block NSInteger count = 0;
+    NSDate * startDate = [NSDate date];
+    [database performWithTimeout:0.05
+                      usingBlock:^{
+      count = [database count:nil from:FMDBSlowFrom where:nil arguments:nil error:&error];
+    }];
+    
+    expect(count).to.equal(-1);
+    expect(error.code).to.equal(FMDBDeadlineExceededErrorCode);
+    expect([[NSDate date] timeIntervalSinceDate:startDate]).to.beLessThan(1);
+    expect(database.timedOutStatementCount).to.equal(1);
+    expect(database.cancelledStatementCount).to.equal(0);
+  });
+  
+  it(@"interrupts statements when the token is cancelled", ^{
+    FMDBCancellationToken * token = [[FMDBCancellationToken alloc] init];
+    [token cancel];
+    
+    __block NSArray * records = nil;
+    [database performWithDeadline:nil
+                cancellationToken:token
+                       usingBlock:^{
+      records = [database selectAllFrom:FMDBSlowFrom where:nil arguments:nil orderBy:nil error:&error];
+    }];
+    
+    expect(records).to.beNil();
+    expect(error.code).to.equal(SQLITE_INTERRUPT);
+    expect(database.cancelledStatementCount).to.equal(1);
+  });
+  
+  it(@"doesn't interrupt statements after the block", ^{
+    [database performWithTimeout:0.05
+                      usingBlock:^{
+      [database count:nil from:FMDBSlowFrom where:nil arguments:nil error:NULL];
+    }];
+    
+    expect([database count:nil from:@"numbers" where:nil arguments:nil error:&error]).to.equal(1000);
+    expect(error).to.beNil();
+  });
+  
+  it(@"restores the deadlines when the block raises an exception", ^{
+    expect(^{
+      [database performWithTimeout:0.05
+                        usingBlock:^{
+        [NSException raise:NSGenericException format:@"The block failed"];
+      }];
+    }).to.raise(NSGenericException);
+    [NSThread sleepForTimeInterval:0.1];
+    
+    expect([database executeUpdate:@"UPDATE numbers SET value = value + 1"]).to.beTruthy();
+    expect(database.timedOutStatementCount).to.equal(0);
+  });
+
+});
+
+describe(@"- defaultStatementTimeout", ^{
+  
+  it(@"interrupts each slow statement", ^{
+    database.defaultStatementTimeout = 0.05;
+    
+    expect([database count:nil from:FMDBSlowFrom where:nil arguments:nil error:&error]).to.equal(-1);
+    expect(error.code).to.equal(FMDBDeadlineExceededErrorCode);
+    expect([database count:nil from:@"numbers" where:nil arguments:nil error:NULL]).to.equal(1000);
+    expect(database.timedOutStatementCount).to.equal(1);
+    
+    [database resetInterruptedStatementCounts];
+    expect(database.timedOutStatementCount).to.equal(0);
+  });
+  
+  it(@"doesn't interrupt later statements once a statement's timeout has elapsed", ^{
+    database.defaultStatementTimeout = 0.05;
+    [database count:nil from:@"numbers" where:nil arguments:nil error:&error];
+    [NSThread sleepForTimeInterval:0.1];
+    
+    expect([database executeUpdate:@"UPDATE numbers SET value = value + 1"]).to.beTruthy();
+    expect([database count:nil from:@"numbers" where:@"value = 1000" arguments:nil error:&error]).to.equal(1);
+    expect(database.timedOutStatementCount).to.equal(0);
+  });
+
+});
+
+SpecEnd
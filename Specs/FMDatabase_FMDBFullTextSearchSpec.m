@@ -0,0 +1,166 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBFullTextSearch.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBFullTextSearch)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"notes"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"title", @"body" ]];
+  [database insertInto:@"notes"
+               columns:@[ @"id", @"title", @"body" ]
+                values:@[ @[ @1, @"Shopping", @"Milk, bread, and eggs" ],
+                          @[ @2, @"SQLite", @"Full-text search in SQLite is fast, and SQLite is small" ],
+                          @[ @3, @"Databases", @"Postgres, MySQL, and SQLite" ] ]];
+  [database createFullTextIndexWithName:@"notes_text"
+                              tableName:@"notes"
+                                columns:@[ @"title", @"body" ]
+                                  error:&error];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+describe(@"- createFullTextIndexWithName:tableName:columns:error:", ^{
+  
+  it(@"indexes existing rows", ^{
+    expect(error).to.beNil();
+    expect([database countMatchingText:@"sqlite" inFullTextIndex:@"notes_text" error:&error]).to.equal(2);
+    expect([database countMatchingText:@"bread" inFullTextIndex:@"notes_text" error:&error]).to.equal(1);
+  });
+  
+  it(@"keeps the index in sync as rows are inserted, updated, and deleted", ^{
+    [database insertInto:@"notes"
+                 columns:@[ @"title", @"body" ]
+                  values:@[ @[ @"Recipes", @"Bread needs flour" ] ]];
+    [database update:@"notes"
+              values:@{ @"body": @"Milk and eggs" }
+               where:@"id = ?"
+           arguments:@[ @1 ]];
+    [database deleteFrom:@"notes"
+                   where:@"id = ?"
+               arguments:@[ @3 ]];
+    
+    expect([database countMatchingText:@"bread" inFullTextIndex:@"notes_text" error:&error]).to.equal(1);
+    expect([database countMatchingText:@"eggs" inFullTextIndex:@"notes_text" error:&error]).to.equal(1);
+    expect([database countMatchingText:@"postgres" inFullTextIndex:@"notes_text" error:&error]).to.equal(0);
+    expect(error).to.beNil();
+  });
+  
+  it(@"keeps the index in sync as a row's rowid changes", ^{
+    [database update:@"notes"
+              values:@{ @"id": @10 }
+               where:@"id = ?"
+           arguments:@[ @1 ]];
+    NSArray * records = [database selectAllFrom:@"notes"
+                                   matchingText:@"bread"
+                                inFullTextIndex:@"notes_text"
+                                        options:nil
+                                          error:&error];
+    
+    expect(error).to.beNil();
+    expect([records valueForKey:@"id"]).to.equal(@[ @10 ]);
+  });
+
+});
+
+describe(@"- rebuildFullTextIndexWithName:error:", ^{
+  
+  it(@"rebuilds and optimizes the index", ^{
+    expect([database rebuildFullTextIndexWithName:@"notes_text" error:&error]).to.beTruthy();
+    expect([database optimizeFullTextIndexWithName:@"notes_text" error:&error]).to.beTruthy();
+    expect([database countMatchingText:@"sqlite" inFullTextIndex:@"notes_text" error:&error]).to.equal(2);
+  });
+
+});
+
+describe(@"- dropFullTextIndexWithName:error:", ^{
+  
+  it(@"drops the index and its triggers", ^{
+    expect([database dropFullTextIndexWithName:@"notes_text" error:&error]).to.beTruthy();
+    expect([database tableNames]).notTo.contain(@"notes_text");
+    
+    [database insertInto:@"notes"
+                 columns:@[ @"title", @"body" ]
+                  values:@[ @[ @"Recipes", @"Bread needs flour" ] ]];
+    expect([database countFrom:@"notes"]).to.equal(4);
+  });
+
+});
+
+// ========== SEARCH ===================================================================================================
+#pragma mark - Search
+
+describe(@"- selectAllFrom:matchingText:inFullTextIndex:options:error:", ^{
+  
+  it(@"selects matching rows, best first", ^{
+    NSArray * records = [database selectAllFrom:@"notes"
+                                   matchingText:@"sqlite"
+                                inFullTextIndex:@"notes_text"
+                                        options:nil
+                                          error:&error];
+    
+    expect(error).to.beNil();
+    expect([records valueForKey:@"id"]).to.equal(@[ @2, @3 ]);
+    expect(records[0][@"title"]).to.equal(@"SQLite");
+    expect([records[0][FMDBFullTextRankKey] doubleValue]).to.beLessThan([records[1][FMDBFullTextRankKey] doubleValue]);
+  });
+  
+  it(@"limits matches", ^{
+    FMDBFullTextSearchOptions * options = [[FMDBFullTextSearchOptions alloc] init];
+    options.limit = @1;
+    options.offset = @1;
+    NSArray * records = [database selectAllFrom:@"notes"
+                                   matchingText:@"sqlite"
+                                inFullTextIndex:@"notes_text"
+                                        options:options
+                                          error:&error];
+    
+    expect([records valueForKey:@"id"]).to.equal(@[ @3 ]);
+  });
+  
+  it(@"adds snippets and highlighted text", ^{
+    FMDBFullTextSearchOptions * options = [[FMDBFullTextSearchOptions alloc] init];
+    options.snippetColumn = @"body";
+    options.highlightColumn = @"body";
+    options.markStart = @"[";
+    options.markEnd = @"]";
+    NSArray * records = [database selectAllFrom:@"notes"
+                                   matchingText:@"postgres"
+                                inFullTextIndex:@"notes_text"
+                                        options:options
+                                          error:&error];
+    
+    expect(error).to.beNil();
+    expect(records.count).to.equal(1);
+    expect(records[0][FMDBFullTextSnippetKey]).to.contain(@"[Postgres]");
+    expect(records[0][FMDBFullTextHighlightKey]).to.equal(@"[Postgres], MySQL, and SQLite");
+    expect(records[0][@"fmdb_offsets"]).to.beNil();
+  });
+  
+  it(@"fails for a missing index", ^{
+    NSArray * records = [database selectAllFrom:@"notes"
+                                   matchingText:@"sqlite"
+                                inFullTextIndex:@"nonexistent"
+                                        options:nil
+                                          error:&error];
+    
+    expect(records).to.beNil();
+    expect(error).notTo.beNil();
+  });
+
+});
+
+SpecEnd
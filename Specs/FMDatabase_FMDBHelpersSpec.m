@@ -495,4 +495,47 @@ describe(@"- selectResultsFrom:matchingValues:orderBy:error", ^{
   
 });
 
+describe(@"- enumerateAllFrom:where:arguments:orderBy:usingBlock:error:", ^{
+  
+  beforeEach(^{
+    [database createTableWithName:@"people"
+                          columns:@[ @"firstName", @"lastName" ]];
+    
+    [database insertInto:@"people"
+                 columns:@[ @"firstName", @"lastName" ]
+                  values:@[ @[ @"Amelia", @"Grey" ],
+                            @[ @"Earl",   @"Grey" ],
+                            @[ @"James",  @"Green" ] ]];
+  });
+  
+  it(@"passes each matching row to the block", ^{
+    NSMutableArray * records = [[NSMutableArray alloc] init];
+    BOOL result = [database enumerateAllFrom:@"people"
+                                       where:@"lastName = ?"
+                                   arguments:@[ @"Grey" ]
+                                     orderBy:@"firstName"
+                                  usingBlock:^(NSDictionary * record, BOOL * stop) {
+                                    [records addObject:record];
+                                  }
+                                       error:&error];
+    
+    expect(result).to.beTruthy();
+    expect(records).to.equal(@[ @{ @"firstName": @"Amelia", @"lastName": @"Grey" },
+                                @{ @"firstName": @"Earl",   @"lastName": @"Grey" } ]);
+  });
+  
+  it(@"provides an error if the rows cannot be selected", ^{
+    BOOL result = [database enumerateAllFrom:@"people"
+                                       where:@"age = ?" // age is an unknown column
+                                   arguments:@[ @21 ]
+                                     orderBy:nil
+                                  usingBlock:^(NSDictionary * record, BOOL * stop) {}
+                                       error:&error];
+    
+    expect(result).to.beFalsy();
+    expect(error).notTo.beNil();
+  });
+  
+});
+
 SpecEnd
@@ -0,0 +1,235 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import <unistd.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBImportExport.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+/**
+ *  Returns the read end of a pipe that yields the given string.
+ */
+static int FMDBSpecFileDescriptorReadingString(NSString * string)
+{
+  int fileDescriptors[2];
+  pipe(fileDescriptors);
+  NSData * data = [string dataUsingEncoding:NSUTF8StringEncoding];
+  write(fileDescriptors[1], data.bytes, data.length);
+  close(fileDescriptors[1]);
+  return fileDescriptors[0];
+}
+
+/**
+ *  Returns what is written to the file descriptor passed to the block.
+ */
+static NSString * FMDBSpecStringWrittenByBlock(void (^block)(int fileDescriptor))
+{
+  int fileDescriptors[2];
+  pipe(fileDescriptors);
+  block(fileDescriptors[1]);
+  close(fileDescriptors[1]);
+  
+  NSMutableData * data = [[NSMutableData alloc] init];
+  char buffer[1024];
+  ssize_t length;
+  while ((length = read(fileDescriptors[0], buffer, sizeof(buffer))) > 0)
+  {
+    [data appendBytes:buffer length:(NSUInteger)length];
+  }
+  close(fileDescriptors[0]);
+  return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+SpecBegin(FMDatabase_FMDBImportExport)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName TEXT", @"lastName TEXT", @"zip TEXT" ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== IMPORT ===================================================================================================
+#pragma mark - Import
+
+describe(@"- importInto:fromFileDescriptor:format:commitInterval:error:", ^{
+  
+  it(@"imports CSV", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"id,firstName,lastName,zip\r\n"
+                                                             @"1,\"Grey, Amelia\",\"Says \"\"hi\"\"\",02139\r\n"
+                                                             @"2,,\"\",\n"
+                                                             @"\n"
+                                                             @"3,\"Earl\nGrey\",Grey,\"\"");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatCSV
+                               commitInterval:2
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(error).to.beNil();
+    expect(rowCount).to.equal(3);
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error]).to.equal(@[
+      @{ @"id": @1, @"firstName": @"Grey, Amelia", @"lastName": @"Says \"hi\"", @"zip": @"02139" },
+      @{ @"id": @2, @"firstName": [NSNull null], @"lastName": @"", @"zip": [NSNull null] },
+      @{ @"id": @3, @"firstName": @"Earl\nGrey", @"lastName": @"Grey", @"zip": @"" },
+    ]);
+  });
+  
+  it(@"imports empty lines of a single column as NULL", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"firstName\nAmelia\n\nEarl\n");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatCSV
+                               commitInterval:0
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(error).to.beNil();
+    expect(rowCount).to.equal(3);
+    expect([[database selectAllFrom:@"people" orderBy:@"id" error:&error] valueForKey:@"firstName"]).to.equal(@[
+      @"Amelia", [NSNull null], @"Earl"
+    ]);
+  });
+  
+  it(@"rolls back a CSV file with a malformed record", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"id,firstName\n1,Amelia\n2,Earl,Grey\n");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatCSV
+                               commitInterval:0
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(rowCount).to.equal(-1);
+    expect(error.code).to.equal(SQLITE_MISMATCH);
+    expect([database countFrom:@"people"]).to.equal(0);
+    expect(database.inTransaction).to.beFalsy();
+  });
+  
+  it(@"imports NDJSON", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"{\"id\":1,\"firstName\":\"Amelia\",\"zip\":\"02139\"}\n"
+                                                             @"{\"id\":2,\"firstName\":\"Earl\"}\r\n"
+                                                             @"{\"id\":3,\"firstName\":null,\"zip\":[1, 2]}");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatNDJSON
+                               commitInterval:0
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(error).to.beNil();
+    expect(rowCount).to.equal(3);
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error]).to.equal(@[
+      @{ @"id": @1, @"firstName": @"Amelia", @"lastName": [NSNull null], @"zip": @"02139" },
+      @{ @"id": @2, @"firstName": @"Earl", @"lastName": [NSNull null], @"zip": [NSNull null] },
+      @{ @"id": @3, @"firstName": [NSNull null], @"lastName": [NSNull null], @"zip": @"[1,2]" },
+    ]);
+  });
+  
+  it(@"fails on a line with a key that the first line doesn't have", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"{\"id\":1,\"firstName\":\"Amelia\"}\n"
+                                                             @"{\"id\":2,\"firstName\":\"Earl\",\"zip\":\"02139\"}\n");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatNDJSON
+                               commitInterval:0
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(rowCount).to.equal(-1);
+    expect(error.localizedDescription).to.contain(@"Line 2");
+    expect(error.localizedDescription).to.contain(@"zip");
+    expect([database countFrom:@"people"]).to.equal(0);
+  });
+  
+  it(@"fails on a line that isn't a JSON object", ^{
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(@"{\"id\": 1}\n[2]\n");
+    NSInteger rowCount = [database importInto:@"people"
+                           fromFileDescriptor:fileDescriptor
+                                       format:FMDBDataFormatNDJSON
+                               commitInterval:0
+                                        error:&error];
+    close(fileDescriptor);
+    
+    expect(rowCount).to.equal(-1);
+    expect(error.localizedDescription).to.contain(@"Line 2");
+    expect([database countFrom:@"people"]).to.equal(0);
+  });
+
+});
+
+// ========== EXPORT ===================================================================================================
+#pragma mark - Export
+
+describe(@"- exportFrom:orderBy:toFileDescriptor:format:error:", ^{
+  
+  beforeEach(^{
+    [database insertInto:@"people"
+                 columns:@[ @"id", @"firstName", @"lastName", @"zip" ]
+                  values:@[ @[ @1, @"Grey, Amelia", @"Says \"hi\"", @"02139" ],
+                            @[ @2, [NSNull null], @"", @2.5 ] ]];
+  });
+  
+  it(@"writes CSV", ^{
+    NSString * csv = FMDBSpecStringWrittenByBlock(^(int fileDescriptor) {
+      expect([database exportFrom:@"people"
+                          orderBy:@"id"
+                 toFileDescriptor:fileDescriptor
+                           format:FMDBDataFormatCSV
+                            error:&error]).to.equal(2);
+    });
+    
+    expect(csv).to.equal(@"id,firstName,lastName,zip\r\n"
+                         @"1,\"Grey, Amelia\",\"Says \"\"hi\"\"\",02139\r\n"
+                         @"2,,\"\",2.5\r\n");
+  });
+  
+  it(@"writes NDJSON", ^{
+    NSString * json = FMDBSpecStringWrittenByBlock(^(int fileDescriptor) {
+      expect([database exportFrom:@"people"
+                          orderBy:@"id"
+                 toFileDescriptor:fileDescriptor
+                           format:FMDBDataFormatNDJSON
+                            error:&error]).to.equal(2);
+    });
+    
+    expect(json).to.equal(@"{\"id\":1,\"firstName\":\"Grey, Amelia\","
+                          @"\"lastName\":\"Says \\\"hi\\\"\",\"zip\":\"02139\"}\n"
+                          @"{\"id\":2,\"firstName\":null,\"lastName\":\"\",\"zip\":\"2.5\"}\n");
+  });
+  
+  it(@"round-trips through CSV", ^{
+    NSString * csv = FMDBSpecStringWrittenByBlock(^(int fileDescriptor) {
+      [database exportFrom:@"people"
+                   orderBy:@"id"
+          toFileDescriptor:fileDescriptor
+                    format:FMDBDataFormatCSV
+                     error:&error];
+    });
+    NSArray * rows = [database selectAllFrom:@"people" orderBy:@"id" error:&error];
+    [database deleteFrom:@"people"
+                   where:nil
+               arguments:nil];
+    
+    int fileDescriptor = FMDBSpecFileDescriptorReadingString(csv);
+    [database importInto:@"people"
+      fromFileDescriptor:fileDescriptor
+                  format:FMDBDataFormatCSV
+          commitInterval:0
+                   error:&error];
+    close(fileDescriptor);
+    
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error]).to.equal(rows);
+  });
+
+});
+
+SpecEnd
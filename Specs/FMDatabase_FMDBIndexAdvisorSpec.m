@@ -0,0 +1,159 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBIndexAdvisor.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBIndexAdvisor)
+
+__block FMDatabase * database;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"firstName", @"lastName", @"age" ]];
+  [database insertInto:@"people"
+               columns:@[ @"firstName", @"lastName", @"age" ]
+                values:@[ @[ @"Amelia", @"Grey",  @30 ],
+                          @[ @"Earl",   @"Grey",  @60 ],
+                          @[ @"James",  @"Green", @45 ] ]];
+  
+  database.shouldAdviseIndexes = YES;
+});
+
+afterEach(^{
+  database = nil;
+});
+
+// ========== INDEX ADVICE =============================================================================================
+#pragma mark - Index Advice
+
+describe(@"- shouldAdviseIndexes", ^{
+  
+  it(@"defaults to NO", ^{
+    FMDatabase * otherDatabase = [FMDatabase openInMemoryDatabase];
+    
+    expect(otherDatabase.shouldAdviseIndexes).to.beFalsy();
+    expect(otherDatabase.indexAdvice).to.equal(@[]);
+  });
+  
+  it(@"advises an index on columns matched by a full scan", ^{
+    NSArray * greys = [database selectResultsFrom:@"people"
+                                   matchingValues:@{ @"lastName": @"Grey" }
+                                          orderBy:@"firstName DESC"
+                                            error:NULL].allRecords;
+    
+    FMDBIndexAdvice * advice = database.indexAdvice.firstObject;
+    expect(greys.count).to.equal(2);
+    expect(database.indexAdvice.count).to.equal(1);
+    expect(advice.tableName).to.equal(@"people");
+    expect(advice.columnNames).to.equal((@[ @"lastName", @"firstName" ]));
+    expect(advice.causesFullScan).to.beTruthy();
+    expect(advice.causesTemporarySort).to.beTruthy();
+  });
+  
+  it(@"puts columns matched to a single value first", ^{
+    [database countFrom:@"people"
+         matchingValues:@{ @"age": @[ @30, @45 ], @"lastName": @"Grey" }
+                  error:NULL];
+    
+    FMDBIndexAdvice * advice = database.indexAdvice.firstObject;
+    expect(advice.columnNames).to.equal((@[ @"lastName", @"age" ]));
+  });
+  
+  it(@"counts each execution of the same statement", ^{
+    for (NSString * lastName in @[ @"Grey", @"Green", @"Gray" ])
+    {
+      [database deleteFrom:@"people"
+            matchingValues:@{ @"lastName": lastName }
+                     error:NULL];
+    }
+    
+    FMDBIndexAdvice * advice = database.indexAdvice.firstObject;
+    expect(advice.executionCount).to.equal(3);
+    expect(advice.statements.count).to.equal(1);
+  });
+  
+  it(@"gives no advice when an index is used", ^{
+    [database createIndexWithName:@"people_lastName"
+                        tableName:@"people"
+                          columns:@[ @"lastName" ]];
+    
+    [database update:@"people"
+              values:@{ @"age": @31 }
+      matchingValues:@{ @"lastName": @"Grey" }
+               error:NULL];
+    
+    expect(database.indexAdvice).to.equal(@[]);
+  });
+  
+  it(@"gives no advice when an existing index serves a scan", ^{
+    [database createIndexWithName:@"people_name"
+                        tableName:@"people"
+                          columns:@[ @"lastName", @"firstName", @"age" ]];
+    
+    NSArray * people = [database selectResultsFrom:@"people"
+                                    matchingValues:@{}
+                                           orderBy:@"lastName"
+                                             error:NULL].allRecords;
+    
+    expect(people.count).to.equal(3);
+    expect(database.indexAdvice).to.equal(@[]);
+  });
+  
+  it(@"advises an index when a scanned index only serves the order", ^{
+    [database createIndexWithName:@"people_last_name"
+                        tableName:@"people"
+                          columns:@[ @"lastName" ]];
+    
+    [database selectResultsFrom:@"people"
+                 matchingValues:@{ @"firstName": @"Amelia" }
+                        orderBy:@"lastName"
+                          error:NULL].allRecords;
+    
+    FMDBIndexAdvice * advice = database.indexAdvice.firstObject;
+    expect(advice.columnNames).to.equal(@[ @"firstName", @"lastName" ]);
+    expect(advice.causesFullScan).to.beTruthy();
+  });
+
+});
+
+describe(@"- indexAdviceHandler", ^{
+  
+  it(@"is called when a statement first produces advice", ^{
+    __block NSUInteger callCount = 0;
+    database.indexAdviceHandler = ^(FMDBIndexAdvice * advice, NSString * statement) {
+      callCount++;
+    };
+    
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Grey" } error:NULL];
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Green" } error:NULL];
+    
+    expect(callCount).to.equal(1);
+  });
+
+});
+
+describe(@"- applyIndexAdvice:error:", ^{
+  
+  it(@"creates the advised indexes", ^{
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Grey" } error:NULL];
+    
+    NSArray * advice = database.indexAdvice;
+    NSError * error = nil;
+    BOOL applied = [database applyIndexAdvice:advice
+                                        error:&error];
+    
+    expect(applied).to.beTruthy();
+    expect(error).to.beNil();
+    expect([database indexNamesOnTable:@"people"]).to.contain([advice.firstObject indexName]);
+    
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Grey" } error:NULL];
+    expect(database.indexAdvice).to.equal(@[]);
+  });
+
+});
+
+SpecEnd
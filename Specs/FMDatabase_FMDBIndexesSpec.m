@@ -0,0 +1,167 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBIndexes.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBIndexes)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"email UNIQUE", @"lastName", @"firstName", @"status" ]];
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== FMDBIndexDescription =====================================================================================
+#pragma mark - FMDBIndexDescription
+
+describe(@"FMDBIndexDescription", ^{
+  
+  __block FMDBIndexDescription * index;
+  beforeEach(^{
+    index = [[FMDBIndexDescription alloc] initWithName:@"people_name"
+                                             tableName:@"people"
+                                                  keys:@[ @"lastName",
+                                                          [FMDBIndexKey keyWithColumn:@"firstName"
+                                                                            collation:@"NOCASE"
+                                                                           descending:YES] ]];
+  });
+  
+  it(@"builds CREATE INDEX", ^{
+    index.includedColumnNames = @[ @"email" ];
+    index.where = @"status = 'active'";
+    
+    expect([index sql]).to.equal(@"CREATE INDEX \"people_name\" ON \"people\" "
+                                 @"(\"lastName\", \"firstName\" COLLATE \"NOCASE\" DESC, \"email\") "
+                                 @"WHERE status = 'active'");
+  });
+  
+  it(@"serves indexes on its leading keys", ^{
+    FMDBIndexDescription * leadingIndex = [[FMDBIndexDescription alloc] initWithName:@"people_last_name"
+                                                                           tableName:@"people"
+                                                                                keys:@[ @"LASTNAME" ]];
+    FMDBIndexDescription * otherIndex = [[FMDBIndexDescription alloc] initWithName:@"people_first_name"
+                                                                         tableName:@"people"
+                                                                              keys:@[ @"firstName" ]];
+    
+    expect([index servesIndex:leadingIndex]).to.beTruthy();
+    expect([index servesIndex:otherIndex]).to.beFalsy();
+    expect([leadingIndex servesIndex:index]).to.beFalsy();
+    
+    leadingIndex.unique = YES;
+    expect([index servesIndex:leadingIndex]).to.beFalsy();
+  });
+  
+  it(@"serves partial indexes with the same WHERE clause", ^{
+    FMDBIndexDescription * partialIndex = [index copy];
+    partialIndex.where = @"status = 'active'";
+    
+    expect([index servesIndex:partialIndex]).to.beTruthy();
+    expect([partialIndex servesIndex:index]).to.beFalsy();
+    
+    index.where = @"status  =\n  'active'";
+    expect([index servesIndex:partialIndex]).to.beTruthy();
+  });
+
+});
+
+// ========== INDEXES ==================================================================================================
+#pragma mark - Indexes
+
+describe(@"- indexesOnTable:", ^{
+  
+  it(@"describes indexes and their keys", ^{
+    FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:@"people_name"
+                                                                    tableName:@"people"
+                                                                         keys:@[ @"lastName" ]];
+    index.includedColumnNames = @[ @"firstName" ];
+    [database createIndex:index error:&error];
+    
+    NSArray * indexes = [database indexesOnTable:@"people"];
+    NSSortDescriptor * byName = [NSSortDescriptor sortDescriptorWithKey:@"indexName" ascending:YES];
+    NSArray * sortedIndexes = [indexes sortedArrayUsingDescriptors:@[ byName ]];
+    
+    expect(error).to.beNil();
+    expect([sortedIndexes valueForKey:@"indexName"]).to.equal(@[ @"people_name", @"sqlite_autoindex_people_1" ]);
+    expect([sortedIndexes[0] keys]).to.equal(@[ [FMDBIndexKey keyWithColumn:@"lastName"],
+                                                [FMDBIndexKey keyWithColumn:@"firstName"] ]);
+    expect([sortedIndexes[0] isUnique]).to.beFalsy();
+    expect([sortedIndexes[1] keys]).to.equal(@[ [FMDBIndexKey keyWithColumn:@"email"] ]);
+    expect([sortedIndexes[1] isUnique]).to.beTruthy();
+  });
+  
+  it(@"reads collations, sort orders, and WHERE clauses from an index's SQL", ^{
+    [database executeUpdate:@"CREATE INDEX people_status ON people ([lastName] collate nocase desc, \"first\"\"Name\")"
+                      error:&error];
+    
+    NSPredicate * predicate = [NSPredicate predicateWithFormat:@"indexName == 'people_status'"];
+    NSArray * indexes = [[database indexesOnTable:@"people"] filteredArrayUsingPredicate:predicate];
+    FMDBIndexDescription * index = indexes.firstObject;
+    
+    expect(indexes.count).to.equal(1);
+    expect([index.keys[0] columnName]).to.equal(@"lastName");
+    expect([index.keys[0] collation]).to.equal(@"nocase");
+    expect([index.keys[0] descending]).to.beTruthy();
+    expect([index.keys[1] columnName]).to.equal(@"first\"Name");
+    expect(index.where).to.beNil();
+  });
+
+});
+
+describe(@"- createIndex:error:", ^{
+  
+  it(@"creates partial indexes on expressions where sqlite supports them", ^{
+    FMDBIndexKey * key = [FMDBIndexKey keyWithExpression:@"lower(email)"];
+    FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:@"people_active_email"
+                                                                    tableName:@"people"
+                                                                         keys:@[ key ]];
+    index.where = @"status = 'active'";
+    BOOL created = [database createIndex:index error:&error];
+    
+    if (sqlite3_libversion_number() >= 3009000)
+    {
+      expect(created).to.beTruthy();
+      
+      FMDBIndexDescription * existingIndex = [database existingIndexServing:index];
+      expect([existingIndex.keys.firstObject expression]).to.equal(@"lower(email)");
+      expect(existingIndex.where).to.equal(@"status = 'active'");
+    }
+    else
+    {
+      expect(created).to.beFalsy();
+      expect(error).notTo.beNil();
+    }
+  });
+
+});
+
+describe(@"- createIndexIfNeeded:created:error:", ^{
+  
+  it(@"doesn't create indexes that are already served", ^{
+    FMDBIndexDescription * index = [[FMDBIndexDescription alloc] initWithName:@"people_name"
+                                                                    tableName:@"people"
+                                                                         keys:@[ @"lastName", @"firstName" ]];
+    FMDBIndexDescription * leadingIndex = [[FMDBIndexDescription alloc] initWithName:@"people_last_name"
+                                                                           tableName:@"people"
+                                                                                keys:@[ @"lastName" ]];
+    BOOL created = NO;
+    
+    expect([database createIndexIfNeeded:index created:&created error:&error]).to.beTruthy();
+    expect(created).to.beTruthy();
+    expect([database createIndexIfNeeded:leadingIndex created:&created error:&error]).to.beTruthy();
+    expect(created).to.beFalsy();
+    expect([database indexNamesOnTable:@"people"]).to.equal([NSSet setWithObject:@"people_name"]);
+  });
+
+});
+
+SpecEnd
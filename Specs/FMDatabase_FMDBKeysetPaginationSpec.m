@@ -0,0 +1,131 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBKeysetPagination.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBKeysetPagination)
+
+__block FMDatabase * database;
+__block NSArray * sortDescriptors;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1, @"Amelia", @"Grey" ],
+                          @[ @2, @"Earl",   @"Grey" ],
+                          @[ @3, @"James",  @"Green" ],
+                          @[ @4, @"Ada",    @"Black" ],
+                          @[ @5, @"Rose",   @"Grey" ] ]];
+  
+  sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"lastName" ascending:YES],
+                       [NSSortDescriptor sortDescriptorWithKey:@"id" ascending:NO] ];
+});
+
+afterEach(^{
+  database = nil;
+  sortDescriptors = nil;
+});
+
+// ========== PAGINATION ===============================================================================================
+#pragma mark - Pagination
+
+describe(@"- selectNextPageWithCursor:error:", ^{
+  
+  it(@"reads pages in order", ^{
+    FMDBPageCursor * cursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                           columns:@[ @"id", @"lastName" ]
+                                                    matchingValues:nil
+                                                   sortDescriptors:sortDescriptors
+                                                          pageSize:2];
+    
+    NSArray * firstPage = [database selectNextPageWithCursor:cursor error:NULL];
+    expect([firstPage valueForKey:@"id"]).to.equal(@[ @4, @3 ]);
+    expect(cursor.lastKey).to.equal(@[ @"Green", @3 ]);
+    expect(cursor.hasMorePages).to.beTruthy();
+    
+    NSArray * secondPage = [database selectNextPageWithCursor:cursor error:NULL];
+    expect([secondPage valueForKey:@"id"]).to.equal(@[ @5, @2 ]);
+    
+    NSArray * thirdPage = [database selectNextPageWithCursor:cursor error:NULL];
+    expect([thirdPage valueForKey:@"id"]).to.equal(@[ @1 ]);
+    expect(cursor.hasMorePages).to.beFalsy();
+    
+    expect([database selectNextPageWithCursor:cursor error:NULL]).to.equal(@[]);
+  });
+  
+  it(@"only reads rows matching the cursor's values", ^{
+    FMDBPageCursor * cursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                           columns:nil
+                                                    matchingValues:@{ @"lastName": @"Grey" }
+                                                   sortDescriptors:sortDescriptors
+                                                          pageSize:2];
+    
+    [database selectNextPageWithCursor:cursor error:NULL];
+    NSArray * secondPage = [database selectNextPageWithCursor:cursor error:NULL];
+    
+    expect([secondPage valueForKey:@"firstName"]).to.equal(@[ @"Amelia" ]);
+  });
+
+});
+
+describe(@"- token", ^{
+  
+  it(@"resumes a cursor for the same query", ^{
+    FMDBPageCursor * cursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                           columns:nil
+                                                    matchingValues:nil
+                                                   sortDescriptors:sortDescriptors
+                                                          pageSize:2];
+    [database selectNextPageWithCursor:cursor error:NULL];
+    
+    FMDBPageCursor * resumedCursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                                  columns:nil
+                                                           matchingValues:nil
+                                                          sortDescriptors:sortDescriptors
+                                                                 pageSize:2];
+    expect([resumedCursor resumeFromToken:cursor.token]).to.beTruthy();
+    expect(resumedCursor.lastKey).to.equal(cursor.lastKey);
+    
+    NSArray * secondPage = [database selectNextPageWithCursor:resumedCursor error:NULL];
+    expect([secondPage valueForKey:@"id"]).to.equal(@[ @5, @2 ]);
+  });
+  
+  it(@"is rejected by a cursor with different sort columns", ^{
+    FMDBPageCursor * cursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                           columns:nil
+                                                    matchingValues:nil
+                                                   sortDescriptors:sortDescriptors
+                                                          pageSize:2];
+    NSArray * otherSortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"id" ascending:YES] ];
+    FMDBPageCursor * otherCursor = [[FMDBPageCursor alloc] initWithFrom:@"people"
+                                                                columns:nil
+                                                         matchingValues:nil
+                                                        sortDescriptors:otherSortDescriptors
+                                                               pageSize:2];
+    
+    expect([otherCursor resumeFromToken:cursor.token]).to.beFalsy();
+    expect([otherCursor resumeFromToken:@"not a token"]).to.beFalsy();
+  });
+
+});
+
+describe(@"+ conditionToSeekPastKey:sortDescriptors:arguments:", ^{
+  
+  it(@"bounds the first column and compares the rest in order", ^{
+    NSArray * arguments = nil;
+    NSString * condition = [FMDatabase conditionToSeekPastKey:@[ @"Grey", @2 ]
+                                              sortDescriptors:sortDescriptors
+                                                    arguments:&arguments];
+    
+    expect(condition).to.equal(@"\"lastName\" >= ? AND ( \"lastName\" > ? OR ( \"lastName\" = ? AND \"id\" < ? ))");
+    expect(arguments).to.equal(@[ @"Grey", @"Grey", @"Grey", @2 ]);
+  });
+
+});
+
+SpecEnd
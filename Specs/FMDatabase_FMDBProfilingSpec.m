@@ -0,0 +1,157 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBProfiling.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBProfiling)
+
+__block FMDatabase * database;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"firstName", @"lastName" ]
+                values:@[ @[ @"Amelia", @"Grey" ],
+                          @[ @"Earl",   @"Grey" ],
+                          @[ @"James",  @"Green" ] ]];
+  
+  database.shouldProfileStatements = YES;
+});
+
+afterEach(^{
+  database = nil;
+});
+
+// ========== PROFILING ================================================================================================
+#pragma mark - Profiling
+
+describe(@"- shouldProfileStatements", ^{
+  
+  it(@"defaults to NO", ^{
+    FMDatabase * otherDatabase = [FMDatabase openInMemoryDatabase];
+    [otherDatabase countFrom:@"sqlite_master"];
+    
+    expect(otherDatabase.shouldProfileStatements).to.beFalsy();
+    expect(otherDatabase.statementProfiles).to.equal(@[]);
+  });
+  
+  it(@"records rows read from selects", ^{
+    NSArray * records = [database selectAllFrom:@"people"
+                                        orderBy:@"firstName"
+                                          error:NULL];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(records.count).to.equal(3);
+    expect(database.statementProfiles.count).to.equal(1);
+    expect(profile.executionCount).to.equal(1);
+    expect(profile.rowCount).to.equal(3);
+    expect(profile.sortCount).to.beGreaterThan(0);
+    expect(profile.fullScanStepCount).to.beGreaterThan(0);
+  });
+  
+  it(@"records counts", ^{
+    NSInteger count = [database countFrom:@"people"
+                           matchingValues:@{ @"lastName": @"Grey" }
+                                    error:NULL];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(count).to.equal(2);
+    expect(profile.executionCount).to.equal(1);
+    expect(profile.rowCount).to.equal(1);
+  });
+  
+  it(@"records rows changed by updates", ^{
+    NSInteger changes = [database update:@"people"
+                                  values:@{ @"lastName": @"Gray" }
+                          matchingValues:@{ @"lastName": @"Grey" }
+                                   error:NULL];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(changes).to.equal(2);
+    expect(profile.rowCount).to.equal(2);
+    expect([database countFrom:@"people" matchingValues:@{ @"lastName": @"Gray" } error:NULL]).to.equal(2);
+  });
+  
+  it(@"doesn't count rows changed by triggers", ^{
+    [database createTableWithName:@"changes"
+                          columns:@[ @"firstName" ]];
+    [database executeUpdate:@"CREATE TRIGGER people_changes AFTER UPDATE ON people "
+                            @"BEGIN INSERT INTO changes (firstName) VALUES (NEW.firstName); END"];
+    [database resetStatementProfiles];
+    
+    [database update:@"people"
+              values:@{ @"lastName": @"Gray" }
+      matchingValues:@{ @"lastName": @"Grey" }
+               error:NULL];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(profile.rowCount).to.equal(2);
+    expect([database countFrom:@"changes"]).to.equal(2);
+  });
+  
+  it(@"still reports errors", ^{
+    NSError * error = nil;
+    NSNumber * rowId = [database insertInto:@"missing"
+                                        row:@{ @"firstName": @"Amelia" }
+                                      error:&error];
+    
+    expect(rowId).to.beNil();
+    expect(error).notTo.beNil();
+  });
+  
+  it(@"reports update errors as unprofiled updates do", ^{
+    [database executeUpdate:@"CREATE UNIQUE INDEX people_name ON people (firstName, lastName)"];
+    NSError * profiledError = nil;
+    NSError * error = nil;
+    
+    [database insertInto:@"people" row:@{ @"firstName": @"Amelia", @"lastName": @"Grey" } error:&profiledError];
+    database.shouldProfileStatements = NO;
+    [database insertInto:@"people" row:@{ @"firstName": @"Amelia", @"lastName": @"Grey" } error:&error];
+    
+    expect(profiledError.code).to.equal(SQLITE_CONSTRAINT);
+    expect(profiledError.code).to.equal(error.code);
+    expect(profiledError.localizedDescription).to.equal(error.localizedDescription);
+  });
+  
+  it(@"aggregates executions of the same statement", ^{
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Grey" } error:NULL];
+    [database countFrom:@"people" matchingValues:@{ @"lastName": @"Green" } error:NULL];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(database.statementProfiles.count).to.equal(1);
+    expect(profile.executionCount).to.equal(2);
+    expect([[profile.latencyHistogram valueForKeyPath:@"@sum.self"] integerValue]).to.equal(2);
+    expect([profile latencyAtPercentile:99]).to.beLessThanOrEqualTo(profile.maximumTime);
+    expect([database profileForStatement:profile.statement].executionCount).to.equal(2);
+  });
+
+});
+
+describe(@"- resetStatementProfiles", ^{
+  
+  it(@"discards all profiles", ^{
+    [database countFrom:@"people"];
+    [database resetStatementProfiles];
+    
+    expect(database.statementProfiles).to.equal(@[]);
+  });
+
+});
+
+describe(@"- statementProfileReport", ^{
+  
+  it(@"lists each statement", ^{
+    [database countFrom:@"people"];
+    
+    FMDBStatementProfile * profile = database.statementProfiles.firstObject;
+    expect(database.statementProfileReport).to.contain(profile.statement);
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,186 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBBatchUpdate.h"
+#import "FMDatabase+FMDBResultCache.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBResultCache)
+
+__block FMDatabase * database;
+__block NSError * error;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database createTableWithName:@"pets"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"name", @"ownerId" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1, @"Amelia", @"Grey" ],
+                          @[ @2, @"Earl",   @"Grey" ] ]];
+  [database insertInto:@"pets"
+               columns:@[ @"id", @"name", @"ownerId" ]
+                values:@[ @[ @1, @"Rex", @1 ] ]];
+  database.shouldCacheResults = YES;
+});
+
+afterEach(^{
+  database = nil;
+  error = nil;
+});
+
+// ========== RESULT CACHE =============================================================================================
+#pragma mark - Result Cache
+
+describe(@"- shouldCacheResults", ^{
+  
+  it(@"answers repeated reads from the cache", ^{
+    NSArray * records = [database selectAllFrom:@"people" orderBy:@"id" error:&error];
+    
+    expect([database selectAllFrom:@"people" orderBy:@"id" error:&error]).to.beIdenticalTo(records);
+    expect([database countFrom:@"people" error:&error]).to.equal(2);
+    expect([database countFrom:@"people" error:&error]).to.equal(2);
+    expect(error).to.beNil();
+    expect(database.resultCacheCount).to.equal(2);
+    expect(database.resultCacheHits).to.equal(2);
+    expect(database.resultCacheMisses).to.equal(2);
+    expect(database.resultCacheHitRate).to.equal(0.5);
+  });
+  
+  it(@"keys results by their arguments", ^{
+    NSArray * greys = [database selectAllFrom:@"people"
+                                        where:@"lastName = ?"
+                                    arguments:@[ @"Grey" ]
+                                      orderBy:nil
+                                        error:&error];
+    NSArray * hoppers = [database selectAllFrom:@"people"
+                                          where:@"lastName = ?"
+                                      arguments:@[ @"Hopper" ]
+                                        orderBy:nil
+                                          error:&error];
+    
+    expect(greys.count).to.equal(2);
+    expect(hoppers.count).to.equal(0);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+  
+  it(@"invalidates results when their table is changed by any statement", ^{
+    [database countFrom:@"people" error:&error];
+    [database executeUpdate:@"INSERT INTO people (firstName, lastName) VALUES ('Grace', 'Hopper')"];
+    
+    expect([database countFrom:@"people" error:&error]).to.equal(3);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+  
+  it(@"invalidates results when all rows are deleted", ^{
+    [database countFrom:@"people" error:&error];
+    [database executeUpdate:@"DELETE FROM people"];
+    
+    expect([database countFrom:@"people" error:&error]).to.equal(0);
+  });
+  
+  it(@"invalidates results of joins", ^{
+    NSString * from = @"people JOIN pets ON pets.ownerId = people.id";
+    [database countFrom:from error:&error];
+    [database update:@"pets"
+              values:@{ @"ownerId": @2 }
+               where:nil
+           arguments:nil];
+    [database insertInto:@"pets"
+                 columns:@[ @"name", @"ownerId" ]
+                  values:@[ @[ @"Fido", @3 ] ]];
+    
+    expect([database countFrom:from error:&error]).to.equal(1);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+  
+  it(@"keeps results of unchanged tables", ^{
+    [database countFrom:@"people" error:&error];
+    [database deleteFrom:@"pets" where:nil arguments:nil];
+    
+    expect([database countFrom:@"people" error:&error]).to.equal(2);
+    expect(database.resultCacheHits).to.equal(1);
+  });
+  
+  it(@"keeps results of unchanged tables across batch updates", ^{
+    [database countFrom:@"people" error:&error];
+    [database batchUpdate:@"pets"
+               keyColumns:@[ @"id" ]
+                     rows:@[ @{ @"id": @1, @"name": @"Max" } ]
+                    error:&error];
+    [database batchUpdate:@"pets"
+               keyColumns:@[ @"id" ]
+                     rows:@[ @{ @"id": @1, @"name": @"Rex" } ]
+                    error:&error];
+    
+    expect([database countFrom:@"people" error:&error]).to.equal(2);
+    expect(error).to.beNil();
+    expect(database.resultCacheHits).to.equal(1);
+  });
+  
+  it(@"doesn't cache results read through an index of a WITHOUT ROWID table", ^{
+    if (sqlite3_libversion_number() < 3008002)
+    {
+      return;
+    }
+    [database executeUpdate:@"CREATE TABLE tags (name TEXT PRIMARY KEY, uses INTEGER) WITHOUT ROWID"];
+    [database executeUpdate:@"CREATE INDEX tags_uses ON tags (uses)"];
+    [database executeUpdate:@"INSERT INTO tags (name, uses) VALUES ('red', 1)"];
+    [database count:nil from:@"tags" where:@"uses = ?" arguments:@[ @1 ] error:&error];
+    [database executeUpdate:@"UPDATE tags SET uses = 2"];
+    
+    expect([database count:nil from:@"tags" where:@"uses = ?" arguments:@[ @1 ] error:&error]).to.equal(0);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+  
+  it(@"clears all results when the schema changes", ^{
+    [database countFrom:@"people" error:&error];
+    [database createIndexWithName:@"people_lastName"
+                        tableName:@"people"
+                          columns:@[ @"lastName" ]];
+    
+    expect(database.resultCacheCount).to.equal(0);
+  });
+  
+  it(@"still drops tables", ^{
+    [database countFrom:@"pets" error:&error];
+    [database dropTableWithName:@"pets"];
+    
+    expect([database countFrom:@"pets" error:&error]).to.equal(-1);
+    expect(error).notTo.beNil();
+  });
+  
+  it(@"doesn't keep results of a rolled back transaction", ^{
+    [database beginTransaction];
+    [database executeUpdate:@"DELETE FROM people WHERE id = 1"];
+    expect([database countFrom:@"people" error:&error]).to.equal(1);
+    [database rollback];
+    
+    expect([database countFrom:@"people" error:&error]).to.equal(2);
+  });
+  
+  it(@"removes the least recently used results beyond the byte limit", ^{
+    NSArray * records = [database selectAllFrom:@"people" orderBy:@"firstName" error:&error];
+    database.resultCacheByteLimit = database.resultCacheBytes;
+    [database selectAllFrom:@"people" orderBy:@"id" error:&error];
+    
+    expect(database.resultCacheCount).to.equal(1);
+    expect([database selectAllFrom:@"people" orderBy:@"firstName" error:&error]).to.equal(records);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+  
+  it(@"stops caching when disabled", ^{
+    [database countFrom:@"people" error:&error];
+    database.shouldCacheResults = NO;
+    [database countFrom:@"people" error:&error];
+    
+    expect(database.resultCacheCount).to.equal(0);
+    expect(database.resultCacheHits).to.equal(0);
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,127 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSchemaCatalog.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBSchemaCatalog)
+
+__block FMDatabase * database;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"firstName TEXT NOT NULL", @"lastName TEXT" ]];
+  [database createIndexWithName:@"name_index"
+                      tableName:@"people"
+                        columns:@[ @"lastName", @"firstName" ]
+                          error:NULL];
+});
+
+afterEach(^{
+  database = nil;
+});
+
+// ========== SCHEMA CATALOG ===========================================================================================
+#pragma mark - Schema Catalog
+
+describe(@"- schemaCatalog", ^{
+  
+  it(@"reads tables, columns, and indexes", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    
+    expect(catalog.tableNames).to.equal([NSSet setWithObject:@"people"]);
+    expect([[catalog schemaOfTable:@"people"] allKeys]).to.contain(@"firstName");
+    expect([catalog schemaOfTable:@"people"][@"firstName"][@"notnull"]).to.equal(@1);
+    expect([catalog schemaOfTable:@"people"][@"lastName"][@"type"]).to.equal(@"TEXT");
+    expect([catalog indexNamesOnTable:@"people"]).to.equal([NSSet setWithObject:@"name_index"]);
+    expect([catalog tableNameForIndex:@"name_index"]).to.equal(@"people");
+    expect([catalog sqlForTable:@"people"]).to.beginWith(@"CREATE TABLE");
+    expect([catalog sqlForIndex:@"name_index"]).to.beginWith(@"CREATE INDEX");
+  });
+  
+  it(@"reads triggers", ^{
+    [database executeUpdate:@"CREATE TRIGGER people_trigger AFTER DELETE ON people BEGIN SELECT 1; END"];
+    
+    expect([[database schemaCatalog] triggerNamesOnTable:@"People"]).to.equal([NSSet setWithObject:@"people_trigger"]);
+    expect([[database schemaCatalog] tableNames]).to.equal([NSSet setWithObject:@"people"]);
+  });
+  
+  it(@"looks up names case-insensitively", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    
+    expect([catalog schemaOfTable:@"PEOPLE"]).notTo.beNil();
+    expect([catalog indexNamesOnTable:@"People"]).to.equal([NSSet setWithObject:@"name_index"]);
+  });
+  
+  it(@"returns copies that callers can't change", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    
+    expect([catalog schemaOfTable:@"people"]).notTo.beKindOf([NSMutableDictionary class]);
+    expect([catalog schemaOfTable:@"people"][@"firstName"]).notTo.beKindOf([NSMutableDictionary class]);
+    expect([catalog indexNamesOnTable:@"people"]).notTo.beKindOf([NSMutableSet class]);
+    expect([database tableSchema:@"people"]).notTo.beKindOf([NSMutableDictionary class]);
+  });
+  
+  it(@"returns nil for unknown tables", ^{
+    expect([[database schemaCatalog] schemaOfTable:@"places"]).to.beNil();
+    expect([database tableSchema:@"places"]).to.equal(@{});
+  });
+  
+  it(@"leaves views to be described by PRAGMA table_info", ^{
+    [database executeUpdate:@"CREATE VIEW surnames AS SELECT lastName FROM people"];
+    
+    expect([[database schemaCatalog] schemaOfTable:@"surnames"]).to.beNil();
+    expect([[database tableSchema:@"surnames"] allKeys]).to.equal(@[ @"lastName" ]);
+  });
+  
+  it(@"is reused while the schema is unchanged", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    [database insertInto:@"people"
+                 columns:@[ @"firstName", @"lastName" ]
+                  values:@[ @[ @"Amelia", @"Grey" ] ]];
+    
+    expect([database schemaCatalog]).to.beIdenticalTo(catalog);
+  });
+  
+  it(@"is invalidated by schema helpers", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    [database addColumn:@"age INTEGER"
+                toTable:@"people"
+                  error:NULL];
+    
+    expect([database schemaCatalog]).notTo.beIdenticalTo(catalog);
+    expect([[database tableSchema:@"people"] allKeys]).to.contain(@"age");
+  });
+  
+  it(@"is invalidated when the schema version changes", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    [database executeUpdate:@"CREATE TABLE places (name TEXT)"];
+    
+    expect([database schemaCatalog].schemaVersion).to.beGreaterThan(catalog.schemaVersion);
+    expect([database tableNames]).to.equal([NSSet setWithObjects:@"people", @"places", nil]);
+  });
+
+});
+
+describe(@"- invalidateSchemaCatalog", ^{
+  
+  it(@"discards the cached catalog", ^{
+    FMDBSchemaCatalog * catalog = [database schemaCatalog];
+    [database invalidateSchemaCatalog];
+    
+    expect([database schemaCatalog]).notTo.beIdenticalTo(catalog);
+  });
+  
+  it(@"picks up temporary tables", ^{
+    [database schemaCatalog];
+    [database executeUpdate:@"CREATE TEMP TABLE scratch (value)"];
+    [database invalidateSchemaCatalog];
+    
+    expect([database tableNames]).to.contain(@"scratch");
+  });
+
+});
+
+SpecEnd
@@ -0,0 +1,172 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBSetMatching.h"
+#import "FMDatabase+FMDBStatementCache.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+#import <FMDB/FMDatabaseAdditions.h>
+
+SpecBegin(FMDatabase_FMDBSetMatching)
+
+__block FMDatabase * database;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName", @"lastName" ]
+                values:@[ @[ @1, @"Amelia", @"Grey" ],
+                          @[ @2, @"Earl",   @"Grey" ],
+                          @[ @3, @"James",  @"Green" ] ]];
+});
+
+afterEach(^{
+  database = nil;
+});
+
+// ========== SET MATCHING =============================================================================================
+#pragma mark - Set Matching
+
+describe(@"- matchingSetThreshold", ^{
+  
+  it(@"never uses a table by default", ^{
+    expect(database.matchingSetThreshold).to.equal(NSUIntegerMax);
+  });
+
+});
+
+describe(@"- prepareMatchingValues:preparedValues:error:", ^{
+  
+  it(@"leaves small arrays in place", ^{
+    NSDictionary * valuesToMatch = @{ @"id": @[ @1, @2 ] };
+    NSDictionary * preparedValues = nil;
+    BOOL succeeded = [database prepareMatchingValues:valuesToMatch
+                                      preparedValues:&preparedValues
+                                               error:NULL];
+    
+    expect(succeeded).to.beTruthy();
+    expect(preparedValues).to.beIdenticalTo(valuesToMatch);
+  });
+  
+  it(@"loads large arrays into a temporary table", ^{
+    database.matchingSetThreshold = 1;
+    
+    NSDictionary * preparedValues = nil;
+    [database prepareMatchingValues:@{ @"id": @[ @1, @2 ], @"lastName": @"Grey" }
+                     preparedValues:&preparedValues
+                              error:NULL];
+    
+    FMDBMatchingSet * matchingSet = preparedValues[@"id"];
+    expect(matchingSet).to.beKindOf([FMDBMatchingSet class]);
+    expect(matchingSet.count).to.equal(2);
+    expect(preparedValues[@"lastName"]).to.equal(@"Grey");
+    expect([database intForQuery:[@"SELECT COUNT(*) FROM " stringByAppendingString:matchingSet.tableName]]).to.equal(2);
+  });
+
+});
+
+describe(@"- selectResults:from:matchingValues:orderBy:limit:offset:error:", ^{
+  
+  it(@"matches more values than can be bound to a statement", ^{
+    database.matchingSetThreshold = 64;
+    
+    NSMutableArray * ids = [[NSMutableArray alloc] init];
+    for (NSInteger idx = 0; idx < 10000; idx++)
+    {
+      [ids addObject:@(idx)];
+    }
+    
+    NSArray * records = [database selectResults:@[ @"id" ]
+                                           from:@"people"
+                                 matchingValues:@{ @"id": ids }
+                                        orderBy:@"id"
+                                          limit:nil
+                                         offset:nil
+                                          error:NULL].allRecords;
+    
+    expect(records).to.equal(@[ @{ @"id": @1 }, @{ @"id": @2 }, @{ @"id": @3 } ]);
+  });
+  
+  it(@"matches tuples of columns", ^{
+    NSArray * records = [database selectResults:@[ @"id" ]
+                                           from:@"people"
+                                 matchingValues:@{ @[ @"firstName", @"lastName" ]: @[ @[ @"Amelia", @"Grey" ],
+                                                                                      @[ @"James",  @"Grey" ] ] }
+                                        orderBy:@"id"
+                                          limit:nil
+                                         offset:nil
+                                          error:NULL].allRecords;
+    
+    expect(records).to.equal(@[ @{ @"id": @1 } ]);
+  });
+  
+  it(@"matches large sets of tuples with a temporary table", ^{
+    database.matchingSetThreshold = 0;
+    
+    NSArray * records = [database selectResults:@[ @"id" ]
+                                           from:@"people"
+                                 matchingValues:@{ @[ @"firstName", @"lastName" ]: @[ @[ @"Earl",  @"Grey" ],
+                                                                                      @[ @"James", @"Green" ] ] }
+                                        orderBy:@"id"
+                                          limit:nil
+                                         offset:nil
+                                          error:NULL].allRecords;
+    
+    expect(records).to.equal(@[ @{ @"id": @2 }, @{ @"id": @3 } ]);
+  });
+  
+  it(@"uses a single statement shape for sets of any size", ^{
+    database.matchingSetThreshold = 0;
+    database.shouldCacheStatementShapes = YES;
+    
+    [database countFrom:@"people"
+         matchingValues:@{ @"id": @[ @1 ] }
+                  error:NULL];
+    NSInteger count = [database countFrom:@"people"
+                           matchingValues:@{ @"id": @[ @1, @2, @3 ] }
+                                    error:NULL];
+    
+    expect(count).to.equal(3);
+    expect(database.statementShapeCacheMisses).to.equal(1);
+    expect(database.statementShapeCacheHits).to.equal(1);
+  });
+
+});
+
+describe(@"- update:values:matchingValues:error:", ^{
+  
+  it(@"updates rows matching a large set", ^{
+    database.matchingSetThreshold = 0;
+    
+    NSInteger changes = [database update:@"people"
+                                  values:@{ @"lastName": @"Gray" }
+                          matchingValues:@{ @"id": @[ @1, @2 ] }
+                                   error:NULL];
+    
+    expect(changes).to.equal(2);
+    expect([database countFrom:@"people"
+                matchingValues:@{ @"lastName": @"Gray" }
+                         error:NULL]).to.equal(2);
+  });
+
+});
+
+describe(@"- deleteFrom:matchingValues:error:", ^{
+  
+  it(@"deletes rows matching a large set of tuples", ^{
+    database.matchingSetThreshold = 0;
+    
+    NSInteger changes = [database deleteFrom:@"people"
+                              matchingValues:@{ @[ @"firstName", @"lastName" ]: @[ @[ @"Amelia", @"Grey" ] ] }
+                                       error:NULL];
+    
+    expect(changes).to.equal(1);
+    expect([database countFrom:@"people"]).to.equal(2);
+  });
+
+});
+
+SpecEnd
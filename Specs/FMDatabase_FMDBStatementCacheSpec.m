@@ -0,0 +1,153 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMDatabase+FMDBStatementCache.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+SpecBegin(FMDatabase_FMDBStatementCache)
+
+__block FMDatabase * database;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"firstName", @"lastName" ]];
+  [database insertInto:@"people"
+               columns:@[ @"firstName", @"lastName" ]
+                values:@[ @[ @"Amelia", @"Grey" ],
+                          @[ @"Earl",   @"Grey" ],
+                          @[ @"James",  @"Green" ] ]];
+  
+  database.shouldCacheStatementShapes = YES;
+});
+
+afterEach(^{
+  database = nil;
+});
+
+// ========== STATEMENT CACHE ==========================================================================================
+#pragma mark - Statement Cache
+
+describe(@"- shouldCacheStatementShapes", ^{
+  
+  it(@"enables FMDB's prepared statement cache", ^{
+    expect(database.shouldCacheStatements).to.beTruthy();
+  });
+  
+  it(@"restores FMDB's prepared statement cache when disabled", ^{
+    database.shouldCacheStatementShapes = NO;
+    
+    expect(database.shouldCacheStatements).to.beFalsy();
+  });
+  
+  it(@"reuses SQL for statements with the same shape", ^{
+    NSArray * greys = [database selectResultsFrom:@"people"
+                                   matchingValues:@{ @"lastName": @"Grey" }
+                                          orderBy:@"firstName"
+                                            error:NULL].allRecords;
+    NSArray * greens = [database selectResultsFrom:@"people"
+                                    matchingValues:@{ @"lastName": @"Green" }
+                                           orderBy:@"firstName"
+                                             error:NULL].allRecords;
+    
+    expect(greys.count).to.equal(2);
+    expect(greens).to.equal(@[ @{ @"firstName": @"James", @"lastName": @"Green" } ]);
+    expect(database.statementShapeCacheMisses).to.equal(1);
+    expect(database.statementShapeCacheHits).to.equal(1);
+  });
+  
+  it(@"distinguishes arrays of different sizes", ^{
+    [database countFrom:@"people"
+         matchingValues:@{ @"firstName": @[ @"Amelia" ] }
+                  error:NULL];
+    NSInteger count = [database countFrom:@"people"
+                           matchingValues:@{ @"firstName": @[ @"Amelia", @"Earl" ] }
+                                    error:NULL];
+    
+    expect(count).to.equal(2);
+    expect(database.statementShapeCacheMisses).to.equal(2);
+    expect(database.statementShapeCacheHits).to.equal(0);
+  });
+  
+  it(@"binds limits and offsets so pages share a statement", ^{
+    NSArray * firstPage = [database selectResults:nil
+                                             from:@"people"
+                                   matchingValues:nil
+                                          orderBy:@"firstName"
+                                            limit:@1
+                                           offset:@0
+                                            error:NULL].allRecords;
+    NSArray * secondPage = [database selectResults:nil
+                                              from:@"people"
+                                    matchingValues:nil
+                                           orderBy:@"firstName"
+                                             limit:@1
+                                            offset:@1
+                                             error:NULL].allRecords;
+    
+    expect(firstPage).to.equal(@[ @{ @"firstName": @"Amelia", @"lastName": @"Grey" } ]);
+    expect(secondPage).to.equal(@[ @{ @"firstName": @"Earl", @"lastName": @"Grey" } ]);
+    expect(database.statementShapeCacheHits).to.equal(1);
+  });
+  
+  it(@"writes limits and offsets into statements with named or numbered parameters", ^{
+    NSString * selectSQL = [FMDatabase statementToSelect:nil
+                                                    from:@"people"
+                                                   where:@"lastName = :lastName"
+                                                 groupBy:nil
+                                                  having:nil
+                                                 orderBy:@"firstName"
+                                                   limit:@1
+                                                  offset:@1];
+    NSArray * secondPage = [database selectResults:nil
+                                              from:@"people"
+                                             where:@"lastName = ?1"
+                                           groupBy:nil
+                                            having:nil
+                                         arguments:@[ @"Grey" ]
+                                           orderBy:@"firstName"
+                                             limit:@1
+                                            offset:@1
+                                             error:NULL].allRecords;
+    
+    expect([selectSQL hasSuffix:@"LIMIT 1 OFFSET 1"]).to.beTruthy();
+    expect(secondPage).to.equal(@[ @{ @"firstName": @"Earl", @"lastName": @"Grey" } ]);
+  });
+  
+  it(@"caches updates, inserts, and deletes", ^{
+    [database update:@"people"
+              values:@{ @"lastName": @"Gris" }
+      matchingValues:@{ @"firstName": @"Amelia" }
+               error:NULL];
+    [database update:@"people"
+              values:@{ @"lastName": @"Gris" }
+      matchingValues:@{ @"firstName": @"Earl" }
+               error:NULL];
+    [database insertInto:@"people" row:@{ @"firstName": @"Ada", @"lastName": @"Byron" } error:NULL];
+    [database insertInto:@"people" row:@{ @"firstName": @"Alan", @"lastName": @"Turing" } error:NULL];
+    [database deleteFrom:@"people" matchingValues:@{ @"lastName": @"Byron" } error:NULL];
+    NSInteger numberDeleted = [database deleteFrom:@"people" matchingValues:@{ @"lastName": @"Gris" } error:NULL];
+    
+    expect(numberDeleted).to.equal(2);
+    expect(database.statementShapeCacheMisses).to.equal(3);
+    expect(database.statementShapeCacheHits).to.equal(3);
+  });
+
+});
+
+describe(@"- clearStatementShapeCache", ^{
+  
+  it(@"resets the counters", ^{
+    [database countFrom:@"people" error:NULL];
+    [database countFrom:@"people" error:NULL];
+    [database clearStatementShapeCache];
+    
+    expect(database.statementShapeCacheHits).to.equal(0);
+    expect(database.statementShapeCacheMisses).to.equal(0);
+  });
+
+});
+
+SpecEnd
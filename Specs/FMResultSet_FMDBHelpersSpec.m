@@ -0,0 +1,255 @@
+#define EXP_SHORTHAND
+
+#import <Specta/Specta.h>
+#import <Expecta/Expecta.h>
+#import "FMDatabase+FMDBHelpers.h"
+#import "FMResultSet+FMDBHelpers.h"
+#import "FMDatabase+FMDBSpecHelpers.h"
+
+@interface FMDBSpecPerson : NSObject
+
+@property (nonatomic, copy) NSString * firstName;
+@property (nonatomic, copy) NSString * lastName;
+@property (nonatomic, assign) NSInteger age;
+@property (nonatomic, assign) double score;
+@property (nonatomic, assign, getter = isActive) BOOL active;
+@property (nonatomic, assign, readonly) int64_t id;
+
+@end
+
+@implementation FMDBSpecPerson
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self != nil)
+  {
+    _lastName = @"Unknown";
+  }
+  return self;
+}
+
+@end
+
+SpecBegin(FMResultSet_FMDBHelpers)
+
+__block FMDatabase * database;
+__block FMResultSet * results;
+beforeEach(^{
+  database = [FMDatabase openInMemoryDatabase];
+  [database createTableWithName:@"people"
+                        columns:@[ @"id INTEGER PRIMARY KEY", @"firstName" ]];
+  
+  NSMutableArray * rows = [[NSMutableArray alloc] init];
+  for (NSUInteger rowIdx = 1; rowIdx <= 200; rowIdx++)
+  {
+    [rows addObject:@[ @(rowIdx), [NSString stringWithFormat:@"Person %lu", (unsigned long)rowIdx] ]];
+  }
+  [database insertInto:@"people"
+               columns:@[ @"id", @"firstName" ]
+                values:rows];
+  
+  results = [database selectResultsFrom:@"people"
+                                orderBy:@"id"
+                                  error:NULL];
+});
+
+afterEach(^{
+  results = nil;
+  database = nil;
+});
+
+// ========== STREAMING ================================================================================================
+#pragma mark - Streaming
+
+describe(@"- enumerateRecordsUsingBlock:", ^{
+  
+  it(@"passes each record to the block", ^{
+    __block NSUInteger recordCount = 0;
+    [results enumerateRecordsUsingBlock:^(NSDictionary * record, BOOL * stop) {
+      recordCount++;
+      expect(record[@"id"]).to.equal(@(recordCount));
+    }];
+    
+    expect(recordCount).to.equal(200);
+  });
+  
+  it(@"stops early", ^{
+    __block NSDictionary * lastRecord = nil;
+    [results enumerateRecordsUsingBlock:^(NSDictionary * record, BOOL * stop) {
+      lastRecord = record;
+      *stop = [record[@"id"] isEqual:@3];
+    }];
+    
+    expect(lastRecord).to.equal(@{ @"id": @3, @"firstName": @"Person 3" });
+  });
+
+});
+
+describe(@"- enumerateRecordsInBatchesOfSize:usingBlock:", ^{
+  
+  it(@"passes records in batches", ^{
+    NSMutableArray * batchSizes = [[NSMutableArray alloc] init];
+    [results enumerateRecordsInBatchesOfSize:75 usingBlock:^(NSArray * records, BOOL * stop) {
+      [batchSizes addObject:@(records.count)];
+    }];
+    
+    expect(batchSizes).to.equal(@[ @75, @75, @50 ]);
+  });
+
+});
+
+describe(@"- lazyRecords", ^{
+  
+  it(@"reads records on demand", ^{
+    NSArray * records = results.lazyRecords;
+    
+    expect(records[150]).to.equal(@{ @"id": @151, @"firstName": @"Person 151" });
+    expect(records[0]).to.equal(@{ @"id": @1, @"firstName": @"Person 1" });
+    expect(records.count).to.equal(200);
+    expect(records.lastObject).to.equal(@{ @"id": @200, @"firstName": @"Person 200" });
+  });
+  
+  it(@"can be enumerated", ^{
+    NSUInteger recordCount = 0;
+    for (NSDictionary * record in results.lazyRecords)
+    {
+      recordCount++;
+      expect(record[@"id"]).to.equal(@(recordCount));
+    }
+    
+    expect(recordCount).to.equal(200);
+  });
+  
+  it(@"raises an exception when a row can't be read", ^{
+    NSArray * records = results.lazyRecords;
+    expect(records[0]).to.equal(@{ @"id": @1, @"firstName": @"Person 1" });
+    
+    sqlite3_interrupt([database sqliteHandle]);
+    expect(^{ [records objectAtIndex:100]; }).to.raise(FMDBRecordReadException);
+    expect(records[100]).to.equal(@{ @"id": @101, @"firstName": @"Person 101" });
+  });
+
+});
+
+// ========== OBJECTS ==================================================================================================
+#pragma mark - Objects
+
+describe(@"- currentObjectOfClass:", ^{
+  
+  beforeEach(^{
+    [database createTableWithName:@"players"
+                          columns:@[ @"id INTEGER PRIMARY KEY", @"FirstName", @"lastName", @"age", @"score",
+                                     @"active", @"team" ]];
+    [database insertInto:@"players"
+                 columns:@[ @"id", @"FirstName", @"lastName", @"age", @"score", @"active", @"team" ]
+                  values:@[ @[ @7, @"Amelia", @"Grey", @42, @3.5, @1, @"Blue" ],
+                            @[ @8, @"Earl", [NSNull null], [NSNull null], @"2.25", @0, @"Red" ] ]];
+    results = [database selectResultsFrom:@"players"
+                                  orderBy:@"id"
+                                    error:NULL];
+  });
+  
+  it(@"sets properties from columns", ^{
+    [results next];
+    FMDBSpecPerson * person = [results currentObjectOfClass:[FMDBSpecPerson class]];
+    
+    expect(person.id).to.equal(7);
+    expect(person.firstName).to.equal(@"Amelia");
+    expect(person.lastName).to.equal(@"Grey");
+    expect(person.age).to.equal(42);
+    expect(person.score).to.equal(3.5);
+    expect(person.active).to.beTruthy();
+  });
+  
+  it(@"leaves properties of NULL columns unchanged", ^{
+    [results next];
+    [results next];
+    FMDBSpecPerson * person = [results currentObjectOfClass:[FMDBSpecPerson class]];
+    
+    expect(person.firstName).to.equal(@"Earl");
+    expect(person.lastName).to.equal(@"Unknown");
+    expect(person.age).to.equal(0);
+    expect(person.score).to.equal(2.25);
+    expect(person.active).to.beFalsy();
+  });
+
+});
+
+describe(@"- allObjectsOfClass:", ^{
+  
+  it(@"reads all rows as objects", ^{
+    NSArray * people = [results allObjectsOfClass:[FMDBSpecPerson class]];
+    
+    expect(people.count).to.equal(200);
+    expect([people[0] firstName]).to.equal(@"Person 1");
+    expect([people[199] id]).to.equal(200);
+  });
+
+});
+
+describe(@"- enumerateObjectsOfClass:usingBlock:", ^{
+  
+  it(@"stops when asked", ^{
+    NSMutableArray * names = [[NSMutableArray alloc] init];
+    [results enumerateObjectsOfClass:[FMDBSpecPerson class] usingBlock:^(FMDBSpecPerson * person, BOOL * stop) {
+      [names addObject:person.firstName];
+      *stop = (names.count == 2);
+    }];
+    
+    expect(names).to.equal(@[ @"Person 1", @"Person 2" ]);
+  });
+
+});
+
+// ========== COLUMNS ==================================================================================================
+#pragma mark - Columns
+
+describe(@"- readColumnsIntoBuffers:", ^{
+  
+  beforeEach(^{
+    [database update:@"people"
+             columns:@[ @"firstName" ]
+         expressions:@[ @"NULL" ]
+               where:@"id = 2"
+           arguments:nil];
+  });
+  
+  it(@"reads columns in chunks", ^{
+    FMDBColumnBuffer * ids = [[FMDBColumnBuffer alloc] initWithColumnIndex:0
+                                                                      type:FMDBColumnBufferTypeInteger
+                                                                  capacity:128];
+    FMDBColumnBuffer * names = [[FMDBColumnBuffer alloc] initWithColumnIndex:1
+                                                                        type:FMDBColumnBufferTypeText
+                                                                    capacity:128];
+    
+    expect([results readColumnsIntoBuffers:@[ ids, names ]]).to.equal(128);
+    expect(ids.integers[0]).to.equal(1);
+    expect(ids.integers[127]).to.equal(128);
+    expect([names stringAtIndex:0]).to.equal(@"Person 1");
+    expect([names isNullAtIndex:1]).to.beTruthy();
+    expect([names stringAtIndex:1]).to.beNil();
+    
+    expect([results readColumnsIntoBuffers:@[ ids, names ]]).to.equal(72);
+    expect(ids.integers[0]).to.equal(129);
+    expect([names stringAtIndex:71]).to.equal(@"Person 200");
+    
+    expect([results readColumnsIntoBuffers:@[ ids, names ]]).to.equal(0);
+  });
+
+});
+
+describe(@"- readRealColumn:intoValues:nullBitmap:maxRows:", ^{
+  
+  it(@"reads into caller-supplied storage", ^{
+    double values[200];
+    uint8_t nulls[25];
+    
+    expect([results readRealColumn:0 intoValues:values nullBitmap:nulls maxRows:200]).to.equal(200);
+    expect(values[199]).to.equal(200.0);
+    expect(nulls[0]).to.equal(0);
+  });
+
+});
+
+SpecEnd